@@ -32,6 +32,7 @@
 #include <fiber/fiber_control.hpp>
 #include <logger/assertions.hpp>
 #include <random/random.hpp>
+#include <perf/timeline_trace.hpp>
 #include <graphlab/macros_def.hpp>
 //#include <valgrind/valgrind.h>
 namespace graphlab {
@@ -222,6 +223,7 @@ void fiber_control::worker_init(size_t workerid) {
   t->garbage = NULL;
   t->workerid = workerid;
   t->parent = this;
+  timeline_trace_set_thread_name("fiber_worker " + std::to_string(workerid));
 
   schedule[workerid].waiting = true;
   schedule[workerid].active_lock.lock();
@@ -234,7 +236,11 @@ void fiber_control::worker_init(size_t workerid) {
       schedule[workerid].active_lock.unlock();
       schedule[workerid].waiting = false;
       active_workers.inc();
-      yield_to(next_fib);
+      {
+        // the time until there are no more fibers to run on this worker
+        TIMELINE_TRACE_SCOPE("fiber", "run_fibers");
+        yield_to(next_fib);
+      }
       if (context_switch_periodic_callback && 
           flush_timer.current_time() > 0.0001 && flush_lock.try_lock()) {
         context_switch_periodic_callback(get_worker_id());
@@ -0,0 +1,307 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <logger/logger.hpp>
+#include <fileio/async_file_io.hpp>
+#include <fileio/fileio_constants.hpp>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define GRAPHLAB_HAS_IO_URING
+#endif
+#endif
+
+#ifdef GRAPHLAB_HAS_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+
+namespace graphlab {
+namespace fileio {
+
+namespace {
+
+/**
+ * Completes a request with pread / pwrite, starting after the bytes
+ * already transferred.
+ */
+void complete_request(async_io_request& request, bool is_write) {
+  size_t done = request.result > 0 ? request.result : 0;
+  while (done < request.length) {
+    ssize_t ret;
+    if (is_write) {
+      ret = pwrite(request.fd, request.buffer + done,
+                   request.length - done, request.offset + done);
+    } else {
+      ret = pread(request.fd, request.buffer + done,
+                  request.length - done, request.offset + done);
+    }
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret < 0) {
+      request.result = -errno;
+      return;
+    }
+    if (ret == 0) break;
+    done += ret;
+  }
+  request.result = done;
+}
+
+} // anonymous namespace
+
+#ifdef GRAPHLAB_HAS_IO_URING
+
+/**
+ * A minimal io_uring: the submission and completion rings mapped from the
+ * kernel.
+ */
+struct async_file_io::ring {
+  int fd = -1;
+  unsigned entries = 0;
+  void* sq_ptr = MAP_FAILED;
+  size_t sq_len = 0;
+  void* cq_ptr = MAP_FAILED;
+  size_t cq_len = 0;
+  io_uring_sqe* sqes = (io_uring_sqe*)MAP_FAILED;
+  size_t sqes_len = 0;
+
+  unsigned* sq_head = NULL;
+  unsigned* sq_tail = NULL;
+  unsigned* sq_mask = NULL;
+  unsigned* sq_array = NULL;
+  unsigned* cq_head = NULL;
+  unsigned* cq_tail = NULL;
+  unsigned* cq_mask = NULL;
+  io_uring_cqe* cqes = NULL;
+
+  ~ring() {
+    if (sqes != MAP_FAILED) munmap(sqes, sqes_len);
+    if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_len);
+    if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_len);
+    if (fd >= 0) close(fd);
+  }
+
+  /// Returns false if io_uring is not available.
+  bool init(unsigned depth) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd = syscall(__NR_io_uring_setup, depth, &params);
+    if (fd < 0) return false;
+    entries = params.sq_entries;
+
+    sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) sq_len = cq_len = std::max(sq_len, cq_len);
+
+    sq_ptr = mmap(NULL, sq_len, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED) return false;
+    if (single_mmap) {
+      cq_ptr = sq_ptr;
+    } else {
+      cq_ptr = mmap(NULL, cq_len, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cq_ptr == MAP_FAILED) return false;
+    }
+    sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = (io_uring_sqe*)mmap(NULL, sqes_len, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+
+    char* sq = (char*)sq_ptr;
+    char* cq = (char*)cq_ptr;
+    sq_head = (unsigned*)(sq + params.sq_off.head);
+    sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    sq_array = (unsigned*)(sq + params.sq_off.array);
+    cq_head = (unsigned*)(cq + params.cq_off.head);
+    cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  /**
+   * Moves the available completions into the requests, and returns their
+   * number.
+   */
+  size_t reap(std::vector<async_io_request>& requests) {
+    size_t num_completed = 0;
+    unsigned head = *cq_head;
+    while (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+      io_uring_cqe* cqe = &cqes[head & *cq_mask];
+      requests[cqe->user_data].result = cqe->res;
+      ++head;
+      ++num_completed;
+    }
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    return num_completed;
+  }
+
+  /**
+   * Submits requests [begin, end), at most entries of them, and waits for
+   * their completion.
+   *
+   * Returns false if the submission failed. The requests the kernel did
+   * not accept are then withdrawn, and left with a result of 0 for the
+   * caller to complete synchronously. The accepted requests still write
+   * to their buffers, so they are waited for before returning. Throws if
+   * even that fails.
+   */
+  bool run(std::vector<async_io_request>& requests,
+           size_t begin, size_t end, bool is_write) {
+    size_t n = end - begin;
+    std::vector<iovec> iov(n);
+    unsigned first = *sq_tail;
+    unsigned tail = first;
+    for (size_t i = 0; i < n; ++i) {
+      async_io_request& request = requests[begin + i];
+      iov[i].iov_base = request.buffer;
+      iov[i].iov_len = request.length;
+      unsigned index = tail & *sq_mask;
+      io_uring_sqe* sqe = &sqes[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe->fd = request.fd;
+      sqe->addr = (unsigned long)&iov[i];
+      sqe->len = 1;
+      sqe->off = request.offset;
+      sqe->user_data = begin + i;
+      sq_array[index] = index;
+      ++tail;
+    }
+    __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+    size_t to_submit = n;
+    size_t completed = 0;
+    while (completed < n) {
+      int ret = syscall(__NR_io_uring_enter, fd, to_submit, 1,
+                        IORING_ENTER_GETEVENTS, NULL, 0);
+      if (ret < 0) {
+        if (errno == EINTR) continue;
+        int error = errno;
+        // withdraw the entries the kernel has not consumed
+        size_t accepted = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) - first;
+        __atomic_store_n(sq_tail, first + (unsigned)accepted, __ATOMIC_RELEASE);
+        logstream(LOG_WARNING) << "io_uring_enter failed: " << strerror(error)
+                               << ". Completing " << n - accepted
+                               << " requests synchronously" << std::endl;
+        completed += reap(requests);
+        while (completed < accepted) {
+          if (syscall(__NR_io_uring_enter, fd, 0, 1,
+                      IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR) {
+            log_and_throw_io_failure(std::string("io_uring_enter failed: ") +
+                                     strerror(errno));
+          }
+          completed += reap(requests);
+        }
+        return false;
+      }
+      to_submit -= std::min<size_t>(to_submit, ret);
+      completed += reap(requests);
+    }
+    return true;
+  }
+};
+
+#else
+
+struct async_file_io::ring {
+  unsigned entries = 0;
+  bool init(unsigned) { return false; }
+  bool run(std::vector<async_io_request>&, size_t, size_t, bool) {
+    return false;
+  }
+};
+
+#endif
+
+async_file_io::async_file_io() {
+  if (FILEIO_USE_IO_URING) {
+    m_ring.reset(new ring);
+    if (!m_ring->init(std::max<size_t>(FILEIO_IO_URING_QUEUE_DEPTH, 1))) {
+      logstream(LOG_INFO) << "io_uring is not available. "
+                          << "Using synchronous local file IO" << std::endl;
+      m_ring.reset();
+    }
+  }
+}
+
+async_file_io::~async_file_io() { }
+
+bool async_file_io::using_io_uring() const {
+  return m_ring != nullptr;
+}
+
+bool async_file_io::read(std::vector<async_io_request>& requests) {
+  return submit(requests, false);
+}
+
+bool async_file_io::write(std::vector<async_io_request>& requests) {
+  return submit(requests, true);
+}
+
+bool async_file_io::submit(std::vector<async_io_request>& requests,
+                           bool is_write) {
+  for (auto& request : requests) request.result = 0;
+  if (m_ring && requests.size() > 1) {
+    for (size_t begin = 0; begin < requests.size(); begin += m_ring->entries) {
+      size_t end = std::min<size_t>(requests.size(), begin + m_ring->entries);
+      if (!m_ring->run(requests, begin, end, is_write)) break;
+    }
+  }
+  bool success = true;
+  for (auto& request : requests) {
+    // complete short transfers, and retry synchronously the requests the
+    // ring did not perform or which failed in the ring
+    if (request.result < 0 || (size_t)request.result < request.length) {
+      if (request.result < 0) request.result = 0;
+      complete_request(request, is_write);
+    }
+    if (request.result < 0 || (size_t)request.result != request.length) {
+      success = false;
+    }
+  }
+  return success;
+}
+
+bool write_fully(int fd, size_t offset, const char* buffer, size_t length) {
+  async_io_request request;
+  request.fd = fd;
+  request.offset = offset;
+  request.buffer = const_cast<char*>(buffer);
+  request.length = length;
+  complete_request(request, true);
+  return request.result >= 0 && (size_t)request.result == length;
+}
+
+async_file_io& get_thread_local_async_file_io() {
+  static thread_local async_file_io io;
+  return io;
+}
+
+int open_local_file_for_read(const std::string& path, bool& direct) {
+#ifdef O_DIRECT
+  if (direct) {
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECT);
+    if (fd >= 0) return fd;
+  }
+#endif
+  direct = false;
+  return open(path.c_str(), O_RDONLY);
+}
+
+} // namespace fileio
+} // namespace graphlab
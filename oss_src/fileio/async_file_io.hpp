@@ -0,0 +1,108 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_FILEIO_ASYNC_FILE_IO_HPP
+#define GRAPHLAB_FILEIO_ASYNC_FILE_IO_HPP
+#include <string>
+#include <vector>
+#include <memory>
+#include <sys/types.h>
+
+namespace graphlab {
+namespace fileio {
+
+/**
+ * A positional read or write of length bytes at offset of an open file
+ * descriptor.
+ */
+struct async_io_request {
+  int fd = -1;
+  size_t offset = 0;
+  char* buffer = NULL;
+  size_t length = 0;
+  /// After completion, the number of bytes transferred, or -errno.
+  ssize_t result = 0;
+};
+
+/**
+ * Batched positional IO on local files.
+ *
+ * A batch of reads (or writes) is submitted at once, and the call returns
+ * once every request of the batch has completed. On Linux, the batch is
+ * submitted through an io_uring of FILEIO_IO_URING_QUEUE_DEPTH entries, so
+ * that a single thread keeps many requests in flight. When io_uring is not
+ * available (older kernels, other platforms, or FILEIO_USE_IO_URING = 0),
+ * the requests are performed one at a time with pread / pwrite.
+ *
+ * Short transfers are completed, so a request is only partial when a read
+ * hits the end of the file or an error occurs.
+ *
+ * An async_file_io object is not safe for concurrent use. Use one per
+ * thread (see \ref get_thread_local_async_file_io).
+ */
+class async_file_io {
+ public:
+  async_file_io();
+  ~async_file_io();
+
+  async_file_io(const async_file_io&) = delete;
+  async_file_io& operator=(const async_file_io&) = delete;
+
+  /// Returns true if requests are submitted through io_uring.
+  bool using_io_uring() const;
+
+  /**
+   * Performs all the reads. Returns true if every request read exactly
+   * length bytes.
+   */
+  bool read(std::vector<async_io_request>& requests);
+
+  /**
+   * Performs all the writes. Returns true if every request wrote exactly
+   * length bytes.
+   */
+  bool write(std::vector<async_io_request>& requests);
+
+ private:
+  struct ring;
+  std::unique_ptr<ring> m_ring;
+
+  bool submit(std::vector<async_io_request>& requests, bool is_write);
+};
+
+/**
+ * Writes length bytes at offset of fd with pwrite, completing short
+ * writes. Returns true if all the bytes were written.
+ *
+ * Single writes gain nothing from a ring: a thread waits for them either
+ * way. This is what the block writer uses, since it writes one block at a
+ * time.
+ */
+bool write_fully(int fd, size_t offset, const char* buffer, size_t length);
+
+/**
+ * Returns an async_file_io object owned by the calling thread.
+ */
+async_file_io& get_thread_local_async_file_io();
+
+/**
+ * Opens a local file for reading. If direct is true, tries to open it with
+ * O_DIRECT, bypassing the page cache, and falls back to a regular open if
+ * the file system does not support it. direct is set to whether O_DIRECT
+ * is used. Reads of a file opened with O_DIRECT must use buffers, offsets
+ * and lengths aligned to DIRECT_IO_ALIGNMENT.
+ *
+ * Returns -1 on failure.
+ */
+int open_local_file_for_read(const std::string& path, bool& direct);
+
+/// The alignment required by O_DIRECT reads.
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+} // namespace fileio
+} // namespace graphlab
+#endif
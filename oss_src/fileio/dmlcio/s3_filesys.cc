@@ -12,7 +12,11 @@
 #include <algorithm>
 #include <ctime>
 #include <sstream>
+#include <map>
+#include <memory>
 #include <fileio/set_curl_options.hpp>
+#include <fileio/fileio_constants.hpp>
+#include <fileio/multipart_upload_writer.hpp>
 extern "C" {
 #include <errno.h>
 #include <curl/curl.h>
@@ -493,9 +497,11 @@ class ReadStream : public CURLReadStreamBase {
   ReadStream(const URI &path,
              const std::string &aws_id,
              const std::string &aws_key,
-             size_t file_size)
-      : path_(path), aws_id_(aws_id), aws_key_(aws_key) {
-        this->expect_file_size_ = file_size;
+             size_t file_size,
+             size_t range_end = 0)
+      : path_(path), aws_id_(aws_id), aws_key_(aws_key), range_end_(range_end) {
+        // a bounded stream ends at range_end
+        this->expect_file_size_ = range_end > 0 ? range_end : file_size;
   }
   virtual ~ReadStream(void) {}
 
@@ -510,6 +516,8 @@ class ReadStream : public CURLReadStreamBase {
   URI path_;
   // aws access key and id
   std::string aws_id_, aws_key_;
+  // end of the requested byte range (exclusive), 0 if the range is open
+  size_t range_end_;
 };
 
 // initialize the reader at begin bytes
@@ -529,6 +537,7 @@ void ReadStream::InitRequest(size_t begin_bytes,
   surl << "https://" << path_.host << ".s3.amazonaws.com" << '/'
        << RemoveBeginSlash(path_.name);
   srange << "Range: bytes=" << begin_bytes << "-";
+  if (range_end_ > begin_bytes) srange << range_end_ - 1;
   *slist = curl_slist_append(*slist, sdate.str().c_str());
   *slist = curl_slist_append(*slist, srange.str().c_str());
   *slist = curl_slist_append(*slist, sauth.str().c_str());
@@ -557,6 +566,15 @@ class HttpReadStream : public CURLReadStreamBase {
   URI path_;
 };
 
+/*!
+ * \brief multipart upload stream. The parts are uploaded by the background
+ *  threads of a graphlab::fileio::multipart_upload_writer while the writer
+ *  keeps producing data.
+ *
+ * Every max_buffer_size_ bytes written become a part. At most
+ * FILEIO_S3_UPLOAD_PARALLELISM parts are uploaded concurrently, each upload
+ * thread with its own curl handle.
+ */
 class WriteStream : public Stream {
  public:
   WriteStream(const URI &path,
@@ -573,56 +591,69 @@ class WriteStream : public Stream {
       max_buffer_size_ = kDefaultBufferSize;
     }
     max_error_retry_ = 3;
+    size_t parallelism = std::max<size_t>(graphlab::fileio::FILEIO_S3_UPLOAD_PARALLELISM, 1);
+    part_curls_.resize(parallelism, NULL);
     ecurl_ = curl_easy_init();
     this->Init();
+    parts_.reset(new graphlab::fileio::multipart_upload_writer(
+        max_buffer_size_, parallelism, max_error_retry_,
+        [this](size_t thread_id, size_t partno, const std::string &data) {
+          return this->UploadPart(thread_id, partno, data);
+        },
+        [this](const std::map<size_t, std::string> &etags) {
+          this->Finish(etags);
+        },
+        [this]() { this->Abort(); }));
   }
   virtual size_t Read(void *ptr, size_t size) {
     logstream(LOG_FATAL) << "S3.WriteStream cannot be used for read" << std::endl;
     return 0;
   }
-  virtual void Write(const void *ptr, size_t size);
+  virtual void Write(const void *ptr, size_t size) {
+    parts_->write(reinterpret_cast<const char*>(ptr), size);
+  }
   // destructor
   virtual ~WriteStream() {
     if (!closed_) {
       no_exception_ = true;
-      this->Upload(true);
-      this->Finish();
-      curl_easy_cleanup(ecurl_);
+      try {
+        parts_->close();
+      } catch (...) {
+      }
     }
+    parts_.reset();
+    this->Cleanup();
   }
 
   virtual void Close() {
     closed_ = true;
-    this->Upload(true);
-    this->Finish();
-    curl_easy_cleanup(ecurl_);
+    parts_->close();
   }
     
  private:
   // internal maximum buffer size
   size_t max_buffer_size_;
-  // maximum time of retry when error occurs
+  // maximum number of attempts of every request
   int max_error_retry_;
   // path we are reading
   URI path_;
   // aws access key and id
   std::string aws_id_, aws_key_;
-  // easy curl handle used for the request
+  // easy curl handle used for the initiate, complete and abort requests
   CURL *ecurl_;
+  // easy curl handle of each upload thread, created on first use
+  std::vector<CURL*> part_curls_;
   // upload_id used by AWS
   std::string upload_id_;
-  // write data buffer
-  std::string buffer_;
-  // etags of each part we uploaded
-  std::vector<std::string> etags_;
-  // part id of each part we uploaded
-  std::vector<size_t> part_ids_;
+  // splits the written data into parts and uploads them
+  std::unique_ptr<graphlab::fileio::multipart_upload_writer> parts_;
 
   bool closed_ = false;
 
   bool no_exception_ = false;
   /*!
    * \brief helper function to do http post request
+   * \param ecurl the curl handle used for the request
    * \param method method to peform
    * \param path the resource to post
    * \param url_args additional arguments in URL
@@ -631,45 +662,54 @@ class WriteStream : public Stream {
    * \param data data to post
    * \param out_header holds output Header
    * \param out_data holds output data
+   * \param max_attempts number of attempts on connection failures, or 0 for
+   *  max_error_retry_
+   * \param throw_on_error if true, an error returned by S3 raises an
+   *  exception even when no_exception_ is set
    */
-  void Run(const std::string &method,
+  void Run(CURL *&ecurl,
+           const std::string &method,
            const URI &path,
            const std::string &args,
            const std::string &content_type,
            const std::string &data,
            std::string *out_header,
-           std::string *out_data);
+           std::string *out_data,
+           int max_attempts = 0,
+           bool throw_on_error = false);
   /*!
    * \brief initialize the upload request
    */
   void Init(void);
   /*!
-   * \brief upload the buffer to S3, store the etag
-   * clear the buffer
+   * \brief upload a single part once, and return its etag. Retries are
+   *  done by the multipart_upload_writer.
    */
-  void Upload(bool force_upload_even_if_zero_bytes = false);
+  std::string UploadPart(size_t thread_id, size_t partno, const std::string &data);
+  /*!
+   * \brief abort the upload, discarding the uploaded parts
+   */
+  void Abort(void);
   /*!
    * \brief commit the upload and finish the session
    */
-  void Finish(void);
+  void Finish(const std::map<size_t, std::string> &etags);
+  /*!
+   * \brief release the curl handles
+   */
+  void Cleanup(void);
 };
 
-void WriteStream::Write(const void *ptr, size_t size) {
-  size_t rlen = buffer_.length();
-  buffer_.resize(rlen + size);
-  std::memcpy(BeginPtr(buffer_) + rlen, ptr, size);
-  if (buffer_.length() >= max_buffer_size_) {
-    this->Upload();
-  }
-}
-
-void WriteStream::Run(const std::string &method,
+void WriteStream::Run(CURL *&ecurl,
+                      const std::string &method,
                       const URI &path,
                       const std::string &args,
                       const std::string &content_type,
                       const std::string &data,
                       std::string *out_header,
-                      std::string *out_data) {
+                      std::string *out_data,
+                      int max_attempts,
+                      bool throw_on_error) {
   // initialize the curl request
   std::vector<std::string> amz;
   std::string md5str = ComputeMD5(data);
@@ -697,40 +737,46 @@ void WriteStream::Run(const std::string &method,
   }
   slist = curl_slist_append(slist, sauth.str().c_str());
   
+  if (max_attempts <= 0) max_attempts = max_error_retry_;
   int num_retry = 0;
   while (true) {
     // helper for read string
     ReadStringStream ss(data);
-    curl_easy_reset(ecurl_);
+    curl_easy_reset(ecurl);
     auto surlstring = surl.str();
-    ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_HTTPHEADER, slist) == CURLE_OK);
-    ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_URL, surlstring.c_str()) == CURLE_OK);
-    ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_HEADER, 0L) == CURLE_OK);
-    ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_WRITEFUNCTION, WriteSStreamCallback) == CURLE_OK);
-    ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_WRITEDATA, &rdata) == CURLE_OK);  
-    ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_WRITEHEADER, WriteSStreamCallback) == CURLE_OK);
-    ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_HEADERDATA, &rheader) == CURLE_OK);
-    set_curl_options(ecurl_);
-    curl_easy_setopt(ecurl_, CURLOPT_NOSIGNAL, 1);
+    ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_HTTPHEADER, slist) == CURLE_OK);
+    ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_URL, surlstring.c_str()) == CURLE_OK);
+    ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_HEADER, 0L) == CURLE_OK);
+    ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_WRITEFUNCTION, WriteSStreamCallback) == CURLE_OK);
+    ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_WRITEDATA, &rdata) == CURLE_OK);  
+    ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_WRITEHEADER, WriteSStreamCallback) == CURLE_OK);
+    ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_HEADERDATA, &rheader) == CURLE_OK);
+    set_curl_options(ecurl);
+    curl_easy_setopt(ecurl, CURLOPT_NOSIGNAL, 1);
     if (method == "POST") {
-      ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_POST, 0L) == CURLE_OK);
-      ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_POSTFIELDSIZE, data.length()) == CURLE_OK);
-      ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_POSTFIELDS, BeginPtr(data)) == CURLE_OK);
+      ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_POST, 0L) == CURLE_OK);
+      ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_POSTFIELDSIZE, data.length()) == CURLE_OK);
+      ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_POSTFIELDS, BeginPtr(data)) == CURLE_OK);
     } else if (method == "PUT") {
-      ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_PUT, 1L) == CURLE_OK);
-      ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_READDATA, &ss) == CURLE_OK);
-      ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_INFILESIZE_LARGE, data.length()) == CURLE_OK);
-      ASSERT_TRUE(curl_easy_setopt(ecurl_, CURLOPT_READFUNCTION, ReadStringStream::Callback) == CURLE_OK);
+      ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_PUT, 1L) == CURLE_OK);
+      ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_READDATA, &ss) == CURLE_OK);
+      ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_INFILESIZE_LARGE, data.length()) == CURLE_OK);
+      ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_READFUNCTION, ReadStringStream::Callback) == CURLE_OK);
+    } else if (method == "DELETE") {
+      ASSERT_TRUE(curl_easy_setopt(ecurl, CURLOPT_CUSTOMREQUEST, "DELETE") == CURLE_OK);
     }
-    CURLcode ret = curl_easy_perform(ecurl_);
+    CURLcode ret = curl_easy_perform(ecurl);
     if (ret != CURLE_OK) {
       logstream(LOG_ERROR) << "request " << "failed with error "
-                << curl_easy_strerror(ret) << " Progress " 
-                << etags_.size() << " uploaded " << " retry=" << num_retry << std::endl;
+                << curl_easy_strerror(ret) << " retry=" << num_retry << std::endl;
       num_retry += 1;
-      ASSERT_MSG(num_retry < max_error_retry_, " maximum retry time reached");
-      curl_easy_cleanup(ecurl_);
-      ecurl_ = curl_easy_init();      
+      if (num_retry >= max_attempts) {
+        curl_slist_free_all(slist);
+        log_and_throw_io_failure(std::string("AWS S3 request failed: ") +
+                                 curl_easy_strerror(ret));
+      }
+      curl_easy_cleanup(ecurl);
+      ecurl = curl_easy_init();      
     } else {
       break;
     }   
@@ -740,14 +786,14 @@ void WriteStream::Run(const std::string &method,
   *out_data = rdata.str();
   if (FindHttpError(*out_header) ||
       out_data->find("<Error>") != std::string::npos) {
-    if (!no_exception_) {
+    if (!no_exception_ || throw_on_error) {
       log_and_throw_io_failure(std::string("AWS S3 Error:") + *out_header + *out_data);
     }
   }
 }
 void WriteStream::Init(void) {
   std::string rheader, rdata;
-  Run("POST", path_, "?uploads",
+  Run(ecurl_, "POST", path_, "?uploads",
       "binary/octel-stream", "", &rheader, &rdata);
   XMLIter xml(rdata.c_str());
   XMLIter upid;
@@ -755,43 +801,62 @@ void WriteStream::Init(void) {
   upload_id_ = upid.str();
 }
 
-void WriteStream::Upload(bool force_upload_even_if_zero_bytes) {
-  if (buffer_.length() == 0 && !force_upload_even_if_zero_bytes) return;
+std::string WriteStream::UploadPart(size_t thread_id, size_t partno,
+                                    const std::string &data) {
+  CURL *&ecurl = part_curls_[thread_id];
+  if (ecurl == NULL) ecurl = curl_easy_init();
   std::ostringstream sarg;
-  std::string rheader, rdata;
-  size_t partno = etags_.size() + 1;
-
   sarg << "?partNumber=" << partno << "&uploadId=" << upload_id_;
-  Run("PUT", path_, sarg.str(),
-      "binary/octel-stream", buffer_, &rheader, &rdata);
+  std::string rheader, rdata;
+  Run(ecurl, "PUT", path_, sarg.str(),
+      "binary/octel-stream", data, &rheader, &rdata, 1, true);
   const char *p = strstr(rheader.c_str(), "ETag: ");
   ASSERT_MSG((p != NULL), "cannot find ETag in header");
   p = strchr(p, '\"');
   ASSERT_MSG((p != NULL), "cannot find ETag in header");
   const char *end = strchr(p + 1, '\"');
   ASSERT_MSG((end != NULL), "cannot find ETag in header");
-  
-  etags_.push_back(std::string(p, end - p + 1));
-  part_ids_.push_back(partno);
-  buffer_.clear();
+  return std::string(p, end - p + 1);
 }
 
-void WriteStream::Finish(void) {
+void WriteStream::Abort(void) {
+  logstream(LOG_WARNING) << "Aborting upload to " << path_.str() << std::endl;
+  std::ostringstream sarg;
+  std::string rheader, rdata;
+  sarg << "?uploadId=" << upload_id_;
+  bool no_exception = no_exception_;
+  no_exception_ = true;
+  try {
+    Run(ecurl_, "DELETE", path_, sarg.str(), "", "", &rheader, &rdata);
+  } catch (...) {
+    logstream(LOG_WARNING) << "Unable to abort upload to " << path_.str() << std::endl;
+  }
+  no_exception_ = no_exception;
+}
+
+void WriteStream::Finish(const std::map<size_t, std::string> &etags) {
   std::ostringstream sarg, sdata;
   std::string rheader, rdata;
   sarg << "?uploadId=" << upload_id_;
   sdata << "<CompleteMultipartUpload>\n";
-  ASSERT_TRUE(etags_.size() == part_ids_.size());
-  for (size_t i = 0; i < etags_.size(); ++i) {
+  for (const auto &part : etags) {
     sdata << " <Part>\n"
-          << "  <PartNumber>" << part_ids_[i] << "</PartNumber>\n"
-          << "  <ETag>" << etags_[i] << "</ETag>\n"
+          << "  <PartNumber>" << part.first << "</PartNumber>\n"
+          << "  <ETag>" << part.second << "</ETag>\n"
           << " </Part>\n";
   }
   sdata << "</CompleteMultipartUpload>\n";
-  Run("POST", path_, sarg.str(),
+  Run(ecurl_, "POST", path_, sarg.str(),
       "text/xml", sdata.str(), &rheader, &rdata);
 }
+
+void WriteStream::Cleanup(void) {
+  for (CURL *ecurl : part_curls_) {
+    if (ecurl != NULL) curl_easy_cleanup(ecurl);
+  }
+  part_curls_.clear();
+  curl_easy_cleanup(ecurl_);
+}
 /*!
  * \brief list the objects in the bucket with prefix specified by path.name
  * \param path the path to query
@@ -952,5 +1017,18 @@ SeekStream *S3FileSystem::OpenForRead(const URI &path) {
     return NULL;
   }
 }
+
+SeekStream *S3FileSystem::OpenRangeForRead(const URI &path,
+                                           size_t file_size,
+                                           size_t begin,
+                                           size_t end) {
+  ASSERT_MSG((path.protocol == "s3://"), " S3FileSystem.Open");
+  ASSERT_LE(begin, end);
+  ASSERT_LE(end, file_size);
+  SeekStream* stream = new s3::ReadStream(path, aws_access_id_, aws_secret_key_,
+                                          file_size, end);
+  stream->Seek(begin);
+  return stream;
+}
 }  // namespace io
 }  // namespace dmlc
@@ -51,6 +51,18 @@ class S3FileSystem {
    * \return the created stream, can be NULL 
    */
   virtual SeekStream *OpenForRead(const URI &path);
+  /*!
+   * \brief open a stream reading only the bytes [begin, end) of a file,
+   *  using a single bounded range request. Unlike OpenForRead, this does not
+   *  query the path information, and is safe to call concurrently.
+   * \param path the path to the file
+   * \param file_size the size of the file
+   * \param begin the first byte to read
+   * \param end one past the last byte to read
+   * \return the created stream, positioned at begin
+   */
+  virtual SeekStream *OpenRangeForRead(const URI &path, size_t file_size,
+                                       size_t begin, size_t end);
   /*!
    * \brief get a singleton of S3FileSystem when needed 
    * \return a singleton instance
@@ -111,6 +111,51 @@ REGISTER_GLOBAL(int64_t, FILEIO_MAXIMUM_CACHE_CAPACITY_PER_FILE, true)
 REGISTER_GLOBAL(int64_t, FILEIO_READER_BUFFER_SIZE, false);
 REGISTER_GLOBAL(int64_t, FILEIO_WRITER_BUFFER_SIZE, false); 
 
+EXPORT size_t FILEIO_RANGE_READ_PARALLELISM = 8;
+EXPORT size_t FILEIO_RANGE_READ_MAX_GAP = 64 * 1024;
+EXPORT size_t FILEIO_RANGE_READ_MAX_REQUEST_SIZE = 4 * 1024 * 1024;
+
+REGISTER_GLOBAL(int64_t, FILEIO_RANGE_READ_PARALLELISM, true);
+REGISTER_GLOBAL(int64_t, FILEIO_RANGE_READ_MAX_GAP, true);
+REGISTER_GLOBAL(int64_t, FILEIO_RANGE_READ_MAX_REQUEST_SIZE, true);
+
+EXPORT size_t FILEIO_S3_UPLOAD_PARALLELISM = 4;
+REGISTER_GLOBAL(int64_t, FILEIO_S3_UPLOAD_PARALLELISM, true);
+
+EXPORT size_t FILEIO_USE_IO_URING = 1;
+EXPORT size_t FILEIO_IO_URING_QUEUE_DEPTH = 64;
+EXPORT size_t FILEIO_DIRECT_IO_THRESHOLD = 0;
+
+REGISTER_GLOBAL(int64_t, FILEIO_USE_IO_URING, true);
+REGISTER_GLOBAL(int64_t, FILEIO_IO_URING_QUEUE_DEPTH, false);
+REGISTER_GLOBAL(int64_t, FILEIO_DIRECT_IO_THRESHOLD, true);
+
+static bool check_fast_spill_location(std::string val) {
+  if (!val.empty() && !boost::filesystem::is_directory(val)) {
+    throw std::string("Directory: ") + val + " does not exist";
+  }
+  return true;
+}
+
+EXPORT std::string FILEIO_CACHE_FAST_SPILL_LOCATION = "";
+EXPORT size_t FILEIO_CACHE_FAST_SPILL_CAPACITY = 8LL * 1024 * 1024 * 1024;
+EXPORT size_t FILEIO_CACHE_RSS_LIMIT_PERCENT = 80;
+EXPORT size_t FILEIO_CACHE_ASYNC_WRITE_BACK = 1;
+
+REGISTER_GLOBAL_WITH_CHECKS(std::string,
+                            FILEIO_CACHE_FAST_SPILL_LOCATION,
+                            true,
+                            check_fast_spill_location);
+REGISTER_GLOBAL(int64_t, FILEIO_CACHE_FAST_SPILL_CAPACITY, true);
+REGISTER_GLOBAL(int64_t, FILEIO_CACHE_RSS_LIMIT_PERCENT, true);
+REGISTER_GLOBAL(int64_t, FILEIO_CACHE_ASYNC_WRITE_BACK, true);
+
+EXPORT size_t FILEIO_GZIP_DECOMPRESSION_THREADS = 8;
+EXPORT size_t FILEIO_GZIP_DECOMPRESSION_CHUNK_SIZE = 1024 * 1024;
+
+REGISTER_GLOBAL(int64_t, FILEIO_GZIP_DECOMPRESSION_THREADS, true);
+REGISTER_GLOBAL(int64_t, FILEIO_GZIP_DECOMPRESSION_CHUNK_SIZE, true);
+
 
 static constexpr char CACHE_PREFIX[] = "cache://";
 static constexpr char TMP_CACHE_PREFIX[] = "cache://tmp/";
@@ -67,6 +67,89 @@ extern size_t FILEIO_READER_BUFFER_SIZE;
  */
 extern size_t FILEIO_WRITER_BUFFER_SIZE;
 
+/**
+ * The maximum number of concurrent requests issued by a
+ * \ref range_reader.
+ */
+extern size_t FILEIO_RANGE_READ_PARALLELISM;
+
+/**
+ * Byte ranges separated by at most this many bytes are read by a
+ * \ref range_reader with a single request.
+ */
+extern size_t FILEIO_RANGE_READ_MAX_GAP;
+
+/**
+ * The maximum size of a request made by merging byte ranges in a
+ * \ref range_reader.
+ */
+extern size_t FILEIO_RANGE_READ_MAX_REQUEST_SIZE;
+
+/**
+ * The maximum number of parts of an S3 multipart upload which are uploaded
+ * concurrently, while the writer fills the next part.
+ */
+extern size_t FILEIO_S3_UPLOAD_PARALLELISM;
+
+/**
+ * If nonzero, batches of local file reads and writes are submitted through
+ * io_uring when the kernel supports it (see \ref async_file_io). Only
+ * affects threads which have not performed batched IO yet.
+ */
+extern size_t FILEIO_USE_IO_URING;
+
+/**
+ * The number of submission queue entries of each io_uring.
+ */
+extern size_t FILEIO_IO_URING_QUEUE_DEPTH;
+
+/**
+ * Batched reads of local files totalling at least this many bytes bypass
+ * the page cache with O_DIRECT. 0 disables direct IO.
+ */
+extern size_t FILEIO_DIRECT_IO_THRESHOLD;
+
+/**
+ * A directory on a fast local device (ex: an SSD or a ramdisk) to which
+ * in-memory cache blocks are spilled first. Empty to spill to the regular
+ * temp directories only.
+ */
+extern std::string FILEIO_CACHE_FAST_SPILL_LOCATION;
+
+/**
+ * The approximate maximum number of bytes spilled to
+ * FILEIO_CACHE_FAST_SPILL_LOCATION. Cache blocks spilled once it is full go
+ * to the regular temp directories.
+ */
+extern size_t FILEIO_CACHE_FAST_SPILL_CAPACITY;
+
+/**
+ * When the resident memory of the process exceeds this percentage of the
+ * physical memory, in-memory cache blocks are spilled, and new cache
+ * blocks are written directly to disk. 0 disables the check.
+ */
+extern size_t FILEIO_CACHE_RSS_LIMIT_PERCENT;
+
+/**
+ * If nonzero, evicted cache blocks are written to disk by a background
+ * thread instead of by the thread creating a new cache block.
+ */
+extern size_t FILEIO_CACHE_ASYNC_WRITE_BACK;
+
+/**
+ * The number of threads decompressing a gzip file read through a
+ * general_ifstream. Files made of many gzip members (ex: bgzip, or
+ * concatenated gzip files) are decompressed a chunk of members per thread.
+ * 1 disables parallel decompression.
+ */
+extern size_t FILEIO_GZIP_DECOMPRESSION_THREADS;
+
+/**
+ * The minimum number of compressed bytes decompressed as one unit by a
+ * gzip decompression thread.
+ */
+extern size_t FILEIO_GZIP_DECOMPRESSION_CHUNK_SIZE;
+
 /**
  * The alternative ssl certificate file and directory.
  */
@@ -8,6 +8,8 @@
 #include <fileio/fileio_constants.hpp>
 #include <fileio/fixed_size_cache_manager.hpp>
 #include <logger/assertions.hpp>
+#include <minipsutil/minipsutil.h>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 
@@ -15,6 +17,12 @@
 namespace graphlab {
 
 namespace fileio {
+
+/**
+ * Minimum interval between two samples of the process resident memory.
+ */
+static constexpr size_t MEMORY_PRESSURE_CHECK_INTERVAL_MS = 100;
+
 /*************************************************************************/
 /*                                                                       */
 /*                         Cache Block implementation                    */
@@ -33,6 +41,8 @@ namespace fileio {
     if (data && new_capacity <= maximum_capacity) {
       // we already have capacity exceeding new capacity
       if (new_capacity <= capacity) return true;
+      // do not grow while the process is short of memory
+      if (owning_cache_manager->under_memory_pressure()) return false;
       size_t queried_capacity = new_capacity;
       // try to double up to maximum capacity
       new_capacity = std::max(new_capacity, capacity * 2);
@@ -69,7 +79,7 @@ namespace fileio {
 
   std::shared_ptr<fileio_impl::general_fstream_sink> cache_block::write_to_file() {
     ASSERT_TRUE(filename.empty());
-    filename = get_temp_name_prefer_hdfs();
+    filename = owning_cache_manager->get_spill_file_name(size, fast_tier_bytes);
     logstream(LOG_DEBUG) << "Flushing to " << filename << std::endl;
     auto fout = std::make_shared<fileio_impl::general_fstream_sink>(filename);
     if (data) fout->write(data, size);
@@ -117,6 +127,10 @@ namespace fileio {
                                << filename << std::endl;
       }
       filename.clear();
+      if (fast_tier_bytes > 0) {
+        owning_cache_manager->release_fast_tier(fast_tier_bytes);
+        fast_tier_bytes = 0;
+      }
     }
   }
 
@@ -137,6 +151,15 @@ namespace fileio {
   fixed_size_cache_manager::fixed_size_cache_manager() { }
 
   fixed_size_cache_manager::~fixed_size_cache_manager() {
+    std::unique_ptr<graphlab::thread> thread;
+    {
+      std::lock_guard<graphlab::mutex> lck(mutex);
+      write_back_stop = true;
+      write_back_cond.broadcast();
+      thread.swap(write_back_thread);
+    }
+    // the write back thread drains the queue before exiting
+    if (thread) thread->join();
     clear();
   }
 
@@ -156,13 +179,20 @@ namespace fileio {
   std::shared_ptr<cache_block> fixed_size_cache_manager::new_cache(cache_id_type cache_id) {
     std::lock_guard<graphlab::mutex> lck(mutex);
     logstream_ontick(5, LOG_INFO) << "Cache Utilization:" << get_cache_utilization() << std::endl;
-    // if we have exceeded, we try to evict
-    if (current_cache_utilization.value >= FILEIO_MAXIMUM_CACHE_CAPACITY) try_cache_evict();
+    bool memory_pressure = under_memory_pressure();
+    if (memory_pressure) {
+      // the process is running out of memory. Give back half the cache.
+      try_cache_evict(current_cache_utilization.value / 2);
+    } else if (current_cache_utilization.value >= FILEIO_MAXIMUM_CACHE_CAPACITY) {
+      // if we have exceeded, we try to evict
+      try_cache_evict(FILEIO_MAXIMUM_CACHE_CAPACITY / 4 * 3);
+    }
     // read the current cache utilization.
     size_t current_utilization = current_cache_utilization.value;
-    // this will the maximum capacity of the new entry
+    // this will the maximum capacity of the new entry.
+    // Under memory pressure, new entries go directly to disk.
     size_t new_entry_max_capacity = 0;
-    if (current_utilization < FILEIO_MAXIMUM_CACHE_CAPACITY) {
+    if (!memory_pressure && current_utilization < FILEIO_MAXIMUM_CACHE_CAPACITY) {
       // if we have less than new_max_block_capacity available,
       // give less capacity.
       new_entry_max_capacity = std::min<size_t>(FILEIO_MAXIMUM_CACHE_CAPACITY_PER_FILE,
@@ -175,6 +205,7 @@ namespace fileio {
                            << " Capacity = " << new_entry_max_capacity << std::endl;
 
       std::shared_ptr<cache_block> block(new cache_block(cache_id, new_entry_max_capacity, this));
+      touch(*block);
       cache_blocks[cache_id] = block;
       return block;
     } else {
@@ -183,12 +214,18 @@ namespace fileio {
       // we need to clear the content of the block.
       auto iter = cache_blocks.find(cache_id);
       std::shared_ptr<cache_block> block = iter->second;
-      // if its a pointer. we just reuse it. 
-      if (block->is_pointer()) {
+      if (block->writing_back) {
+        // the write back still reads the old contents. Replace the block;
+        // the write back will drop it.
+        block.reset(new cache_block(cache_id, new_entry_max_capacity, this));
+        iter->second = block;
+      } else if (block->is_pointer()) {
+        // if its a pointer. we just reuse it. 
         block->initialize_memory(block->maximum_capacity);
       } else {
         block->initialize_memory(new_entry_max_capacity);
       }
+      touch(*block);
       return block;
     }
   }
@@ -205,8 +242,10 @@ namespace fileio {
   std::shared_ptr<cache_block> fixed_size_cache_manager::get_cache(cache_id_type cache_id) {
     logstream(LOG_DEBUG) << "Get cache block " << cache_id << std::endl;
     std::lock_guard<graphlab::mutex> lck(mutex);
-    if (cache_blocks.find(cache_id) != cache_blocks.end()) {
-      return cache_blocks[cache_id];
+    auto iter = cache_blocks.find(cache_id);
+    if (iter != cache_blocks.end()) {
+      touch(*(iter->second));
+      return iter->second;
     }
     throw std::out_of_range("Cannot find cache block with id " + cache_id);
   }
@@ -219,30 +258,160 @@ namespace fileio {
     current_cache_utilization.dec(increment);
   }
 
-  void fixed_size_cache_manager::try_cache_evict() {
+  void fixed_size_cache_manager::try_cache_evict(size_t target_utilization) {
     // lock must be acquired outside of this call
     ASSERT_FALSE(mutex.try_lock());
-    // we will try to evict the largest
-    std::string largest_entry_name;
-    std::shared_ptr<cache_block> largest_block;
-    size_t current_largest_block_size = 0;
+    // blocks already being written back will soon release their memory
+    size_t utilization = current_cache_utilization.value;
+    utilization -= std::min(utilization, write_back_bytes);
+    if (utilization <= target_utilization) return;
+
+    // evict the blocks with the largest size x age first
+    size_t now = access_clock.value;
+    std::vector<std::pair<double, std::shared_ptr<cache_block> > > candidates;
     for (auto& iter: cache_blocks) {
+      auto& block = iter.second;
       // we can only evict if we are the only pointers to the cache block
-      if (iter.second.unique() && iter.second->is_pointer()) {
-        if (iter.second->get_pointer_size() > current_largest_block_size) {
-          largest_entry_name = iter.first;
-          largest_block = iter.second;
-          current_largest_block_size = largest_block->get_pointer_size();
+      if (block.unique() && block->is_pointer() && !block->writing_back &&
+          block->get_pointer_size() > 0) {
+        double age = now - std::min(now, block->last_access) + 1;
+        candidates.emplace_back(age * block->get_pointer_size(), block);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<double, std::shared_ptr<cache_block> >& a,
+                 const std::pair<double, std::shared_ptr<cache_block> >& b) {
+                return a.first > b.first;
+              });
+
+    for (auto& candidate: candidates) {
+      if (utilization <= target_utilization) break;
+      auto& block = candidate.second;
+      size_t capacity = block->get_pointer_capacity();
+      logstream_ontick(5, LOG_INFO) << "Evicting " << block->get_cache_id()
+                          << " with size " << block->get_pointer_size() << std::endl;
+      if (FILEIO_CACHE_ASYNC_WRITE_BACK) {
+        block->writing_back = true;
+        write_back_bytes += capacity;
+        ++write_back_pending;
+        write_back_queue.push_back(block);
+        if (!write_back_thread) {
+          write_back_thread.reset(new graphlab::thread());
+          write_back_thread->launch([this]() { write_back_loop(); });
         }
+        write_back_cond.broadcast();
+      } else {
+        block->write_to_file();
+      }
+      utilization -= std::min(utilization, capacity);
+    }
+    logstream_ontick(5, LOG_INFO) << "Cache Utilization:" << get_cache_utilization()
+                                  << std::endl;
+  }
+
+  void fixed_size_cache_manager::write_back_loop() {
+    std::unique_lock<graphlab::mutex> lck(mutex);
+    while(1) {
+      while (write_back_queue.empty() && !write_back_stop) {
+        write_back_cond.wait(lck);
+      }
+      if (write_back_queue.empty()) break;
+      std::shared_ptr<cache_block> block = write_back_queue.front();
+      write_back_queue.pop_front();
+      size_t capacity = block->get_pointer_capacity();
+      lck.unlock();
+
+      // the contents of the block do not change while it is written back:
+      // writers create a new block instead (see new_cache).
+      std::string filename;
+      size_t fast_tier_bytes = 0;
+      bool success = false;
+      try {
+        filename = get_spill_file_name(block->get_pointer_size(), fast_tier_bytes);
+        logstream(LOG_DEBUG) << "Flushing to " << filename << std::endl;
+        fileio_impl::general_fstream_sink fout(filename);
+        fout.write(block->get_pointer(), block->get_pointer_size());
+        success = fout.good();
+        fout.close();
+      } catch (...) {
+        logstream(LOG_WARNING) << "Unable to write back cache block "
+                               << block->get_cache_id() << std::endl;
+      }
+
+      lck.lock();
+      block->writing_back = false;
+      auto iter = cache_blocks.find(block->get_cache_id());
+      // the block stays in memory if it was freed or replaced, or if it is
+      // still in use by a reader which accessed it during the write back.
+      if (success && iter != cache_blocks.end() && iter->second == block &&
+          block.use_count() == 2) {
+        block->release_memory();
+        block->filename = filename;
+        block->fast_tier_bytes = fast_tier_bytes;
+      } else {
+        if (!filename.empty()) delete_temp_file(filename);
+        if (fast_tier_bytes > 0) release_fast_tier(fast_tier_bytes);
+      }
+      write_back_bytes -= capacity;
+      --write_back_pending;
+      block.reset();
+      write_back_cond.broadcast();
+    }
+  }
+
+  void fixed_size_cache_manager::wait_for_write_back() {
+    std::unique_lock<graphlab::mutex> lck(mutex);
+    while (write_back_pending > 0) write_back_cond.wait(lck);
+  }
+
+  bool fixed_size_cache_manager::under_memory_pressure() {
+    if (FILEIO_CACHE_RSS_LIMIT_PERCENT == 0) return false;
+    std::lock_guard<graphlab::mutex> lck(memory_pressure_lock);
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_memory_pressure_check >=
+        std::chrono::milliseconds(MEMORY_PRESSURE_CHECK_INTERVAL_MS)) {
+      last_memory_pressure_check = now;
+      uint64_t rss = process_rss_function ? process_rss_function() : process_rss();
+      uint64_t total = total_mem();
+      bool pressure = rss > 0 && total > 0 &&
+          rss > total / 100 * FILEIO_CACHE_RSS_LIMIT_PERCENT;
+      if (pressure && !memory_pressure) {
+        logstream(LOG_WARNING) << "Process memory (" << rss << " bytes) exceeds "
+                               << FILEIO_CACHE_RSS_LIMIT_PERCENT << "% of "
+                               << total << " bytes. Spilling cache to disk."
+                               << std::endl;
       }
+      memory_pressure = pressure;
     }
-    if (largest_block) {
-      logstream_ontick(5, LOG_INFO) << "Evicting " << largest_entry_name 
-                          << " with size " << current_largest_block_size << std::endl;
-      largest_block->write_to_file();
-      logstream_ontick(5, LOG_INFO) << "Cache Utilization:" << get_cache_utilization()
-                                    << std::endl;
+    return memory_pressure;
+  }
+
+  void fixed_size_cache_manager::set_process_rss_function(std::function<uint64_t()> fn) {
+    std::lock_guard<graphlab::mutex> lck(memory_pressure_lock);
+    process_rss_function = fn;
+    // sample again on the next check
+    last_memory_pressure_check = std::chrono::steady_clock::time_point();
+  }
+
+  std::string fixed_size_cache_manager::get_spill_file_name(size_t size,
+                                                            size_t& fast_tier_bytes) {
+    fast_tier_bytes = 0;
+    std::string fast_location = FILEIO_CACHE_FAST_SPILL_LOCATION;
+    if (!fast_location.empty()) {
+      // blocks spilled by a full writer keep growing on disk, so this is
+      // only approximate.
+      size_t charge = std::max<size_t>(size, 1);
+      if (fast_tier_utilization.inc(charge) <= FILEIO_CACHE_FAST_SPILL_CAPACITY) {
+        fast_tier_bytes = charge;
+        return get_temp_name_in_directory(fast_location);
+      }
+      fast_tier_utilization.dec(charge);
     }
+    return get_temp_name_prefer_hdfs();
+  }
+
+  void fixed_size_cache_manager::release_fast_tier(size_t bytes) {
+    fast_tier_utilization.dec(bytes);
   }
 } // end of fileio
 
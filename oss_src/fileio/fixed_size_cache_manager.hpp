@@ -10,8 +10,12 @@
 
 #include <vector>
 #include <string>
+#include <deque>
+#include <memory>
 #include <parallel/pthread_tools.hpp>
 #include <unordered_map>
+#include <chrono>
+#include <functional>
 #include <parallel/atomic.hpp>
 #include <fileio/temp_files.hpp>
 #include <fileio/general_fstream_sink.hpp>
@@ -124,6 +128,14 @@ struct cache_block {
    */
   std::shared_ptr<fileio_impl::general_fstream_sink> write_to_file();
 
+  /**
+   * Returns true if the block is a file in the fast spill tier
+   * (FILEIO_CACHE_FAST_SPILL_LOCATION).
+   */
+  inline bool is_fast_tier_file() const {
+    return fast_tier_bytes > 0;
+  }
+
   /**
    * Destructor. Clears all the memory in the cache block.
    */
@@ -144,6 +156,12 @@ struct cache_block {
   std::string filename;
   // the cache manager which created this block
   fixed_size_cache_manager* owning_cache_manager = NULL;
+  // value of the cache manager's access clock at the last access
+  size_t last_access = 0;
+  // true while the block is queued or being written back to disk
+  bool writing_back = false;
+  // number of bytes of the file charged to the fast spill tier
+  size_t fast_tier_bytes = 0;
 
   /**
    * Clears, and reinitializes the cache block with a new maximum capacity.
@@ -187,6 +205,32 @@ struct cache_block {
  *   FILEIO_MAXIMUM_CACHE_CAPACITY_PER_FILE : the maximum size of each cache blocks
  *   FILEIO_INITIAL_CAPACITY_PER_FILE : the initial size of each cache blocks
  *
+ *  Eviction
+ *  --------
+ *  Only blocks which nobody else holds a reference to can be evicted. The
+ *  victims are the blocks with the largest size x age, where the age is the
+ *  number of cache accesses since the block was last accessed, so that large
+ *  blocks which have not been used in a while go first. Blocks are evicted
+ *  until utilization drops to 3/4 of the capacity, which avoids evicting one
+ *  block for every new block once the cache is full.
+ *
+ *  Evicted blocks are written to disk by a background thread
+ *  (FILEIO_CACHE_ASYNC_WRITE_BACK), so that creating a cache block does not
+ *  wait for the disk. A block which is accessed again while it is being
+ *  written stays in memory.
+ *
+ *  Spilled blocks go to FILEIO_CACHE_FAST_SPILL_LOCATION while it holds less
+ *  than FILEIO_CACHE_FAST_SPILL_CAPACITY bytes of them, and to the regular
+ *  temp directories (or HDFS if configured) otherwise.
+ *
+ *  Memory Pressure
+ *  ---------------
+ *  The cache capacity alone does not prevent the process from running out of
+ *  memory when several large queries run at once. When the resident memory
+ *  of the process exceeds FILEIO_CACHE_RSS_LIMIT_PERCENT of the physical
+ *  memory, half of the in-memory cache is evicted, and new cache blocks are
+ *  written directly to disk until the pressure is relieved.
+ *
  *  Overcommit Behavior
  *  -------------------
  *  We try our best to maintain cache utilization below the maximum. However,
@@ -242,6 +286,25 @@ class fixed_size_cache_manager {
     return current_cache_utilization.value;
   }
 
+  /**
+   * Returns the approximate number of bytes spilled to the fast spill tier.
+   */
+  inline size_t get_fast_tier_utilization() {
+    return fast_tier_utilization.value;
+  }
+
+  /**
+   * Blocks until all the pending write backs of evicted blocks complete.
+   */
+  void wait_for_write_back();
+
+  /**
+   * Replaces the function returning the resident memory of the process, in
+   * bytes, which is used to detect memory pressure. Used by tests to
+   * simulate memory pressure. An empty function restores process_rss().
+   */
+  void set_process_rss_function(std::function<uint64_t()> fn);
+
  private:
   fixed_size_cache_manager();
 
@@ -258,9 +321,34 @@ class fixed_size_cache_manager {
 
   atomic<size_t> current_cache_utilization;
 
+  /// Incremented on every access to a cache block
+  atomic<size_t> access_clock;
+
+  /// Number of bytes charged to the fast spill tier
+  atomic<size_t> fast_tier_utilization;
+
+  /// Result of the last check of the process resident memory
+  volatile bool memory_pressure = false;
+  /// Time of the last check of the process resident memory
+  std::chrono::steady_clock::time_point last_memory_pressure_check;
+  /// Returns the resident memory of the process. Empty for process_rss().
+  std::function<uint64_t()> process_rss_function;
+  /// Lock on the three fields above
+  graphlab::mutex memory_pressure_lock;
+
   graphlab::mutex mutex;
   std::unordered_map<std::string, std::shared_ptr<cache_block> > cache_blocks;
 
+  /// Blocks waiting to be written back. Protected by mutex.
+  std::deque<std::shared_ptr<cache_block> > write_back_queue;
+  /// Memory of the blocks queued or being written back. Protected by mutex.
+  size_t write_back_bytes = 0;
+  /// Number of blocks queued or being written back. Protected by mutex.
+  size_t write_back_pending = 0;
+  bool write_back_stop = false;
+  graphlab::conditional write_back_cond;
+  std::unique_ptr<graphlab::thread> write_back_thread;
+
   /**
    * Increments cache utilization counter
    */
@@ -271,10 +359,36 @@ class fixed_size_cache_manager {
   void decrement_utilization(ssize_t decrement);
 
   /**
-   * Tries to evict some stuff out of cache.
+   * Tries to evict cache blocks until the utilization, not counting the
+   * blocks already being written back, is at most target_utilization.
    * Lock must be acquired when this function is called.
    */
-  void try_cache_evict();
+  void try_cache_evict(size_t target_utilization);
+
+  /**
+   * Returns true if the resident memory of the process exceeds
+   * FILEIO_CACHE_RSS_LIMIT_PERCENT of the physical memory. The resident
+   * memory is sampled at most every few milliseconds.
+   */
+  bool under_memory_pressure();
+
+  /// Records an access to the cache block.
+  inline void touch(cache_block& block) {
+    block.last_access = access_clock.inc();
+  }
+
+  /**
+   * Returns the name of a new file to spill size bytes to. Picks the fast
+   * spill tier if it has room, in which case fast_tier_bytes is set to the
+   * number of bytes charged to it.
+   */
+  std::string get_spill_file_name(size_t size, size_t& fast_tier_bytes);
+
+  /// Returns bytes charged to the fast spill tier.
+  void release_fast_tier(size_t bytes);
+
+  /// Body of the write back thread.
+  void write_back_loop();
 
   friend struct cache_block;
 };
@@ -8,6 +8,7 @@
 #include <boost/algorithm/string.hpp>
 #include <logger/assertions.hpp>
 #include <fileio/general_fstream_source.hpp>
+#include <fileio/parallel_gzip_decompressor.hpp>
 
 namespace graphlab {
 namespace fileio_impl {
@@ -25,10 +26,17 @@ general_fstream_source::general_fstream_source(std::string file,
 void general_fstream_source::open_file(std::string file, bool gzip_compressed) {
   in_file = std::make_shared<union_fstream>(file, std::ios_base::in | std::ios_base::binary);
   is_gzip_compressed = gzip_compressed;
+  underlying_stream = in_file->get_istream();
   if (gzip_compressed) {
-    decompressor = std::make_shared<boost::iostreams::gzip_decompressor>();
+    if (fileio::FILEIO_GZIP_DECOMPRESSION_THREADS > 1) {
+      parallel_decompressor = std::make_shared<parallel_gzip_decompressor>(
+          underlying_stream,
+          fileio::FILEIO_GZIP_DECOMPRESSION_THREADS,
+          fileio::FILEIO_GZIP_DECOMPRESSION_CHUNK_SIZE);
+    } else {
+      decompressor = std::make_shared<boost::iostreams::gzip_decompressor>();
+    }
   }
-  underlying_stream = in_file->get_istream();
 }
 
 bool general_fstream_source::is_open() const {
@@ -36,7 +44,9 @@ bool general_fstream_source::is_open() const {
 }
 
 std::streamsize general_fstream_source::read(char* c, std::streamsize bufsize) {
-  if (is_gzip_compressed) {
+  if (parallel_decompressor) {
+    return parallel_decompressor->read(c, bufsize);
+  } else if (is_gzip_compressed) {
     return decompressor->read(*underlying_stream, c, bufsize);
   } else {
     underlying_stream->read(c, bufsize);
@@ -54,6 +64,8 @@ general_fstream_source::~general_fstream_source() {
 }
 
 void general_fstream_source::close() {
+  // stops the decompression threads before the stream goes away
+  parallel_decompressor.reset();
   if (decompressor) {
     decompressor->close(*underlying_stream, std::ios_base::in);
     decompressor.reset();
@@ -64,7 +76,7 @@ void general_fstream_source::close() {
 
 std::streampos general_fstream_source::seek(std::streamoff off, 
                                             std::ios_base::seekdir way) {
-  if (!decompressor) {
+  if (!is_gzip_compressed) {
     underlying_stream->clear();
     underlying_stream->seekg(off, way);
     return underlying_stream->tellg();
@@ -83,7 +95,10 @@ size_t general_fstream_source::file_size() const {
 
 
 size_t general_fstream_source::get_bytes_read() const {
-  if (underlying_stream) {
+  if (parallel_decompressor) {
+    // the underlying stream is read ahead of the decompressed output
+    return parallel_decompressor->get_bytes_read();
+  } else if (underlying_stream) {
     return underlying_stream->tellg();
   } else {
     return (size_t)(-1);
@@ -91,7 +106,7 @@ size_t general_fstream_source::get_bytes_read() const {
 }
 
 std::shared_ptr<std::istream> general_fstream_source::get_underlying_stream() const {
-  if (decompressor) {
+  if (is_gzip_compressed) {
     return nullptr;
   } else {
     return underlying_stream;
@@ -0,0 +1,153 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <algorithm>
+#include <exception>
+#include <logger/logger.hpp>
+#include <timer/timer.hpp>
+#include <fileio/multipart_upload_writer.hpp>
+
+namespace graphlab {
+namespace fileio {
+
+multipart_upload_writer::multipart_upload_writer(
+    size_t part_size,
+    size_t max_parts_in_flight,
+    size_t max_attempts,
+    upload_part_function upload_part,
+    complete_function complete,
+    abort_function abort,
+    size_t retry_backoff_ms)
+    : m_part_size(std::max<size_t>(part_size, 1)),
+      m_max_parts_in_flight(std::max<size_t>(max_parts_in_flight, 1)),
+      m_max_attempts(std::max<size_t>(max_attempts, 1)),
+      m_retry_backoff_ms(retry_backoff_ms),
+      m_upload_part(upload_part),
+      m_complete(complete),
+      m_abort(abort) { }
+
+multipart_upload_writer::~multipart_upload_writer() {
+  stop_upload_threads();
+}
+
+void multipart_upload_writer::write(const char* data, size_t length) {
+  if (m_aborted) log_and_throw_io_failure(m_error);
+  ASSERT_FALSE(m_closed);
+  while (length > 0) {
+    size_t n = std::min(length, m_part_size - m_buffer.length());
+    m_buffer.append(data, n);
+    data += n;
+    length -= n;
+    if (m_buffer.length() == m_part_size) queue_part();
+  }
+}
+
+void multipart_upload_writer::close() {
+  if (m_aborted) log_and_throw_io_failure(m_error);
+  if (m_closed) return;
+  m_closed = true;
+  if (!m_buffer.empty() || m_num_parts == 0) queue_part();
+  stop_upload_threads();
+  if (!m_error.empty()) abort_and_throw();
+  m_complete(m_etags);
+}
+
+void multipart_upload_writer::queue_part() {
+  size_t part_number = ++m_num_parts;
+  std::unique_lock<graphlab::mutex> guard(m_lock);
+  while (m_parts_in_flight >= m_max_parts_in_flight && m_error.empty()) {
+    m_cond.wait(guard);
+  }
+  if (!m_error.empty()) {
+    // fail early instead of waiting for the end of the stream
+    guard.unlock();
+    m_buffer = std::string();
+    stop_upload_threads();
+    abort_and_throw();
+  }
+  m_pending_parts.emplace_back(part_number, std::move(m_buffer));
+  ++m_parts_in_flight;
+  if (m_num_upload_threads < m_max_parts_in_flight) {
+    size_t thread_id = m_num_upload_threads++;
+    m_upload_threads.launch([this, thread_id]() { upload_thread(thread_id); });
+  }
+  m_cond.broadcast();
+  guard.unlock();
+  m_buffer = std::string();
+}
+
+std::string multipart_upload_writer::upload_with_retries(size_t thread_id,
+                                                         size_t part_number,
+                                                         const std::string& data) {
+  for (size_t attempt = 1; ; ++attempt) {
+    try {
+      return m_upload_part(thread_id, part_number, data);
+    } catch (...) {
+      if (attempt >= m_max_attempts) throw;
+      logstream(LOG_WARNING) << "Retrying upload of part " << part_number
+                             << ", retry " << attempt << std::endl;
+      // 1s, 2s, 4s ...
+      timer::sleep_ms(m_retry_backoff_ms << (attempt - 1));
+    }
+  }
+}
+
+void multipart_upload_writer::upload_thread(size_t thread_id) {
+  std::unique_lock<graphlab::mutex> guard(m_lock);
+  while (true) {
+    while (m_pending_parts.empty() && !m_parts_done) m_cond.wait(guard);
+    if (m_pending_parts.empty()) break;
+    std::pair<size_t, std::string> part = std::move(m_pending_parts.front());
+    m_pending_parts.pop_front();
+    bool skip = !m_error.empty();
+    guard.unlock();
+
+    std::string etag, error;
+    if (!skip) {
+      try {
+        etag = upload_with_retries(thread_id, part.first, part.second);
+      } catch (std::exception& e) {
+        error = e.what();
+      } catch (...) {
+        error = "Unknown error";
+      }
+    }
+    part.second = std::string();
+
+    guard.lock();
+    if (!error.empty()) {
+      if (m_error.empty()) {
+        m_error = "Fail to upload part " + std::to_string(part.first) + ": " + error;
+      }
+    } else if (!skip) {
+      m_etags[part.first] = etag;
+    }
+    --m_parts_in_flight;
+    m_cond.broadcast();
+  }
+}
+
+void multipart_upload_writer::stop_upload_threads() {
+  {
+    std::lock_guard<graphlab::mutex> guard(m_lock);
+    m_parts_done = true;
+    m_cond.broadcast();
+  }
+  m_upload_threads.join();
+  m_num_upload_threads = 0;
+}
+
+void multipart_upload_writer::abort_and_throw() {
+  if (!m_aborted) {
+    m_aborted = true;
+    m_abort();
+  }
+  log_and_throw_io_failure(m_error);
+}
+
+} // namespace fileio
+} // namespace graphlab
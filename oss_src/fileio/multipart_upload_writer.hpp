@@ -0,0 +1,131 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_FILEIO_MULTIPART_UPLOAD_WRITER_HPP
+#define GRAPHLAB_FILEIO_MULTIPART_UPLOAD_WRITER_HPP
+#include <string>
+#include <deque>
+#include <map>
+#include <functional>
+#include <parallel/mutex.hpp>
+#include <parallel/pthread_tools.hpp>
+
+namespace graphlab {
+namespace fileio {
+
+/**
+ * Splits a stream of bytes into the parts of a multipart upload, and
+ * uploads the parts with background threads while the writer keeps
+ * producing data.
+ *
+ * Every part_size bytes written become a part, numbered from 1. At most
+ * max_parts_in_flight parts are queued or uploading at a time, each upload
+ * thread using its own thread_id in [0, max_parts_in_flight). write blocks
+ * while that many parts are pending, so the memory used is bounded by
+ * (max_parts_in_flight + 1) * part_size.
+ *
+ * A part which fails is retried, up to max_attempts attempts in total, with
+ * an exponential backoff starting at retry_backoff_ms. Once a part has
+ * failed for good, no more parts are uploaded, the upload is aborted, and
+ * the error is thrown by the next write or by close.
+ *
+ * \code
+ * multipart_upload_writer writer(64 << 20, 4, 3, upload_part, complete, abort);
+ * writer.write(data, length);
+ * writer.close();  // uploads the last part and completes the upload
+ * \endcode
+ *
+ * The writer is not safe for concurrent use.
+ */
+class multipart_upload_writer {
+ public:
+  /**
+   * Uploads one part, and returns its etag. Throws on failure. Called
+   * concurrently from the upload threads.
+   */
+  typedef std::function<std::string(size_t thread_id, size_t part_number,
+                                    const std::string& data)>
+      upload_part_function;
+
+  /// Completes the upload with the etags of all the parts, by part number.
+  typedef std::function<void(const std::map<size_t, std::string>& etags)>
+      complete_function;
+
+  /// Aborts the upload, discarding the uploaded parts. Must not throw.
+  typedef std::function<void()> abort_function;
+
+  multipart_upload_writer(size_t part_size,
+                          size_t max_parts_in_flight,
+                          size_t max_attempts,
+                          upload_part_function upload_part,
+                          complete_function complete,
+                          abort_function abort,
+                          size_t retry_backoff_ms = 1000);
+
+  /// Stops the upload threads. Neither completes nor aborts the upload.
+  ~multipart_upload_writer();
+
+  /**
+   * Appends data to the upload. Queues a part for every part_size bytes
+   * accumulated. Throws if a part failed.
+   */
+  void write(const char* data, size_t length);
+
+  /**
+   * Uploads the remaining data as the last part, waits for all the parts,
+   * and completes the upload. If a part failed, aborts the upload and
+   * throws instead. A single empty part is uploaded if nothing was written.
+   */
+  void close();
+
+  /// The number of parts queued so far.
+  size_t num_parts() const { return m_num_parts; }
+
+ private:
+  void queue_part();
+  void upload_thread(size_t thread_id);
+  std::string upload_with_retries(size_t thread_id, size_t part_number,
+                                  const std::string& data);
+  void stop_upload_threads();
+  void abort_and_throw();
+
+  size_t m_part_size;
+  size_t m_max_parts_in_flight;
+  size_t m_max_attempts;
+  size_t m_retry_backoff_ms;
+  upload_part_function m_upload_part;
+  complete_function m_complete;
+  abort_function m_abort;
+
+  // data not queued yet
+  std::string m_buffer;
+  size_t m_num_parts = 0;
+  bool m_closed = false;
+  bool m_aborted = false;
+
+  // protects everything below
+  graphlab::mutex m_lock;
+  // signaled when a part is queued, or a part upload completes
+  graphlab::conditional m_cond;
+  // parts waiting for an upload thread, as (part number, data)
+  std::deque<std::pair<size_t, std::string> > m_pending_parts;
+  // number of parts queued or being uploaded
+  size_t m_parts_in_flight = 0;
+  // etags of the uploaded parts, by part number
+  std::map<size_t, std::string> m_etags;
+  // error message of the first part which failed
+  std::string m_error;
+  // set when no more parts will be queued
+  bool m_parts_done = false;
+  // upload threads, launched with the first parts
+  graphlab::thread_group m_upload_threads;
+  size_t m_num_upload_threads = 0;
+};
+
+} // namespace fileio
+} // namespace graphlab
+#endif
@@ -0,0 +1,407 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <cstring>
+#include <algorithm>
+#include <logger/logger.hpp>
+#include <fileio/parallel_gzip_decompressor.hpp>
+
+namespace graphlab {
+namespace fileio_impl {
+
+namespace {
+
+/// The size of the fixed part of a gzip member header
+constexpr size_t GZIP_HEADER_SIZE = 10;
+
+/// Chunks inflating to more than this many bytes are inflated sequentially
+constexpr size_t MAX_CHUNK_OUTPUT_SIZE = 256 * 1024 * 1024;
+
+/// The number of bytes inflated at a time by the reader
+constexpr size_t SEQUENTIAL_OUTPUT_SIZE = 1024 * 1024;
+
+/**
+ * Returns true if the GZIP_HEADER_SIZE bytes at p are plausibly the start of
+ * a gzip member: the magic number, the deflate method, no reserved flags,
+ * and valid extra flags and OS.
+ */
+bool is_member_header(const char* p) {
+  const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+  return u[0] == 0x1f && u[1] == 0x8b && u[2] == 8 &&
+      (u[3] & 0xe0) == 0 &&
+      (u[8] == 0 || u[8] == 2 || u[8] == 4) &&
+      (u[9] <= 13 || u[9] == 255);
+}
+
+/**
+ * Returns the position of the first plausible member header at or after
+ * from, or std::string::npos.
+ */
+size_t find_member_header(const std::string& data, size_t from) {
+  if (data.size() < GZIP_HEADER_SIZE) return std::string::npos;
+  const char* begin = data.data();
+  size_t end = data.size() - GZIP_HEADER_SIZE + 1;
+  size_t i = from;
+  while (i < end) {
+    const void* p = memchr(begin + i, 0x1f, end - i);
+    if (p == NULL) break;
+    i = reinterpret_cast<const char*>(p) - begin;
+    if (is_member_header(begin + i)) return i;
+    ++i;
+  }
+  return std::string::npos;
+}
+
+/**
+ * If the member starting at pos of data is a bgzip block, returns its
+ * total size. Returns 0 if it is not, or if data does not hold enough of it
+ * to tell. needed is set to the number of bytes needed to tell.
+ */
+size_t bgzf_block_size(const std::string& data, size_t pos, size_t& needed) {
+  needed = pos + GZIP_HEADER_SIZE + 2;
+  if (data.size() < needed) return 0;
+  const unsigned char* u = reinterpret_cast<const unsigned char*>(data.data() + pos);
+  if (!is_member_header(data.data() + pos) || (u[3] & 4) == 0) return 0;
+  size_t xlen = u[10] | (u[11] << 8);
+  needed += xlen;
+  if (data.size() < needed) return 0;
+  // look for the "BC" subfield holding the block size - 1
+  size_t i = 12;
+  while (i + 4 <= 12 + xlen) {
+    size_t slen = u[i + 2] | (u[i + 3] << 8);
+    if (u[i] == 'B' && u[i + 1] == 'C' && slen == 2 && i + 6 <= 12 + xlen) {
+      return (u[i + 4] | (u[i + 5] << 8)) + 1;
+    }
+    i += 4 + slen;
+  }
+  return 0;
+}
+
+} // anonymous namespace
+
+bool inflate_gzip_members(const std::string& input,
+                          std::string& output,
+                          size_t max_output_size) {
+  output.clear();
+  if (input.empty()) return false;
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) return false;
+  output.resize(std::min(std::max<size_t>(4 * input.size(), 64 * 1024),
+                         max_output_size));
+  size_t input_pos = 0;
+  size_t output_pos = 0;
+  bool success = false;
+  while (true) {
+    stream.next_in = (Bytef*)(input.data() + input_pos);
+    stream.avail_in = input.size() - input_pos;
+    stream.next_out = (Bytef*)(&output[0] + output_pos);
+    stream.avail_out = output.size() - output_pos;
+    int ret = inflate(&stream, Z_NO_FLUSH);
+    input_pos = input.size() - stream.avail_in;
+    output_pos = output.size() - stream.avail_out;
+    if (ret == Z_STREAM_END) {
+      if (input_pos == input.size()) {
+        success = true;
+        break;
+      }
+      // the next member must follow immediately
+      if (input.size() - input_pos < GZIP_HEADER_SIZE ||
+          !is_member_header(input.data() + input_pos)) {
+        break;
+      }
+      inflateReset(&stream);
+    } else if (ret == Z_OK || ret == Z_BUF_ERROR) {
+      if (stream.avail_out == 0) {
+        if (output.size() >= max_output_size) break;
+        output.resize(std::min(2 * output.size(), max_output_size));
+      } else if (input_pos == input.size()) {
+        // the last member is truncated
+        break;
+      }
+    } else {
+      break;
+    }
+  }
+  inflateEnd(&stream);
+  if (success) {
+    output.resize(output_pos);
+  } else {
+    std::string().swap(output);
+  }
+  return success;
+}
+
+parallel_gzip_decompressor::parallel_gzip_decompressor(
+    std::shared_ptr<std::istream> input,
+    size_t nthreads,
+    size_t chunk_size)
+    : m_input(input),
+      m_nthreads(std::max<size_t>(nthreads, 1)),
+      m_chunk_size(std::max<size_t>(chunk_size, 1)) {
+  memset(&m_stream, 0, sizeof(m_stream));
+}
+
+parallel_gzip_decompressor::~parallel_gzip_decompressor() {
+  {
+    std::lock_guard<mutex> guard(m_lock);
+    m_stop = true;
+    m_cond.broadcast();
+  }
+  m_threads.join();
+  if (m_stream_initialized) inflateEnd(&m_stream);
+}
+
+std::streamsize parallel_gzip_decompressor::read(char* c,
+                                                 std::streamsize bufsize) {
+  std::streamsize total = 0;
+  while (total < bufsize && ensure_output()) {
+    const std::string& output = m_sequential ? m_sequential_output
+                                             : m_window.front()->output;
+    size_t& pos = m_sequential ? m_sequential_output_pos : m_output_pos;
+    size_t n = std::min<size_t>(bufsize - total, output.size() - pos);
+    memcpy(c + total, output.data() + pos, n);
+    pos += n;
+    total += n;
+  }
+  if (total == 0 && bufsize > 0) return -1;
+  return total;
+}
+
+size_t parallel_gzip_decompressor::get_bytes_read() const {
+  return m_sequential ? m_bytes_read + m_sequential_input_pos : m_bytes_read;
+}
+
+size_t parallel_gzip_decompressor::num_parallel_chunks() const {
+  return m_num_parallel_chunks;
+}
+
+bool parallel_gzip_decompressor::read_input(size_t bytes) {
+  if (m_input_eof) return false;
+  size_t old_size = m_pending.size();
+  m_pending.resize(old_size + bytes);
+  m_input->read(&m_pending[old_size], bytes);
+  size_t bytes_read = m_input->gcount();
+  m_pending.resize(old_size + bytes_read);
+  if (m_input->bad()) {
+    log_and_throw_io_failure("Fail to read the compressed input");
+  }
+  if (bytes_read < bytes) m_input_eof = true;
+  return bytes_read > 0;
+}
+
+std::shared_ptr<parallel_gzip_decompressor::chunk>
+parallel_gzip_decompressor::next_chunk() {
+  if (m_split_done) return nullptr;
+  if (m_pending.empty() && !read_input(m_chunk_size)) {
+    m_split_done = true;
+    return nullptr;
+  }
+  size_t cut = 0;
+  bool ends_at_member = true;
+
+  // bgzip blocks have exact boundaries. Take whole blocks.
+  if (m_at_member_start) {
+    while (cut < m_chunk_size) {
+      size_t needed = 0;
+      size_t block_size = bgzf_block_size(m_pending, cut, needed);
+      if (block_size == 0 && m_pending.size() < needed &&
+          read_input(std::max(m_chunk_size, needed - m_pending.size()))) {
+        continue;
+      }
+      if (block_size == 0) break;
+      while (m_pending.size() < cut + block_size &&
+             read_input(std::max(m_chunk_size, cut + block_size - m_pending.size())));
+      if (m_pending.size() < cut + block_size) break;
+      cut += block_size;
+    }
+  }
+
+  if (cut == 0) {
+    // cut speculatively at the next member header after m_chunk_size bytes,
+    // and give up on members longer than a few chunks.
+    size_t scan_from = m_chunk_size;
+    size_t max_size = 4 * m_chunk_size;
+    while (true) {
+      if (m_pending.size() >= scan_from + GZIP_HEADER_SIZE) {
+        size_t pos = find_member_header(m_pending, scan_from);
+        if (pos != std::string::npos) {
+          cut = pos;
+          break;
+        }
+        scan_from = m_pending.size() - GZIP_HEADER_SIZE + 1;
+      }
+      if (m_pending.size() >= max_size) {
+        cut = m_pending.size();
+        ends_at_member = false;
+        break;
+      }
+      if (!read_input(m_chunk_size)) {
+        cut = m_pending.size();
+        break;
+      }
+    }
+  }
+
+  auto ret = std::make_shared<chunk>();
+  ret->offset = m_pending_offset;
+  ret->input = m_pending.substr(0, cut);
+  ret->state = (m_at_member_start && ends_at_member) ? chunk::QUEUED
+                                                     : chunk::SEQUENTIAL;
+  m_pending.erase(0, cut);
+  m_pending_offset += cut;
+  m_at_member_start = ends_at_member;
+  if (m_pending.empty() && m_input_eof) m_split_done = true;
+  return ret;
+}
+
+void parallel_gzip_decompressor::fill_window() {
+  while (!m_split_done && m_window.size() < 2 * m_nthreads) {
+    auto c = next_chunk();
+    if (c == nullptr) break;
+    m_window.push_back(c);
+    if (c->state == chunk::QUEUED) submit(c);
+  }
+}
+
+void parallel_gzip_decompressor::submit(const std::shared_ptr<chunk>& c) {
+  if (!m_threads_started && m_split_done && m_window.size() == 1) {
+    // the whole stream is a single chunk. Not worth starting threads.
+    c->state = inflate_gzip_members(c->input, c->output, MAX_CHUNK_OUTPUT_SIZE)
+        ? chunk::DONE : chunk::FAILED;
+    return;
+  }
+  if (!m_threads_started) {
+    for (size_t i = 0; i < m_nthreads; ++i) {
+      m_threads.launch([this]() { worker_loop(); });
+    }
+    m_threads_started = true;
+  }
+  std::lock_guard<mutex> guard(m_lock);
+  m_queue.push_back(c);
+  m_cond.broadcast();
+}
+
+void parallel_gzip_decompressor::worker_loop() {
+  while (true) {
+    std::shared_ptr<chunk> c;
+    {
+      std::unique_lock<mutex> guard(m_lock);
+      while (m_queue.empty() && !m_stop) m_cond.wait(guard);
+      if (m_stop) return;
+      c = m_queue.front();
+      m_queue.pop_front();
+    }
+    bool success = false;
+    try {
+      success = inflate_gzip_members(c->input, c->output, MAX_CHUNK_OUTPUT_SIZE);
+    } catch (...) {
+      // out of memory. The reader inflates the chunk instead.
+    }
+    std::lock_guard<mutex> guard(m_lock);
+    c->state = success ? chunk::DONE : chunk::FAILED;
+    m_cond.broadcast();
+  }
+}
+
+bool parallel_gzip_decompressor::ensure_output() {
+  while (!m_eof) {
+    if (m_sequential) {
+      if (m_sequential_output_pos < m_sequential_output.size()) return true;
+      sequential_step();
+      continue;
+    }
+    fill_window();
+    if (m_window.empty()) {
+      m_eof = true;
+      break;
+    }
+    std::shared_ptr<chunk> front = m_window.front();
+    {
+      std::unique_lock<mutex> guard(m_lock);
+      while (front->state == chunk::QUEUED) m_cond.wait(guard);
+    }
+    if (front->state == chunk::DONE) {
+      if (m_output_pos < front->output.size()) return true;
+      m_bytes_read = front->offset + front->input.size();
+      m_window.pop_front();
+      m_output_pos = 0;
+      ++m_num_parallel_chunks;
+    } else {
+      // The chunk starts at a member boundary. Inflate it, and the
+      // following chunks, sequentially until a member ends at the end of a
+      // chunk.
+      if (!m_stream_initialized) {
+        if (inflateInit2(&m_stream, 16 + MAX_WBITS) != Z_OK) {
+          log_and_throw_io_failure("Unable to initialize gzip decompression");
+        }
+        m_stream_initialized = true;
+      }
+      m_sequential = true;
+      m_in_member = false;
+      m_sequential_input_pos = 0;
+      m_sequential_output.clear();
+      m_sequential_output_pos = 0;
+    }
+  }
+  return false;
+}
+
+void parallel_gzip_decompressor::sequential_step() {
+  m_sequential_output.clear();
+  m_sequential_output_pos = 0;
+  std::shared_ptr<chunk> front = m_window.front();
+  const std::string& input = front->input;
+
+  if (m_sequential_input_pos == input.size()) {
+    m_bytes_read = front->offset + input.size();
+    m_window.pop_front();
+    m_sequential_input_pos = 0;
+    if (!m_in_member) {
+      // the next chunk starts at a member boundary. Its own output is valid.
+      m_sequential = false;
+      return;
+    }
+    fill_window();
+    if (m_window.empty()) {
+      log_and_throw_io_failure("Unexpected end of gzip stream");
+    }
+    return;
+  }
+
+  if (!m_in_member) {
+    const unsigned char* next =
+        reinterpret_cast<const unsigned char*>(input.data()) + m_sequential_input_pos;
+    size_t remaining = input.size() - m_sequential_input_pos;
+    if (next[0] != 0x1f || (remaining > 1 && next[1] != 0x8b)) {
+      // same as gzip: trailing bytes which are not a member are ignored
+      logstream(LOG_WARNING) << "Ignoring trailing garbage after the "
+                             << "end of a gzip stream" << std::endl;
+      m_eof = true;
+      return;
+    }
+    inflateReset(&m_stream);
+    m_in_member = true;
+  }
+
+  m_sequential_output.resize(SEQUENTIAL_OUTPUT_SIZE);
+  m_stream.next_in = (Bytef*)(input.data() + m_sequential_input_pos);
+  m_stream.avail_in = input.size() - m_sequential_input_pos;
+  m_stream.next_out = (Bytef*)(&m_sequential_output[0]);
+  m_stream.avail_out = m_sequential_output.size();
+  int ret = inflate(&m_stream, Z_NO_FLUSH);
+  m_sequential_input_pos = input.size() - m_stream.avail_in;
+  m_sequential_output.resize(SEQUENTIAL_OUTPUT_SIZE - m_stream.avail_out);
+  if (ret == Z_STREAM_END) {
+    m_in_member = false;
+  } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+    log_and_throw_io_failure("Corrupted gzip stream");
+  }
+}
+
+} // namespace fileio_impl
+} // namespace graphlab
@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_FILEIO_PARALLEL_GZIP_DECOMPRESSOR_HPP
+#define GRAPHLAB_FILEIO_PARALLEL_GZIP_DECOMPRESSOR_HPP
+#include <string>
+#include <deque>
+#include <memory>
+#include <istream>
+#include <zlib.h>
+#include <parallel/pthread_tools.hpp>
+
+namespace graphlab {
+namespace fileio_impl {
+
+/**
+ * \internal
+ * Decompresses a gzip stream using multiple threads.
+ *
+ * A gzip file may consist of many independently compressed members, as
+ * produced by bgzip, or by concatenating gzip files. The compressed input is
+ * cut into chunks of about FILEIO_GZIP_DECOMPRESSION_CHUNK_SIZE bytes at
+ * member boundaries, and up to nthreads chunks are inflated concurrently
+ * while the reader consumes the output in order.
+ *
+ * The member boundaries of bgzip files are exact: every member records its
+ * size in its header. Otherwise, the boundaries are speculative: the input
+ * is cut where the bytes look like a gzip member header. A chunk is only
+ * used if it inflates to the end of a member ending exactly at the end of
+ * the chunk, and the CRC of each of its members matches. When a cut turns
+ * out to be wrong, or the members are too large to be cut at all (ex: a
+ * file compressed by a single gzip invocation), the chunks are inflated
+ * sequentially by the reader until the next real member boundary.
+ *
+ * Reading is not thread safe.
+ */
+class parallel_gzip_decompressor {
+ public:
+  /**
+   * Decompresses the gzip stream read from input, with nthreads threads,
+   * cutting the input into chunks of at least chunk_size compressed bytes.
+   */
+  parallel_gzip_decompressor(std::shared_ptr<std::istream> input,
+                             size_t nthreads,
+                             size_t chunk_size);
+
+  ~parallel_gzip_decompressor();
+
+  parallel_gzip_decompressor(const parallel_gzip_decompressor&) = delete;
+  parallel_gzip_decompressor& operator=(const parallel_gzip_decompressor&) = delete;
+
+  /**
+   * Reads up to bufsize decompressed bytes into c. Returns the number of
+   * bytes read, or -1 at the end of the stream. Throws an io failure if the
+   * stream is corrupted.
+   */
+  std::streamsize read(char* c, std::streamsize bufsize);
+
+  /**
+   * Returns the approximate number of compressed bytes consumed so far.
+   */
+  size_t get_bytes_read() const;
+
+  /**
+   * Returns the number of chunks whose output came from a decompression
+   * thread, rather than from sequential decompression by the reader.
+   */
+  size_t num_parallel_chunks() const;
+
+ private:
+  struct chunk {
+    enum chunk_state {
+      QUEUED,      ///< Waiting to be inflated by a thread
+      DONE,        ///< output holds the inflated chunk
+      FAILED,      ///< The chunk could not be inflated on its own
+      SEQUENTIAL   ///< Known not to be inflatable on its own
+    };
+    /// The offset of the chunk in the compressed stream
+    size_t offset = 0;
+    std::string input;
+    std::string output;
+    chunk_state state = QUEUED;
+  };
+
+  std::shared_ptr<std::istream> m_input;
+  size_t m_nthreads;
+  size_t m_chunk_size;
+
+  /// Compressed bytes read from m_input not yet assigned to a chunk
+  std::string m_pending;
+  size_t m_pending_offset = 0;
+  bool m_input_eof = false;
+  /// True once all of the input is assigned to chunks
+  bool m_split_done = false;
+  /// True if the next chunk starts at a member boundary
+  bool m_at_member_start = true;
+
+  /// Chunks in stream order. The front is the one being read.
+  std::deque<std::shared_ptr<chunk> > m_window;
+  /// The read position in the output of the front chunk
+  size_t m_output_pos = 0;
+
+  /// Whether the front chunk is inflated sequentially by the reader
+  bool m_sequential = false;
+  z_stream m_stream;
+  bool m_stream_initialized = false;
+  /// Whether m_stream is in the middle of a member
+  bool m_in_member = false;
+  /// The position in the input of the front chunk
+  size_t m_sequential_input_pos = 0;
+  std::string m_sequential_output;
+  size_t m_sequential_output_pos = 0;
+
+  bool m_eof = false;
+  size_t m_bytes_read = 0;
+  size_t m_num_parallel_chunks = 0;
+
+  mutex m_lock;
+  conditional m_cond;
+  /// Chunks waiting for a decompression thread
+  std::deque<std::shared_ptr<chunk> > m_queue;
+  bool m_stop = false;
+  thread_group m_threads;
+  bool m_threads_started = false;
+
+  /// Reads more compressed bytes into m_pending. Returns false at EOF.
+  bool read_input(size_t bytes);
+
+  /// Cuts the next chunk from the input. Returns nullptr at EOF.
+  std::shared_ptr<chunk> next_chunk();
+
+  /// Cuts chunks and queues them, up to 2 * m_nthreads chunks ahead.
+  void fill_window();
+
+  /// Queues a chunk for decompression.
+  void submit(const std::shared_ptr<chunk>& c);
+
+  /**
+   * Makes output available for reading, at the front chunk or in
+   * m_sequential_output. Returns false at the end of the stream.
+   */
+  bool ensure_output();
+
+  /// Inflates the next piece of the front chunk sequentially.
+  void sequential_step();
+
+  void worker_loop();
+};
+
+/**
+ * \internal
+ * Inflates a sequence of complete gzip members. Returns false if input is
+ * not exactly a sequence of valid members, or if the output would exceed
+ * max_output_size bytes.
+ */
+bool inflate_gzip_members(const std::string& input,
+                          std::string& output,
+                          size_t max_output_size);
+
+} // namespace fileio_impl
+} // namespace graphlab
+#endif
@@ -0,0 +1,167 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <boost/algorithm/string/predicate.hpp>
+#include <logger/logger.hpp>
+#include <parallel/mutex.hpp>
+#include <parallel/pthread_tools.hpp>
+#include <fileio/range_reader.hpp>
+#include <fileio/fileio_constants.hpp>
+#include <fileio/general_fstream.hpp>
+#include <fileio/s3_fstream.hpp>
+#include <fileio/sanitize_url.hpp>
+
+namespace graphlab {
+namespace fileio {
+
+std::vector<byte_range> coalesce_byte_ranges(std::vector<byte_range> ranges,
+                                             size_t max_gap,
+                                             size_t max_request_size) {
+  ranges.erase(std::remove_if(ranges.begin(), ranges.end(),
+                              [](const byte_range& r) { return r.length == 0; }),
+               ranges.end());
+  std::sort(ranges.begin(), ranges.end(),
+            [](const byte_range& a, const byte_range& b) {
+              return a.offset < b.offset;
+            });
+  std::vector<byte_range> requests;
+  for (const byte_range& r : ranges) {
+    if (!requests.empty()) {
+      byte_range& last = requests.back();
+      size_t end = std::max(last.end(), r.end());
+      if (r.offset <= last.end() + max_gap &&
+          (end - last.offset <= max_request_size || r.end() <= last.end())) {
+        last.length = end - last.offset;
+        continue;
+      }
+    }
+    requests.push_back(r);
+  }
+  return requests;
+}
+
+range_reader::range_reader(const std::string& url) : m_url(url) {
+  if (boost::starts_with(url, "s3://")) {
+    m_s3_device = std::make_shared<s3_device>(url, false);
+    m_file_size = m_s3_device->file_size();
+  } else {
+    general_ifstream fin(url, false);
+    if (fin.fail()) {
+      log_and_throw_io_failure("Cannot open " + sanitize_url(url));
+    }
+    m_file_size = fin.file_size();
+  }
+}
+
+range_reader::range_reader(fetch_function fetch, size_t file_size)
+    : m_file_size(file_size), m_fetch(fetch) { }
+
+void range_reader::fetch(char* out, const byte_range& request) {
+  size_t bytes_read = 0;
+  if (m_fetch) {
+    bytes_read = m_fetch(out, request.offset, request.length);
+  } else if (m_s3_device) {
+    bytes_read = m_s3_device->read_range(out, request.offset, request.length);
+  } else {
+    general_ifstream fin(m_url, false);
+    fin.seekg(request.offset, std::ios_base::beg);
+    fin.read(out, request.length);
+    bytes_read = fin.gcount();
+  }
+  m_num_requests.inc();
+  m_bytes_requested.inc(request.length);
+  if (bytes_read != request.length) {
+    log_and_throw_io_failure("Unable to read " + std::to_string(request.length) +
+                             " bytes at offset " + std::to_string(request.offset) +
+                             " of " + sanitize_url(m_url));
+  }
+}
+
+void range_reader::read(const std::vector<byte_range>& ranges,
+                        std::vector<std::vector<char> >& out) {
+  out.resize(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (ranges[i].end() > m_file_size) {
+      log_and_throw_io_failure("Reading past the end of " + sanitize_url(m_url));
+    }
+    out[i].resize(ranges[i].length);
+  }
+
+  std::vector<byte_range> requests =
+      coalesce_byte_ranges(ranges, FILEIO_RANGE_READ_MAX_GAP,
+                           FILEIO_RANGE_READ_MAX_REQUEST_SIZE);
+  if (requests.empty()) return;
+
+  // the ranges contained in each request
+  std::vector<std::vector<size_t> > request_ranges(requests.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (ranges[i].length == 0) continue;
+    auto iter = std::upper_bound(requests.begin(), requests.end(), ranges[i].offset,
+                                 [](size_t offset, const byte_range& r) {
+                                   return offset < r.offset;
+                                 });
+    --iter;
+    DASSERT_LE(iter->offset, ranges[i].offset);
+    DASSERT_LE(ranges[i].end(), iter->end());
+    request_ranges[iter - requests.begin()].push_back(i);
+  }
+
+  auto run_request = [&](size_t request_id) {
+    const byte_range& request = requests[request_id];
+    const std::vector<size_t>& contained = request_ranges[request_id];
+    if (contained.size() == 1 &&
+        ranges[contained[0]].offset == request.offset &&
+        ranges[contained[0]].length == request.length) {
+      // read directly into the output
+      fetch(out[contained[0]].data(), request);
+      return;
+    }
+    std::vector<char> buffer(request.length);
+    fetch(buffer.data(), request);
+    for (size_t i : contained) {
+      memcpy(out[i].data(), buffer.data() + (ranges[i].offset - request.offset),
+             ranges[i].length);
+    }
+  };
+
+  size_t nthreads = std::min<size_t>(requests.size(),
+                                     std::max<size_t>(FILEIO_RANGE_READ_PARALLELISM, 1));
+  if (nthreads == 1) {
+    for (size_t i = 0; i < requests.size(); ++i) run_request(i);
+    return;
+  }
+
+  // requests are handed out to the threads one at a time
+  graphlab::atomic<size_t> next_request;
+  graphlab::mutex error_lock;
+  std::exception_ptr error;
+  volatile bool failed = false;
+  thread_group threads;
+  for (size_t t = 0; t < nthreads; ++t) {
+    threads.launch([&]() {
+      while (!failed) {
+        size_t request_id = next_request.inc_ret_last();
+        if (request_id >= requests.size()) break;
+        try {
+          run_request(request_id);
+        } catch (...) {
+          std::lock_guard<graphlab::mutex> guard(error_lock);
+          if (!error) error = std::current_exception();
+          failed = true;
+        }
+      }
+    });
+  }
+  threads.join();
+  if (error) std::rethrow_exception(error);
+}
+
+} // namespace fileio
+} // namespace graphlab
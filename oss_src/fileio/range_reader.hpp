@@ -0,0 +1,127 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_FILEIO_RANGE_READER_HPP
+#define GRAPHLAB_FILEIO_RANGE_READER_HPP
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <parallel/atomic.hpp>
+
+namespace graphlab {
+class s3_device;
+
+namespace fileio {
+
+/**
+ * The range of bytes [offset, offset + length) of a file.
+ */
+struct byte_range {
+  size_t offset = 0;
+  size_t length = 0;
+
+  byte_range() = default;
+  byte_range(size_t offset, size_t length) : offset(offset), length(length) { }
+
+  /// Returns one past the last byte of the range.
+  inline size_t end() const { return offset + length; }
+};
+
+/**
+ * Merges a collection of byte ranges into as few read requests as possible.
+ *
+ * Ranges which overlap, or are separated by at most max_gap bytes, are
+ * merged into the same request as long as the request does not grow beyond
+ * max_request_size bytes. A single range longer than max_request_size is
+ * kept whole. Empty ranges are ignored.
+ *
+ * Returns the requests sorted by offset. Every non empty input range is
+ * contained in exactly one request.
+ */
+std::vector<byte_range> coalesce_byte_ranges(std::vector<byte_range> ranges,
+                                             size_t max_gap,
+                                             size_t max_request_size);
+
+/**
+ * Reads arbitrary collections of byte ranges of a file with concurrent
+ * range requests.
+ *
+ * On remote file systems, the latency of a request dominates the cost of
+ * reading a small range, and reading a whole file to access a few parts of
+ * it wastes bandwidth. The range_reader coalesces the requested ranges
+ * (see \ref coalesce_byte_ranges) and issues the resulting requests
+ * concurrently, with at most FILEIO_RANGE_READ_PARALLELISM requests in
+ * flight.
+ *
+ * For s3:// urls, each request is a single bounded HTTP range request
+ * (\ref s3_device::read_range). For all other urls, each request opens the
+ * file with a \ref general_ifstream, seeks and reads.
+ *
+ * \code
+ * fileio::range_reader reader("s3://bucket/sframe/m_1234.0000");
+ * std::vector<std::vector<char> > contents;
+ * reader.read({{0, 4096}, {8192, 4096}}, contents);
+ * \endcode
+ *
+ * The reader is safe for concurrent use.
+ */
+class range_reader {
+ public:
+  /**
+   * Reads length bytes at offset into the output buffer, and returns the
+   * number of bytes read. Must be safe to call concurrently.
+   */
+  typedef std::function<size_t(char* out, size_t offset, size_t length)>
+      fetch_function;
+
+  /**
+   * Opens a file for ranged reads.
+   * Throws an exception if the file cannot be opened.
+   */
+  explicit range_reader(const std::string& url);
+
+  /**
+   * Constructs a reader over a file of a given size accessed through an
+   * arbitrary fetch function. Mainly useful for testing.
+   */
+  range_reader(fetch_function fetch, size_t file_size);
+
+  /// Returns the size of the file.
+  inline size_t file_size() const { return m_file_size; }
+
+  /**
+   * Reads a collection of byte ranges. On return, out[i] contains the
+   * contents of ranges[i]. Ranges may overlap and need not be sorted.
+   *
+   * Throws an exception if a range goes past the end of the file, or if a
+   * request fails.
+   */
+  void read(const std::vector<byte_range>& ranges,
+            std::vector<std::vector<char> >& out);
+
+  /// Returns the number of requests issued so far.
+  inline size_t num_requests() const { return m_num_requests.value; }
+
+  /// Returns the number of bytes requested so far.
+  inline size_t bytes_requested() const { return m_bytes_requested.value; }
+
+ private:
+  std::string m_url;
+  size_t m_file_size = 0;
+  fetch_function m_fetch;
+  std::shared_ptr<s3_device> m_s3_device;
+  graphlab::atomic<size_t> m_num_requests;
+  graphlab::atomic<size_t> m_bytes_requested;
+
+  /// Performs a single request. Throws on failure.
+  void fetch(char* out, const byte_range& request);
+};
+
+} // namespace fileio
+} // namespace graphlab
+#endif
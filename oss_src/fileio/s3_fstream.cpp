@@ -31,6 +31,7 @@ s3_device::s3_device(const std::string& filename, const bool write) {
   } else {
     url_without_credentials = "s3://" + url.endpoint + "/" + url.bucket + "/" + url.object_name;
   }
+  m_url_without_credentials = url_without_credentials;
   auto uri = dmlc::io::URI(url_without_credentials.c_str());
   if (write) {
     m_write_stream.reset(m_s3fs->Open(uri, "w"));
@@ -64,6 +65,26 @@ std::streamsize s3_device::read(char* strm_ptr, std::streamsize n) {
   return m_read_stream->Read((void*)strm_ptr, n);
 }
 
+std::streamsize s3_device::read_range(char* strm_ptr,
+                                      size_t offset,
+                                      size_t length) const {
+  ASSERT_MSG(m_read_stream != nullptr, "S3 file is not opened for reading");
+  if (offset >= m_filesize) return 0;
+  length = std::min(length, m_filesize - offset);
+  if (length == 0) return 0;
+  auto uri = dmlc::io::URI(m_url_without_credentials.c_str());
+  std::unique_ptr<dmlc::SeekStream> stream(
+      m_s3fs->OpenRangeForRead(uri, m_filesize, offset, offset + length));
+  size_t bytes_read = 0;
+  while (bytes_read < length) {
+    size_t ret = stream->Read(strm_ptr + bytes_read, length - bytes_read);
+    if (ret == 0) break;
+    bytes_read += ret;
+  }
+  stream->Close();
+  return bytes_read;
+}
+
 std::streamsize s3_device::write(const char* strm_ptr, std::streamsize n) {
   m_write_stream->Write((void*)(strm_ptr), n);
   return n;
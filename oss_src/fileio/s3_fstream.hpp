@@ -35,6 +35,7 @@ class s3_device {
   std::shared_ptr<dmlc::io::S3FileSystem> m_s3fs;
   std::shared_ptr<dmlc::Stream> m_write_stream;
   std::shared_ptr<dmlc::SeekStream> m_read_stream;
+  std::string m_url_without_credentials;
   size_t m_filesize = (size_t)(-1);
  public:
   s3_device() { }
@@ -53,6 +54,14 @@ class s3_device {
 
   std::streamsize read(char* strm_ptr, std::streamsize n);
 
+  /**
+   * Reads the bytes [offset, offset + length) of the file into strm_ptr with
+   * a single bounded range request, without moving the read position.
+   * Each call uses its own connection, and is safe to call concurrently.
+   * Returns the number of bytes read.
+   */
+  std::streamsize read_range(char* strm_ptr, size_t offset, size_t length) const;
+
   std::streamsize write(const char* strm_ptr, std::streamsize n);
 
   bool good() const;
@@ -55,6 +55,10 @@ struct tempfile_information {
   /// lists all the temporary directories created by this process
   std::set<boost::filesystem::path> process_temp_directories;
 
+  /// graphlab-[username] directories of the get_temp_name_in_directory()
+  /// directories, reaped in addition to the regular temp directories
+  std::set<boost::filesystem::path> extra_temp_directories;
+
   /// Counts the number of temp files created
   size_t temp_file_counter;
 
@@ -252,60 +256,75 @@ static void delete_proc_directory(fs::path path) {
 }
 
 /**
- * we will store the temporary files in [tmp_directory]/graphlab/[procid]
- * This searches in graphlab's temp directory for unused temporary files
- * (what procids no longer exist) and deletes them.
+ * Deletes the [procid] subdirectories of a graphlab-[username] directory
+ * whose process no longer exists.
  */
-EXPORT void reap_unused_temp_files() {
-  // loop through all the subdirectories in get_graphlab_temp_directory()
+static void reap_unused_temp_files_in(const fs::path& temp_dir) {
+  // loop through all the subdirectories in temp_dir
   // and unlink if the pid does not exist
-  size_t temp_dir_size = num_temp_directories();
-  for (size_t idx = 0; idx < temp_dir_size; ++idx) {
-    try {
-      fs::path temp_dir(get_graphlab_temp_directory(idx));
-      auto diriter = fs::directory_iterator(temp_dir);
-      auto enditer = fs::directory_iterator();
-
-      while(diriter != enditer) {
-        auto path = diriter->path();
-        if (fs::is_directory(path)) {
-          try {
-            long pid = std::stol(path.filename().string());
-            if(!is_process_running(pid)) {
-              // PID no longer exists.
-              // delete it
-              logstream(LOG_EMPH) << "Deleting orphaned temp directory found in "
-                << path.string() << std::endl;
-
-              delete_proc_directory(path);
-            }
-          } catch (...) {
-            // empty catch. if the path does not parse as an
-            // integer, ignore it.
-            logstream(LOG_WARNING)
-                << "Unexpcted file in GraphLab's temp directory: " << path
-                << std::endl;
+  try {
+    auto diriter = fs::directory_iterator(temp_dir);
+    auto enditer = fs::directory_iterator();
+
+    while(diriter != enditer) {
+      auto path = diriter->path();
+      if (fs::is_directory(path)) {
+        try {
+          long pid = std::stol(path.filename().string());
+          if(!is_process_running(pid)) {
+            // PID no longer exists.
+            // delete it
+            logstream(LOG_EMPH) << "Deleting orphaned temp directory found in "
+              << path.string() << std::endl;
+
+            delete_proc_directory(path);
           }
+        } catch (...) {
+          // empty catch. if the path does not parse as an
+          // integer, ignore it.
+          logstream(LOG_WARNING)
+              << "Unexpcted file in GraphLab's temp directory: " << path
+              << std::endl;
         }
-        ++diriter;
       }
-    } catch (...) {
-      // Failures are ok. we just stop.
+      ++diriter;
     }
+  } catch (...) {
+    // Failures are ok. we just stop.
   }
 }
 
+/**
+ * we will store the temporary files in [tmp_directory]/graphlab/[procid]
+ * This searches in graphlab's temp directories, and in the directories used
+ * by get_temp_name_in_directory(), for unused temporary files (what procids
+ * no longer exist) and deletes them.
+ */
+EXPORT void reap_unused_temp_files() {
+  size_t temp_dir_size = num_temp_directories();
+  for (size_t idx = 0; idx < temp_dir_size; ++idx) {
+    reap_unused_temp_files_in(get_graphlab_temp_directory(idx));
+  }
+  // cache blocks may be spilled to the fast spill location
+  std::set<fs::path> extra_dirs;
+  if (!fileio::FILEIO_CACHE_FAST_SPILL_LOCATION.empty()) {
+    extra_dirs.insert(fs::path(fileio::FILEIO_CACHE_FAST_SPILL_LOCATION) /
+                      get_graphlab_temp_directory_prefix());
+  }
+  {
+    std::lock_guard<mutex> lg(get_temp_info().lock);
+    extra_dirs.insert(get_temp_info().extra_temp_directories.begin(),
+                      get_temp_info().extra_temp_directories.end());
+  }
+  for (auto& dir: extra_dirs) reap_unused_temp_files_in(dir);
+}
 
-EXPORT std::string get_temp_name(const std::string& prefix, bool _prefer_hdfs) {
-  std::lock_guard<mutex> lg(get_temp_info().lock);
 
-  // Local system temp dir
-  fs::path path(get_current_process_temp_directory(get_temp_info().temp_file_counter++));
-  // hdfs temp dir
-  fs::path hdfs_path(get_current_process_hdfs_temp_directory());
-  if (_prefer_hdfs && !hdfs_path.empty()) {
-    path = hdfs_path;
-  }
+/**
+ * Returns a temp file name under the current process temp directory path.
+ * The temp info lock must be acquired.
+ */
+static std::string make_temp_name(fs::path path, const std::string& prefix) {
   // create the directories if they do not exist
   create_current_process_temp_directory(path.string());
   
@@ -322,8 +341,35 @@ EXPORT std::string get_temp_name(const std::string& prefix, bool _prefer_hdfs) {
   get_temp_info().tempfile_history.insert(ret);
 
   return ret;
+}
+
+EXPORT std::string get_temp_name(const std::string& prefix, bool _prefer_hdfs) {
+  std::lock_guard<mutex> lg(get_temp_info().lock);
+
+  // Local system temp dir
+  fs::path path(get_current_process_temp_directory(get_temp_info().temp_file_counter++));
+  // hdfs temp dir
+  fs::path hdfs_path(get_current_process_hdfs_temp_directory());
+  if (_prefer_hdfs && !hdfs_path.empty()) {
+    path = hdfs_path;
+  }
+  return make_temp_name(path, prefix);
 };
 
+std::string get_temp_name_in_directory(const std::string& directory,
+                                       const std::string& prefix) {
+  std::lock_guard<mutex> lg(get_temp_info().lock);
+  fs::path path(directory);
+  path /= get_graphlab_temp_directory_prefix();
+  if (get_temp_info().extra_temp_directories.insert(path).second) {
+    // the directory may hold the files of processes which died since the
+    // startup reaping, or which were not configured to use it then
+    reap_unused_temp_files_in(path);
+  }
+  path /= std::to_string(getpid());
+  return make_temp_name(path, prefix);
+}
+
 std::string get_temp_name_prefer_hdfs(const std::string& prefix) {
   bool prefer_hdfs = true;
   return get_temp_name(prefix, prefer_hdfs);
@@ -50,6 +50,17 @@ std::string get_temp_name(const std::string& prefix="", bool _prefer_hdfs=false)
  */
 std::string get_temp_name_prefer_hdfs(const std::string& prefix="");
 
+/**
+ * Same as get_temp_name but returns a temp file under the given base
+ * directory instead of the configured temp directories, for instance
+ * /mnt/ssd/graphlab-ylow/12345/[prefix] for the directory /mnt/ssd. The
+ * file is cleaned up like all other temp files. The first call for a
+ * directory also deletes the files left in it by processes which no longer
+ * exist.
+ */
+std::string get_temp_name_in_directory(const std::string& directory,
+                                       const std::string& prefix="");
+
 /**
  * Deletes the temporary file with the name s. 
  * Returns true on success, false on failure (file does not exist, 
@@ -80,7 +91,8 @@ void delete_temp_files(std::vector<std::string> files);
 /**
  * Deletes all temporary directories in the temporary graphlab/ directory 
  * (/var/tmp/graphlab) which are no longer used. i.e. was created by a process
- * which no longer exists.
+ * which no longer exists. The directories used by get_temp_name_in_directory()
+ * and FILEIO_CACHE_FAST_SPILL_LOCATION are reaped as well.
  */
 void reap_unused_temp_files();
 
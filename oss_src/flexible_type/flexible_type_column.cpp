@@ -0,0 +1,307 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <cstring>
+#include <logger/logger.hpp>
+#include <serialization/serialization_includes.hpp>
+#include <flexible_type/flexible_type_column.hpp>
+
+namespace graphlab {
+
+namespace {
+
+const char COLUMN_FORMAT_VERSION = 1;
+
+/*
+ * The column header is
+ *  - char: format version
+ *  - char: column type
+ *  - char: whether there is an undefined bitmap
+ *  - uint64_t: number of values
+ *  - uint64_t: number of bytes following the header
+ */
+const size_t COLUMN_HEADER_SIZE = 3 + 2 * sizeof(uint64_t);
+
+inline void write_uint64(oarchive& oarc, uint64_t value) {
+  oarc.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline uint64_t read_uint64(const char* buf) {
+  uint64_t ret;
+  memcpy(&ret, buf, sizeof(ret));
+  return ret;
+}
+
+inline bool uses_offsets_table(flex_type_enum type) {
+  return type != flex_type_enum::INTEGER && type != flex_type_enum::FLOAT;
+}
+
+/**
+ * Decodes a serialized column in place: the values are read from the
+ * buffer the column was written to, which must outlive the reader.
+ */
+class column_reader {
+ public:
+  /**
+   * Points the reader at the column in [buf, buf + len). Returns the number
+   * of bytes used by the column.
+   */
+  size_t load(const char* buf, size_t len) {
+    if (len < COLUMN_HEADER_SIZE || buf[0] != COLUMN_FORMAT_VERSION) {
+      log_and_throw("Invalid flexible_type column");
+    }
+    m_type = (flex_type_enum)(buf[1]);
+    bool has_undefined = buf[2];
+    m_size = read_uint64(buf + 3);
+    size_t payload_size = read_uint64(buf + 3 + sizeof(uint64_t));
+    if (len - COLUMN_HEADER_SIZE < payload_size) {
+      log_and_throw("Unexpected end of flexible_type column");
+    }
+    if (m_type != flex_type_enum::INTEGER && m_type != flex_type_enum::FLOAT &&
+        m_type != flex_type_enum::STRING && m_type != flex_type_enum::UNDEFINED) {
+      log_and_throw("Invalid flexible_type column type");
+    }
+    // every value takes at least 8 bytes (a value or an offset), which also
+    // keeps the size computations below from overflowing
+    if (m_size > payload_size / sizeof(uint64_t)) {
+      log_and_throw("Invalid flexible_type column size");
+    }
+    size_t bitmap_size = has_undefined ? (m_size + 7) / 8 : 0;
+    size_t table_size = uses_offsets_table(m_type) ?
+        (m_size + 1) * sizeof(uint64_t) : m_size * sizeof(uint64_t);
+    if (bitmap_size + table_size > payload_size ||
+        (!uses_offsets_table(m_type) && bitmap_size + table_size != payload_size)) {
+      log_and_throw("Invalid flexible_type column size");
+    }
+
+    const char* payload = buf + COLUMN_HEADER_SIZE;
+    m_undefined_bitmap = nullptr;
+    if (has_undefined) {
+      m_undefined_bitmap = reinterpret_cast<const unsigned char*>(payload);
+      payload += bitmap_size;
+    }
+    m_offsets = nullptr;
+    if (uses_offsets_table(m_type)) {
+      m_offsets = payload;
+      payload += table_size;
+      // the offsets must be non decreasing, and within the payload
+      size_t values_size = payload_size - bitmap_size - table_size;
+      uint64_t prev = 0;
+      for (size_t i = 0; i <= m_size; ++i) {
+        uint64_t offset = get_offset(i);
+        if (offset < prev || offset > values_size) {
+          log_and_throw("Invalid flexible_type column offsets");
+        }
+        prev = offset;
+      }
+    }
+    m_values = payload;
+    return COLUMN_HEADER_SIZE + payload_size;
+  }
+
+  /// Decodes all the values into out, replacing its contents
+  void materialize(std::vector<flexible_type>& out) const {
+    out.resize(m_size);
+    switch(m_type) {
+     case flex_type_enum::INTEGER:
+       for (size_t i = 0; i < m_size; ++i) {
+         if (is_undefined(i)) out[i] = flex_undefined();
+         else out[i] = (flex_int)read_uint64(m_values + i * sizeof(flex_int));
+       }
+       break;
+     case flex_type_enum::FLOAT:
+       for (size_t i = 0; i < m_size; ++i) {
+         if (is_undefined(i)) {
+           out[i] = flex_undefined();
+         } else {
+           flex_float value;
+           memcpy(&value, m_values + i * sizeof(flex_float), sizeof(flex_float));
+           out[i] = value;
+         }
+       }
+       break;
+     case flex_type_enum::STRING:
+       for (size_t i = 0; i < m_size; ++i) {
+         if (is_undefined(i)) {
+           out[i] = flex_undefined();
+         } else {
+           // reuse the string if there is one
+           if (out[i].get_type() != flex_type_enum::STRING) {
+             out[i] = flexible_type(flex_type_enum::STRING);
+           }
+           out[i].mutable_get<flex_string>().assign(m_values + get_offset(i),
+                                                    get_offset(i + 1) - get_offset(i));
+         }
+       }
+       break;
+     default:
+       {
+         iarchive iarc(m_values, get_offset(m_size));
+         for (size_t i = 0; i < m_size; ++i) {
+           if (is_undefined(i)) {
+             out[i] = flex_undefined();
+           } else {
+             iarc.off = get_offset(i);
+             iarc >> out[i];
+             if (iarc.off != get_offset(i + 1)) {
+               log_and_throw("Invalid flexible_type column value");
+             }
+           }
+         }
+       }
+       break;
+    }
+  }
+
+ private:
+  size_t m_size = 0;
+  flex_type_enum m_type = flex_type_enum::UNDEFINED;
+  const unsigned char* m_undefined_bitmap = nullptr;
+  /// The offsets table of STRING and UNDEFINED columns
+  const char* m_offsets = nullptr;
+  /// The values of INTEGER and FLOAT columns, or the contents the offsets
+  /// table refers to
+  const char* m_values = nullptr;
+
+  inline bool is_undefined(size_t i) const {
+    return m_undefined_bitmap != nullptr &&
+        (m_undefined_bitmap[i / 8] >> (i % 8)) & 1;
+  }
+
+  inline uint64_t get_offset(size_t i) const {
+    return read_uint64(m_offsets + i * sizeof(uint64_t));
+  }
+};
+
+} // anonymous namespace
+
+void save_flexible_type_column(oarchive& oarc,
+                               const flexible_type* data,
+                               size_t length) {
+  // find the column type
+  flex_type_enum type = flex_type_enum::UNDEFINED;
+  bool has_undefined = false;
+  bool mixed = false;
+  for (size_t i = 0; i < length; ++i) {
+    flex_type_enum t = data[i].get_type();
+    if (t == flex_type_enum::UNDEFINED) {
+      has_undefined = true;
+    } else if (type == flex_type_enum::UNDEFINED) {
+      if (!mixed) type = t;
+    } else if (t != type) {
+      mixed = true;
+      type = flex_type_enum::UNDEFINED;
+    }
+  }
+  if (type != flex_type_enum::INTEGER &&
+      type != flex_type_enum::FLOAT &&
+      type != flex_type_enum::STRING) {
+    type = flex_type_enum::UNDEFINED;
+  }
+
+  // values of an UNDEFINED column are serialized individually
+  oarchive generic_values;
+  std::vector<uint64_t> offsets;
+  if (uses_offsets_table(type)) {
+    offsets.resize(length + 1);
+    offsets[0] = 0;
+    for (size_t i = 0; i < length; ++i) {
+      if (type == flex_type_enum::STRING) {
+        offsets[i + 1] = offsets[i] + (data[i].get_type() == flex_type_enum::STRING ?
+                                       data[i].get<flex_string>().length() : 0);
+      } else {
+        if (data[i].get_type() != flex_type_enum::UNDEFINED) {
+          generic_values << data[i];
+        }
+        offsets[i + 1] = generic_values.off;
+      }
+    }
+  }
+
+  size_t bitmap_size = has_undefined ? (length + 7) / 8 : 0;
+  size_t payload_size = bitmap_size;
+  if (uses_offsets_table(type)) {
+    payload_size += offsets.size() * sizeof(uint64_t) + offsets.back();
+  } else {
+    payload_size += length * sizeof(flex_int);
+  }
+
+  oarc << COLUMN_FORMAT_VERSION << (char)type << (char)has_undefined;
+  write_uint64(oarc, length);
+  write_uint64(oarc, payload_size);
+
+  if (has_undefined) {
+    std::vector<unsigned char> bitmap(bitmap_size, 0);
+    for (size_t i = 0; i < length; ++i) {
+      if (data[i].get_type() == flex_type_enum::UNDEFINED) {
+        bitmap[i / 8] |= (unsigned char)(1 << (i % 8));
+      }
+    }
+    oarc.write(reinterpret_cast<const char*>(bitmap.data()), bitmap.size());
+  }
+
+  switch(type) {
+   case flex_type_enum::INTEGER:
+   case flex_type_enum::FLOAT:
+     // both are 8 bytes. UNDEFINED values are written as 0
+     for (size_t i = 0; i < length; ++i) {
+       if (data[i].get_type() == flex_type_enum::UNDEFINED) {
+         write_uint64(oarc, 0);
+       } else if (type == flex_type_enum::INTEGER) {
+         flex_int value = data[i].get<flex_int>();
+         oarc.write(reinterpret_cast<const char*>(&value), sizeof(value));
+       } else {
+         flex_float value = data[i].get<flex_float>();
+         oarc.write(reinterpret_cast<const char*>(&value), sizeof(value));
+       }
+     }
+     break;
+   case flex_type_enum::STRING:
+     oarc.write(reinterpret_cast<const char*>(offsets.data()),
+                offsets.size() * sizeof(uint64_t));
+     for (size_t i = 0; i < length; ++i) {
+       if (data[i].get_type() == flex_type_enum::STRING) {
+         const flex_string& value = data[i].get<flex_string>();
+         oarc.write(value.data(), value.length());
+       }
+     }
+     break;
+   default:
+     oarc.write(reinterpret_cast<const char*>(offsets.data()),
+                offsets.size() * sizeof(uint64_t));
+     oarc.write(generic_values.buf, generic_values.off);
+     break;
+  }
+  free(generic_values.buf);
+}
+
+void save_flexible_type_column(oarchive& oarc,
+                               const std::vector<flexible_type>& data) {
+  save_flexible_type_column(oarc, data.data(), data.size());
+}
+
+void load_flexible_type_column(iarchive& iarc,
+                               std::vector<flexible_type>& out) {
+  column_reader reader;
+  if (iarc.buf != nullptr) {
+    // decode in place
+    iarc.off += reader.load(iarc.buf + iarc.off, iarc.len - iarc.off);
+    reader.materialize(out);
+  } else {
+    // read the column into a buffer first
+    std::string buffer(COLUMN_HEADER_SIZE, 0);
+    iarc.read(&(buffer[0]), COLUMN_HEADER_SIZE);
+    size_t payload_size = read_uint64(buffer.data() + 3 + sizeof(uint64_t));
+    buffer.resize(COLUMN_HEADER_SIZE + payload_size);
+    iarc.read(&(buffer[COLUMN_HEADER_SIZE]), payload_size);
+    if (iarc.fail()) log_and_throw("Unexpected end of flexible_type column");
+    reader.load(buffer.data(), buffer.size());
+    reader.materialize(out);
+  }
+}
+
+} // namespace graphlab
@@ -0,0 +1,70 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_FLEXIBLE_TYPE_FLEXIBLE_TYPE_COLUMN_HPP
+#define GRAPHLAB_FLEXIBLE_TYPE_FLEXIBLE_TYPE_COLUMN_HPP
+#include <string>
+#include <vector>
+#include <flexible_type/flexible_type.hpp>
+
+namespace graphlab {
+
+class oarchive;
+class iarchive;
+
+/**
+ * \ingroup unity
+ * Bulk serialization of a sequence of flexible_type values.
+ *
+ * Serializing a std::vector<flexible_type> with the archive operators
+ * writes a type tag before every value, and loading it allocates every
+ * string separately. The column format instead writes the type of the
+ * column once, followed by a contiguous payload:
+ *  - INTEGER and FLOAT columns: an array of 8 byte values.
+ *  - STRING columns: an offsets table of size()+1 entries followed by the
+ *    concatenated string contents.
+ *  - Any other column (mixed types, vectors, lists, ...): an offsets table
+ *    followed by every value serialized individually.
+ * UNDEFINED values are recorded in a bitmap, and do not change the type of
+ * the column.
+ *
+ * Loading from an in memory archive decodes the values in place, without
+ * copying the payload first.
+ *
+ * The format is meant for transient messages (the results of shared memory
+ * lambda calls), not for persisted data: it may change between versions.
+ * sframe_rows and the sort and shuffle spill files keep their own block
+ * encoding.
+ *
+ * \code
+ * oarchive oarc;
+ * save_flexible_type_column(oarc, values);
+ *
+ * iarchive iarc(oarc.buf, oarc.off);
+ * load_flexible_type_column(iarc, values);
+ * \endcode
+ */
+void save_flexible_type_column(oarchive& oarc,
+                               const flexible_type* data,
+                               size_t length);
+
+/// \overload
+void save_flexible_type_column(oarchive& oarc,
+                               const std::vector<flexible_type>& data);
+
+/**
+ * Loads a column saved with \ref save_flexible_type_column into out,
+ * replacing its contents.
+ *
+ * Throws if the column is truncated, or if its sizes or offsets are
+ * inconsistent.
+ */
+void load_flexible_type_column(iarchive& iarc,
+                               std::vector<flexible_type>& out);
+
+} // namespace graphlab
+#endif
@@ -9,6 +9,7 @@
 #define GRAPHLAB_IMAGE_IO_IMPL_HPP
 
 #include <string>
+#include <vector>
 #include <image/image_type.hpp>
 
 namespace graphlab {
@@ -37,6 +38,21 @@ void parse_jpeg(const char* data, size_t length,
 
 void decode_jpeg(const char* data, size_t length, char** decoded_data, size_t& out_length);
 
+/**
+ * Decode a jpeg into out_data, which is resized as needed so that the same
+ * buffer can be reused across images. Sets width, height and channels to the
+ * dimensions of the decoded pixels.
+ *
+ * If min_width and min_height are not 0, the image is downscaled by libjpeg
+ * in the DCT domain by the largest factor among 1/2, 1/4 and 1/8 which keeps
+ * the output at least min_width x min_height. This is much cheaper than a
+ * full resolution decode when the image is later resized to a small size.
+ */
+void decode_jpeg_scaled(const char* data, size_t length,
+                        size_t min_width, size_t min_height,
+                        std::vector<char>& out_data,
+                        size_t& width, size_t& height, size_t& channels);
+
 /**
  * Parse the image information, set width, height and channels using libpng.
  */
@@ -22,6 +22,7 @@
 #include <jpeglib.h>
 
 #include <string.h>
+#include <vector>
 
 namespace graphlab {
 
@@ -112,4 +113,59 @@ void decode_jpeg(const char* data, size_t length, char** out_data, size_t& out_l
   jpeg_destroy_decompress(&cinfo);
 }
 
+void decode_jpeg_scaled(const char* data, size_t length,
+                        size_t min_width, size_t min_height,
+                        std::vector<char>& out_data,
+                        size_t& width, size_t& height, size_t& channels) {
+  struct jpeg_decompress_struct cinfo;
+  struct jpeg_error_mgr jerr;
+  memset(&cinfo, 0, sizeof(cinfo));
+  memset(&jerr, 0, sizeof(jerr));
+  cinfo.err = jpeg_std_error(&jerr);
+  jerr.error_exit = jpeg_error_exit;
+
+  if (data == NULL) {
+    log_and_throw("Trying to decode image with NULL data pointer.");
+  }
+
+  try {
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, (unsigned char*)data, length);
+    jpeg_read_header(&cinfo, TRUE);
+
+    // Pick the largest DCT domain downscaling (1/2, 1/4 or 1/8) which still
+    // produces at least min_width x min_height pixels.
+    size_t denom = 1;
+    if (min_width > 0 && min_height > 0) {
+      for (size_t d = 8; d > 1; d /= 2) {
+        if ((cinfo.image_width + d - 1) / d >= min_width &&
+            (cinfo.image_height + d - 1) / d >= min_height) {
+          denom = d;
+          break;
+        }
+      }
+    }
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = denom;
+    jpeg_start_decompress(&cinfo);
+
+    width = cinfo.output_width;
+    height = cinfo.output_height;
+    channels = cinfo.output_components;
+    size_t row_stride = width * channels;
+    out_data.resize(row_stride * height);
+
+    JSAMPROW rowptr[1];
+    while (cinfo.output_scanline < cinfo.output_height) {
+      rowptr[0] = (unsigned char*)(out_data.data() + cinfo.output_scanline * row_stride);
+      jpeg_read_scanlines(&cinfo, rowptr, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+  } catch (...) {
+    jpeg_destroy_decompress(&cinfo);
+    throw;
+  }
+  jpeg_destroy_decompress(&cinfo);
+}
+
 }
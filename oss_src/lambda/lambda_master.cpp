@@ -12,6 +12,10 @@
 #include <algorithm>
 #include <lambda/lambda_constants.hpp>
 #include <shmipc/shmipc.hpp>
+#include <flexible_type/flexible_type_column.hpp>
+#include <perf/thread_counters.hpp>
+#include <perf/timeline_trace.hpp>
+#include <chrono>
 
 namespace graphlab { namespace lambda {
 
@@ -23,6 +27,28 @@ namespace graphlab { namespace lambda {
 std::vector<std::string> lambda_master::lambda_worker_binary_and_args = {};
 static lambda_master* instance_ptr = nullptr;
 
+namespace {
+  /**
+   * Adds the time between its construction and destruction to the
+   * lambda time of the calling thread if its counters are enabled (see
+   * \ref thread_counters), and traces it on the timeline.
+   */
+  struct lambda_call_timer {
+    timeline_scope scope{"lambda", "bulk_eval"};
+    bool enabled = thread_counters_enabled();
+    std::chrono::steady_clock::time_point begin;
+    lambda_call_timer() {
+      if (enabled) begin = std::chrono::steady_clock::now();
+    }
+    ~lambda_call_timer() {
+      if (!enabled) return;
+      auto elapsed = std::chrono::steady_clock::now() - begin;
+      get_thread_counters().lambda_nanoseconds +=
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+  };
+} // anonymous namespace
+
   lambda_master& lambda_master::get_instance() {
     if (instance_ptr == nullptr) {
       size_t num_workers = std::min<size_t>(DEFAULT_NUM_PYLAMBDA_WORKERS,
@@ -130,6 +156,7 @@ static lambda_master* instance_ptr = nullptr;
                                 std::vector<flexible_type>& out,
                                 bool skip_undefined, int seed) {
 
+    lambda_call_timer call_timer;
     auto worker = m_worker_pool->get_worker();
     auto worker_guard = m_worker_pool->get_worker_guard(worker);
     // catch and reinterpret comm failure
@@ -154,14 +181,15 @@ static lambda_master* instance_ptr = nullptr;
    * will also take over management of the buffer inside of "arguments" and
    * free it when done.
    *
-   * Results will be deserialized into the ret.
+   * Results will be deserialized into the ret. They are sent in the bulk
+   * column format (see \ref save_flexible_type_column).
    *
    * This function may throw exceptions if remote exceptions were raised.
    */
-  template <typename RetType>
   static bool shm_call(const std::shared_ptr<shmipc::client>& shmclient,
                        oarchive& arguments,
-                       RetType& ret) {
+                       std::vector<flexible_type>& ret) {
+    TIMELINE_TRACE_SCOPE("lambda", "shm_call");
     // send the message
     bool shmok = shmipc::large_send(*shmclient, arguments.buf, arguments.off);
     if (shmok == false) {
@@ -187,7 +215,7 @@ static lambda_master* instance_ptr = nullptr;
     char good_call;
     iarc >> good_call;
     if (good_call) {
-      iarc >> ret;
+      load_flexible_type_column(iarc, ret);
     } else {
       std::string message;
       iarc >> message;
@@ -208,6 +236,7 @@ static lambda_master* instance_ptr = nullptr;
                                   bool skip_undefined,
                                   int seed) {
 
+    lambda_call_timer call_timer;
     auto worker = m_worker_pool->get_worker();
     auto worker_guard = m_worker_pool->get_worker_guard(worker);
 
@@ -248,6 +277,7 @@ static lambda_master* instance_ptr = nullptr;
                                 const std::vector<std::vector<flexible_type>>& values,
                                 std::vector<flexible_type>& out,
                                 bool skip_undefined, int seed) {
+    lambda_call_timer call_timer;
     auto worker = m_worker_pool->get_worker();
     auto worker_guard = m_worker_pool->get_worker_guard(worker);
     // catch and reinterpret comm failure
@@ -264,6 +294,7 @@ static lambda_master* instance_ptr = nullptr;
                                   const sframe_rows& rows,
                                   std::vector<flexible_type>& out,
                                   bool skip_undefined, int seed) {
+    lambda_call_timer call_timer;
     auto worker = m_worker_pool->get_worker();
     auto worker_guard = m_worker_pool->get_worker_guard(worker);
     // catch and reinterpret comm failure
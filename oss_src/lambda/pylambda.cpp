@@ -12,6 +12,7 @@
 #include <fileio/fs_utils.hpp>
 #include <util/cityhash_gl.hpp>
 #include <shmipc/shmipc.hpp>
+#include <flexible_type/flexible_type_column.hpp>
 
 namespace graphlab { namespace lambda {
 
@@ -237,7 +238,8 @@ std::string pylambda_evaluator::initialize_shared_memory_comm() {
                 oarc.len = send_buffer_length;
                 try {
                   auto ret = bulk_eval_rows_serialized(receive_buffer, message_length);
-                  oarc << (char)(1) << ret;
+                  oarc << (char)(1);
+                  save_flexible_type_column(oarc, ret);
                 } catch (std::string& s) {
                   oarc << (char)(0) << s;
                 } catch (const char* s) {
@@ -32,10 +32,13 @@
 #include <map>
 #include <utility>
 #include <sstream>
+#include <cstdlib>
+#include <algorithm>
 #include <boost/function.hpp>
 
 #include <util/stl_util.hpp>
 #include <parallel/pthread_tools.hpp>
+#include <perf/timeline_trace.hpp>
 
 #include <metric/mongoose/mongoose.h>
 #include <metric/metrics_server.hpp>
@@ -203,6 +206,36 @@ index_page(std::map<std::string, std::string>& varmap) {
 extern std::pair<std::string, std::string> 
 simple_metrics_callback(std::map<std::string, std::string>& varmap);
 
+/*
+   Starts the timeline tracer. The optional sample_rate variable keeps one
+   in every sample_rate traced scopes of each thread.
+   */
+static std::pair<std::string, std::string> 
+timeline_trace_start_page(std::map<std::string, std::string>& varmap) {
+  size_t sample_rate = 1;
+  if (varmap.count("sample_rate")) {
+    sample_rate = std::max<long>(std::atol(varmap["sample_rate"].c_str()), 1);
+  }
+  timeline_trace_clear();
+  timeline_trace_start(sample_rate);
+  return std::make_pair(std::string("text/plain"), std::string("started\n"));
+}
+
+static std::pair<std::string, std::string> 
+timeline_trace_stop_page(std::map<std::string, std::string>& varmap) {
+  timeline_trace_stop();
+  return std::make_pair(std::string("text/plain"), std::string("stopped\n"));
+}
+
+/*
+   Returns the events recorded by the timeline tracer as a Chrome trace,
+   which can be loaded in chrome://tracing.
+   */
+static std::pair<std::string, std::string> 
+timeline_trace_json(std::map<std::string, std::string>& varmap) {
+  return std::make_pair(std::string("application/json"), timeline_trace_to_json());
+}
+
 
 static void fill_builtin_callbacks() {
   callbacks()["404"] = four_oh_four;
@@ -210,6 +243,9 @@ static void fill_builtin_callbacks() {
   callbacks()[""] = index_page;
   callbacks()["index.html"] = index_page;
   callbacks()["simple_metrics"] = simple_metrics_callback;
+  callbacks()["timeline_trace_start"] = timeline_trace_start_page;
+  callbacks()["timeline_trace_stop"] = timeline_trace_stop_page;
+  callbacks()["timeline_trace.json"] = timeline_trace_json;
 }
 
 
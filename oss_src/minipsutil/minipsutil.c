@@ -18,6 +18,12 @@ int32_t num_cpus();
  */
 uint64_t total_mem();
 
+/**
+ * Returns the resident set size of the current process in bytes.
+ * Returns 0 on failure.
+ */
+uint64_t process_rss();
+
 /**
  * Returns 1 if the pid is running, 0 otherwise. 
  */
@@ -113,6 +119,15 @@ uint64_t total_mem() {
 }
 
 
+uint64_t process_rss() {
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.WorkingSetSize;
+}
+
+
 int32_t pid_is_running(int32_t pid)
 {
     HANDLE hProcess;
@@ -189,6 +204,7 @@ int32_t kill_process(int32_t pid) {
 /*                                                                        */
 /**************************************************************************/
 #include <sys/sysctl.h>
+#include <mach/mach.h>
 #include <stdio.h>
 #include <errno.h>
 #include <stdlib.h>
@@ -233,6 +249,17 @@ uint64_t total_mem() {
 }
 
 
+uint64_t process_rss() {
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+}
+
+
 int32_t pid_is_running(int32_t pid) {
     int kill_ret;
 
@@ -264,6 +291,7 @@ int32_t kill_process(int32_t pid) {
 /*                                                                        */
 /**************************************************************************/
 #include <sys/sysinfo.h>
+#include <unistd.h>
 #include <stdio.h>
 #include <errno.h>
 #include <stdlib.h>
@@ -331,6 +359,18 @@ uint64_t total_mem() {
 }
 
 
+uint64_t process_rss() {
+    // the second field of /proc/self/statm is the number of resident pages
+    unsigned long long size = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f == NULL) return 0;
+    int ret = fscanf(f, "%llu %llu", &size, &resident);
+    fclose(f);
+    if (ret != 2) return 0;
+    return (uint64_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+
 int32_t pid_is_running(int32_t pid) {
     int kill_ret;
 
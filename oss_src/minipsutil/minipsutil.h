@@ -21,6 +21,12 @@ int32_t num_cpus();
  */
 uint64_t total_mem();
 
+/**
+ * Returns the resident set size of the current process in bytes.
+ * Returns 0 on failure.
+ */
+uint64_t process_rss();
+
 /**
  * Returns 1 if the pid is running, 0 otherwise. 
  */
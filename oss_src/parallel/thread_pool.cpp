@@ -32,6 +32,7 @@
 #include <parallel/thread_pool.hpp>
 #include <logger/assertions.hpp>
 #include <parallel/pthread_tools.hpp>
+#include <perf/timeline_trace.hpp>
 
 namespace graphlab {
 
@@ -198,6 +199,7 @@ void thread_pool::launch(const boost::function<void (void)> &spawn_function,
 
 void thread_pool::wait_for_task() {
   thread::get_tls_data().set_in_thread_flag(true);
+  timeline_trace_set_thread_name("thread_pool");
   while(1) {
     std::pair<std::pair<boost::function<void (void)>, int>, bool> queue_entry;
     // pop from the queue
@@ -209,7 +211,10 @@ void thread_pool::wait_for_task() {
       if (virtual_thread_id != -1) {
         thread::set_thread_id(virtual_thread_id);
       }
-      queue_entry.first.first();
+      {
+        TIMELINE_TRACE_SCOPE("thread_pool", "task");
+        queue_entry.first.first();
+      }
       thread::set_thread_id(cur_thread_id);
       std::lock_guard<mutex> lock(mut);
       ++tasks_completed;
@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <perf/thread_counters.hpp>
+
+namespace graphlab {
+
+thread_counters& thread_counters::operator+=(const thread_counters& other) {
+  blocks_read += other.blocks_read;
+  bytes_decompressed += other.bytes_decompressed;
+  bytes_written += other.bytes_written;
+  lambda_nanoseconds += other.lambda_nanoseconds;
+  return *this;
+}
+
+thread_counters& thread_counters::operator-=(const thread_counters& other) {
+  blocks_read -= other.blocks_read;
+  bytes_decompressed -= other.bytes_decompressed;
+  bytes_written -= other.bytes_written;
+  lambda_nanoseconds -= other.lambda_nanoseconds;
+  return *this;
+}
+
+thread_counters& get_thread_counters() {
+  static thread_local thread_counters counters;
+  return counters;
+}
+
+static thread_local bool counters_enabled = false;
+
+bool thread_counters_enabled() {
+  return counters_enabled;
+}
+
+thread_counters_scope::thread_counters_scope(bool enable)
+    : m_previous(counters_enabled) {
+  if (enable) counters_enabled = true;
+}
+
+thread_counters_scope::~thread_counters_scope() {
+  counters_enabled = m_previous;
+}
+
+uint64_t thread_cpu_time_nanoseconds() {
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time,
+                      &kernel_time, &user_time)) {
+    return 0;
+  }
+  // FILETIMEs are in units of 100 nanoseconds
+  uint64_t kernel = ((uint64_t)kernel_time.dwHighDateTime << 32) + kernel_time.dwLowDateTime;
+  uint64_t user = ((uint64_t)user_time.dwHighDateTime << 32) + user_time.dwLowDateTime;
+  return (kernel + user) * 100;
+#else
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+} // namespace graphlab
@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_PERF_THREAD_COUNTERS_HPP
+#define GRAPHLAB_PERF_THREAD_COUNTERS_HPP
+#include <cstdint>
+
+namespace graphlab {
+
+/**
+ * Counters of the work done by the storage and lambda layers on the calling
+ * thread. 
+ *
+ * The counters only ever increase, and are cheap to update since they are
+ * not shared between threads. They are used to attribute this work to the
+ * query operators executing on the thread: callers take a snapshot of the
+ * counters before and after running an operator, and use the difference.
+ *
+ * The counters are only updated while enabled on the thread (see
+ * \ref thread_counters_scope), that is while a profiled query runs on it.
+ */
+struct thread_counters {
+  /// Number of sarray blocks read
+  uint64_t blocks_read = 0;
+  /// Number of bytes produced by decompressing blocks
+  uint64_t bytes_decompressed = 0;
+  /// Number of (compressed) bytes of sarray blocks written
+  uint64_t bytes_written = 0;
+  /// Time spent waiting for lambda workers, in nanoseconds
+  uint64_t lambda_nanoseconds = 0;
+
+  thread_counters& operator+=(const thread_counters& other);
+  thread_counters& operator-=(const thread_counters& other);
+};
+
+/**
+ * Returns the counters of the calling thread.
+ */
+thread_counters& get_thread_counters();
+
+/**
+ * Returns true if the counters of the calling thread are enabled. Code
+ * updating the counters checks this first, and skips measuring altogether
+ * when they are disabled.
+ */
+bool thread_counters_enabled();
+
+/**
+ * Enables the counters of the calling thread for its lifetime, if enable is
+ * true, and restores the previous state on destruction.
+ */
+class thread_counters_scope {
+ public:
+  explicit thread_counters_scope(bool enable);
+  ~thread_counters_scope();
+
+ private:
+  bool m_previous;
+};
+
+/**
+ * Returns the CPU time used by the calling thread in nanoseconds.
+ */
+uint64_t thread_cpu_time_nanoseconds();
+
+} // namespace graphlab
+#endif
@@ -0,0 +1,266 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <set>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <perf/timeline_trace.hpp>
+
+namespace graphlab {
+namespace timeline_trace_impl {
+
+std::atomic<bool> enabled(false);
+
+struct trace_event {
+  const char* category;
+  const char* name;
+  uint64_t begin_nanoseconds;
+  uint64_t duration_nanoseconds;
+};
+
+/**
+ * The ring buffer of events of one thread. Only the owning thread writes
+ * events: it announces the write by incrementing writing, fills the slot,
+ * then publishes it by incrementing head. Readers copy the slots, and
+ * discard the ones which may have been overwritten while copying.
+ */
+struct thread_buffer {
+  std::vector<trace_event> events;
+  /// The number of events ever written
+  std::atomic<uint64_t> head;
+  /// The number of events whose write started
+  std::atomic<uint64_t> writing;
+  /// Events before this index were cleared. Protected by the registry lock.
+  uint64_t tail = 0;
+  /// Used for sampling. Only accessed by the owning thread.
+  uint64_t num_scopes = 0;
+  size_t thread_id = 0;
+  /// Protected by the registry lock
+  std::string thread_name;
+  /// True when the owning thread exited. Protected by the registry lock.
+  bool exited = false;
+
+  thread_buffer() : events(TIMELINE_TRACE_BUFFER_EVENTS), head(0), writing(0) { }
+
+  inline void record(const trace_event& event) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    writing.store(h + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    events[h % events.size()] = event;
+    head.store(h + 1, std::memory_order_release);
+  }
+};
+
+struct registry {
+  std::mutex lock;
+  std::vector<std::shared_ptr<thread_buffer>> buffers;
+  std::set<std::string> interned_names;
+  size_t next_thread_id = 0;
+  std::atomic<size_t> sample_rate;
+  registry() : sample_rate(1) { }
+};
+
+static registry& get_registry() {
+  static registry* r = new registry;
+  return *r;
+}
+
+/**
+ * Owns the buffer of a thread. The buffer is only created when the thread
+ * records its first event, and outlives the thread so that its events can
+ * still be exported.
+ */
+struct thread_buffer_holder {
+  std::shared_ptr<thread_buffer> buffer;
+  /// The name of the thread, until the buffer is created
+  std::string thread_name;
+
+  thread_buffer* get() {
+    if (__unlikely__(buffer == nullptr)) {
+      auto b = std::make_shared<thread_buffer>();
+      registry& r = get_registry();
+      std::lock_guard<std::mutex> guard(r.lock);
+      b->thread_id = r.next_thread_id++;
+      b->thread_name = thread_name;
+      r.buffers.push_back(b);
+      buffer = b;
+    }
+    return buffer.get();
+  }
+
+  ~thread_buffer_holder() {
+    if (buffer != nullptr) {
+      registry& r = get_registry();
+      std::lock_guard<std::mutex> guard(r.lock);
+      buffer->exited = true;
+    }
+  }
+};
+
+static thread_buffer_holder& get_thread_buffer_holder() {
+  static thread_local thread_buffer_holder holder;
+  return holder;
+}
+
+static const auto clock_epoch = std::chrono::steady_clock::now();
+
+static inline uint64_t now_nanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - clock_epoch).count();
+}
+
+} // namespace timeline_trace_impl
+
+using namespace timeline_trace_impl;
+
+void timeline_trace_start(size_t sample_rate) {
+  get_registry().sample_rate = sample_rate == 0 ? 1 : sample_rate;
+  enabled = true;
+}
+
+void timeline_trace_stop() {
+  enabled = false;
+}
+
+void timeline_trace_clear() {
+  registry& r = get_registry();
+  std::lock_guard<std::mutex> guard(r.lock);
+  std::vector<std::shared_ptr<thread_buffer>> remaining;
+  for (auto& buffer: r.buffers) {
+    buffer->tail = buffer->head.load(std::memory_order_acquire);
+    if (!buffer->exited) remaining.push_back(buffer);
+  }
+  r.buffers.swap(remaining);
+}
+
+void timeline_trace_set_thread_name(const std::string& name) {
+  // do not allocate a buffer for threads which may never record events
+  thread_buffer_holder& holder = get_thread_buffer_holder();
+  holder.thread_name = name;
+  if (holder.buffer != nullptr) {
+    registry& r = get_registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    holder.buffer->thread_name = name;
+  }
+}
+
+const char* timeline_trace_intern(const std::string& name) {
+  registry& r = get_registry();
+  std::lock_guard<std::mutex> guard(r.lock);
+  return r.interned_names.insert(name).first->c_str();
+}
+
+void timeline_scope::begin(const char* category, const char* name) {
+  thread_buffer* buffer = get_thread_buffer_holder().get();
+  if (buffer->num_scopes++ % get_registry().sample_rate.load(std::memory_order_relaxed) != 0) {
+    return;
+  }
+  m_buffer = buffer;
+  m_category = category;
+  m_name = name;
+  m_begin_nanoseconds = now_nanoseconds();
+}
+
+void timeline_scope::end() {
+  trace_event event;
+  event.category = m_category;
+  event.name = m_name;
+  event.begin_nanoseconds = m_begin_nanoseconds;
+  event.duration_nanoseconds = now_nanoseconds() - m_begin_nanoseconds;
+  m_buffer->record(event);
+}
+
+static void write_json_string(std::ostream& out, const char* s) {
+  out << '"';
+  for (; *s; ++s) {
+    if (*s == '"' || *s == '\\') {
+      out << '\\' << *s;
+    } else if ((unsigned char)(*s) < 0x20) {
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)(*s)
+          << std::dec << std::setfill(' ');
+    } else {
+      out << *s;
+    }
+  }
+  out << '"';
+}
+
+void timeline_trace_write_json(std::ostream& out) {
+  // copy the events out of the buffers, so that the lock is held briefly
+  struct thread_events {
+    size_t thread_id;
+    std::string thread_name;
+    std::vector<trace_event> events;
+  };
+  std::vector<thread_events> all_events;
+  {
+    registry& r = get_registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    for (auto& buffer: r.buffers) {
+      thread_events t;
+      t.thread_id = buffer->thread_id;
+      t.thread_name = buffer->thread_name;
+      uint64_t capacity = buffer->events.size();
+      uint64_t head = buffer->head.load(std::memory_order_acquire);
+      uint64_t begin = std::max(buffer->tail, head > capacity ? head - capacity : 0);
+      for (uint64_t i = begin; i < head; ++i) {
+        t.events.push_back(buffer->events[i % capacity]);
+      }
+      // the owning thread may have overwritten the oldest slots while they
+      // were copied. The slot of event i is overwritten by event i + capacity.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint64_t writing = buffer->writing.load(std::memory_order_relaxed);
+      if (writing > begin + capacity) {
+        size_t num_overwritten = std::min<uint64_t>(writing - capacity - begin,
+                                                    t.events.size());
+        t.events.erase(t.events.begin(), t.events.begin() + num_overwritten);
+      }
+      all_events.push_back(std::move(t));
+    }
+  }
+
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for (auto& t: all_events) {
+    if (!t.thread_name.empty()) {
+      if (!first) out << ",";
+      first = false;
+      out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << t.thread_id
+          << ",\"args\":{\"name\":";
+      write_json_string(out, t.thread_name.c_str());
+      out << "}}";
+    }
+    for (auto& event: t.events) {
+      if (!first) out << ",";
+      first = false;
+      out << "{\"name\":";
+      write_json_string(out, event.name);
+      out << ",\"cat\":";
+      write_json_string(out, event.category);
+      // timestamps are in microseconds
+      out << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << t.thread_id
+          << ",\"ts\":" << event.begin_nanoseconds / 1000
+          << "." << std::setw(3) << std::setfill('0') << event.begin_nanoseconds % 1000
+          << ",\"dur\":" << event.duration_nanoseconds / 1000
+          << "." << std::setw(3) << event.duration_nanoseconds % 1000
+          << std::setfill(' ') << "}";
+    }
+  }
+  out << "],\"displayTimeUnit\":\"ms\"}";
+}
+
+std::string timeline_trace_to_json() {
+  std::stringstream strm;
+  timeline_trace_write_json(strm);
+  return strm.str();
+}
+
+} // namespace graphlab
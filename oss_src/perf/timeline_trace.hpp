@@ -0,0 +1,151 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_PERF_TIMELINE_TRACE_HPP
+#define GRAPHLAB_PERF_TIMELINE_TRACE_HPP
+#include <atomic>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <util/branch_hints.hpp>
+
+namespace graphlab {
+
+/**
+ * \ingroup perf
+ * A timeline tracer recording when scopes of code start and end on each
+ * thread, which can be exported as a Chrome trace (viewable in
+ * chrome://tracing or Perfetto).
+ *
+ * Unlike \ref trace_count which aggregates the time spent in a tracepoint,
+ * the timeline shows when things happen relative to each other: pipeline
+ * stalls, and threads waiting for work, are gaps in the timeline.
+ *
+ * Scopes are traced with
+ * \code
+ * void read_block(...) {
+ *   TIMELINE_TRACE_SCOPE("io", "read_block");
+ *   ...
+ * }
+ * \endcode
+ * which costs a relaxed atomic load when tracing is not running.
+ *
+ * Every thread records its events into its own fixed size ring buffer
+ * without locking. When a buffer is full, the oldest events of the thread
+ * are overwritten. To reduce the overhead further, only one in every
+ * sample_rate scopes of each thread may be recorded.
+ *
+ * \code
+ * timeline_trace_start();
+ * ... run things ...
+ * timeline_trace_stop();
+ * std::ofstream fout("trace.json");
+ * timeline_trace_write_json(fout);
+ * \endcode
+ */
+
+/// The number of events kept per thread
+const size_t TIMELINE_TRACE_BUFFER_EVENTS = 65536;
+
+/**
+ * Starts recording events, keeping one in every sample_rate scopes of each
+ * thread.
+ */
+void timeline_trace_start(size_t sample_rate = 1);
+
+/**
+ * Stops recording events. Recorded events are kept until
+ * timeline_trace_clear() is called.
+ */
+void timeline_trace_stop();
+
+/**
+ * Discards the recorded events.
+ */
+void timeline_trace_clear();
+
+/**
+ * Names the calling thread in the exported traces.
+ */
+void timeline_trace_set_thread_name(const std::string& name);
+
+/**
+ * Returns a pointer to a copy of the string which remains valid until the
+ * program exits, for use as a scope name which is not a string literal.
+ * Intended for a small number of distinct names.
+ */
+const char* timeline_trace_intern(const std::string& name);
+
+/**
+ * Writes the recorded events in the Chrome trace event JSON format.
+ * Events of scopes still running are not included.
+ */
+void timeline_trace_write_json(std::ostream& out);
+
+/**
+ * Returns the recorded events in the Chrome trace event JSON format.
+ */
+std::string timeline_trace_to_json();
+
+namespace timeline_trace_impl {
+extern std::atomic<bool> enabled;
+struct thread_buffer;
+} // namespace timeline_trace_impl
+
+/**
+ * Returns true if timeline_trace_start() was called, and
+ * timeline_trace_stop() was not called since.
+ */
+inline bool timeline_trace_enabled() {
+  return timeline_trace_impl::enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Records an event spanning the lifetime of the object, if tracing is
+ * running when it is constructed. Use TIMELINE_TRACE_SCOPE instead of
+ * constructing it directly.
+ *
+ * category and name are not copied: they must be string literals, or
+ * strings returned by \ref timeline_trace_intern.
+ */
+class timeline_scope {
+ public:
+  inline timeline_scope(const char* category, const char* name) {
+    if (__unlikely__(timeline_trace_enabled())) begin(category, name);
+  }
+
+  inline ~timeline_scope() {
+    if (__unlikely__(m_buffer != nullptr)) end();
+  }
+
+  timeline_scope(const timeline_scope&) = delete;
+  timeline_scope& operator=(const timeline_scope&) = delete;
+
+ private:
+  void begin(const char* category, const char* name);
+  void end();
+
+  timeline_trace_impl::thread_buffer* m_buffer = nullptr;
+  const char* m_category = nullptr;
+  const char* m_name = nullptr;
+  uint64_t m_begin_nanoseconds = 0;
+};
+
+} // namespace graphlab
+
+#define __TIMELINE_TRACE_CONCAT_IMPL(a, b) a ## b
+#define __TIMELINE_TRACE_CONCAT(a, b) __TIMELINE_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * Traces the enclosing scope as an event with the given category and name.
+ * Both must be string literals or strings returned by
+ * timeline_trace_intern().
+ */
+#define TIMELINE_TRACE_SCOPE(category, name) \
+  graphlab::timeline_scope __TIMELINE_TRACE_CONCAT(__timeline_scope_, __COUNTER__)(category, name)
+
+#endif
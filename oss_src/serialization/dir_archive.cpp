@@ -18,8 +18,6 @@
 #include <fileio/general_fstream.hpp>
 #include <fileio/fs_utils.hpp>
 #include <fileio/sanitize_url.hpp>
-#include <fileio/temp_files.hpp>
-#include <fileio/s3_api.hpp>
 #include <serialization/dir_archive.hpp>
 #include <serialization/dir_archive_cache.hpp>
 #include <random/random.hpp>
@@ -150,22 +148,6 @@ void dir_archive::make_s3_read_cache(const std::string& s3_url) {
     m_cache_archive->open_directory_for_read(local_url);
 }
 
-void dir_archive::make_s3_write_cache(const std::string& s3_url) {
-    m_cache_archive.reset(new dir_archive());
-    std::string temp_dir = graphlab::get_temp_name();
-    m_cache_archive->open_directory_for_write(temp_dir);
-    std::function<void()> s3_upload_callback = [=] () {
-      std::string error = webstor::upload_to_s3_recursive(temp_dir, s3_url).get();
-      delete_archive(temp_dir);
-      delete_temp_file(temp_dir);
-      if (!error.empty()) {
-        log_and_throw_io_failure(error);
-      }
-    };
-    m_cache_archive->set_close_callback(s3_upload_callback);
-}
-
-
 void check_directory_writable(std::string directory, bool fail_on_existing_archive) {
   if (!fileio::is_writable_protocol(fileio::get_protocol(directory))) {
       log_and_throw_io_failure("Cannot write to " + sanitize_url(directory));
@@ -255,7 +237,8 @@ void dir_archive::open_directory_for_write(std::string directory,
 
   check_directory_writable(directory, fail_on_existing_archive);
 
-  // If the target directory is on s3, we create a local directory cache
+  // s3 directories are written directly: every file of the archive is a
+  // general_ofstream, which streams to s3 as a multipart upload.
   init_for_write(directory);
 }
 
@@ -375,10 +358,6 @@ general_ofstream* dir_archive::get_output_stream() {
   return m_objects_out.get();
 }
 
-void dir_archive::set_close_callback(std::function<void()>& fn) {
-  m_close_callback = fn;
-};
-
 void dir_archive::close() {
   if (m_objects_out) {
     // write out the index file
@@ -394,10 +373,6 @@ void dir_archive::close() {
   m_index_info = dir_archive_impl::archive_index_information();
   m_read_prefix_index = 0;
 
-  if (m_close_callback) {
-    m_close_callback();
-    m_close_callback = NULL;
-  }
   if (m_cache_archive) {
     m_cache_archive->close();
     m_cache_archive.reset();
@@ -208,16 +208,12 @@ class dir_archive {
 
  private:
 
-  void set_close_callback(std::function<void()>&);
-
   void init_for_read(const std::string& directory);
 
   void init_for_write(const std::string& directory);
 
   void make_s3_read_cache(const std::string& directory);
 
-  void make_s3_write_cache(const std::string& directory);
-
   /**
    * The index information for the archive
    */
@@ -243,9 +239,6 @@ class dir_archive {
 
   /// Cache dir_archive
   std::unique_ptr<dir_archive> m_cache_archive;
-
-  /// callback on close
-  std::function<void()> m_close_callback;
 };
 
 
@@ -15,11 +15,161 @@
 #include <algorithm>
 #include <boost/config/warning_disable.hpp>
 #include <sframe/csv_line_tokenizer.hpp>
+#include <sframe/sframe_constants.hpp>
 #include <flexible_type/string_escape.hpp>
 #include <flexible_type/flexible_type_spirit_parser.hpp>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace graphlab {
 
+namespace {
+
+/// Powers of 10 which are exactly representable as doubles
+const double exact_powers_of_10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool is_digit(char c) {
+  return (unsigned char)(c - '0') < 10;
+}
+
+/**
+ * Parses a plain integer: [sign]digits, with up to 18 digits, surrounded by
+ * whitespace. Returns false for anything else, leaving the general parser
+ * to decide. Like the general parser, characters after the digits are
+ * ignored, and *buf is advanced past the parsed number.
+ */
+inline bool fast_int_parse(const char** buf, size_t len, flex_int& value) {
+  const char* c = *buf;
+  const char* end = c + len;
+  while (c < end && std::isspace(*c)) ++c;
+  bool negative = false;
+  if (c < end && (*c == '-' || *c == '+')) {
+    negative = (*c == '-');
+    ++c;
+  }
+  const char* digits = c;
+  uint64_t v = 0;
+  while (c < end && is_digit(*c)) {
+    // 19 digits may overflow
+    if (c - digits >= 18) return false;
+    v = v * 10 + (*c - '0');
+    ++c;
+  }
+  if (c == digits) return false;
+  while (c < end && std::isspace(*c)) ++c;
+  value = negative ? -(flex_int)v : (flex_int)v;
+  (*buf) = c;
+  return true;
+}
+
+/**
+ * Parses a plain decimal number: [sign]digits[.digits][(e|E)[sign]digits]
+ * with at most 15 significant digits and a decimal exponent of at most 22,
+ * surrounded by whitespace. Such numbers are exactly computed by a single
+ * multiplication or division of exact doubles. Returns false for anything
+ * else, leaving the general parser to decide.
+ */
+inline bool fast_double_parse(const char** buf, size_t len, double& value) {
+  const char* c = *buf;
+  const char* end = c + len;
+  while (c < end && std::isspace(*c)) ++c;
+  bool negative = false;
+  if (c < end && (*c == '-' || *c == '+')) {
+    negative = (*c == '-');
+    ++c;
+  }
+  uint64_t mantissa = 0;
+  int num_digits = 0;
+  int exponent = 0;
+  while (c < end && is_digit(*c)) {
+    mantissa = mantissa * 10 + (*c - '0');
+    ++num_digits;
+    ++c;
+  }
+  if (c < end && *c == '.') {
+    ++c;
+    while (c < end && is_digit(*c)) {
+      mantissa = mantissa * 10 + (*c - '0');
+      ++num_digits;
+      --exponent;
+      ++c;
+    }
+  }
+  if (num_digits == 0 || num_digits > 15) return false;
+  if (c < end && (*c == 'e' || *c == 'E')) {
+    ++c;
+    bool negative_exponent = false;
+    if (c < end && (*c == '-' || *c == '+')) {
+      negative_exponent = (*c == '-');
+      ++c;
+    }
+    const char* exponent_digits = c;
+    int e = 0;
+    while (c < end && is_digit(*c) && c - exponent_digits < 3) {
+      e = e * 10 + (*c - '0');
+      ++c;
+    }
+    if (c == exponent_digits || (c < end && is_digit(*c))) return false;
+    exponent += negative_exponent ? -e : e;
+  }
+  if (exponent < -22 || exponent > 22) return false;
+  while (c < end && std::isspace(*c)) ++c;
+  double v = (double)mantissa;
+  if (exponent >= 0) v *= exact_powers_of_10[exponent];
+  else v /= exact_powers_of_10[-exponent];
+  value = negative ? -v : v;
+  (*buf) = c;
+  return true;
+}
+
+/**
+ * Appends the positions of the delimiter in [str, str + len) to positions.
+ * Returns false as soon as one of the 4 special characters is found.
+ *
+ * Blocks of 16 characters are compared to every character at once, giving
+ * bitmasks of the matches.
+ */
+inline bool find_delimiters(const char* str, size_t len, char delimiter,
+                            const char* special, std::vector<size_t>& positions) {
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128i d = _mm_set1_epi8(delimiter);
+  const __m128i s0 = _mm_set1_epi8(special[0]);
+  const __m128i s1 = _mm_set1_epi8(special[1]);
+  const __m128i s2 = _mm_set1_epi8(special[2]);
+  const __m128i s3 = _mm_set1_epi8(special[3]);
+  for (; i + 16 <= len; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+    __m128i special_match = 
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, s0), 
+                                  _mm_cmpeq_epi8(block, s1)),
+                     _mm_or_si128(_mm_cmpeq_epi8(block, s2), 
+                                  _mm_cmpeq_epi8(block, s3)));
+    if (_mm_movemask_epi8(special_match)) return false;
+    unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, d));
+    while (mask) {
+      positions.push_back(i + __builtin_ctz(mask));
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; i < len; ++i) {
+    char c = str[i];
+    if (c == special[0] || c == special[1] || 
+        c == special[2] || c == special[3]) {
+      return false;
+    }
+    if (c == delimiter) positions.push_back(i);
+  }
+  return true;
+}
+
+} // anonymous namespace
+
 csv_line_tokenizer::csv_line_tokenizer() {
   field_buffer.resize(1024);
 }
@@ -246,11 +396,29 @@ bool csv_line_tokenizer::parse_as(char** buf, size_t len,
    */
   switch(out.get_type()) {
    case flex_type_enum::INTEGER:
-     std::tie(out, parse_success) = parser->int_parse((const char**)buf, len);
-     break;
+     {
+       flex_int intval;
+       if (fast_number_parsing && 
+           fast_int_parse((const char**)buf, len, intval)) {
+         out = intval;
+         parse_success = true;
+       } else {
+         std::tie(out, parse_success) = parser->int_parse((const char**)buf, len);
+       }
+       break;
+     }
    case flex_type_enum::FLOAT:
-     std::tie(out, parse_success) = parser->double_parse((const char**)buf, len);
-     break;
+     {
+       double dblval;
+       if (fast_number_parsing && 
+           fast_double_parse((const char**)buf, len, dblval)) {
+         out = dblval;
+         parse_success = true;
+       } else {
+         std::tie(out, parse_success) = parser->double_parse((const char**)buf, len);
+       }
+       break;
+     }
    case flex_type_enum::VECTOR:
      std::tie(out, parse_success) = parser->vector_parse((const char**)buf, len);
      break;
@@ -372,6 +540,37 @@ static inline bool is_space_but_not_tab(char c) {
   return c != '\t' && std::isspace(c);
 }
 
+template <typename Fn>
+int csv_line_tokenizer::tokenize_simple_line(char* str, size_t len, Fn add_token) {
+  delimiter_positions.clear();
+  if (!find_delimiters(str, len, delimiter_first_character, 
+                       special_characters, delimiter_positions)) {
+    return -1;
+  }
+  // the fields are exactly what the state machine would accumulate:
+  // everything between delimiters, minus the initial spaces.
+  size_t num_fields = delimiter_positions.size() + 1;
+  size_t field_begin = 0;
+  for (size_t i = 0; i < num_fields; ++i) {
+    size_t field_end = (i + 1 < num_fields) ? delimiter_positions[i] : len;
+    size_t begin = field_begin;
+    if (skip_initial_space) {
+      while (begin < field_end && is_space_but_not_tab(str[begin])) ++begin;
+    }
+    field_begin = field_end + 1;
+    if (begin < field_end) {
+      if (!add_token(str + begin, field_end - begin)) return 0;
+    } else if (i + 1 < num_fields) {
+      // empty field followed by a delimiter
+      if (!add_token(&(field_buffer[0]), 0)) return 0;
+    } else if (i > 0) {
+      // empty last field, following a delimiter
+      if (!add_token(NULL, 0)) return 0;
+    }
+  }
+  return 1;
+}
+
 template <typename Fn, typename Fn2, typename Fn3>
 bool csv_line_tokenizer::tokenize_line_impl(char* str, 
                                             size_t len,
@@ -396,6 +595,10 @@ bool csv_line_tokenizer::tokenize_line_impl(char* str,
     add_token(str, len);
     return true;
   }
+  if (simple_line_fast_path) {
+    int ret = tokenize_simple_line(str, len, add_token);
+    if (ret >= 0) return ret == 1;
+  }
 
   // this is adaptive. It can be either " or ' as we encounter it
 
@@ -568,6 +771,20 @@ void csv_line_tokenizer::init() {
   for (auto& na_val: na_values) {
     empty_string_in_na_values |= na_val.length() == 0;
   }
+
+  // lines are split on the delimiter without the state machine unless they
+  // contain one of these characters.
+  special_characters[0] = quote_char;
+  special_characters[1] = '[';
+  special_characters[2] = '{';
+  special_characters[3] = has_comment_char ? comment_char : quote_char;
+  fast_number_parsing = SFRAME_CSV_PARSER_FAST_TOKENIZER != 0;
+  simple_line_fast_path = fast_number_parsing &&
+      delimiter_is_singlechar &&
+      !delimiter_is_space_but_not_tab &&
+      !delimiter_is_new_line &&
+      std::find(special_characters, special_characters + 4, 
+                delimiter_first_character) == special_characters + 4;
   
 }
 
@@ -309,6 +309,17 @@ struct csv_line_tokenizer {
                           Fn2 lookahead,
                           Fn3 undotoken);
 
+  /**
+   * Tokenizes a line with no quote, comment or bracketing characters by
+   * splitting it on the delimiter, which is located with a vectorized scan.
+   * Produces the same tokens as tokenize_line_impl.
+   *
+   * \returns -1 if the line has characters which need the state machine of
+   * tokenize_line_impl. Otherwise 1 on success and 0 on failure.
+   */
+  template <typename Fn>
+  int tokenize_simple_line(char* str, size_t len, Fn add_token);
+
   std::shared_ptr<flexible_type_parser> parser;
 
   // some precomputed information about the delimiter so we avoid excess
@@ -320,6 +331,15 @@ struct csv_line_tokenizer {
   bool delimiter_is_not_empty = true;
   bool empty_string_in_na_values = false;
   bool is_regular_line_terminator = true;
+
+  // whether tokenize_simple_line may be used with this dialect
+  bool simple_line_fast_path = false;
+  // the characters which send a line to the state machine
+  char special_characters[4];
+  // the delimiter positions found by tokenize_simple_line
+  std::vector<size_t> delimiter_positions;
+  // whether plain numbers are parsed without the spirit parser
+  bool fast_number_parsing = false;
 };
 } // namespace graphlab
 
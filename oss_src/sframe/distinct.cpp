@@ -0,0 +1,341 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <logger/assertions.hpp>
+#include <logger/logger.hpp>
+#include <parallel/lambda_omp.hpp>
+#include <fileio/buffered_writer.hpp>
+#include <util/cityhash_gl.hpp>
+#include <sketches/hyperloglog_pp.hpp>
+#include <sframe/sframe_rows.hpp>
+#include <sframe/sframe_constants.hpp>
+#include <sframe/distinct.hpp>
+
+namespace graphlab {
+
+namespace {
+
+/// Number of fingerprints each thread remembers while partitioning.
+constexpr size_t RECENT_FINGERPRINTS_SIZE = 4096;
+
+/// The precision of the approximate count, 1.04 / 2^7 relative error.
+constexpr size_t APPROXIMATE_COUNT_PRECISION = 14;
+
+/**
+ * Upper bound on the memory of a fingerprint_set per fingerprint: 16 byte
+ * slots at a load factor of 1/4 right after the table doubled.
+ */
+constexpr size_t BYTES_PER_FINGERPRINT = 64;
+
+/**
+ * The number of fingerprints one thread may keep in memory, so that
+ * cpu_count() concurrent fingerprint sets fit in SFRAME_DISTINCT_BUFFER_SIZE.
+ */
+inline size_t max_fingerprints_per_thread() {
+  return std::max<size_t>(
+      1024, SFRAME_DISTINCT_BUFFER_SIZE / (BYTES_PER_FINGERPRINT * thread::cpu_count()));
+}
+
+/**
+ * The fingerprint of a row. It is never 0, which marks the empty slots
+ * of a fingerprint_set.
+ */
+inline uint128_t row_fingerprint(const std::vector<flexible_type>& row) {
+  uint128_t h = hash128(row);
+  return h == 0 ? 1 : h;
+}
+
+/**
+ * The number of times a partition with too many distinct rows may be
+ * partitioned again. Past it, its fingerprint_set grows beyond its share.
+ */
+constexpr size_t MAX_PARTITION_LEVEL = 8;
+
+/**
+ * The partition of a fingerprint. Uses the high bits, since the low bits
+ * address the slots of a fingerprint_set. Partitioning a partition again
+ * uses a different level, which mixes the bits differently.
+ */
+inline size_t fingerprint_partition(uint128_t fingerprint, size_t num_partitions,
+                                    size_t level = 0) {
+  uint64_t high = uint64_t(fingerprint >> 64);
+  if (level == 0) return high % num_partitions;
+  return hash64_combine(high, level) % num_partitions;
+}
+
+/// Copies a row into a reused vector.
+inline void copy_row(const sframe_rows::row& row, std::vector<flexible_type>& values) {
+  values.resize(row.size());
+  for (size_t i = 0; i < values.size(); ++i) values[i] = row[i];
+}
+
+/**
+ * An open addressing set of row fingerprints, 16 bytes per slot. The table
+ * doubles to keep its load factor under 1/2.
+ */
+class fingerprint_set {
+ public:
+  explicit fingerprint_set(size_t expected_size) {
+    size_t capacity = 16;
+    while (capacity < 2 * expected_size) capacity *= 2;
+    m_slots.assign(capacity, 0);
+  }
+
+  /// Inserts a fingerprint. Returns false if it was already in the set.
+  bool insert(uint128_t fingerprint) {
+    if (2 * (m_size + 1) > m_slots.size()) grow();
+    size_t mask = m_slots.size() - 1;
+    size_t i = size_t(fingerprint) & mask;
+    for (; m_slots[i] != 0; i = (i + 1) & mask) {
+      if (m_slots[i] == fingerprint) return false;
+    }
+    m_slots[i] = fingerprint;
+    ++m_size;
+    return true;
+  }
+
+  size_t size() const { return m_size; }
+
+ private:
+  void grow() {
+    std::vector<uint128_t> old_slots(2 * m_slots.size(), 0);
+    old_slots.swap(m_slots);
+    size_t mask = m_slots.size() - 1;
+    for (uint128_t fingerprint: old_slots) {
+      if (fingerprint == 0) continue;
+      size_t i = size_t(fingerprint) & mask;
+      while (m_slots[i] != 0) i = (i + 1) & mask;
+      m_slots[i] = fingerprint;
+    }
+  }
+
+  std::vector<uint128_t> m_slots;
+  size_t m_size = 0;
+};
+
+/**
+ * Calls fn(row, fingerprint, thread_id) on every row of the input, reading
+ * one contiguous range of rows in each of thread::cpu_count() threads.
+ */
+template <typename Fn>
+void for_each_fingerprint(const sframe& input, Fn fn) {
+  size_t num_rows = input.num_rows();
+  size_t num_threads = thread::cpu_count();
+  auto reader = input.get_reader();
+  parallel_for(0, num_threads, [&](size_t thread_id) {
+    size_t start_row = num_rows * thread_id / num_threads;
+    size_t end_row = num_rows * (thread_id + 1) / num_threads;
+    sframe_rows rows;
+    std::vector<flexible_type> values;
+    while (start_row < end_row) {
+      size_t rows_to_read = std::min<size_t>(end_row - start_row,
+                                             DEFAULT_SARRAY_READER_BUFFER_SIZE);
+      size_t rows_read = reader->read_rows(start_row, start_row + rows_to_read, rows);
+      DASSERT_EQ(rows_read, rows_to_read);
+      start_row += rows_read;
+      for (const auto& row: rows) {
+        copy_row(row, values);
+        fn(values, row_fingerprint(values), thread_id);
+      }
+    }
+  });
+}
+
+/**
+ * Deduplicates the whole input in memory, in a single sequential pass.
+ * Only used for inputs that fit in one thread's share of the buffer, which
+ * are too small to be worth partitioning.
+ */
+sframe distinct_in_memory(const sframe& input) {
+  sframe output;
+  output.open_for_write(input.column_names(), input.column_types(), "", 1);
+  auto out = output.get_output_iterator(0);
+  fingerprint_set seen(input.num_rows());
+  auto reader = input.get_reader();
+  sframe_rows rows;
+  std::vector<flexible_type> values;
+  for (size_t start_row = 0; start_row < input.num_rows();
+       start_row += DEFAULT_SARRAY_READER_BUFFER_SIZE) {
+    size_t end_row = std::min(start_row + DEFAULT_SARRAY_READER_BUFFER_SIZE,
+                              input.num_rows());
+    reader->read_rows(start_row, end_row, rows);
+    for (const auto& row: rows) {
+      copy_row(row, values);
+      if (seen.insert(row_fingerprint(values))) {
+        *out = values;
+        ++out;
+      }
+    }
+  }
+  output.close();
+  return output;
+}
+
+/**
+ * Writes the rows of the input into one segment per fingerprint partition.
+ * Rows whose fingerprint the thread has seen recently are dropped.
+ */
+sframe partition_by_fingerprint(const sframe& input, size_t num_partitions) {
+  sframe partitioned;
+  partitioned.open_for_write(input.column_names(), input.column_types(), "",
+                             num_partitions);
+  std::vector<sframe::iterator> partition_iters;
+  std::vector<std::unique_ptr<graphlab::mutex>> partition_locks;
+  for (size_t i = 0; i < num_partitions; ++i) {
+    partition_iters.push_back(partitioned.get_output_iterator(i));
+    partition_locks.emplace_back(new graphlab::mutex);
+  }
+
+  typedef buffered_writer<std::vector<flexible_type>, sframe::iterator> writer_type;
+  size_t num_threads = thread::cpu_count();
+  std::vector<std::vector<writer_type>> writers(num_threads);
+  std::vector<std::vector<uint128_t>> recent(
+      num_threads, std::vector<uint128_t>(RECENT_FINGERPRINTS_SIZE, 0));
+  for (size_t t = 0; t < num_threads; ++t) {
+    for (size_t i = 0; i < num_partitions; ++i) {
+      writers[t].emplace_back(partition_iters[i], *partition_locks[i],
+                              SFRAME_WRITER_BUFFER_SOFT_LIMIT,
+                              SFRAME_WRITER_BUFFER_HARD_LIMIT);
+    }
+  }
+
+  for_each_fingerprint(input,
+      [&](const std::vector<flexible_type>& row, uint128_t fingerprint, size_t thread_id) {
+        uint128_t& slot = recent[thread_id][size_t(fingerprint) % RECENT_FINGERPRINTS_SIZE];
+        if (slot == fingerprint) return;
+        slot = fingerprint;
+        writers[thread_id][fingerprint_partition(fingerprint, num_partitions)].write(row);
+      });
+
+  for (auto& thread_writers: writers) {
+    for (auto& writer: thread_writers) writer.flush();
+  }
+  partitioned.close();
+  return partitioned;
+}
+
+/**
+ * Deduplicates a segment of a partitioned sframe into out.
+ *
+ * The first occurrence of every row before row num_emitted of the segment
+ * was already written to out. If the segment turns out to have more
+ * distinct rows than one thread's share of the buffer, its rows are
+ * partitioned again with different fingerprint bits, and each part is
+ * deduplicated in turn, so that a single fingerprint_set is in memory.
+ */
+void distinct_segment(const sframe& partitioned, sframe::reader_type* reader,
+                      size_t segment, size_t num_emitted, size_t level,
+                      sframe::iterator& out) {
+  size_t max_fingerprints = max_fingerprints_per_thread();
+  size_t segment_length = reader->segment_length(segment);
+  // most partitions have about max_fingerprints distinct rows, but a
+  // partition of many duplicates would over-allocate if sized by its length
+  fingerprint_set seen(std::min(segment_length, max_fingerprints));
+  size_t row_index = 0;
+  bool overflow = false;
+  auto enditer = reader->end(segment);
+  for (auto iter = reader->begin(segment); iter != enditer; ++iter) {
+    const auto& row = *iter;
+    if (seen.insert(row_fingerprint(row)) && row_index >= num_emitted) {
+      *out = row;
+      ++out;
+    }
+    ++row_index;
+    if (seen.size() > max_fingerprints && level < MAX_PARTITION_LEVEL &&
+        row_index < segment_length) {
+      overflow = true;
+      break;
+    }
+  }
+  if (!overflow) return;
+
+  // Partition the segment again, into parts of about max_fingerprints
+  // distinct rows, extrapolated from the rows seen so far. The rows keep
+  // their order, and the first ones of each part are those already emitted.
+  size_t estimated_distinct = seen.size() * (segment_length / row_index + 1);
+  size_t num_parts = std::max<size_t>(
+      2, (estimated_distinct + max_fingerprints - 1) / max_fingerprints);
+  num_emitted = std::max(num_emitted, row_index);
+  seen = fingerprint_set(0);
+  logstream(LOG_INFO) << "Partitioning a distinct partition with over "
+                      << max_fingerprints << " distinct rows into "
+                      << num_parts << " parts" << std::endl;
+
+  sframe parts;
+  parts.open_for_write(partitioned.column_names(), partitioned.column_types(), "",
+                       num_parts);
+  std::vector<sframe::iterator> part_iters;
+  for (size_t i = 0; i < num_parts; ++i) {
+    part_iters.push_back(parts.get_output_iterator(i));
+  }
+  std::vector<size_t> part_emitted(num_parts, 0);
+  row_index = 0;
+  for (auto iter = reader->begin(segment); iter != enditer; ++iter) {
+    const auto& row = *iter;
+    size_t part = fingerprint_partition(row_fingerprint(row), num_parts, level + 1);
+    *(part_iters[part]) = row;
+    ++(part_iters[part]);
+    if (row_index < num_emitted) ++part_emitted[part];
+    ++row_index;
+  }
+  parts.close();
+  auto parts_reader = parts.get_reader();
+  for (size_t i = 0; i < num_parts; ++i) {
+    distinct_segment(parts, parts_reader.get(), i, part_emitted[i], level + 1, out);
+  }
+}
+
+} // anonymous namespace
+
+sframe distinct(const sframe& input) {
+  size_t num_rows = input.num_rows();
+  size_t fingerprints_per_partition = max_fingerprints_per_thread();
+  if (num_rows <= fingerprints_per_partition) {
+    return distinct_in_memory(input);
+  }
+
+  // at most cpu_count() partitions are deduplicated at once, each with at
+  // most fingerprints_per_partition fingerprints, assuming the fingerprints
+  // are evenly spread.
+  size_t num_partitions = (num_rows + fingerprints_per_partition - 1)
+                          / fingerprints_per_partition;
+  logstream(LOG_INFO) << "Partitioning " << num_rows << " rows into "
+                      << num_partitions << " partitions for distinct" << std::endl;
+  sframe partitioned = partition_by_fingerprint(input, num_partitions);
+
+  // every row of a partition has the same fingerprint partition, so each
+  // partition is deduplicated on its own.
+  sframe output;
+  output.open_for_write(input.column_names(), input.column_types(), "",
+                        num_partitions);
+  auto reader = partitioned.get_reader();
+  ASSERT_EQ(reader->num_segments(), num_partitions);
+  parallel_for(0, num_partitions, [&](size_t i) {
+    auto out = output.get_output_iterator(i);
+    distinct_segment(partitioned, reader.get(), i, 0, 0, out);
+  });
+  output.close();
+  return output;
+}
+
+size_t count_distinct(const sframe& input, bool approximate) {
+  if (!approximate) return distinct(input).num_rows();
+
+  std::vector<sketches::hyperloglog_pp> sketches(
+      thread::cpu_count(), sketches::hyperloglog_pp(APPROXIMATE_COUNT_PRECISION));
+  for_each_fingerprint(input,
+      [&](const std::vector<flexible_type>&, uint128_t fingerprint, size_t thread_id) {
+        sketches[thread_id].add_hash(uint64_t(fingerprint));
+      });
+  for (size_t i = 1; i < sketches.size(); ++i) sketches[0].combine(sketches[i]);
+  return std::llround(sketches[0].estimate());
+}
+
+} // namespace graphlab
@@ -0,0 +1,49 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_SFRAME_DISTINCT_HPP
+#define GRAPHLAB_SFRAME_DISTINCT_HPP
+
+#include <sframe/sframe.hpp>
+
+namespace graphlab {
+
+/**
+ * Removes the duplicate rows of an sframe.
+ *
+ * Rows are identified by a 128 bit fingerprint of their values, and each
+ * fingerprint is kept in a hash set once. Two different rows are merged
+ * only if their fingerprints collide, which is astronomically unlikely.
+ *
+ * If the fingerprints of the input do not fit in one thread's share of
+ * SFRAME_DISTINCT_BUFFER_SIZE, the rows are first partitioned by fingerprint
+ * into spilled partitions small enough for each of cpu_count() concurrent
+ * threads to keep their fingerprints in memory; each thread drops the
+ * duplicates it recently saw while partitioning. The partitions are then
+ * deduplicated in parallel, each into its own segment of the result. A
+ * partition which turns out to have more distinct rows than its share is
+ * partitioned again with different fingerprint bits.
+ * Otherwise, the input is small and is deduplicated in a single sequential
+ * pass, keeping the first occurrence of each row in the order of the input.
+ *
+ * \param input The input sframe (expects to be materialized)
+ *
+ * Returns an sframe with the column names and types of the input.
+ */
+sframe distinct(const sframe& input);
+
+/**
+ * Returns the number of distinct rows of an sframe.
+ *
+ * If approximate is true, the rows are not deduplicated: their fingerprints
+ * are counted in a single pass by a HyperLogLog++ sketch, with a relative
+ * standard error of about 0.8%.
+ */
+size_t count_distinct(const sframe& input, bool approximate = false);
+
+} // namespace graphlab
+#endif
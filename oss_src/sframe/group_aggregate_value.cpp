@@ -69,6 +69,8 @@ std::shared_ptr<group_aggregate_value> get_builtin_group_aggregator(
     return quantile_operator;
   } else if (boost::algorithm::starts_with(name, "__builtin__count__distinct__")) {
     return std::make_shared<groupby_operators::count_distinct>();
+  } else if (boost::algorithm::starts_with(name, "__builtin__approx__count__distinct__")) {
+    return std::make_shared<groupby_operators::approx_count_distinct>();
   } else if (boost::algorithm::starts_with(name, "__builtin__distinct__")) {
     return std::make_shared<groupby_operators::distinct>();
   } else if (boost::algorithm::starts_with(name, "__builtin__freq_count__")) {
@@ -9,6 +9,7 @@
 #define GRAPHLAB_SFRAME_GROUPBY_AGGREGATE_OPERATORS_HPP
 #include <sframe/group_aggregate_value.hpp>
 #include <sketches/streaming_quantile_sketch.hpp>
+#include <sketches/hyperloglog_pp.hpp>
 namespace graphlab {
 namespace groupby_operators {
 /**
@@ -1293,6 +1294,62 @@ class distinct: public count_distinct {
 
 };
 
+/**
+ * Implements an aggregator that estimates the number of unique elements
+ * with a \ref sketches::hyperloglog_pp sketch. Groups with few unique values
+ * only store a small sparse list, and no group uses more than 4KB.
+ */
+class approx_count_distinct: public group_aggregate_value {
+ public:
+  /// Returns a new empty instance of approx_count_distinct
+  group_aggregate_value* new_instance() const {
+    approx_count_distinct* ret = new approx_count_distinct;
+    return ret;
+  }
+
+  void add_element_simple(const flexible_type& flex) {
+    m_sketch.add(flex);
+  }
+
+  /// combines two partial sketches
+  void combine(const group_aggregate_value& other) {
+    auto& v = dynamic_cast<const approx_count_distinct&>(other);
+    m_sketch.combine(v.m_sketch);
+  }
+
+  /// Emits the rounded estimate
+  flexible_type emit() const {
+    return (flex_int)std::llround(m_sketch.estimate());
+  }
+
+  /// The types supported by the sketch
+  bool support_type(flex_type_enum type) const {
+    return true;
+  }
+
+  flex_type_enum set_input_type(flex_type_enum type) {
+    return flex_type_enum::INTEGER;
+  }
+
+  /// Name of the class
+  std::string name() const {
+    return "Approximate Count Distinct";
+  }
+
+  /// Serializer
+  void save(oarchive& oarc) const {
+    oarc << m_sketch;
+  }
+
+  /// Deserializer
+  void load(iarchive& iarc) {
+    iarc >> m_sketch;
+  }
+
+ private:
+  sketches::hyperloglog_pp m_sketch{12};
+};
+
 /**
  * Implements an aggregator that computes frequncies for each unique value. 
  */
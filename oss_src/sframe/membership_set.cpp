@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <logger/assertions.hpp>
+#include <sframe/sarray_reader_buffer.hpp>
+#include <sframe/membership_set.hpp>
+
+namespace graphlab {
+
+constexpr size_t membership_set::BLOOM_FILTER_MIN_SIZE;
+constexpr uint32_t membership_set::EMPTY_SLOT;
+
+membership_set::membership_set(const sarray<flexible_type>& values) {
+  rehash(16);
+  std::shared_ptr<sarray_reader<flexible_type>> reader(std::move(values.get_reader()));
+  sarray_reader_buffer<flexible_type> buf_reader(reader, 0, reader->size());
+  while (buf_reader.has_next()) {
+    insert(buf_reader.next());
+  }
+  build_bloom_filter();
+}
+
+membership_set::membership_set(const std::vector<flexible_type>& values) {
+  rehash(16);
+  for (const auto& value: values) insert(value);
+  build_bloom_filter();
+}
+
+void membership_set::rehash(size_t num_slots) {
+  m_mask = num_slots - 1;
+  m_slots.assign(num_slots, slot());
+  for (size_t index = 0; index < m_values.size(); ++index) {
+    size_t i = m_hashes[index] & m_mask;
+    while (m_slots[i].index != EMPTY_SLOT) i = (i + 1) & m_mask;
+    m_slots[i].tag = hash_tag(m_hashes[index]);
+    m_slots[i].index = index;
+  }
+}
+
+void membership_set::insert(const flexible_type& value) {
+  uint64_t hash = value.hash();
+  uint32_t tag = hash_tag(hash);
+  size_t i = hash & m_mask;
+  for (; m_slots[i].index != EMPTY_SLOT; i = (i + 1) & m_mask) {
+    if (m_slots[i].tag == tag && m_values[m_slots[i].index] == value) return;
+  }
+  if (m_values.size() >= EMPTY_SLOT) {
+    log_and_throw("Too many distinct values in a membership set");
+  }
+  m_slots[i].tag = tag;
+  m_slots[i].index = m_values.size();
+  m_values.push_back(value);
+  m_hashes.push_back(hash);
+  // keep the load factor under 1/2, so that probe sequences stay short
+  if (2 * m_values.size() > m_slots.size()) rehash(2 * m_slots.size());
+}
+
+void membership_set::build_bloom_filter() {
+  if (m_values.size() < BLOOM_FILTER_MIN_SIZE) return;
+  // about 16 bits per value
+  size_t num_words = 1;
+  while (num_words * 4 < m_values.size()) num_words *= 2;
+  m_bloom_filter_mask = num_words - 1;
+  m_bloom_filter.assign(num_words, 0);
+  for (uint64_t hash: m_hashes) {
+    m_bloom_filter[(hash >> 32) & m_bloom_filter_mask] |=
+        (uint64_t(1) << (hash & 63)) | (uint64_t(1) << ((hash >> 6) & 63));
+  }
+}
+
+} // namespace graphlab
@@ -0,0 +1,118 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_SFRAME_MEMBERSHIP_SET_HPP
+#define GRAPHLAB_SFRAME_MEMBERSHIP_SET_HPP
+
+#include <vector>
+#include <cstdint>
+#include <flexible_type/flexible_type.hpp>
+#include <sframe/sarray.hpp>
+
+namespace graphlab {
+
+/**
+ * A set of flexible_type values built once, and then probed concurrently
+ * with the values of a large SFrame column. This is the build side of the
+ * semi-joins and anti-joins used by gl_sframe::filter_by.
+ *
+ * The distinct values are kept once, in a dense vector. The open addressing
+ * table only holds, in each 8 byte slot, the upper half of the hash of a
+ * value and its index in the vector, so that most probes compare a single
+ * 32 bit hash, and the table is sized by the number of distinct values,
+ * growing as they are inserted. Large sets are fronted by a bloom filter
+ * much smaller than the table, which rejects most values not in the set
+ * without touching the table.
+ *
+ * \code
+ * membership_set ids(id_sarray);
+ * if (ids.contains(row[0])) ...
+ * \endcode
+ *
+ * contains() is safe to call concurrently.
+ */
+class membership_set {
+ public:
+  /// Sets with at least this many values get a bloom filter
+  static constexpr size_t BLOOM_FILTER_MIN_SIZE = 65536;
+
+  membership_set() = default;
+
+  /// Builds the set from the values of an sarray.
+  explicit membership_set(const sarray<flexible_type>& values);
+
+  /// Builds the set from a vector of values.
+  explicit membership_set(const std::vector<flexible_type>& values);
+
+  /// Returns true if the set contains the value.
+  inline bool contains(const flexible_type& value) const {
+    if (m_values.empty()) return false;
+    uint64_t hash = value.hash();
+    if (!m_bloom_filter.empty() && !bloom_filter_contains(hash)) return false;
+    uint32_t tag = hash_tag(hash);
+    for (size_t i = hash & m_mask; m_slots[i].index != EMPTY_SLOT;
+         i = (i + 1) & m_mask) {
+      if (m_slots[i].tag == tag && m_values[m_slots[i].index] == value) return true;
+    }
+    return false;
+  }
+
+  /// Returns the number of distinct values in the set
+  inline size_t size() const {
+    return m_values.size();
+  }
+
+  /// Returns the number of slots of the hash table
+  inline size_t num_slots() const {
+    return m_slots.size();
+  }
+
+ private:
+  /// Index of the empty slots
+  static constexpr uint32_t EMPTY_SLOT = (uint32_t)(-1);
+
+  struct slot {
+    /// The upper half of the hash of the value
+    uint32_t tag = 0;
+    /// The index of the value in m_values
+    uint32_t index = EMPTY_SLOT;
+  };
+
+  /// Adds a value to the set, growing the table as needed
+  void insert(const flexible_type& value);
+
+  /// Reallocates the table with the given number of slots
+  void rehash(size_t num_slots);
+
+  /// Builds the bloom filter from the values, if the set is large enough
+  void build_bloom_filter();
+
+  static inline uint32_t hash_tag(uint64_t hash) {
+    return (uint32_t)(hash >> 32);
+  }
+
+  /**
+   * Each value sets 2 bits of one word of the bloom filter, so that a probe
+   * reads a single word.
+   */
+  inline bool bloom_filter_contains(uint64_t hash) const {
+    uint64_t word = m_bloom_filter[(hash >> 32) & m_bloom_filter_mask];
+    uint64_t bits = (uint64_t(1) << (hash & 63)) | (uint64_t(1) << ((hash >> 6) & 63));
+    return (word & bits) == bits;
+  }
+
+  /// The distinct values, and their hashes
+  std::vector<flexible_type> m_values;
+  std::vector<uint64_t> m_hashes;
+  size_t m_mask = 0;
+  std::vector<slot> m_slots;
+  size_t m_bloom_filter_mask = 0;
+  std::vector<uint64_t> m_bloom_filter;
+};
+
+} // namespace graphlab
+#endif
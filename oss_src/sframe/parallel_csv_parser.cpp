@@ -10,6 +10,8 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <algorithm>
+#include <exception>
 #include <parallel/mutex.hpp>
 #include <boost/algorithm/string.hpp>
 #include <logger/logger.hpp>
@@ -184,14 +186,39 @@ class parallel_csv_parser {
   void set_total_input_size(size_t input_size) {
     total_input_file_sizes = input_size;
   }
+
+  /**
+   * Writes all the output to one output segment, instead of striping the
+   * inputs across segments.
+   */
+  void set_output_segment(size_t segment) {
+    current_output_segment = segment;
+    total_input_file_sizes = 0;
+  }
+
+  /**
+   * Sets the amount to read from the file each time. Defaults to
+   * SFRAME_CSV_PARSER_READ_SIZE.
+   */
+  void set_read_size(size_t size) {
+    read_size = size;
+  }
+
   /**
-   * Parses an input file into an output frame
+   * Parses an input file into an output frame.
+   *
+   * If range_length is set, only the lines beginning in the next
+   * range_length bytes of fin are parsed. The last of them is read to its
+   * end, past the range.
    */
   void parse(general_ifstream& fin, 
              sframe& output_frame, 
-             sarray<flexible_type>& errors) {
+             sarray<flexible_type>& errors,
+             size_t range_length = (size_t)(-1)) {
     size_t num_output_segments = output_frame.num_segments();
     size_t current_input_file_size = fin.file_size();
+    range_remaining = range_length;
+    range_complete = false;
     try {
       timer ti;
       bool fill_buffer_is_good = true;
@@ -356,6 +383,12 @@ class parallel_csv_parser {
   std::vector<size_t> column_output_order;
 
   size_t current_output_segment = 0;
+  size_t read_size = SFRAME_CSV_PARSER_READ_SIZE;
+
+  /// The number of bytes left to read in the range being parsed
+  size_t range_remaining = (size_t)(-1);
+  /// True once the last line of the range being parsed is in the buffer
+  bool range_complete = false;
 
   atomic<size_t> lines_read = 0;
   timer ti;
@@ -604,6 +637,7 @@ class parallel_csv_parser {
    * ends with a line terminator, even the last line. 
    */
   void add_line_terminator_to_buffer() {
+    if (buffer.empty()) return;
     if (is_regular_line_terminator && 
         buffer[buffer.length() - 1] != '\n' && 
         buffer[buffer.length() - 1] != '\r') {
@@ -620,11 +654,18 @@ class parallel_csv_parser {
    * lines were read. False otherwise: indicating this is the last block.
    */
   bool fill_buffer(general_ifstream& fin) {
-    if (fin.good()) {
+    if (fin.good() && !range_complete) {
       size_t oldsize = buffer.size();
-      size_t amount_to_read = SFRAME_CSV_PARSER_READ_SIZE;
+      size_t amount_to_read = read_size;
       buffer.resize(buffer.size() + amount_to_read);
       fin.read(&(buffer[0]) + oldsize, buffer.size() - oldsize);
+      if (range_remaining != (size_t)(-1)) {
+        buffer.resize(oldsize + fin.gcount());
+        if (truncate_at_range_end(oldsize)) {
+          add_line_terminator_to_buffer();
+          return false;
+        }
+      }
       if ((size_t)fin.gcount() < amount_to_read) {
         // if we did not read till the entire buffer , this is an EOF
         buffer.resize(oldsize + fin.gcount());
@@ -641,6 +682,30 @@ class parallel_csv_parser {
     }
   }
 
+  /**
+   * Given that the bytes just read begin at buffer[start], truncates the
+   * buffer after the line terminator ending the last line which begins in
+   * the range being parsed. Returns true if that line terminator was found,
+   * in which case the range is complete.
+   */
+  bool truncate_at_range_end(size_t start) {
+    size_t amount_read = buffer.size() - start;
+    // the terminator of the last line ends at or after the last byte of the
+    // range
+    size_t search_start = start + (range_remaining > 0 ? range_remaining - 1 : 0);
+    range_remaining -= std::min(range_remaining, amount_read);
+    if (search_start >= buffer.size()) return false;
+    bool newline_was_matched = false;
+    char* bufstart = &(buffer[0]);
+    char* range_end = advance_past_newline(bufstart + search_start,
+                                           bufstart + buffer.size(),
+                                           newline_was_matched);
+    if (!newline_was_matched) return false;
+    buffer.resize(range_end - bufstart);
+    range_complete = true;
+    return true;
+  }
+
   /**
    * Performs a parallel parse of the contents of the buffer, adding to
    * parsed_buffer.
@@ -877,6 +942,41 @@ void get_column_types(csv_info& info,
 
 } // anonymous namespace
 
+/**
+ * Skips the first skip_rows lines of a CSV file, and its header if
+ * use_header. Returns false if the header does not have num_input_columns
+ * columns and the file should be skipped.
+ */
+bool skip_csv_header(general_ifstream& fin,
+                     csv_line_tokenizer& tokenizer,
+                     const csv_file_handling_options& options,
+                     size_t num_input_columns) {
+  // skip skip_rows lines
+  std::string skip_string;
+  for (size_t i = 0;i < options.skip_rows; ++i) {
+    eol_getline(fin, skip_string, tokenizer.line_terminator);
+  }
+
+  // if use_header, we keep throwing away empty or comment lines until we 
+  // get one good line
+  if (options.use_header) {
+    std::vector<std::string> first_line_tokens;
+    // skip rows with no data, and skip the head
+    while (first_line_tokens.size() == 0 && fin.good()) {
+      std::string line;
+      eol_getline(fin, line, tokenizer.line_terminator);
+      tokenizer.tokenize_line(&(line[0]), line.length(), first_line_tokens);
+    }
+    // if we are going to store errors, we don't do early skippng on 
+    // mismatched files
+    if (!options.store_errors && 
+        first_line_tokens.size() != num_input_columns) {
+      return false;
+    }
+  }
+  return true;
+}
+
 /**
  * Parsed a CSV file to an SFrame.
  *
@@ -890,6 +990,8 @@ void get_column_types(csv_info& info,
  * \param parallel_csv_parser A parallel_csv_parser
  * \param errors A reference to a map in which to store an sarray of bad lines 
  * for each input file.
+ * \param range_begin, range_end If set, only the lines beginning in the byte
+ *                  range [range_begin, range_end) of the file are parsed.
  */
 void parse_csv_to_sframe(
     const std::string& path,
@@ -898,43 +1000,57 @@ void parse_csv_to_sframe(
     sframe& frame,
     std::string frame_sidx_file,
     parallel_csv_parser& parser,
-    std::map<std::string, std::shared_ptr<sarray<flexible_type>>>& errors) {
-  auto use_header = options.use_header;
+    std::map<std::string, std::shared_ptr<sarray<flexible_type>>>& errors,
+    size_t range_begin = 0,
+    size_t range_end = (size_t)(-1)) {
   auto continue_on_failure = options.continue_on_failure;
   auto store_errors = options.store_errors;
-  auto skip_rows = options.skip_rows;
+  bool whole_file = (range_begin == 0 && range_end == (size_t)(-1));
 
-  logstream(LOG_INFO) << "Loading sframe from " << sanitize_url(path) << std::endl;
+  if (whole_file) {
+    logstream(LOG_INFO) << "Loading sframe from " << sanitize_url(path) << std::endl;
+  } else {
+    logstream(LOG_INFO) << "Loading sframe from bytes " << range_begin << " to "
+                        << range_end << " of " << sanitize_url(path) << std::endl;
+  }
 
   // load; For each line, insert into the frame
   {
     general_ifstream fin(path);
     if (!fin.good()) log_and_throw("Cannot open " + sanitize_url(path));
 
-    // skip skip_rows lines
-    std::string skip_string;
-    for (size_t i = 0;i < skip_rows; ++i) {
-      eol_getline(fin, skip_string, tokenizer.line_terminator);
-    }
-
-    // if use_header, we keep throwing away empty or comment lines until we 
-    // get one good line
-    if (use_header) {
-      std::vector<std::string> first_line_tokens;
-      // skip rows with no data, and skip the head
-      while (first_line_tokens.size() == 0 && fin.good()) {
-        std::string line;
-        eol_getline(fin, line, tokenizer.line_terminator);
-        tokenizer.tokenize_line(&(line[0]), line.length(), first_line_tokens);
-      }
-      // if we are going to store errors, we don't do early skippng on 
-      // mismatched files
-      if (!store_errors && 
-          first_line_tokens.size() != parser.num_input_columns()) {
+    size_t range_length = (size_t)(-1);
+    if (range_begin == 0) {
+      if (!skip_csv_header(fin, tokenizer, options, parser.num_input_columns())) {
         logprogress_stream << "Unexpected number of columns found in " << path
                            << ". Skipping this file." << std::endl;
         return;
       }
+      if (range_end != (size_t)(-1)) {
+        size_t data_begin = fin.tellg();
+        if (data_begin >= range_end) return;
+        range_length = range_end - data_begin;
+      }
+    } else {
+      // The line holding the byte before the range belongs to the previous
+      // range. Skip it.
+      fin.seekg(range_begin - 1);
+      size_t position = range_begin - 1;
+      int c;
+      while ((c = fin.get()) != EOF) {
+        ++position;
+        if (c == '\n') break;
+        if (c == '\r') {
+          if (fin.peek() == '\n') {
+            fin.get();
+            ++position;
+          }
+          break;
+        }
+      }
+      // no line begins in the range
+      if (!fin.good() || position >= range_end) return;
+      range_length = range_end - position;
     }
     
     // store errors for this particular file in an sarray
@@ -945,11 +1061,10 @@ void parse_csv_to_sframe(
     }
 
     try {
-      parser.parse(fin, frame, *file_errors);
-    } catch(const std::string& s) {
-      frame.close();
+      parser.parse(fin, frame, *file_errors, range_length);
+    } catch(...) {
       if (store_errors) file_errors->close();
-      log_and_throw(s);
+      throw;
     }
 
     if (continue_on_failure && parser.num_lines_failed() > 0) {
@@ -965,10 +1080,162 @@ void parse_csv_to_sframe(
       }
     }
 
-    logprogress_stream << "Finished parsing file " << sanitize_url(path) << std::endl;
+    if (whole_file) {
+      logprogress_stream << "Finished parsing file " << sanitize_url(path) << std::endl;
+    }
   }
 }
 
+namespace {
+
+/**
+ * A byte range of a CSV file: the lines beginning in [begin, end).
+ */
+struct csv_input_range {
+  std::string path;
+  size_t begin = 0;
+  size_t end = (size_t)(-1);
+  /// The approximate number of bytes in the range
+  size_t size = 0;
+};
+
+/**
+ * Lists the ranges of the input files to be parsed. Large uncompressed
+ * local files are cut into ranges of about SFRAME_CSV_PARSER_SPLIT_SIZE
+ * bytes. Other files are parsed whole.
+ */
+std::vector<csv_input_range> make_csv_input_ranges(
+    const std::vector<std::string>& files,
+    const std::vector<size_t>& file_sizes,
+    csv_line_tokenizer& tokenizer,
+    const csv_file_handling_options& options,
+    size_t num_input_columns) {
+  std::vector<csv_input_range> ranges;
+  size_t split_size = SFRAME_CSV_PARSER_SPLIT_SIZE;
+  // Ranges resynchronize on "\n", "\r" or "\r\n". Errors are stored by
+  // file, so files are not split when storing errors.
+  bool can_split = split_size > 0 && 
+      tokenizer.line_terminator == "\n" && 
+      !options.store_errors;
+  for (size_t i = 0; i < files.size(); ++i) {
+    csv_input_range whole_file;
+    whole_file.path = files[i];
+    whole_file.size = file_sizes[i];
+    bool split = can_split && 
+        file_sizes[i] > 2 * split_size &&
+        fileio::get_protocol(files[i]) == "" &&
+        !boost::ends_with(files[i], ".gz");
+    if (split) {
+      // the header must be in the first range
+      general_ifstream fin(files[i]);
+      split = fin.good() && 
+          skip_csv_header(fin, tokenizer, options, num_input_columns) &&
+          fin.good() && 
+          (size_t)fin.tellg() < split_size;
+    }
+    if (!split) {
+      ranges.push_back(whole_file);
+      continue;
+    }
+    size_t num_ranges = file_sizes[i] / split_size;
+    for (size_t j = 0; j < num_ranges; ++j) {
+      csv_input_range range;
+      range.path = files[i];
+      range.begin = j * split_size;
+      range.end = (j + 1 == num_ranges) ? (size_t)(-1) : (j + 1) * split_size;
+      range.size = (j + 1 == num_ranges) ? file_sizes[i] - range.begin : split_size;
+      ranges.push_back(range);
+    }
+  }
+  return ranges;
+}
+
+/**
+ * Parses the ranges with num_readers concurrent readers. The ranges are
+ * cut into num_readers consecutive groups of about equal size, and reader i
+ * parses group i into segment i of the frame, so that the rows are in the
+ * order of the inputs, and the segment of each row does not depend on the
+ * timing of the readers.
+ */
+void parse_csv_ranges_to_sframe(
+    const std::vector<csv_input_range>& ranges,
+    size_t num_readers,
+    const csv_info& info,
+    const std::vector<size_t>& output_column_order,
+    csv_line_tokenizer& tokenizer,
+    csv_file_handling_options options,
+    sframe& frame,
+    std::string frame_sidx_file,
+    std::map<std::string, std::shared_ptr<sarray<flexible_type>>>& errors) {
+  size_t total_size = 0;
+  for (auto& range: ranges) total_size += range.size;
+
+  std::vector<std::vector<csv_input_range> > groups(num_readers);
+  size_t cumulative_size = 0;
+  for (auto& range: ranges) {
+    // the group in which the middle of the range falls
+    size_t group = total_size == 0 ? 0 :
+        (cumulative_size + range.size / 2) * num_readers / total_size;
+    groups[std::min(group, num_readers - 1)].push_back(range);
+    cumulative_size += range.size;
+  }
+
+  size_t threads_per_reader = 
+      std::max<size_t>(2, thread_pool::get_instance().size() / num_readers + 1);
+  size_t read_size = 
+      std::max(SFRAME_CSV_PARSER_READ_SIZE / num_readers,
+               std::min<size_t>(SFRAME_CSV_PARSER_READ_SIZE, 1024 * 1024));
+
+  std::vector<std::unique_ptr<parallel_csv_parser> > parsers(num_readers);
+  std::vector<std::map<std::string, std::shared_ptr<sarray<flexible_type>>> > 
+      reader_errors(num_readers);
+  std::vector<std::exception_ptr> reader_exceptions(num_readers);
+  atomic<size_t> num_failed_readers = 0;
+  timer ti;
+
+  thread_group readers;
+  for (size_t i = 0; i < num_readers; ++i) {
+    parsers[i].reset(new parallel_csv_parser(info.column_types, tokenizer,
+                                             options.continue_on_failure, 
+                                             options.store_errors, 
+                                             0 /* row limit */,
+                                             output_column_order,
+                                             threads_per_reader));
+    parsers[i]->set_output_segment(i);
+    parsers[i]->set_read_size(read_size);
+    readers.launch([&, i]() {
+      try {
+        csv_line_tokenizer reader_tokenizer = tokenizer;
+        parsers[i]->start_timer();
+        for (auto& range: groups[i]) {
+          if (num_failed_readers.value > 0) break;
+          parse_csv_to_sframe(range.path, reader_tokenizer, options, frame,
+                              frame_sidx_file, *parsers[i], reader_errors[i],
+                              range.begin, range.end);
+        }
+      } catch (...) {
+        reader_exceptions[i] = std::current_exception();
+        num_failed_readers.inc();
+      }
+    });
+  }
+  readers.join();
+
+  for (auto& exception: reader_exceptions) {
+    if (exception) std::rethrow_exception(exception);
+  }
+
+  size_t lines_read = 0;
+  for (size_t i = 0; i < num_readers; ++i) {
+    lines_read += parsers[i]->num_lines_read();
+    errors.insert(reader_errors[i].begin(), reader_errors[i].end());
+  }
+  logprogress_stream << "Parsing completed. Parsed " << lines_read
+                     << " lines in " << ti.current_time() << " secs."  << std::endl;
+}
+
+} // anonymous namespace
+
 std::map<std::string, std::shared_ptr<sarray<flexible_type>>> parse_csvs_to_sframe(
     const std::string& url,
     csv_line_tokenizer& tokenizer,
@@ -1075,41 +1342,72 @@ std::map<std::string, std::shared_ptr<sarray<flexible_type>>> parse_csvs_to_sfra
   // fill in the type information
   get_column_types(info, column_type_hints);
 
-  parallel_csv_parser parser(info.column_types, tokenizer,
-                             continue_on_failure, store_errors, row_limit,
-                             output_column_order);
   // get the total input file size so I can stripe it across segments
   size_t total_input_file_sizes = 0;
+  std::vector<size_t> file_sizes;
   for (auto file : files) {
     general_ifstream fin(file);
-    total_input_file_sizes += fin.file_size();
+    file_sizes.push_back(fin.file_size());
+    total_input_file_sizes += file_sizes.back();
+  }
+
+  // Many files, or large files, are parsed by concurrent readers. A row 
+  // limit requires reading the files in order.
+  size_t input_columns = output_column_order.empty() ? 
+      info.column_types.size() : output_column_order.size();
+  std::vector<csv_input_range> ranges;
+  size_t num_readers = std::min<size_t>(SFRAME_CSV_PARSER_NUM_READERS,
+                                        thread_pool::get_instance().size());
+  if (row_limit == 0 && num_readers > 1) {
+    ranges = make_csv_input_ranges(files, file_sizes, tokenizer, 
+                                   options, input_columns);
+    num_readers = std::min(num_readers, ranges.size());
+    if (frame.is_opened_for_write()) {
+      num_readers = std::min(num_readers, frame.num_segments());
+    }
   }
-  parser.set_total_input_size(total_input_file_sizes);
 
   if (!frame.is_opened_for_write()) {
     // open as many segments as there are temp directories.
-    // But at least one segment
+    // But at least one segment, and one per reader
     frame.open_for_write(info.column_names, info.column_types, 
                          frame_sidx_file, 
-                         std::max<size_t>(1, num_temp_directories()));
+                         std::max<size_t>({1, num_temp_directories(), 
+                                           ranges.size() > 1 ? num_readers : 1}));
   }
 
   // create the errors map
   std::map<std::string, std::shared_ptr<sarray<flexible_type>>> errors;
 
-  // start parser timer for cumulative time consumed (in seconds)
-  parser.start_timer();
+  try {
+    if (ranges.size() > 1 && num_readers > 1) {
+      parse_csv_ranges_to_sframe(ranges, num_readers, info, output_column_order,
+                                 tokenizer, options, frame, frame_sidx_file,
+                                 errors);
+    } else {
+      parallel_csv_parser parser(info.column_types, tokenizer,
+                                 continue_on_failure, store_errors, row_limit,
+                                 output_column_order);
+      parser.set_total_input_size(total_input_file_sizes);
+
+      // start parser timer for cumulative time consumed (in seconds)
+      parser.start_timer();
+
+      for (auto file : files) {
+        // check that we've read < row_limit  
+        if (parser.num_lines_read() < row_limit || row_limit == 0) {      
+          parse_csv_to_sframe(file, tokenizer, options, frame, 
+                              frame_sidx_file, parser, errors);
+        } else break;
+      }
 
-  for (auto file : files) {
-    // check that we've read < row_limit  
-    if (parser.num_lines_read() < row_limit || row_limit == 0) {      
-      parse_csv_to_sframe(file, tokenizer, options, frame, 
-                          frame_sidx_file, parser, errors);
-    } else break;
+      logprogress_stream << "Parsing completed. Parsed " << parser.num_lines_read()
+                         << " lines in " << parser.get_time_elapsed() << " secs."  << std::endl;
+    }
+  } catch (...) {
+    frame.close();
+    throw;
   }
-  
-  logprogress_stream << "Parsing completed. Parsed " << parser.num_lines_read()
-                     << " lines in " << parser.get_time_elapsed() << " secs."  << std::endl;
 
   
   if (frame.is_opened_for_write()) frame.close();
@@ -1,12 +1,354 @@
+#include <cmath>
+#include <deque>
+#include <limits>
 #include <algorithm>
 #include <flexible_type/flexible_type.hpp>
 #include <boost/circular_buffer.hpp>
 #include <boost/algorithm/string.hpp>
+#include <sframe/sframe_reader_buffer.hpp>
 #include <sframe/rolling_aggregate.hpp>
 
 namespace graphlab {
 namespace rolling_aggregate {
 
+namespace {
+
+inline bool is_nan(const flexible_type& value) {
+  return value.get_type() == flex_type_enum::FLOAT &&
+         std::isnan(value.get<flex_float>());
+}
+
+/**
+ * A floating point sum which values can be added to and subtracted from,
+ * with Neumaier's compensated summation so that rounding errors do not
+ * accumulate over long series. Infinities and NaNs are counted instead of
+ * summed, since subtracting them back out would leave a NaN.
+ */
+class running_sum {
+ public:
+  void add(double value) {
+    if (std::isfinite(value)) add_finite(value);
+    else ++non_finite(value);
+  }
+
+  void remove(double value) {
+    if (std::isfinite(value)) add_finite(-value);
+    else --non_finite(value);
+  }
+
+  /// Returns true if the sum contains an infinity or a NaN
+  bool has_non_finite() const {
+    return m_num_pos_inf + m_num_neg_inf + m_num_nan > 0;
+  }
+
+  double value() const {
+    if (m_num_nan > 0 || (m_num_pos_inf > 0 && m_num_neg_inf > 0)) {
+      return std::numeric_limits<double>::quiet_NaN();
+    } else if (m_num_pos_inf > 0) {
+      return std::numeric_limits<double>::infinity();
+    } else if (m_num_neg_inf > 0) {
+      return -std::numeric_limits<double>::infinity();
+    }
+    return m_sum + m_compensation;
+  }
+
+ private:
+  void add_finite(double value) {
+    double t = m_sum + value;
+    if (std::abs(m_sum) >= std::abs(value)) {
+      m_compensation += (m_sum - t) + value;
+    } else {
+      m_compensation += (value - t) + m_sum;
+    }
+    m_sum = t;
+  }
+
+  size_t& non_finite(double value) {
+    if (std::isnan(value)) return m_num_nan;
+    else if (value > 0) return m_num_pos_inf;
+    else return m_num_neg_inf;
+  }
+
+  double m_sum = 0;
+  double m_compensation = 0;
+  size_t m_num_pos_inf = 0;
+  size_t m_num_neg_inf = 0;
+  size_t m_num_nan = 0;
+};
+
+/// Sum (and average) of the non-NULL values in the window
+class sum_window_aggregate : public window_aggregate {
+ public:
+  sum_window_aggregate(flex_type_enum input_type, bool average)
+      : m_input_type(input_type), m_average(average) { }
+
+  void add(const flexible_type& value) {
+    if (value.get_type() == flex_type_enum::UNDEFINED) return;
+    ++m_count;
+    if (m_input_type == flex_type_enum::INTEGER && !m_average) {
+      m_int_sum += value.get<flex_int>();
+    } else {
+      m_sum.add((double)value);
+    }
+  }
+
+  void remove(const flexible_type& value) {
+    if (value.get_type() == flex_type_enum::UNDEFINED) return;
+    --m_count;
+    if (m_input_type == flex_type_enum::INTEGER && !m_average) {
+      m_int_sum -= value.get<flex_int>();
+    } else {
+      m_sum.remove((double)value);
+    }
+  }
+
+  flexible_type emit() const {
+    if (m_average) {
+      if (m_count == 0) return FLEX_UNDEFINED;
+      return m_sum.value() / m_count;
+    } else if (m_input_type == flex_type_enum::INTEGER) {
+      return m_int_sum;
+    } else {
+      return m_sum.value();
+    }
+  }
+
+ private:
+  flex_type_enum m_input_type;
+  bool m_average;
+  size_t m_count = 0;
+  flex_int m_int_sum = 0;
+  running_sum m_sum;
+};
+
+/// Number of non-NULL values in the window
+class non_null_count_window_aggregate : public window_aggregate {
+ public:
+  void add(const flexible_type& value) {
+    if (value.get_type() != flex_type_enum::UNDEFINED) ++m_count;
+  }
+
+  void remove(const flexible_type& value) {
+    if (value.get_type() != flex_type_enum::UNDEFINED) --m_count;
+  }
+
+  flexible_type emit() const {
+    return flexible_type(m_count);
+  }
+
+ private:
+  size_t m_count = 0;
+};
+
+/**
+ * Population variance (or standard deviation) of the non-NULL values in the
+ * window, with Welford's update run forwards to add values and backwards to
+ * remove them.
+ */
+class variance_window_aggregate : public window_aggregate {
+ public:
+  explicit variance_window_aggregate(bool stdv) : m_stdv(stdv) { }
+
+  void add(const flexible_type& value) {
+    if (value.get_type() == flex_type_enum::UNDEFINED) return;
+    double x = (double)value;
+    if (!std::isfinite(x)) {
+      ++m_num_non_finite;
+      return;
+    }
+    ++m_count;
+    double delta = x - m_mean;
+    m_mean += delta / m_count;
+    m_M2 += delta * (x - m_mean);
+  }
+
+  void remove(const flexible_type& value) {
+    if (value.get_type() == flex_type_enum::UNDEFINED) return;
+    double x = (double)value;
+    if (!std::isfinite(x)) {
+      --m_num_non_finite;
+      return;
+    }
+    --m_count;
+    if (m_count == 0) {
+      m_mean = 0;
+      m_M2 = 0;
+      return;
+    }
+    double delta = x - m_mean;
+    m_mean -= delta / m_count;
+    m_M2 -= delta * (x - m_mean);
+    // cancellation may leave a tiny negative residue
+    if (m_M2 < 0) m_M2 = 0;
+  }
+
+  flexible_type emit() const {
+    double ret;
+    if (m_count + m_num_non_finite <= 1) ret = 0.0;
+    else if (m_num_non_finite > 0) ret = std::numeric_limits<double>::quiet_NaN();
+    else ret = m_M2 / m_count;
+    return m_stdv ? std::sqrt(ret) : ret;
+  }
+
+ private:
+  bool m_stdv;
+  size_t m_count = 0;
+  size_t m_num_non_finite = 0;
+  double m_mean = 0;
+  double m_M2 = 0;
+};
+
+/**
+ * Minimum (or maximum) of the non-NULL values in the window.
+ *
+ * Keeps the values which may still become the minimum in a queue: a value
+ * is dropped as soon as a smaller value enters the window after it, so
+ * the queue is increasing and its front is the minimum. Like
+ * groupby_operators::min, the earliest of equal values is emitted, and
+ * NaN is emitted only if it is the first non-NULL value in the window.
+ */
+template <bool IsMax>
+class extremum_window_aggregate : public window_aggregate {
+ public:
+  void add(const flexible_type& value) {
+    uint64_t position = m_num_added++;
+    if (value.get_type() == flex_type_enum::UNDEFINED) return;
+    if (is_nan(value)) {
+      m_nans.push_back({position, m_num_values_added});
+      return;
+    }
+    ++m_num_values_added;
+    while (!m_candidates.empty() && better(value, m_candidates.back().second)) {
+      m_candidates.pop_back();
+    }
+    m_candidates.push_back({position, value});
+  }
+
+  void remove(const flexible_type& value) {
+    uint64_t position = m_num_removed++;
+    if (value.get_type() == flex_type_enum::UNDEFINED) return;
+    if (is_nan(value)) {
+      DASSERT_EQ(m_nans.front().first, position);
+      m_nans.pop_front();
+      return;
+    }
+    ++m_num_values_removed;
+    if (m_candidates.front().first == position) m_candidates.pop_front();
+  }
+
+  flexible_type emit() const {
+    // the oldest NaN comes first if all the values added before it left
+    if (!m_nans.empty() && m_nans.front().second == m_num_values_removed) {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (m_candidates.empty()) return FLEX_UNDEFINED;
+    return m_candidates.front().second;
+  }
+
+ private:
+  static inline bool better(const flexible_type& a, const flexible_type& b) {
+    return IsMax ? b < a : a < b;
+  }
+
+  uint64_t m_num_added = 0;
+  uint64_t m_num_removed = 0;
+  /// The number of non-NULL, non-NaN values added and removed
+  uint64_t m_num_values_added = 0;
+  uint64_t m_num_values_removed = 0;
+  /// (position, value) of the candidates, oldest first
+  std::deque<std::pair<uint64_t, flexible_type>> m_candidates;
+  /// (position, m_num_values_added when added) of the NaNs, oldest first
+  std::deque<std::pair<uint64_t, uint64_t>> m_nans;
+};
+
+/// Recomputes any aggregator over the whole window on each emit()
+class recompute_window_aggregate : public window_aggregate {
+ public:
+  explicit recompute_window_aggregate(std::shared_ptr<group_aggregate_value> agg_op)
+      : m_agg_op(agg_op) { }
+
+  void add(const flexible_type& value) {
+    m_window.push_back(value);
+  }
+
+  void remove(const flexible_type& value) {
+    m_window.pop_front();
+  }
+
+  flexible_type emit() const {
+    return full_window_aggregate(m_agg_op, m_window.begin(), m_window.end());
+  }
+
+ private:
+  std::shared_ptr<group_aggregate_value> m_agg_op;
+  std::deque<flexible_type> m_window;
+};
+
+/**
+ * Returns the type of the output of an aggregation given the first
+ * non-NULL type returned in each segment.
+ */
+flex_type_enum combine_returned_types(const std::vector<flex_type_enum>& types) {
+  flex_type_enum array_type = flex_type_enum::UNDEFINED;
+  for(const auto &i : types) {
+    // Error out if the aggregation function outputs values with more than one
+    // type (not counting NULL)
+    if((i != array_type) &&
+        (array_type != flex_type_enum::UNDEFINED) &&
+        (i != flex_type_enum::UNDEFINED)) {
+      log_and_throw("Aggregation function returned two different non-NULL "
+          "types!");
+    }
+    if(i != flex_type_enum::UNDEFINED) {
+      array_type = i;
+    }
+  }
+  return array_type;
+}
+
+/// Returns the value of an order column in the units of the window range
+double order_value(const flexible_type& value) {
+  switch(value.get_type()) {
+   case flex_type_enum::INTEGER:
+     return value.get<flex_int>();
+   case flex_type_enum::FLOAT:
+     if (std::isnan(value.get<flex_float>())) break;
+     return value.get<flex_float>();
+   case flex_type_enum::DATETIME:
+     return value.get<flex_date_time>().microsecond_res_timestamp();
+   default:
+     break;
+  }
+  log_and_throw("Order column cannot contain missing values.");
+}
+
+} // anonymous namespace
+
+std::unique_ptr<window_aggregate> make_window_aggregate(
+    std::shared_ptr<group_aggregate_value> agg_op,
+    flex_type_enum input_type) {
+  // stdv derives from variance, so it is tested first
+  if (dynamic_cast<groupby_operators::sum*>(agg_op.get())) {
+    return std::unique_ptr<window_aggregate>(
+        new sum_window_aggregate(input_type, false));
+  } else if (dynamic_cast<groupby_operators::average*>(agg_op.get())) {
+    return std::unique_ptr<window_aggregate>(
+        new sum_window_aggregate(input_type, true));
+  } else if (dynamic_cast<groupby_operators::non_null_count*>(agg_op.get())) {
+    return std::unique_ptr<window_aggregate>(new non_null_count_window_aggregate);
+  } else if (dynamic_cast<groupby_operators::stdv*>(agg_op.get())) {
+    return std::unique_ptr<window_aggregate>(new variance_window_aggregate(true));
+  } else if (dynamic_cast<groupby_operators::variance*>(agg_op.get())) {
+    return std::unique_ptr<window_aggregate>(new variance_window_aggregate(false));
+  } else if (dynamic_cast<groupby_operators::min*>(agg_op.get())) {
+    return std::unique_ptr<window_aggregate>(new extremum_window_aggregate<false>);
+  } else if (dynamic_cast<groupby_operators::max*>(agg_op.get())) {
+    return std::unique_ptr<window_aggregate>(new extremum_window_aggregate<true>);
+  } else {
+    return std::unique_ptr<window_aggregate>(new recompute_window_aggregate(agg_op));
+  }
+}
+
 ssize_t clip(ssize_t val, ssize_t lower, ssize_t upper) {
   return std::min(upper, std::max(lower, val));
 }
@@ -90,6 +432,20 @@ std::shared_ptr<sarray<flexible_type>> rolling_apply(
     // Create buffer for the window
     auto window_buf = boost::circular_buffer<flexible_type>(total_window_size,
         flex_undefined());
+    auto window_agg = make_window_aggregate(agg_op, input.get_type());
+    for (const auto& value: window_buf) window_agg->add(value);
+    // The number of non-NULL values in window_buf
+    size_t num_observations = 0;
+
+    // Slides the window by one value
+    auto push_back = [&](const flexible_type& value) {
+      const flexible_type& oldest = window_buf.front();
+      if (oldest.get_type() != flex_type_enum::UNDEFINED) --num_observations;
+      window_agg->remove(oldest);
+      if (value.get_type() != flex_type_enum::UNDEFINED) ++num_observations;
+      window_agg->add(value);
+      window_buf.push_back(value);
+    };
     auto out_iter = ret_sarray->get_output_iterator(segment_id);
 
     sarray_reader_buffer<flexible_type> buf_reader(reader,
@@ -112,7 +468,7 @@ std::shared_ptr<sarray<flexible_type>> rolling_apply(
         i <= my_logical_window.second;
         ++i) {
       if(i >= 0 && buf_reader.has_next()) {
-        window_buf.push_back(buf_reader.next());
+        push_back(buf_reader.next());
       }
     }
 
@@ -121,11 +477,10 @@ std::shared_ptr<sarray<flexible_type>> rolling_apply(
       // First check if we have the minimum non-NULL observations. This is here
       // to remove the burden of checking from every aggregation function.
       if(check_num_observations &&
-          !has_min_observations(min_observations,
-            window_buf.begin(), window_buf.end())) {
+          num_observations < min_observations) {
         *out_iter = flex_undefined();
       } else {
-        auto result = full_window_aggregate(agg_op, window_buf.begin(), window_buf.end());
+        auto result = window_agg->emit();
         // Record the emitted type from the function. We just take the first
         // one that is non-NULL.
         if(fn_returned_types[segment_id] == flex_type_enum::UNDEFINED && 
@@ -142,33 +497,213 @@ std::shared_ptr<sarray<flexible_type>> rolling_apply(
 
       // Get the next value in the SArray
       if(my_logical_window.second >= 0 && buf_reader.has_next()) {
-        window_buf.push_back(buf_reader.next());
+        push_back(buf_reader.next());
       } else {
         // If this is a "fake" section of the logical window, just fill with
         // NULL values
-        window_buf.push_back(flex_undefined());
+        push_back(flex_undefined());
       }
     }
   }
   );
 
-  // Set output type of SArray based on what the aggregation function returned
-  flex_type_enum array_type = flex_type_enum::UNDEFINED;
-  for(const auto &i : fn_returned_types) {
-    // Error out if the aggregation function outputs values with more than one
-    // type (not counting NULL)
-    if((i != array_type) &&
-        (array_type != flex_type_enum::UNDEFINED) &&
-        (i != flex_type_enum::UNDEFINED)) {
-      log_and_throw("Aggregation function returned two different non-NULL "
-          "types!");
+  ret_sarray->set_type(combine_returned_types(fn_returned_types));
+
+  ret_sarray->close();
+  return ret_sarray;
+}
+
+std::shared_ptr<sarray<flexible_type>> partitioned_rolling_apply(
+    const sframe& input,
+    const std::vector<std::string>& partition_columns,
+    const std::string& order_column,
+    const std::string& value_column,
+    std::shared_ptr<group_aggregate_value> agg_op,
+    double range_start,
+    double range_end,
+    size_t min_observations) {
+  /// Sanity checks
+  if(!(range_start <= range_end)) {
+    log_and_throw("Start of window cannot be > end of window.");
+  }
+
+  auto order_type = input.column_type(order_column);
+  if(order_type != flex_type_enum::INTEGER &&
+     order_type != flex_type_enum::FLOAT &&
+     order_type != flex_type_enum::DATETIME) {
+    log_and_throw("Order column must be of type int, float or datetime.");
+  }
+
+  auto value_type = input.column_type(value_column);
+  if(!agg_op->support_type(value_type)) {
+    log_and_throw(agg_op->name() + std::string(" does not support input type."));
+  }
+  agg_op->set_input_type(value_type);
+
+  // The partition columns, then the order column, then the value column.
+  // The same column may appear more than once.
+  std::vector<std::shared_ptr<sarray<flexible_type>>> columns;
+  for (const auto& column: partition_columns) {
+    columns.push_back(input.select_column(column));
+  }
+  columns.push_back(input.select_column(order_column));
+  columns.push_back(input.select_column(value_column));
+  const size_t num_keys = partition_columns.size();
+  const size_t order_idx = num_keys;
+  const size_t value_idx = num_keys + 1;
+
+  sframe selected(columns, {}, false);
+
+  auto num_segments = thread::cpu_count();
+  std::shared_ptr<sframe::reader_type> reader(
+      std::move(selected.get_reader(num_segments)));
+  const size_t num_rows = reader->num_rows();
+  auto ret_sarray = std::make_shared<sarray<flexible_type>>();
+  ret_sarray->open_for_write(num_segments);
+
+  std::vector<size_t> seg_starts(num_segments + 1, 0);
+  for(size_t i = 0; i < num_segments; ++i) {
+    seg_starts[i + 1] = seg_starts[i] + reader->segment_length(i);
+  }
+
+  std::vector<flex_type_enum> fn_returned_types(num_segments,
+                                                flex_type_enum::UNDEFINED);
+
+  // The segments are split between partitions: a segment skips the rows of
+  // the partition which the previous segment ends in, and reads past its
+  // end to complete the partition it ends in.
+  parallel_for(0, num_segments, [&](size_t segment_id) {
+    auto out_iter = ret_sarray->get_output_iterator(segment_id);
+    size_t row = seg_starts[segment_id];
+    const size_t seg_end = seg_starts[segment_id + 1];
+    if (row == seg_end) return;
+
+    auto same_partition = [&](const std::vector<flexible_type>& a,
+                              const sframe_rows::row& b) {
+      for (size_t i = 0; i < num_keys; ++i) {
+        if (a[i] != b[i]) return false;
+      }
+      return true;
+    };
+
+    sframe_reader_buffer buf_reader(reader, row, num_rows);
+    // The partition key of the row before the current one
+    std::vector<flexible_type> key(num_keys);
+    bool has_next_row = false;
+    if (row > 0 && num_keys > 0) {
+      std::vector<std::vector<flexible_type>> prev_row;
+      reader->read_rows(row - 1, row, prev_row);
+      std::copy_n(prev_row[0].begin(), num_keys, key.begin());
+      while (row < seg_end) {
+        const auto& r = buf_reader.next();
+        ++row;
+        if (!same_partition(key, r)) {
+          has_next_row = true;
+          break;
+        }
+      }
+      // the partition spans this whole segment
+      if (!has_next_row) return;
+      --row;
+    } else if (row > 0) {
+      // everything is one partition, processed by the first non-empty segment
+      return;
+    } else {
+      buf_reader.next();
+      has_next_row = true;
     }
-    if(i != flex_type_enum::UNDEFINED) {
-      array_type = i;
+
+    // Rows read and not yet emitted or removed from the window.
+    // (order value, value), starting at row buffer_begin.
+    std::deque<std::pair<double, flexible_type>> buffer;
+    size_t buffer_begin = row;
+
+    // buf_reader.current() is the first row of the next partition, which
+    // starts at row. Each iteration handles one partition.
+    while (has_next_row && row < seg_end) {
+      const auto& first = buf_reader.current();
+      std::copy_n(first.begin(), num_keys, key.begin());
+      buffer.clear();
+      buffer_begin = row;
+      double last_order = order_value(first[order_idx]);
+      buffer.emplace_back(last_order, first[value_idx]);
+      has_next_row = false;
+      bool partition_done = false;
+
+      auto window_agg = make_window_aggregate(agg_op, value_type);
+      size_t num_observations = 0;
+      // The window is the rows [lo, hi), and out is the row to emit
+      size_t out = row, lo = row, hi = row;
+      auto at = [&](size_t r) -> std::pair<double, flexible_type>& {
+        return buffer[r - buffer_begin];
+      };
+      auto num_read = [&]() { return buffer_begin + buffer.size(); };
+      // Reads the next row into the buffer. Returns false at the end of the
+      // partition.
+      auto read_row = [&]() {
+        if (partition_done) return false;
+        if (!buf_reader.has_next()) {
+          partition_done = true;
+          return false;
+        }
+        const auto& r = buf_reader.next();
+        if (!same_partition(key, r)) {
+          partition_done = true;
+          has_next_row = true;
+          return false;
+        }
+        double next_order = order_value(r[order_idx]);
+        if (next_order < last_order) {
+          log_and_throw("Input must be sorted by the order column within "
+                        "each partition.");
+        }
+        last_order = next_order;
+        buffer.emplace_back(next_order, r[value_idx]);
+        return true;
+      };
+
+      while (out < num_read() || read_row()) {
+        double order = at(out).first;
+        // extend the window, reading rows of the partition as needed
+        while (hi < num_read() || read_row()) {
+          if (!(at(hi).first <= order + range_end)) break;
+          const auto& value = at(hi).second;
+          if (value.get_type() != flex_type_enum::UNDEFINED) ++num_observations;
+          window_agg->add(value);
+          ++hi;
+        }
+        // shrink the window
+        while (lo < hi && at(lo).first < order + range_start) {
+          const auto& value = at(lo).second;
+          if (value.get_type() != flex_type_enum::UNDEFINED) --num_observations;
+          window_agg->remove(value);
+          ++lo;
+        }
+
+        bool has_min_observations = (min_observations == size_t(-1)) ?
+            (num_observations == hi - lo) : (num_observations >= min_observations);
+        if (!has_min_observations) {
+          *out_iter = flex_undefined();
+        } else {
+          auto result = window_agg->emit();
+          if(fn_returned_types[segment_id] == flex_type_enum::UNDEFINED &&
+              result.get_type() != flex_type_enum::UNDEFINED) {
+            fn_returned_types[segment_id] = result.get_type();
+          }
+          *out_iter = result;
+        }
+        ++out;
+
+        while (buffer_begin < std::min(out, lo)) {
+          buffer.pop_front();
+          ++buffer_begin;
+        }
+      }
+      row = out;
     }
-  }
+  });
 
-  ret_sarray->set_type(array_type);
+  ret_sarray->set_type(combine_returned_types(fn_returned_types));
 
   ret_sarray->close();
   return ret_sarray;
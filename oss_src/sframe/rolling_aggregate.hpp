@@ -1,8 +1,11 @@
 #ifndef GRAPHLAB_SFRAME_ROLLING_AGGREGATE_HPP
 #define GRAPHLAB_SFRAME_ROLLING_AGGREGATE_HPP
 
+#include <memory>
+#include <boost/circular_buffer.hpp>
 #include <flexible_type/flexible_type.hpp>
 #include <sframe/sarray.hpp>
+#include <sframe/sframe.hpp>
 #include <sframe/groupby_aggregate_operators.hpp>
 
 namespace graphlab {
@@ -47,6 +50,92 @@ std::shared_ptr<sarray<flexible_type>> rolling_apply(
     size_t min_observations);
 
 
+/**
+ * Apply an aggregate function over a moving range of the rows of an SFrame
+ * which have the same partition key, in the order of an order column.
+ *
+ * For each row, the window holds the rows of its partition whose order
+ * value is within [order + range_start, order + range_end]. For instance
+ * with a DATETIME order column, range_start = -7 * 86400 and range_end = 0
+ * aggregate over the last 7 days of each partition up to the current row.
+ *
+ * \param input The input SFrame. Must be sorted by the partition columns
+ * (so that the rows of a partition are contiguous), then by the order
+ * column.
+ * \param partition_columns The columns forming the partition key. May be
+ * empty, in which case the whole SFrame is one partition.
+ * \param order_column The column ordering the rows of a partition. Must be
+ * INTEGER, FLOAT or DATETIME, with no missing values. DATETIME values are
+ * in seconds.
+ * \param value_column The column to aggregate.
+ * \param agg_op The aggregator. These classes are the same as used by groupby.
+ * \param range_start The start of the window relative to the order value
+ * of the current row, inclusive.
+ * \param range_end The end of the window relative to the order value of the
+ * current row, inclusive.
+ * \param min_observations The minimum allowed number of non-NULL values in
+ * the window for the emitted value to be non-NULL. size_t(-1) indicates that
+ * all values must be non-NULL.
+ *
+ * Partitions are processed in parallel, and the window of each partition is
+ * updated incrementally (see \ref make_window_aggregate).
+ *
+ * Returns an SArray with one value for each row of the input.
+ *
+ * Throws an exception if:
+ *  - range_end < range_start
+ *  - The order column is not sorted within a partition or has missing values.
+ *  - The given function name corresponds to a function that will not operate
+ *  on the data type of the value column.
+ *  - The aggregation function returns more than one non-NULL types.
+ */
+std::shared_ptr<sarray<flexible_type>> partitioned_rolling_apply(
+    const sframe& input,
+    const std::vector<std::string>& partition_columns,
+    const std::string& order_column,
+    const std::string& value_column,
+    std::shared_ptr<group_aggregate_value> agg_op,
+    double range_start,
+    double range_end,
+    size_t min_observations);
+
+/**
+ * An aggregate over a moving window, updated as values enter and leave the
+ * window instead of being recomputed over the whole window for every
+ * output.
+ *
+ * Values leave the window in the order they entered it.
+ */
+class window_aggregate {
+ public:
+  virtual ~window_aggregate() = default;
+
+  /// Adds a value entering the window
+  virtual void add(const flexible_type& value) = 0;
+
+  /// Removes the oldest value in the window, which must be value
+  virtual void remove(const flexible_type& value) = 0;
+
+  /// Returns the aggregate of the values currently in the window
+  virtual flexible_type emit() const = 0;
+};
+
+/**
+ * Returns a window_aggregate computing agg_op over a moving window of
+ * values of type input_type. set_input_type() must have been called on
+ * agg_op.
+ *
+ * Sums, averages, non-NULL counts, variances and standard deviations are
+ * updated by adding and subtracting the values entering and leaving the
+ * window, and minimums and maximums with a monotonic queue of candidates,
+ * so that each update takes amortized constant time. Other aggregators are
+ * recomputed over the whole window by full_window_aggregate() on each
+ * emit().
+ */
+std::unique_ptr<window_aggregate> make_window_aggregate(
+    std::shared_ptr<group_aggregate_value> agg_op,
+    flex_type_enum input_type);
+
 /// Aggregate functions
 template<typename Iterator>
 flexible_type full_window_aggregate(std::shared_ptr<group_aggregate_value> agg_op,
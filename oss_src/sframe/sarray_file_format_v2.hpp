@@ -85,6 +85,10 @@ class sarray_format_reader_v2: public sarray_format_reader<T> {
     m_cache.resize(m_block_list.size());
     m_used_cache_entries.resize(m_block_list.size());
     m_used_cache_entries.clear();
+    m_string_pool.reset();
+    if (SFRAME_STRING_INTERN_POOL_SIZE > 0) {
+      m_string_pool = std::make_shared<string_intern_pool>(SFRAME_STRING_INTERN_POOL_SIZE);
+    }
     // it is convenient for m_start_row to have one more entry which is 
     // the total # elements in the file
     m_start_row.push_back(m_num_rows);
@@ -262,6 +266,8 @@ class sarray_format_reader_v2: public sarray_format_reader<T> {
    */
   std::vector<cache_entry> m_cache;
   static buffer_pool<std::vector<T> > m_buffer_pool;
+  /// Shares the decoded dictionary strings between the blocks of the column
+  std::shared_ptr<string_intern_pool> m_string_pool;
 
   /**
    * Extracts as many from fetch_start to fetch_end from the cache
@@ -319,6 +325,23 @@ class sarray_format_reader_v2: public sarray_format_reader<T> {
 
   void fetch_cache_from_file(size_t block_number, cache_entry& ret);
 
+  /**
+   * Holds a block read from file, encoded, in a cache entry, and evicts
+   * random entries if the cache is full.
+   */
+  void fill_cache(size_t block_number, cache_entry& ret,
+                  std::shared_ptr<std::vector<char> > buffer,
+                  v2_block_impl::block_info* info);
+
+  /**
+   * Like fetch_cache_from_file, but also reads ahead the following blocks of
+   * the same segment, up to SFRAME_READ_AHEAD_BLOCKS blocks in total, with
+   * a single batch of reads (see \ref v2_block_impl::block_manager::read_blocks).
+   * Read ahead stops at the first block which is cached, or whose cache
+   * entry is locked by another thread. The caller holds the lock of ret.
+   */
+  void fetch_cache_with_read_ahead(size_t block_number, cache_entry& ret);
+
   size_t block_offset_containing_row(size_t row) {
     auto pos = std::lower_bound(m_start_row.begin(), m_start_row.end(), row);
     size_t blocknum = std::distance(m_start_row.begin(), pos);
@@ -345,22 +368,18 @@ buffer_pool<std::vector<T> > sarray_format_reader_v2<T>::m_buffer_pool;
 template <>
 inline void 
 sarray_format_reader_v2<flexible_type>::
-fetch_cache_from_file(size_t block_number, cache_entry& ret) {
-//   std::cerr << "Fetching from file: " << block_number << std::endl;
+fill_cache(size_t block_number, cache_entry& ret,
+           std::shared_ptr<std::vector<char> > buffer,
+           v2_block_impl::block_info* info) {
   // don't use the buffer. hold as encoded always when reading from a 
   // flexible_type file
   if (ret.buffer) {
     m_buffer_pool.release_buffer(std::move(ret.buffer));
     ret.buffer.reset();
   }
-  block_address block_addr = m_block_list[block_number];
-  v2_block_impl::block_info* info; 
-  auto buffer = m_manager.read_block(block_addr, &info);
-  if (buffer == nullptr) {
-    log_and_throw("Unexpected block read failure. Bad file?");
-  }
   ret.buffer_start_row = m_start_row[block_number];
   ret.encoded_buffer.init(*info, buffer);
+  if (m_string_pool) ret.encoded_buffer.set_string_pool(m_string_pool);
   ret.encoded_buffer_reader = ret.encoded_buffer.get_range();
   ret.is_encoded = true;
   ret.has_data = true;
@@ -377,6 +396,58 @@ fetch_cache_from_file(size_t block_number, cache_entry& ret) {
   }
 }
 
+// specialization for fetch_cache_from_file when T is a flexible_type
+// since this permits an encoded representation
+template <>
+inline void 
+sarray_format_reader_v2<flexible_type>::
+fetch_cache_from_file(size_t block_number, cache_entry& ret) {
+//   std::cerr << "Fetching from file: " << block_number << std::endl;
+  block_address block_addr = m_block_list[block_number];
+  v2_block_impl::block_info* info; 
+  auto buffer = m_manager.read_block(block_addr, &info);
+  if (buffer == nullptr) {
+    log_and_throw("Unexpected block read failure. Bad file?");
+  }
+  fill_cache(block_number, ret, buffer, info);
+}
+
+template <>
+inline void 
+sarray_format_reader_v2<flexible_type>::
+fetch_cache_with_read_ahead(size_t block_number, cache_entry& ret) {
+  size_t segment_id = std::get<0>(m_block_list[block_number]);
+  size_t max_blocks = std::min<size_t>(SFRAME_READ_AHEAD_BLOCKS,
+                                       SFRAME_MAX_BLOCKS_IN_CACHE);
+  std::vector<size_t> block_numbers{block_number};
+  std::vector<std::unique_lock<graphlab::simple_spinlock> > read_ahead_locks;
+  for (size_t i = block_number + 1; 
+       i < m_block_list.size() && block_numbers.size() < max_blocks && 
+       std::get<0>(m_block_list[i]) == segment_id; 
+       ++i) {
+    std::unique_lock<graphlab::simple_spinlock> lock(m_cache[i].lock, std::try_to_lock);
+    if (!lock.owns_lock() || m_cache[i].has_data) break;
+    read_ahead_locks.push_back(std::move(lock));
+    block_numbers.push_back(i);
+  }
+  if (block_numbers.size() == 1) {
+    fetch_cache_from_file(block_number, ret);
+    return;
+  }
+
+  std::vector<block_address> addrs;
+  for (size_t i: block_numbers) addrs.push_back(m_block_list[i]);
+  std::vector<std::shared_ptr<std::vector<char> > > buffers;
+  std::vector<v2_block_impl::block_info*> infos;
+  if (!m_manager.read_blocks(addrs, buffers, &infos)) {
+    log_and_throw("Unexpected block read failure. Bad file?");
+  }
+  fill_cache(block_number, ret, buffers[0], infos[0]);
+  for (size_t j = 1; j < block_numbers.size(); ++j) {
+    fill_cache(block_numbers[j], m_cache[block_numbers[j]], buffers[j], infos[j]);
+  }
+}
+
 template <typename T>
 inline void 
 sarray_format_reader_v2<T>::
@@ -413,7 +484,8 @@ ensure_cache_decoded(cache_entry& cache, size_t block_number) {
     v2_block_impl::typed_decode(cache.encoded_buffer.get_block_info(),
                                 data->data(),
                                 data->size(),
-                                *cache.buffer);
+                                *cache.buffer,
+                                m_string_pool.get());
     // clear the encoded buffer information
     cache.encoded_buffer.release();
     cache.encoded_buffer_reader.release();
@@ -448,7 +520,12 @@ fetch_rows_from_cache(size_t fetch_start,
     auto& cache = m_cache[i];
     std::unique_lock<graphlab::simple_spinlock> cache_lock_guard(cache.lock);
     if (!cache.has_data) {
-      fetch_cache_from_file(i, cache);
+      if (first_row_to_fetch_in_this_block == m_start_row[i]) {
+        // a sequential scan entering the block. Read the next blocks too.
+        fetch_cache_with_read_ahead(i, cache);
+      } else {
+        fetch_cache_from_file(i, cache);
+      }
     } 
     if (cache.buffer_start_row < first_row_to_fetch_in_this_block && cache.is_encoded) {
       // fast forward
@@ -9,12 +9,22 @@ extern "C" {
 #include <lz4/lz4.h>
 }
 #include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
 #include <parallel/mutex.hpp>
 #include <boost/algorithm/string.hpp>
 #include <sframe/sarray_v2_block_manager.hpp>
 #include <sframe/sarray_index_file.hpp>
 #include <sframe/sframe_constants.hpp>
 #include <sframe/unfair_lock.hpp>
+#include <fileio/fs_utils.hpp>
+#include <fileio/sanitize_url.hpp>
+#include <fileio/async_file_io.hpp>
+#include <fileio/fileio_constants.hpp>
+#include <perf/thread_counters.hpp>
+#include <perf/timeline_trace.hpp>
 
 namespace graphlab {
 namespace v2_block_impl {
@@ -25,6 +35,20 @@ static unfair_lock* get_io_locks() {
   return iolocks;
 }
 
+/**
+ * Number of bytes at the end of a remote segment file read in the first
+ * request. If the footer fits, it takes a single request to read it.
+ */
+static constexpr size_t REMOTE_FOOTER_READ_SIZE = 64 * 1024;
+
+/**
+ * Returns true if the segment file should be read with range requests
+ * instead of through a file handle.
+ */
+static bool is_remote_segment(const std::string& segment_file) {
+  return fileio::get_protocol(segment_file) == "s3";
+}
+
 block_manager& block_manager::get_instance() {
   static block_manager* manager = new block_manager();
   return *manager;
@@ -118,6 +142,7 @@ const block_info& block_manager::get_block_info(block_address addr) {
 
 std::shared_ptr<std::vector<char> > 
 block_manager::read_block(block_address addr, block_info** ret_info) {
+  TIMELINE_TRACE_SCOPE("io", "read_block");
 
   size_t segment_id, column_id, block_id;
   std::tie(segment_id, column_id, block_id) = addr;
@@ -128,46 +153,68 @@ block_manager::read_block(block_address addr, block_info** ret_info) {
 
   if(ret_info) (*ret_info) = &info;
 
-  // get the return buffer
-  // resize ret to the block length on disk
-  std::shared_ptr<std::vector<char> > ret = m_buffer_pool.get_new_buffer();
-  ret->resize(info.length);
-
-  // acquire lock on get the file handle and perform the read
-  std::unique_lock<graphlab::mutex> guard(seg->lock);
-  std::shared_ptr<general_ifstream> fin = get_segment_file_handle(seg);
-  fin->seekg(info.offset, std::ios_base::beg);
-  size_t iolockid = seg->io_parallelism_id;
-  bool use_io_lock = SFRAME_IO_READ_LOCK > 0 && 
-      (seg->file_size > SFRAME_IO_LOCK_FILE_SIZE_THRESHOLD);
-  if (use_io_lock && iolockid != (size_t)(-1)) get_io_locks()[iolockid].lock();
-  fin->read(ret->data(), info.length);
-  if (use_io_lock && iolockid != (size_t)(-1)) get_io_locks()[iolockid].unlock();
-  if (fin->fail()) {
-    m_buffer_pool.release_buffer(std::move(ret));
-    ret.reset();
-    return ret;
+  std::shared_ptr<std::vector<char> > ret;
+  if (seg->remote_reader) {
+    ret = read_remote_block(seg, column_id, block_id);
+    if (!ret) return ret;
+  } else {
+    // get the return buffer
+    // resize ret to the block length on disk
+    ret = m_buffer_pool.get_new_buffer();
+    ret->resize(info.length);
+
+    // acquire lock on get the file handle and perform the read
+    std::unique_lock<graphlab::mutex> guard(seg->lock);
+    std::shared_ptr<general_ifstream> fin = get_segment_file_handle(seg);
+    fin->seekg(info.offset, std::ios_base::beg);
+    size_t iolockid = seg->io_parallelism_id;
+    bool use_io_lock = SFRAME_IO_READ_LOCK > 0 && 
+        (seg->file_size > SFRAME_IO_LOCK_FILE_SIZE_THRESHOLD);
+    if (use_io_lock && iolockid != (size_t)(-1)) get_io_locks()[iolockid].lock();
+    fin->read(ret->data(), info.length);
+    if (use_io_lock && iolockid != (size_t)(-1)) get_io_locks()[iolockid].unlock();
+    if (fin->fail()) {
+      m_buffer_pool.release_buffer(std::move(ret));
+      ret.reset();
+      return ret;
+    }
+    guard.unlock();
   }
-  guard.unlock();
-
 
-  if (info.flags & LZ4_COMPRESSION) {
-    /*
-     * Decompress into another buffer.
-     */
-    std::shared_ptr<std::vector<char> > decompression_buffer = 
-        m_buffer_pool.get_new_buffer();
-    decompression_buffer->resize(info.block_size);
-    LZ4_decompress_safe(ret->data(),                   // src
-                        decompression_buffer->data(),  // target
-                        info.length,                   // src length
-                        info.block_size);              // target length
-    std::swap(ret, decompression_buffer);
-    m_buffer_pool.release_buffer(std::move(decompression_buffer));
-  } 
+  decompress_block(ret, info);
   return ret;
 }
 
+bool block_manager::read_blocks(const std::vector<block_address>& addrs,
+                                std::vector<std::shared_ptr<std::vector<char> > >& ret,
+                                std::vector<block_info*>* ret_info) {
+  TIMELINE_TRACE_SCOPE("io", "read_blocks");
+  ret.clear();
+  ret.resize(addrs.size());
+  if (ret_info) ret_info->resize(addrs.size());
+
+  bool success = true;
+  // blocks of local segment files, grouped by segment
+  std::map<size_t, std::vector<size_t> > local_blocks;
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    size_t segment_id, column_id, block_id;
+    std::tie(segment_id, column_id, block_id) = addrs[i];
+    std::shared_ptr<segment> seg = get_segment(segment_id);
+    if (ret_info) (*ret_info)[i] = &(seg->blocks[column_id][block_id]);
+    if (!seg->remote_reader && fileio::get_protocol(seg->segment_file) == "") {
+      local_blocks[segment_id].push_back(i);
+    } else {
+      ret[i] = read_block(addrs[i]);
+      if (!ret[i]) success = false;
+    }
+  }
+  for (auto& seg_blocks: local_blocks) {
+    std::shared_ptr<segment> seg = get_segment(seg_blocks.first);
+    if (!read_local_blocks(seg, addrs, seg_blocks.second, ret)) success = false;
+  }
+  return success;
+}
+
 
 
 bool block_manager::read_typed_block(block_address addr, 
@@ -184,6 +231,41 @@ bool block_manager::read_typed_block(block_address addr,
   return success;
 }
 
+bool block_manager::read_typed_blocks(block_address addr,
+                                      size_t nblocks,
+                                      std::vector<std::vector<flexible_type> >& ret,
+                                      std::vector<block_info>* ret_info) {
+  size_t segment_id, column_id, block_id;
+  std::tie(segment_id, column_id, block_id) = addr;
+  size_t num_blocks = get_segment(segment_id)->blocks[column_id].size();
+  std::vector<block_address> addrs;
+  for (size_t i = block_id; i < std::min(block_id + nblocks, num_blocks); ++i) {
+    addrs.push_back(block_address{segment_id, column_id, i});
+  }
+  return read_typed_blocks(addrs, ret, ret_info);
+}
+
+bool block_manager::read_typed_blocks(const std::vector<block_address>& addrs,
+                                      std::vector<std::vector<flexible_type> >& ret,
+                                      std::vector<block_info>* ret_info) {
+  std::vector<std::shared_ptr<std::vector<char> > > buffers;
+  std::vector<block_info*> infos;
+  bool success = read_blocks(addrs, buffers, &infos);
+  ret.resize(addrs.size());
+  if (ret_info) ret_info->resize(addrs.size());
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    if (ret_info) (*ret_info)[i] = *(infos[i]);
+    ret[i].clear();
+    if (!buffers[i]) continue;
+    if (success) {
+      success = typed_decode(*(infos[i]), buffers[i]->data(),
+                             buffers[i]->size(), ret[i]);
+    }
+    m_buffer_pool.release_buffer(std::move(buffers[i]));
+  }
+  return success;
+}
+
 
 
 /**************************************************************************/
@@ -231,6 +313,11 @@ void block_manager::init_segment(std::shared_ptr<block_manager::segment>& seg) {
   std::lock_guard<graphlab::mutex> guard(seg->lock);
   // check and exit again while within the lock
   if (seg->inited) return;
+  if (is_remote_segment(seg->segment_file)) {
+    init_remote_segment(seg);
+    seg->inited = true;
+    return;
+  }
   // for each segment, read the block footer
   std::shared_ptr<general_ifstream> fin = get_segment_file_handle(seg);
   // jump to the footer
@@ -251,6 +338,213 @@ void block_manager::init_segment(std::shared_ptr<block_manager::segment>& seg) {
   seg->file_size = filesize;
 }
 
+void block_manager::init_remote_segment(std::shared_ptr<segment>& seg) {
+  auto reader = std::make_shared<fileio::range_reader>(seg->segment_file);
+  uint64_t filesize = reader->file_size();
+  uint64_t footer_size = -1;
+  if (filesize < sizeof(footer_size)) {
+    log_and_throw(std::string("Invalid segment file: ") +
+                  sanitize_url(seg->segment_file));
+  }
+  // read the tail of the file, which usually contains the whole footer
+  size_t tail_size = std::min<size_t>(filesize, REMOTE_FOOTER_READ_SIZE);
+  std::vector<std::vector<char> > contents;
+  reader->read({fileio::byte_range(filesize - tail_size, tail_size)}, contents);
+  const std::vector<char>& tail = contents[0];
+  memcpy(&footer_size, tail.data() + tail_size - sizeof(footer_size),
+         sizeof(footer_size));
+  if (footer_size > filesize - sizeof(footer_size)) {
+    log_and_throw(std::string("Invalid segment file: ") +
+                  sanitize_url(seg->segment_file));
+  }
+
+  if (footer_size + sizeof(footer_size) <= tail_size) {
+    iarchive iarc(tail.data() + tail_size - sizeof(footer_size) - footer_size,
+                  footer_size);
+    iarc >> seg->blocks;
+  } else {
+    reader->read({fileio::byte_range(filesize - footer_size - sizeof(footer_size),
+                                     footer_size)}, contents);
+    iarchive iarc(contents[0].data(), contents[0].size());
+    iarc >> seg->blocks;
+  }
+  seg->remote_reader = reader;
+  seg->file_size = filesize;
+}
+
+std::shared_ptr<std::vector<char> >
+block_manager::read_remote_block(std::shared_ptr<segment>& seg,
+                                 size_t column_id, size_t block_id) {
+  const std::vector<block_info>& blocks = seg->blocks[column_id];
+  std::vector<fileio::byte_range> ranges;
+  size_t nbytes = 0;
+  {
+    std::lock_guard<graphlab::mutex> guard(seg->lock);
+    auto iter = seg->prefetched_blocks.find({column_id, block_id});
+    if (iter != seg->prefetched_blocks.end()) {
+      std::shared_ptr<std::vector<char> > ret = std::move(iter->second);
+      seg->prefetched_bytes -= ret->size();
+      seg->prefetched_blocks.erase(iter);
+      return ret;
+    }
+    // fetch the block together with the next blocks of the column, up to
+    // the first block which is already prefetched.
+    for (size_t i = block_id; i < blocks.size(); ++i) {
+      if (i > block_id &&
+          (nbytes + blocks[i].length > SFRAME_REMOTE_PREFETCH_SIZE ||
+           seg->prefetched_blocks.count({column_id, i}))) {
+        break;
+      }
+      ranges.emplace_back(blocks[i].offset, blocks[i].length);
+      nbytes += blocks[i].length;
+    }
+  }
+
+  // the requests are issued without holding the segment lock so that
+  // other columns of the segment can be read concurrently.
+  std::vector<std::vector<char> > contents;
+  try {
+    seg->remote_reader->read(ranges, contents);
+  } catch (std::exception& e) {
+    logstream(LOG_ERROR) << "Unable to read block " << block_id << " of column "
+                         << column_id << " of "
+                         << sanitize_url(seg->segment_file) << ": "
+                         << e.what() << std::endl;
+    return nullptr;
+  }
+
+  std::shared_ptr<std::vector<char> > ret = m_buffer_pool.get_new_buffer();
+  ret->swap(contents[0]);
+
+  std::lock_guard<graphlab::mutex> guard(seg->lock);
+  // Blocks are prefetched ahead of sequential readers, so there is at most
+  // about one prefetch window per column. Readers which skip around, or
+  // stop early, may leave more behind, in which case everything is dropped.
+  if (seg->prefetched_bytes + nbytes >
+      SFRAME_REMOTE_PREFETCH_SIZE * std::max<size_t>(seg->blocks.size(), 1)) {
+    seg->prefetched_blocks.clear();
+    seg->prefetched_bytes = 0;
+  }
+  for (size_t i = 1; i < contents.size(); ++i) {
+    auto& prefetched = seg->prefetched_blocks[{column_id, block_id + i}];
+    // another reader may have fetched the same block concurrently
+    if (prefetched) continue;
+    prefetched = m_buffer_pool.get_new_buffer();
+    prefetched->swap(contents[i]);
+    seg->prefetched_bytes += prefetched->size();
+  }
+  return ret;
+}
+
+
+bool block_manager::read_local_blocks(std::shared_ptr<segment>& seg,
+                                      const std::vector<block_address>& addrs,
+                                      const std::vector<size_t>& indices,
+                                      std::vector<std::shared_ptr<std::vector<char> > >& ret) {
+  const size_t alignment = fileio::DIRECT_IO_ALIGNMENT;
+  auto block_info_of = [&](size_t i) -> const block_info& {
+    return seg->blocks[std::get<1>(addrs[i])][std::get<2>(addrs[i])];
+  };
+  size_t total_bytes = 0;
+  for (size_t i : indices) total_bytes += block_info_of(i).length;
+  // large batches may bypass the page cache. Their contents are unlikely
+  // to be read again soon, and would only evict more useful pages.
+  bool direct = fileio::FILEIO_DIRECT_IO_THRESHOLD > 0 &&
+      total_bytes >= fileio::FILEIO_DIRECT_IO_THRESHOLD;
+  int fd = fileio::open_local_file_for_read(seg->segment_file, direct);
+  if (fd < 0) {
+    logstream(LOG_ERROR) << "Unable to open " << sanitize_url(seg->segment_file)
+                         << ": " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  std::vector<fileio::async_io_request> requests(indices.size());
+  for (size_t k = 0; k < indices.size(); ++k) {
+    const block_info& info = block_info_of(indices[k]);
+    auto& buffer = ret[indices[k]];
+    buffer = m_buffer_pool.get_new_buffer();
+    buffer->resize(info.length);
+    fileio::async_io_request& request = requests[k];
+    request.fd = fd;
+    if (direct) {
+      // O_DIRECT reads must cover whole aligned pages into aligned memory
+      size_t begin = info.offset & ~(alignment - 1);
+      size_t end = (info.offset + info.length + alignment - 1) & ~(alignment - 1);
+      void* aligned_buffer = NULL;
+      if (posix_memalign(&aligned_buffer, alignment, end - begin) != 0) {
+        log_and_throw("Unable to allocate read buffer");
+      }
+      request.offset = begin;
+      request.buffer = (char*)aligned_buffer;
+      request.length = end - begin;
+    } else {
+      request.offset = info.offset;
+      request.buffer = buffer->data();
+      request.length = info.length;
+    }
+  }
+
+  size_t iolockid = seg->io_parallelism_id;
+  bool use_io_lock = SFRAME_IO_READ_LOCK > 0 &&
+      (seg->file_size > SFRAME_IO_LOCK_FILE_SIZE_THRESHOLD) &&
+      iolockid != (size_t)(-1);
+  if (use_io_lock) get_io_locks()[iolockid].lock();
+  fileio::get_thread_local_async_file_io().read(requests);
+  if (use_io_lock) get_io_locks()[iolockid].unlock();
+  close(fd);
+
+  bool success = true;
+  for (size_t k = 0; k < indices.size(); ++k) {
+    const block_info& info = block_info_of(indices[k]);
+    auto& buffer = ret[indices[k]];
+    fileio::async_io_request& request = requests[k];
+    // a direct read of the last block may stop at the end of the file
+    size_t needed = info.offset + info.length - request.offset;
+    bool ok = request.result >= 0 && (size_t)request.result >= needed;
+    if (direct) {
+      if (ok) {
+        memcpy(buffer->data(), request.buffer + (info.offset - request.offset),
+               info.length);
+      }
+      free(request.buffer);
+    }
+    if (ok) {
+      decompress_block(buffer, info);
+    } else {
+      logstream(LOG_ERROR) << "Unable to read block at offset " << info.offset
+                           << " of " << sanitize_url(seg->segment_file) << std::endl;
+      m_buffer_pool.release_buffer(std::move(buffer));
+      buffer.reset();
+      success = false;
+    }
+  }
+  return success;
+}
+
+void block_manager::decompress_block(std::shared_ptr<std::vector<char> >& buffer,
+                                     const block_info& info) {
+  // every block read goes through here
+  if (thread_counters_enabled()) {
+    thread_counters& counters = get_thread_counters();
+    ++counters.blocks_read;
+    if (info.flags & LZ4_COMPRESSION) counters.bytes_decompressed += info.block_size;
+  }
+  if (info.flags & LZ4_COMPRESSION) {
+    TIMELINE_TRACE_SCOPE("io", "decompress_block");
+    /*
+     * Decompress into another buffer.
+     */
+    std::shared_ptr<std::vector<char> > decompression_buffer = 
+        m_buffer_pool.get_new_buffer();
+    decompression_buffer->resize(info.block_size);
+    LZ4_decompress_safe(buffer->data(),                // src
+                        decompression_buffer->data(),  // target
+                        info.length,                   // src length
+                        info.block_size);              // target length
+    std::swap(buffer, decompression_buffer);
+    m_buffer_pool.release_buffer(std::move(decompression_buffer));
+  } 
+}
 
 } // namespace v2_block_impl
 } // namespace graphlab
@@ -14,6 +14,7 @@
 #include <parallel/pthread_tools.hpp>
 #include <parallel/atomic.hpp>
 #include <fileio/general_fstream.hpp>
+#include <fileio/range_reader.hpp>
 #include <sframe/sarray_index_file.hpp>
 #include <flexible_type/flexible_type.hpp>
 #include <util/buffer_pool.hpp>
@@ -124,6 +125,14 @@ namespace v2_block_impl {
  * Furthermore, the block manager can combine accesses of multiple columns in the
  * same array group into a single file handle. Future performance improvements
  * involving better IO scheduling can also be performed here.
+ *
+ * Segment files on S3 are not read through a file handle. Instead, the
+ * block manager reads the footer, and then only the blocks which are
+ * requested, with concurrent range requests (\ref fileio::range_reader).
+ * A read of block b of a column also fetches the following blocks of the
+ * same column (which are consecutive in the segment file), up to
+ * SFRAME_REMOTE_PREFETCH_SIZE bytes, so that reading a few columns of a wide
+ * SFrame only transfers the blocks of these columns.
  * 
  * When a column is opened by \ref open_column(), a \ref column_address is 
  * returned. This is a pair of integers of {segment_file_id, and column_id}.
@@ -221,6 +230,50 @@ class block_manager {
                          std::vector<std::vector<flexible_type> >& ret, 
                          std::vector<block_info>* ret_info = NULL);
 
+  /**
+   * Reads a batch of blocks given their block addresses, into typed arrays.
+   * The blocks must have been stored as typed blocks. ret[i] contains the
+   * contents of the block at addrs[i]. Returns true on success, false on
+   * failure.
+   *
+   * See \ref read_blocks.
+   *
+   * Safe for concurrent operation.
+   */
+  bool read_typed_blocks(const std::vector<block_address>& addrs,
+                         std::vector<std::vector<flexible_type> >& ret,
+                         std::vector<block_info>* ret_info = NULL);
+
+  /**
+   * Reads a batch of blocks given their block addresses. On return, ret[i]
+   * is the (decompressed) contents of the block at addrs[i], or an empty
+   * pointer if the block could not be read. Buffers may be given back with
+   * \ref release_buffer.
+   *
+   * The reads of all the blocks of a local segment file are submitted
+   * together (see \ref fileio::async_file_io), so that the disk can serve
+   * many of them at once. Blocks of other segment files are read one at a
+   * time with \ref read_block.
+   *
+   * If ret_info is not NULL, (*ret_info)[i] points to the block information
+   * of addrs[i].
+   *
+   * Returns true if all the blocks were read.
+   *
+   * Safe for concurrent operation.
+   */
+  bool read_blocks(const std::vector<block_address>& addrs,
+                   std::vector<std::shared_ptr<std::vector<char> > >& ret,
+                   std::vector<block_info*>* ret_info = NULL);
+
+  /**
+   * Returns a buffer returned by \ref read_block or \ref read_blocks to the
+   * buffer pool.
+   */
+  inline void release_buffer(std::shared_ptr<std::vector<char> >&& buffer) {
+    m_buffer_pool.release_buffer(std::move(buffer));
+  }
+
   /** 
    * Reads a few blocks starting from a given a block address ((array_group ID,
    * segment ID, block ID) tuple) and deserializes it into an array. The block
@@ -276,6 +329,22 @@ class block_manager {
     std::vector<std::vector<block_info> > blocks;
 
     graphlab::atomic<size_t> reference_count;
+
+    /**
+     * Reader used in place of the file handle when the segment file is
+     * remote. NULL for local segment files.
+     */
+    std::shared_ptr<fileio::range_reader> remote_reader;
+
+    /**
+     * Raw contents of the blocks fetched ahead of time from a remote segment
+     * file, by {column_id, block_id}. A block is removed once it is read.
+     */
+    std::map<std::pair<size_t, size_t>,
+             std::shared_ptr<std::vector<char> > > prefetched_blocks;
+
+    /// Total size of the prefetched blocks
+    size_t prefetched_bytes = 0;
   };
   
   /// All the internal segments
@@ -321,6 +390,39 @@ class block_manager {
   std::shared_ptr<segment> get_segment(size_t segmentid);
 
   void init_segment(std::shared_ptr<segment>& seg);
+
+  /**
+   * Reads the blocks addrs[i] for i in indices, which all belong to the
+   * local segment file seg, with a single batch of reads into ret.
+   * Returns false if any of the blocks could not be read.
+   */
+  bool read_local_blocks(std::shared_ptr<segment>& seg,
+                         const std::vector<block_address>& addrs,
+                         const std::vector<size_t>& indices,
+                         std::vector<std::shared_ptr<std::vector<char> > >& ret);
+
+  /**
+   * Replaces the raw contents of a block by its decompressed contents if
+   * the block is compressed.
+   */
+  void decompress_block(std::shared_ptr<std::vector<char> >& buffer,
+                        const block_info& info);
+
+  /**
+   * Reads the footer of a remote segment file with the segment's
+   * remote_reader.
+   */
+  void init_remote_segment(std::shared_ptr<segment>& seg);
+
+  /**
+   * Returns the raw (possibly compressed) contents of a block of a remote
+   * segment, either from the prefetched blocks or by fetching it together
+   * with the following blocks of the column.
+   * Returns an empty pointer on failure.
+   */
+  std::shared_ptr<std::vector<char> >
+      read_remote_block(std::shared_ptr<segment>& seg,
+                        size_t column_id, size_t block_id);
 };
 
 
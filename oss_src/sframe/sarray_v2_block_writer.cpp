@@ -8,6 +8,12 @@
 extern "C" {
 #include <lz4/lz4.h>
 }
+#include <fcntl.h>
+#include <unistd.h>
+#include <fileio/fs_utils.hpp>
+#include <fileio/async_file_io.hpp>
+#include <perf/thread_counters.hpp>
+#include <perf/timeline_trace.hpp>
 #include <sframe/sarray_v2_block_writer.hpp>
 #include <sframe/sarray_index_file.hpp>
 #include <sframe/sframe_constants.hpp>
@@ -16,10 +22,17 @@ extern "C" {
 namespace graphlab {
 namespace v2_block_impl {
 
+block_writer::~block_writer() {
+  for (int fd: m_output_fds) {
+    if (fd >= 0) close(fd);
+  }
+}
+
 void block_writer::init(std::string group_index_file, 
                         size_t num_segments, 
                         size_t num_columns) {
   m_output_files.resize(num_segments);
+  m_output_fds.resize(num_segments, -1);
   m_output_file_locks.resize(num_segments);
   m_output_bytes_written.resize(num_segments);
 
@@ -53,10 +66,19 @@ void block_writer::init(std::string group_index_file,
 void block_writer::open_segment(size_t segmentid, std::string filename) {
   ASSERT_LT(segmentid, m_index_info.nsegments);
   ASSERT_TRUE(m_output_files[segmentid] == nullptr);
-  m_output_files[segmentid].reset(new general_ofstream(filename, 
-                                                    /* must not compress! 
-                                                     * We need the blocks!*/
-                                                     false));
+  ASSERT_LT(m_output_fds[segmentid], 0);
+  if (fileio::get_protocol(filename) == "") {
+    m_output_fds[segmentid] = open(filename.c_str(),
+                                   O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (m_output_fds[segmentid] < 0) {
+      log_and_throw("Unable to open segment data file " + filename);
+    }
+  } else {
+    m_output_files[segmentid].reset(new general_ofstream(filename, 
+                                                      /* must not compress! 
+                                                       * We need the blocks!*/
+                                                       false));
+  }
   m_index_info.segment_files[segmentid] = filename;
   // update the per column segment file
   for (size_t col = 0;col < m_index_info.columns.size(); ++col) {
@@ -64,7 +86,7 @@ void block_writer::open_segment(size_t segmentid, std::string filename) {
         m_index_info.segment_files[segmentid] + ":" + std::to_string(col);
   }
 
-  if (m_output_files[segmentid]->fail()) {
+  if (m_output_files[segmentid] && m_output_files[segmentid]->fail()) {
     log_and_throw("Unable to open segment data file " + filename);
   }
 
@@ -77,9 +99,11 @@ size_t block_writer::write_block(size_t segment_id,
                                  size_t column_id, 
                                  char* data,
                                  block_info block) {
+  TIMELINE_TRACE_SCOPE("io", "write_block");
   DASSERT_LT(segment_id, m_index_info.nsegments);
   DASSERT_LT(column_id, m_index_info.columns.size());
-  DASSERT_TRUE(m_output_files[segment_id] != nullptr);
+  DASSERT_TRUE(m_output_files[segment_id] != nullptr ||
+               m_output_fds[segment_id] >= 0);
   // try to compress the data
   size_t compress_bound = LZ4_compressBound(block.block_size);
   auto compression_buffer = m_buffer_pool.get_new_buffer();
@@ -112,16 +136,32 @@ size_t block_writer::write_block(size_t segment_id,
   block.offset = m_output_bytes_written[segment_id];
   m_output_bytes_written[segment_id] += buffer_to_write_len + padding;
   m_index_info.columns[column_id].segment_sizes[segment_id] += block.num_elem;
-  m_output_files[segment_id]->write(buffer_to_write, buffer_to_write_len);
-  m_output_files[segment_id]->write(padding_bytes, padding);
   m_blocks[segment_id][column_id].push_back(block);
-  m_output_file_locks[segment_id].unlock();
+  bool success = true;
+  if (m_output_fds[segment_id] >= 0) {
+    // the range of the file is reserved. Concurrent writers of the same
+    // segment need not wait for this write.
+    m_output_file_locks[segment_id].unlock();
+    int fd = m_output_fds[segment_id];
+    success = fileio::write_fully(fd, block.offset,
+                                  buffer_to_write, buffer_to_write_len) &&
+              fileio::write_fully(fd, block.offset + buffer_to_write_len,
+                                  padding_bytes, padding);
+  } else {
+    m_output_files[segment_id]->write(buffer_to_write, buffer_to_write_len);
+    m_output_files[segment_id]->write(padding_bytes, padding);
+    success = m_output_files[segment_id]->good();
+    m_output_file_locks[segment_id].unlock();
+  }
 
   m_buffer_pool.release_buffer(std::move(compression_buffer));
 
-  if (!m_output_files[segment_id]->good()) {
+  if (!success) {
     log_and_throw_io_failure("Fail to write. Disk may be full.");
   }
+  if (thread_counters_enabled()) {
+    get_thread_counters().bytes_written += buffer_to_write_len + padding;
+  }
   return buffer_to_write_len;
 }
 
@@ -141,6 +181,13 @@ size_t block_writer::write_typed_block(size_t segment_id,
 void block_writer::close_segment(size_t segment_id) {
   emit_footer(segment_id);
   m_output_files[segment_id].reset();
+  if (m_output_fds[segment_id] >= 0) {
+    int ret = close(m_output_fds[segment_id]);
+    m_output_fds[segment_id] = -1;
+    if (ret != 0) {
+      log_and_throw_io_failure("Fail to write. Disk may be full.");
+    }
+  }
 }
 
 group_index_file_information& block_writer::get_index_info() {
@@ -157,14 +204,21 @@ void block_writer::emit_footer(size_t segment_id) {
   // write out all the block headers
   oarchive oarc;
   oarc << m_blocks[segment_id];
-  m_output_files[segment_id]->write(oarc.buf, oarc.off);
   uint64_t footer_size = oarc.off;
+  oarc.write(reinterpret_cast<char*>(&footer_size), sizeof(footer_size));
 
-  m_output_files[segment_id]->write(reinterpret_cast<char*>(&footer_size),
-                                 sizeof(footer_size));
+  bool success = true;
+  if (m_output_fds[segment_id] >= 0) {
+    success = fileio::write_fully(m_output_fds[segment_id],
+                                  m_output_bytes_written[segment_id],
+                                  oarc.buf, oarc.off);
+  } else {
+    m_output_files[segment_id]->write(oarc.buf, oarc.off);
+    success = m_output_files[segment_id]->good();
+  }
   free(oarc.buf);
 
-  if (!m_output_files[segment_id]->good()) {
+  if (!success) {
     log_and_throw_io_failure("Fail to write. Disk may be full.");
   }
 }
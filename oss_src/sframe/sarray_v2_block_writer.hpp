@@ -49,6 +49,9 @@ namespace v2_block_impl {
 class block_writer {
  public:
 
+  /// Closes the file descriptors of the segments which were not closed.
+  ~block_writer();
+
   /**
    * Opens a block writer with a target index file, the number of segments
    * to write, and the number of columns to write.
@@ -133,6 +136,12 @@ class block_writer {
   buffer_pool<std::vector<char> > m_buffer_pool;
   /// The output files for each open segment
   std::vector<std::shared_ptr<general_ofstream> > m_output_files;
+  /**
+   * File descriptors of the local output segment files, -1 for the segments
+   * written through m_output_files. Blocks of local segment files are
+   * written with positional writes outside of the segment lock.
+   */
+  std::vector<int> m_output_fds;
   /// Locks on the output segments
   std::vector<graphlab::mutex> m_output_file_locks;
   /// Number of bytes written to each output segments
@@ -31,6 +31,7 @@ encoded_block_range encoded_block::get_range() {
 
 void encoded_block::release() {
   m_block.m_data.reset();
+  m_block.m_string_pool.reset();
   m_block.m_block_info = block_info();
 }
 
@@ -72,7 +73,8 @@ void encoded_block_range::coroutine_launch() {
                                              shared.m_skip--;
                                              if (shared.m_skip == 0) sink();
                                            }
-                                         });
+                                         },
+                                         coro_m_block.m_string_pool.get());
             return;
       }));
 }
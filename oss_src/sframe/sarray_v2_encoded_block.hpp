@@ -13,6 +13,7 @@
 #include <memory>
 #include <flexible_type/flexible_type.hpp>
 #include <sframe/sarray_v2_block_types.hpp>
+#include <sframe/string_intern_pool.hpp>
 namespace graphlab {
 namespace v2_block_impl {
 
@@ -80,6 +81,14 @@ class encoded_block {
    */
   encoded_block_range get_range();
 
+  /**
+   * Sets the pool the string dictionary of the block is interned in when
+   * decoded by ranges obtained afterwards. See \ref string_intern_pool.
+   */
+  void set_string_pool(std::shared_ptr<string_intern_pool> pool) {
+    m_block.m_string_pool = pool;
+  }
+
   /**
    * Release the block object. All acquired ranges are stil valid.
    */
@@ -107,6 +116,8 @@ class encoded_block {
     block_info m_block_info;
     /// The actual block data.
     std::shared_ptr<std::vector<char> > m_data;
+    /// The pool for the string dictionary. May be empty.
+    std::shared_ptr<string_intern_pool> m_string_pool;
   };
 
   block m_block;
@@ -344,7 +344,8 @@ static void encode_string(block_info& info,
  */
 static void decode_string(iarchive& iarc, 
                           std::vector<flexible_type>& ret,
-                          size_t num_undefined) {
+                          size_t num_undefined,
+                          string_intern_pool* string_pool) {
   unsigned int last_id = 0;
   decode_string_stream(ret.size() - num_undefined, iarc, 
                        [&](flexible_type val) {
@@ -355,7 +356,7 @@ static void decode_string(iarchive& iarc,
                          ret[last_id] = val;
                          DASSERT_LT(last_id, ret.size());
                          ++last_id;
-                       });
+                       }, string_pool);
 }
 
 /**
@@ -516,7 +517,8 @@ void typed_encode(const std::vector<flexible_type>& data,
  */
 bool typed_decode(const block_info& info,
                   char* start, size_t len,
-                  std::vector<flexible_type>& ret) {
+                  std::vector<flexible_type>& ret,
+                  string_intern_pool* string_pool) {
   if (!(info.flags & IS_FLEXIBLE_TYPE)) {
     logstream(LOG_ERROR) << "Attempting to decode a non-typed block"
                          << std::endl;
@@ -576,7 +578,7 @@ bool typed_decode(const block_info& info,
         decode_double_legacy(iarc, ret, num_undefined);
       }
     } else if (column_type == flex_type_enum::STRING) {
-      decode_string(iarc, ret, num_undefined);
+      decode_string(iarc, ret, num_undefined, string_pool);
     } else if (column_type == flex_type_enum::VECTOR) {
       decode_vector(iarc, ret, num_undefined, 
                     info.flags & BLOCK_ENCODING_EXTENSION);
@@ -11,6 +11,7 @@
 #include <sframe/sarray_v2_block_types.hpp>
 #include <util/dense_bitset.hpp>
 #include <sframe/integer_pack.hpp>
+#include <sframe/string_intern_pool.hpp>
 namespace graphlab {
 namespace v2_block_impl {
 using namespace graphlab::integer_pack;
@@ -38,10 +39,14 @@ void decode_double_legacy(iarchive& iarc,
 /**
  * Decodes a type block. Reads from block_info and a buffer.
  * Returns false on failure. 
+ *
+ * If string_pool is not NULL, the dictionary of a dictionary encoded string
+ * block is interned in it.
  */
 bool typed_decode(const block_info& info,
                   char* start, size_t len,
-                  std::vector<flexible_type>& ret);
+                  std::vector<flexible_type>& ret,
+                  string_intern_pool* string_pool = NULL);
 
 /**
  * Decodes a type block. Reads from block_info and a buffer.
@@ -49,7 +54,8 @@ bool typed_decode(const block_info& info,
  */
 bool typed_decode_stream_callback(const block_info& info,
                                   char* start, size_t len,
-                                  std::function<void(flexible_type)> retcallback);
+                                  std::function<void(flexible_type)> retcallback,
+                                  string_intern_pool* string_pool = NULL);
 
 /**
  * Encodes a type block. Serializes data into the output archive
@@ -132,11 +138,14 @@ static void decode_double_stream(size_t num_elements,
 
 /**
  * Decodes num_elements of strings , calling the callback for each string.
+ * If string_pool is not NULL, the dictionary of a dictionary encoded block
+ * is interned in it.
  */
 template <typename Fn> // Fn is a function like void(flexible_type)
 static void decode_string_stream(size_t num_elements,
                                  iarchive& iarc,
-                                 Fn callback) {
+                                 Fn callback,
+                                 string_intern_pool* string_pool = NULL) {
   bool use_dictionary_encoding = false;
   std::vector<flexible_type> idx_values;
   idx_values.resize(num_elements, flexible_type(flex_type_enum::INTEGER));
@@ -150,6 +159,12 @@ static void decode_string_stream(size_t num_elements,
       std::string new_str;
       uint64_t str_len;
       variable_decode(iarc, str_len);
+      if (string_pool != NULL && iarc.buf != NULL) {
+        // share the buffers of the values of the previous blocks
+        str = string_pool->intern(iarc.buf + iarc.off, str_len);
+        iarc.off += str_len;
+        continue;
+      }
       new_str.resize(str_len);
       iarc.read(&(new_str[0]), str_len);
       str = std::move(new_str);
@@ -234,7 +249,8 @@ static void decode_vector_stream(size_t num_elements,
 template <typename Fn> // Fn is a function like void(flexible_type)
 static bool typed_decode_stream_callback(const block_info& info,
                                   char* start, size_t len,
-                                  Fn callback) {
+                                  Fn callback,
+                                  string_intern_pool* string_pool = NULL) {
   if (!(info.flags & IS_FLEXIBLE_TYPE)) {
     logstream(LOG_ERROR) << "Attempting to decode a non-typed block"
                          << std::endl;
@@ -315,7 +331,8 @@ static bool typed_decode_stream_callback(const block_info& info,
         decode_double_stream_legacy(elements_to_decode, iarc, stream_callback); 
       }
     } else if (column_type == flex_type_enum::STRING) {
-      decode_string_stream(elements_to_decode, iarc, stream_callback); 
+      decode_string_stream(elements_to_decode, iarc, stream_callback,
+                           string_pool); 
     } else if (column_type == flex_type_enum::VECTOR) {
       decode_vector_stream(elements_to_decode, iarc, stream_callback, 
                            info.flags & BLOCK_ENCODING_EXTENSION); 
@@ -28,13 +28,20 @@ EXPORT size_t SFRAME_WRITER_MAX_BUFFERED_CELLS = 32*1024*1024; // 64M elements
 EXPORT size_t SFRAME_WRITER_MAX_BUFFERED_CELLS_PER_BLOCK = 256*1024; // 1M elements.
 EXPORT // will be modified at startup to be 4x nCPUS
 EXPORT size_t SFRAME_MAX_BLOCKS_IN_CACHE = 32;
+EXPORT size_t SFRAME_READ_AHEAD_BLOCKS = 4;
+EXPORT size_t SFRAME_STRING_INTERN_POOL_SIZE = 4096;
 EXPORT size_t SFRAME_CSV_PARSER_READ_SIZE = 50 * 1024 * 1024; // 50MB
+EXPORT size_t SFRAME_CSV_PARSER_NUM_READERS = 8;
+EXPORT size_t SFRAME_CSV_PARSER_SPLIT_SIZE = 128 * 1024 * 1024; // 128MB
+EXPORT size_t SFRAME_CSV_PARSER_FAST_TOKENIZER = 1;
 EXPORT size_t SFRAME_GROUPBY_BUFFER_NUM_ROWS = 1024 * 1024;
+EXPORT size_t SFRAME_DISTINCT_BUFFER_SIZE = 1024 * 1024 * 1024; // 1GB
 EXPORT size_t SFRAME_JOIN_BUFFER_NUM_CELLS = 50*1024*1024;
 EXPORT size_t SFRAME_IO_READ_LOCK = false;
 EXPORT size_t SFRAME_SORT_PIVOT_ESTIMATION_SAMPLE_SIZE = 2000000;
 EXPORT size_t SFRAME_SORT_MAX_SEGMENTS = 128;
 EXPORT const size_t SFRAME_IO_LOCK_FILE_SIZE_THRESHOLD = 4 * 1024 * 1024;
+EXPORT size_t SFRAME_REMOTE_PREFETCH_SIZE = 16 * 1024 * 1024;
 EXPORT std::string LIBODBC_PREFIX("");
 EXPORT size_t ODBC_BUFFER_SIZE = size_t(3 * 1024 * 1024) * size_t(1024); // 3 GB (to allow for a blob or two)
 EXPORT size_t ODBC_BUFFER_MAX_ROWS = 2000;
@@ -67,6 +74,13 @@ REGISTER_GLOBAL_WITH_CHECKS(int64_t,
                             true, 
                             +[](int64_t val){ return val >= 1; });
 
+REGISTER_GLOBAL_WITH_CHECKS(int64_t, 
+                            SFRAME_READ_AHEAD_BLOCKS, 
+                            true, 
+                            +[](int64_t val){ return val >= 1; });
+
+REGISTER_GLOBAL(int64_t, SFRAME_STRING_INTERN_POOL_SIZE, true);
+
 
 REGISTER_GLOBAL_WITH_CHECKS(int64_t, 
                             SFRAME_CSV_PARSER_READ_SIZE, 
@@ -74,12 +88,28 @@ REGISTER_GLOBAL_WITH_CHECKS(int64_t,
                             +[](int64_t val){ return val >= 1024; });
 
 
+REGISTER_GLOBAL_WITH_CHECKS(int64_t, 
+                            SFRAME_CSV_PARSER_NUM_READERS, 
+                            true, 
+                            +[](int64_t val){ return val >= 1; });
+
+
+REGISTER_GLOBAL(int64_t, SFRAME_CSV_PARSER_SPLIT_SIZE, true);
+REGISTER_GLOBAL(int64_t, SFRAME_CSV_PARSER_FAST_TOKENIZER, true);
+
+
 REGISTER_GLOBAL_WITH_CHECKS(int64_t, 
                             SFRAME_GROUPBY_BUFFER_NUM_ROWS,
                             true, 
                             +[](int64_t val){ return val >= 64; });
 
 
+REGISTER_GLOBAL_WITH_CHECKS(int64_t, 
+                            SFRAME_DISTINCT_BUFFER_SIZE,
+                            true, 
+                            +[](int64_t val){ return val >= 1024; });
+
+
 REGISTER_GLOBAL_WITH_CHECKS(int64_t, 
                             SFRAME_JOIN_BUFFER_NUM_CELLS,
                             true, 
@@ -103,6 +133,11 @@ REGISTER_GLOBAL_WITH_CHECKS(int64_t,
                             true, 
                             +[](int64_t val){ return val == 0 || val == 1 ; });
 
+REGISTER_GLOBAL_WITH_CHECKS(int64_t, 
+                            SFRAME_REMOTE_PREFETCH_SIZE,
+                            true, 
+                            +[](int64_t val){ return val >= 0; });
+
 REGISTER_GLOBAL_WITH_CHECKS(int64_t, 
                             SFRAME_SORT_PIVOT_ESTIMATION_SAMPLE_SIZE,
                             true, 
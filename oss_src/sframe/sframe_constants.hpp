@@ -116,12 +116,46 @@ extern size_t SFRAME_WRITER_MAX_BUFFERED_CELLS;
  */
 extern size_t SFRAME_MAX_BLOCKS_IN_CACHE;
 
+/**
+ * The number of blocks of a segment a reader fetches in one batch of reads
+ * when a sequential scan reaches a block which is not cached. 1 disables
+ * read ahead.
+ */
+extern size_t SFRAME_READ_AHEAD_BLOCKS;
+
+/**
+ * The maximum number of distinct strings interned per column by a reader.
+ * Dictionary encoded string blocks of a column decode repeated values to
+ * flexible_types sharing a single buffer. 0 disables interning.
+ */
+extern size_t SFRAME_STRING_INTERN_POOL_SIZE;
+
 /**
  * The amount to read from the file each time by the CSV parser. (this block
  * is then parsed in parallel by a collection of threads)
  */
 extern size_t SFRAME_CSV_PARSER_READ_SIZE;
 
+/**
+ * The maximum number of CSV files, or ranges of CSV files, which are read
+ * and parsed concurrently when loading many files, or large files.
+ */
+extern size_t SFRAME_CSV_PARSER_NUM_READERS;
+
+/**
+ * Uncompressed local CSV files larger than twice this many bytes are cut
+ * into ranges of this many bytes which are parsed concurrently. 0 disables
+ * the splitting of files.
+ */
+extern size_t SFRAME_CSV_PARSER_SPLIT_SIZE;
+
+/**
+ * If nonzero, CSV lines with no quoted, commented or bracketed fields are
+ * split on single character delimiters with a vectorized scan, and plain
+ * integer and float fields are parsed without the general parser.
+ */
+extern size_t SFRAME_CSV_PARSER_FAST_TOKENIZER;
+
 
 
 /**
@@ -130,6 +164,14 @@ extern size_t SFRAME_CSV_PARSER_READ_SIZE;
 extern size_t SFRAME_GROUPBY_BUFFER_NUM_ROWS;
 
 
+/**
+ * The number of bytes of row fingerprints distinct keeps in memory, shared
+ * by all threads. Larger inputs are partitioned by fingerprint before
+ * deduplicating.
+ */
+extern size_t SFRAME_DISTINCT_BUFFER_SIZE;
+
+
 /**
  * The number of bytes that a join algorithm is allowed to use during execution.
  */
@@ -148,6 +190,13 @@ extern size_t SFRAME_IO_READ_LOCK;
  */
 extern const size_t SFRAME_IO_LOCK_FILE_SIZE_THRESHOLD;
 
+/**
+ * When reading a column from a remote (S3) segment file, the block manager
+ * fetches the requested block together with the following blocks of the
+ * same column, up to this many bytes, with concurrent range requests.
+ */
+extern size_t SFRAME_REMOTE_PREFETCH_SIZE;
+
 /**
  * Number of samples used to estimate the pivot positions to partition the
  * data for sorting.
@@ -0,0 +1,37 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <sframe/string_intern_pool.hpp>
+
+namespace graphlab {
+
+constexpr size_t string_intern_pool::MAX_STRING_LENGTH;
+
+string_intern_pool::string_intern_pool(size_t max_size)
+    : m_max_size(max_size) { }
+
+flexible_type string_intern_pool::intern(const char* str, size_t len) {
+  if (len > MAX_STRING_LENGTH || m_max_size == 0) {
+    return flex_string(str, len);
+  }
+  std::lock_guard<mutex> guard(m_lock);
+  m_key.assign(str, len);
+  auto iter = m_values.find(m_key);
+  if (iter != m_values.end()) return iter->second;
+
+  if (m_values.size() >= m_max_size) m_values.clear();
+  flexible_type ret = flex_string(str, len);
+  m_values.emplace(m_key, ret);
+  return ret;
+}
+
+size_t string_intern_pool::size() const {
+  std::lock_guard<mutex> guard(m_lock);
+  return m_values.size();
+}
+
+} // namespace graphlab
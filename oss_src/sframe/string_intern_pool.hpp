@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_SFRAME_STRING_INTERN_POOL_HPP
+#define GRAPHLAB_SFRAME_STRING_INTERN_POOL_HPP
+#include <string>
+#include <unordered_map>
+#include <flexible_type/flexible_type.hpp>
+#include <parallel/mutex.hpp>
+
+namespace graphlab {
+
+/**
+ * \internal
+ * A bounded pool of STRING flexible_type values.
+ *
+ * flexible_type strings are reference counted, so values returned by
+ * \ref intern for identical strings share one buffer. This is used when
+ * decoding the dictionaries of dictionary encoded string blocks: every
+ * block of a column with few distinct values otherwise allocates its own
+ * copy of the same dictionary.
+ *
+ * When the pool holds max_size values it is cleared, so that columns with
+ * many distinct values do not grow it unboundedly.
+ *
+ * Safe for concurrent use.
+ */
+class string_intern_pool {
+ public:
+  /// Strings longer than this are not interned
+  static constexpr size_t MAX_STRING_LENGTH = 256;
+
+  explicit string_intern_pool(size_t max_size);
+
+  /**
+   * Returns a STRING flexible_type holding [str, str + len), sharing its
+   * buffer with the values previously returned for the same string.
+   */
+  flexible_type intern(const char* str, size_t len);
+
+  /// The number of strings in the pool
+  size_t size() const;
+
+ private:
+  mutable mutex m_lock;
+  std::unordered_map<std::string, flexible_type> m_values;
+  /// Lookup key, reused to avoid allocations
+  std::string m_key;
+  size_t m_max_size;
+};
+
+} // namespace graphlab
+#endif
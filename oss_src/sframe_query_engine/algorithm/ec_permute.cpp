@@ -13,6 +13,12 @@ namespace graphlab {
 namespace query_eval {
 using sframe_config::SFRAME_SORT_BUFFER_SIZE;
 
+/**
+ * The number of blocks read from the block manager with a single call to
+ * read_typed_blocks when filling the permute buffer.
+ */
+static constexpr size_t BLOCK_READ_BATCH_SIZE = 64;
+
 /**
 * This returns the number of bytes after LZ4 decode needed for each column.
 *
@@ -402,24 +408,35 @@ sframe ec_permute_partitions(sframe input,
                                 block_manager.get_block_info(right).offset;
                   });
         ti.start();
-        // good. now we fetch the blocks in that order.
-        std::vector<flexible_type> buffer;
-        for (auto& block: block_read_order) {
-          block_manager.read_typed_block(block, buffer);
-          v2_block_impl::column_address col_address{std::get<0>(block), std::get<1>(block)};
-          size_t column_id = column_id_from_column_address.at(col_address);
-
-          ASSERT_LT(column_id - col_start, cur_row_number.size());
-          size_t& row_number = cur_row_number[column_id - col_start];
-          for (size_t i = 0; i < buffer.size(); ++i) {
-            ASSERT_LT(row_number, forward_map_buffer.size());
-            ASSERT_GE(forward_map_buffer[row_number].get<flex_int>(), row_start);
-            ASSERT_LT(forward_map_buffer[row_number].get<flex_int>(), row_end);
-            size_t target = forward_map_buffer[row_number].get<flex_int>() - row_start;
-            DASSERT_LT(column_id - col_start, permute_buffer.size());
-            DASSERT_LT(target, permute_buffer[column_id - col_start].size());
-            permute_buffer[column_id - col_start][target] = std::move(buffer[i]);
-            ++row_number;
+        // good. now we fetch the blocks in that order, a batch at a time
+        // so that the reads of a batch are issued together.
+        std::vector<std::vector<flexible_type> > buffers;
+        for (size_t batch_start = 0; batch_start < block_read_order.size();
+             batch_start += BLOCK_READ_BATCH_SIZE) {
+          size_t batch_end = std::min(batch_start + BLOCK_READ_BATCH_SIZE,
+                                      block_read_order.size());
+          std::vector<v2_block_impl::block_address>
+              batch(block_read_order.begin() + batch_start,
+                    block_read_order.begin() + batch_end);
+          ASSERT_TRUE(block_manager.read_typed_blocks(batch, buffers));
+          for (size_t b = 0; b < batch.size(); ++b) {
+            auto& block = batch[b];
+            auto& buffer = buffers[b];
+            v2_block_impl::column_address col_address{std::get<0>(block), std::get<1>(block)};
+            size_t column_id = column_id_from_column_address.at(col_address);
+
+            ASSERT_LT(column_id - col_start, cur_row_number.size());
+            size_t& row_number = cur_row_number[column_id - col_start];
+            for (size_t i = 0; i < buffer.size(); ++i) {
+              ASSERT_LT(row_number, forward_map_buffer.size());
+              ASSERT_GE(forward_map_buffer[row_number].get<flex_int>(), row_start);
+              ASSERT_LT(forward_map_buffer[row_number].get<flex_int>(), row_end);
+              size_t target = forward_map_buffer[row_number].get<flex_int>() - row_start;
+              DASSERT_LT(column_id - col_start, permute_buffer.size());
+              DASSERT_LT(target, permute_buffer[column_id - col_start].size());
+              permute_buffer[column_id - col_start][target] = std::move(buffer[i]);
+              ++row_number;
+            }
           }
         }
 
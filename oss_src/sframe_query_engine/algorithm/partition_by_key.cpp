@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <algorithm>
+#include <functional>
+#include <logger/logger.hpp>
+#include <util/cityhash_gl.hpp>
+#include <fileio/buffered_writer.hpp>
+#include <sframe/sframe_rows.hpp>
+#include <sframe/sframe_constants.hpp>
+#include <sframe_query_engine/planning/planner_node.hpp>
+#include <sframe_query_engine/planning/planner.hpp>
+#include <sframe_query_engine/operators/operator_properties.hpp>
+#include <sframe_query_engine/algorithm/sort_comparator.hpp>
+#include <sframe_query_engine/algorithm/partition_by_key.hpp>
+
+namespace graphlab {
+namespace query_eval {
+
+double key_partitions::skew() const {
+  size_t num_rows = 0;
+  size_t max_rows = 0;
+  for (size_t size: partition_sizes) {
+    num_rows += size;
+    max_rows = std::max(max_rows, size);
+  }
+  if (num_rows == 0) return 1.0;
+  return double(max_rows) * partition_sizes.size() / num_rows;
+}
+
+/**
+ * Streams the source into partitioned segments. partition_fn maps the key
+ * columns of a row to a partition in [0, num_partitions).
+ */
+static key_partitions partition_by_key(
+    std::shared_ptr<planner_node> source,
+    const std::vector<std::string>& column_names,
+    const std::vector<size_t>& key_column_indices,
+    size_t num_partitions,
+    std::function<size_t(const std::vector<flexible_type>&)> partition_fn) {
+  ASSERT_GT(num_partitions, 0);
+  auto column_types = infer_planner_node_type(source);
+  ASSERT_EQ(column_names.size(), column_types.size());
+  for (size_t index: key_column_indices) {
+    if (index >= column_types.size()) {
+      log_and_throw("Partition key column index out of range");
+    }
+  }
+
+  key_partitions ret;
+  ret.partitions.open_for_write(column_names, column_types, "", num_partitions);
+  std::vector<sframe::iterator> outiter_vector;
+  for (size_t i = 0; i < num_partitions; ++i) {
+    outiter_vector.push_back(ret.partitions.get_output_iterator(i));
+  }
+  std::vector<graphlab::mutex> outiter_mutexes(num_partitions);
+
+  // thread local buffers, one writer per partition
+  typedef buffered_writer<std::vector<flexible_type>, sframe::iterator> writer_type;
+  size_t num_threads = thread::cpu_count();
+  std::vector<std::vector<writer_type>> writers(num_threads);
+  for (auto& thread_writers: writers) {
+    for (size_t i = 0; i < num_partitions; ++i) {
+      thread_writers.emplace_back(outiter_vector[i], outiter_mutexes[i],
+                                  SFRAME_WRITER_BUFFER_SOFT_LIMIT,
+                                  SFRAME_WRITER_BUFFER_HARD_LIMIT);
+    }
+  }
+  std::vector<std::vector<size_t>> partition_sizes(
+      num_threads, std::vector<size_t>(num_partitions, 0));
+  std::vector<std::vector<flexible_type>> key_buffers(
+      num_threads, std::vector<flexible_type>(key_column_indices.size()));
+
+  auto partition_callback = [&](size_t segment_id,
+                                const std::shared_ptr<sframe_rows>& data) {
+    auto& keys = key_buffers[segment_id];
+    for (const auto& row: (*data)) {
+      for (size_t i = 0; i < key_column_indices.size(); ++i) {
+        keys[i] = row[key_column_indices[i]];
+      }
+      size_t partition_id = partition_fn(keys);
+      DASSERT_LT(partition_id, num_partitions);
+      ++partition_sizes[segment_id][partition_id];
+      writers[segment_id][partition_id].write(row);
+    }
+    return false;
+  };
+  planner().materialize(source, partition_callback, num_threads);
+
+  for (auto& thread_writers: writers) {
+    for (auto& writer: thread_writers) writer.flush();
+  }
+  ret.partitions.close();
+
+  ret.partition_sizes.assign(num_partitions, 0);
+  for (const auto& thread_sizes: partition_sizes) {
+    for (size_t i = 0; i < num_partitions; ++i) {
+      ret.partition_sizes[i] += thread_sizes[i];
+    }
+  }
+  logstream(LOG_INFO) << "Partitioned " << ret.partitions.num_rows()
+                      << " rows into " << num_partitions
+                      << " partitions, skew " << ret.skew() << std::endl;
+  return ret;
+}
+
+key_partitions hash_partition(
+    std::shared_ptr<planner_node> source,
+    const std::vector<std::string>& column_names,
+    const std::vector<size_t>& key_column_indices,
+    size_t num_partitions) {
+  return partition_by_key(
+      source, column_names, key_column_indices, num_partitions,
+      [num_partitions](const std::vector<flexible_type>& keys) {
+        return hash64(keys) % num_partitions;
+      });
+}
+
+key_partitions range_partition(
+    std::shared_ptr<planner_node> source,
+    const std::vector<std::string>& column_names,
+    const std::vector<size_t>& key_column_indices,
+    const std::vector<std::vector<flexible_type>>& boundaries) {
+  less_than_full_function less_than(std::vector<bool>(key_column_indices.size(), true));
+  for (size_t i = 0; i < boundaries.size(); ++i) {
+    if (boundaries[i].size() != key_column_indices.size()) {
+      log_and_throw("Every partition boundary must have one value per key column");
+    }
+    if (i > 0 && less_than(boundaries[i], boundaries[i - 1])) {
+      log_and_throw("Partition boundaries must be sorted");
+    }
+  }
+  return partition_by_key(
+      source, column_names, key_column_indices, boundaries.size() + 1,
+      [&](const std::vector<flexible_type>& keys) {
+        // the first boundary greater than the key ends its partition
+        return std::distance(boundaries.begin(),
+                             std::upper_bound(boundaries.begin(), boundaries.end(),
+                                              keys, less_than));
+      });
+}
+
+} // end of query_eval
+} // end of graphlab
@@ -0,0 +1,78 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_QUERY_EVAL_PARTITION_BY_KEY_HPP
+#define GRAPHLAB_QUERY_EVAL_PARTITION_BY_KEY_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <flexible_type/flexible_type.hpp>
+#include <sframe/sframe.hpp>
+
+namespace graphlab {
+namespace query_eval {
+
+class planner_node;
+
+/**
+ * The rows of a lazy sframe partitioned by key.
+ */
+struct key_partitions {
+  /// One segment per partition, with the column names and types of the source.
+  sframe partitions;
+
+  /// The number of rows in each partition.
+  std::vector<size_t> partition_sizes;
+
+  /**
+   * The number of rows in the largest partition divided by the mean number
+   * of rows per partition. 1 means the partitions are perfectly balanced.
+   */
+  double skew() const;
+};
+
+/**
+ * Partitions the rows of a lazy sframe by the hash of their key columns.
+ * All the rows with equal keys are written to the same partition.
+ *
+ * The source is streamed through the planner, and is not materialized.
+ * Each thread buffers the rows of every partition, and writes them out in
+ * batches.
+ *
+ * \param source The lazy sframe to be partitioned
+ * \param column_names The column names of the source
+ * \param key_column_indices The key columns
+ * \param num_partitions The number of partitions
+ */
+key_partitions hash_partition(
+    std::shared_ptr<planner_node> source,
+    const std::vector<std::string>& column_names,
+    const std::vector<size_t>& key_column_indices,
+    size_t num_partitions);
+
+/**
+ * Partitions the rows of a lazy sframe by ranges of their key columns.
+ *
+ * boundaries must be sorted ascending, and every boundary has one value per
+ * key column. Partition i gets the rows whose key is in
+ * [boundaries[i-1], boundaries[i]), so there are boundaries.size() + 1
+ * partitions, and every key in partition i is less than the keys of
+ * partition i + 1.
+ *
+ * \see hash_partition
+ */
+key_partitions range_partition(
+    std::shared_ptr<planner_node> source,
+    const std::vector<std::string>& column_names,
+    const std::vector<size_t>& key_column_indices,
+    const std::vector<std::vector<flexible_type>>& boundaries);
+
+} // end of query_eval
+} // end of graphlab
+
+#endif
@@ -8,9 +8,11 @@
 #include <sframe/sframe_rows.hpp>
 #include <sframe/sframe_config.hpp>
 #include <globals/globals.hpp>
+#include <perf/timeline_trace.hpp>
 #include <sframe_query_engine/execution/query_context.hpp>
 #include <sframe_query_engine/execution/execution_node.hpp>
 #include <cppipc/cppipc.hpp>
+#include <chrono>
 
 namespace graphlab {
 namespace query_eval {
@@ -35,6 +37,7 @@ execution_node::execution_node(const std::shared_ptr<query_operator>& op,
 void execution_node::init(const std::shared_ptr<query_operator>& op,
                           const std::vector<std::shared_ptr<execution_node> >& inputs) {
   m_operator = op;
+  m_trace_name = timeline_trace_intern(m_operator->name());
   int num_inputs = m_operator->attributes().num_inputs;
   // num_inputs may be negative if it does not care about the number of inputs.
   if (num_inputs >= 0) {
@@ -177,13 +180,20 @@ std::shared_ptr<sframe_rows> execution_node::get_next(size_t consumer_id, bool s
 
   m_skip_next_block = skip;
 
+  // the coroutine starts running when it is created, so that is timed too
+  profile_counters begin;
+  if (m_profiling) begin = profile_counters::now();
+
   if (m_coroutines_started == false) start_coroutines();
   DASSERT_LT(consumer_id, m_consumer_pos.size());
 
   // consume from source when queue is empty and there is more in source
   while (m_output_queue->empty(consumer_id) && m_source) {
+    TIMELINE_TRACE_SCOPE("query", m_trace_name);
     m_source();
   }
+
+  if (m_profiling) m_total_counters.add_interval(begin, profile_counters::now());
   // end of data
   if (m_output_queue->empty(consumer_id) && !m_source) return nullptr;
 
@@ -198,13 +208,70 @@ std::shared_ptr<sframe_rows> execution_node::get_next(size_t consumer_id, bool s
 }
 
 void execution_node::add_operator_output(const std::shared_ptr<sframe_rows>& rows) {
+  if (m_profiling && rows != nullptr) {
+    m_rows_out += rows->num_rows();
+    ++m_blocks_out;
+  }
   m_output_queue->push(rows);
 }
 
 std::shared_ptr<sframe_rows> execution_node::get_next_from_input(size_t input_id, bool skip) {
   ASSERT_LT(input_id, m_inputs.size());
   auto& input = m_inputs[input_id];
-  return input.m_node->get_next(input.m_consumer_id, skip);
+  if (!m_profiling) return input.m_node->get_next(input.m_consumer_id, skip);
+
+  auto begin = profile_counters::now();
+  auto ret = input.m_node->get_next(input.m_consumer_id, skip);
+  m_input_counters.add_interval(begin, profile_counters::now());
+  if (ret != nullptr) {
+    m_rows_in += ret->num_rows();
+    ++m_blocks_in;
+  }
+  return ret;
+}
+
+void execution_node::enable_profiling() {
+  m_profiling = true;
+}
+
+operator_profile execution_node::get_profile() const {
+  operator_profile ret;
+  ret.name = m_operator->name();
+  ret.num_instances = 1;
+  // the work done by the inputs is a part of the total. The subtractions
+  // cannot underflow.
+  ret.wall_time = (m_total_counters.wall_nanoseconds -
+                   m_input_counters.wall_nanoseconds) * 1e-9;
+  ret.cpu_time = (m_total_counters.cpu_nanoseconds -
+                  m_input_counters.cpu_nanoseconds) * 1e-9;
+  thread_counters io = m_total_counters.io;
+  io -= m_input_counters.io;
+  ret.blocks_read = io.blocks_read;
+  ret.bytes_decompressed = io.bytes_decompressed;
+  ret.bytes_written = io.bytes_written;
+  ret.lambda_time = io.lambda_nanoseconds * 1e-9;
+  ret.rows_in = m_rows_in;
+  ret.blocks_in = m_blocks_in;
+  ret.rows_out = m_rows_out;
+  ret.blocks_out = m_blocks_out;
+  return ret;
+}
+
+execution_node::profile_counters execution_node::profile_counters::now() {
+  profile_counters ret;
+  ret.wall_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  ret.cpu_nanoseconds = thread_cpu_time_nanoseconds();
+  ret.io = get_thread_counters();
+  return ret;
+}
+
+void execution_node::profile_counters::add_interval(const profile_counters& begin,
+                                                    const profile_counters& end) {
+  wall_nanoseconds += end.wall_nanoseconds - begin.wall_nanoseconds;
+  cpu_nanoseconds += end.cpu_nanoseconds - begin.cpu_nanoseconds;
+  io += end.io;
+  io -= begin.io;
 }
 
 size_t execution_node::register_consumer() {
@@ -13,7 +13,9 @@
 #include <queue>
 #include <boost/coroutine/coroutine.hpp>
 #include <flexible_type/flexible_type.hpp>
+#include <perf/thread_counters.hpp>
 #include <sframe_query_engine/operators/operator.hpp>
+#include <sframe_query_engine/execution/query_profile.hpp>
 #include <sframe_query_engine/util/broadcast_queue.hpp>
 
 namespace graphlab { 
@@ -214,7 +216,33 @@ class execution_node  : public std::enable_shared_from_this<execution_node> {
   std::exception_ptr get_exception() const {
     return m_exception;
   }
+
+  /**
+   * Enables collection of the profile of this node (see get_profile()).
+   * Must be called before the first call to get_next().
+   */
+  void enable_profiling();
+
+  /**
+   * Returns the times and counters of the operator, excluding the work done
+   * by its inputs. The inputs field of the returned profile is left empty.
+   * Everything is 0 unless enable_profiling() was called.
+   */
+  operator_profile get_profile() const;
  private:
+  /**
+   * A snapshot of the clocks and \ref thread_counters of the calling thread.
+   */
+  struct profile_counters {
+    uint64_t wall_nanoseconds = 0;
+    uint64_t cpu_nanoseconds = 0;
+    thread_counters io;
+
+    static profile_counters now();
+    /// Adds the difference between two snapshots
+    void add_interval(const profile_counters& begin, const profile_counters& end);
+  };
+
   /**
    * Internal function used to add to the operator output
    */
@@ -256,10 +284,24 @@ class execution_node  : public std::enable_shared_from_this<execution_node> {
   /// m_consumer_pos[i] is the ID which consumer i is consuming next.
   std::vector<size_t> m_consumer_pos;
 
+  /// The operator name, as traced on the timeline (see \ref timeline_scope)
+  const char* m_trace_name = nullptr;
+
   /// exception handling
   bool m_exception_occured = false;
   std::exception_ptr m_exception;
 
+  /// profiling
+  bool m_profiling = false;
+  /// work done in get_next(), including the work done by the inputs
+  profile_counters m_total_counters;
+  /// work done by the inputs
+  profile_counters m_input_counters;
+  uint64_t m_rows_in = 0;
+  uint64_t m_blocks_in = 0;
+  uint64_t m_rows_out = 0;
+  uint64_t m_blocks_out = 0;
+
   friend class query_context;
 };
 
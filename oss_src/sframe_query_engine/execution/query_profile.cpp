@@ -0,0 +1,221 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <deque>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+#include <logger/assertions.hpp>
+#include <globals/globals.hpp>
+#include <metric/metrics_server.hpp>
+#include <sframe_query_engine/execution/query_profile.hpp>
+
+namespace graphlab {
+namespace query_eval {
+
+size_t SFRAME_QUERY_PROFILING = 0;
+size_t SFRAME_QUERY_PROFILE_HISTORY = 16;
+
+REGISTER_GLOBAL(int64_t, SFRAME_QUERY_PROFILING, true);
+REGISTER_GLOBAL(int64_t, SFRAME_QUERY_PROFILE_HISTORY, true);
+
+void operator_profile::merge(const operator_profile& other) {
+  if (num_instances == 0) {
+    name = other.name;
+    inputs = other.inputs;
+  }
+  num_instances += other.num_instances;
+  wall_time += other.wall_time;
+  cpu_time += other.cpu_time;
+  rows_in += other.rows_in;
+  blocks_in += other.blocks_in;
+  rows_out += other.rows_out;
+  blocks_out += other.blocks_out;
+  blocks_read += other.blocks_read;
+  bytes_decompressed += other.bytes_decompressed;
+  bytes_written += other.bytes_written;
+  lambda_time += other.lambda_time;
+}
+
+void stage_profile::merge_segment(const std::vector<operator_profile>& segment_operators) {
+  if (operators.empty()) operators.resize(segment_operators.size());
+  ASSERT_EQ(operators.size(), segment_operators.size());
+  for (size_t i = 0; i < operators.size(); ++i) {
+    operators[i].merge(segment_operators[i]);
+  }
+  ++num_segments;
+}
+
+void query_profile::add_stage(const stage_profile& stage) {
+  std::lock_guard<mutex> guard(m_lock);
+  m_stages.push_back(stage);
+}
+
+std::vector<stage_profile> query_profile::stages() const {
+  std::lock_guard<mutex> guard(m_lock);
+  return m_stages;
+}
+
+void query_profile::set_plan(const std::string& plan) {
+  std::lock_guard<mutex> guard(m_lock);
+  m_plan = plan;
+}
+
+std::string query_profile::plan() const {
+  std::lock_guard<mutex> guard(m_lock);
+  return m_plan;
+}
+
+void query_profile::set_wall_time(double wall_time) {
+  std::lock_guard<mutex> guard(m_lock);
+  m_wall_time = wall_time;
+}
+
+double query_profile::wall_time() const {
+  std::lock_guard<mutex> guard(m_lock);
+  return m_wall_time;
+}
+
+std::string query_profile::to_string() const {
+  std::stringstream strm;
+  auto all_stages = stages();
+  strm << "Query profile: " << all_stages.size() << " stages, "
+       << wall_time() << "s" << std::endl;
+  for (size_t s = 0; s < all_stages.size(); ++s) {
+    const stage_profile& stage = all_stages[s];
+    strm << "Stage " << s << ": " << stage.num_segments << " segments, "
+         << stage.wall_time << "s, " << stage.rows_out << " rows, "
+         << stage.bytes_written << " bytes written" << std::endl;
+    strm << std::setw(10) << "wall(s)"
+         << std::setw(10) << "cpu(s)"
+         << std::setw(10) << "lambda(s)"
+         << std::setw(12) << "rows in"
+         << std::setw(12) << "rows out"
+         << std::setw(10) << "blocks"
+         << std::setw(14) << "decompressed"
+         << std::setw(12) << "written"
+         << "  operator" << std::endl;
+    if (stage.operators.empty()) continue;
+
+    // print the tip first, with the inputs of each operator indented below it
+    std::function<void(size_t, size_t)> print_operator =
+        [&](size_t id, size_t depth) {
+      const operator_profile& op = stage.operators[id];
+      strm << std::fixed << std::setprecision(3)
+           << std::setw(10) << op.wall_time
+           << std::setw(10) << op.cpu_time
+           << std::setw(10) << op.lambda_time
+           << std::setw(12) << op.rows_in
+           << std::setw(12) << op.rows_out
+           << std::setw(10) << op.blocks_read
+           << std::setw(14) << op.bytes_decompressed
+           << std::setw(12) << op.bytes_written
+           << "  " << std::string(2 * depth, ' ') << op.name << std::endl;
+      strm.unsetf(std::ios_base::floatfield);
+      for (size_t input: op.inputs) print_operator(input, depth + 1);
+    };
+    print_operator(stage.operators.size() - 1, 0);
+  }
+  return strm.str();
+}
+
+static std::string json_escape(const std::string& s) {
+  std::stringstream strm;
+  strm << '"';
+  for (char c: s) {
+    if (c == '"' || c == '\\') {
+      strm << '\\' << c;
+    } else if ((unsigned char)c < 0x20) {
+      strm << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c
+           << std::dec << std::setfill(' ');
+    } else {
+      strm << c;
+    }
+  }
+  strm << '"';
+  return strm.str();
+}
+
+std::string query_profile::to_json() const {
+  std::stringstream strm;
+  auto all_stages = stages();
+  strm << "{\"plan\":" << json_escape(plan())
+       << ",\"wall_time\":" << wall_time()
+       << ",\"stages\":[";
+  for (size_t s = 0; s < all_stages.size(); ++s) {
+    const stage_profile& stage = all_stages[s];
+    if (s > 0) strm << ",";
+    strm << "{\"num_segments\":" << stage.num_segments
+         << ",\"wall_time\":" << stage.wall_time
+         << ",\"rows_out\":" << stage.rows_out
+         << ",\"bytes_written\":" << stage.bytes_written
+         << ",\"operators\":[";
+    for (size_t i = 0; i < stage.operators.size(); ++i) {
+      const operator_profile& op = stage.operators[i];
+      if (i > 0) strm << ",";
+      strm << "{\"name\":" << json_escape(op.name) << ",\"inputs\":[";
+      for (size_t j = 0; j < op.inputs.size(); ++j) {
+        if (j > 0) strm << ",";
+        strm << op.inputs[j];
+      }
+      strm << "],\"num_instances\":" << op.num_instances
+           << ",\"wall_time\":" << op.wall_time
+           << ",\"cpu_time\":" << op.cpu_time
+           << ",\"rows_in\":" << op.rows_in
+           << ",\"blocks_in\":" << op.blocks_in
+           << ",\"rows_out\":" << op.rows_out
+           << ",\"blocks_out\":" << op.blocks_out
+           << ",\"blocks_read\":" << op.blocks_read
+           << ",\"bytes_decompressed\":" << op.bytes_decompressed
+           << ",\"bytes_written\":" << op.bytes_written
+           << ",\"lambda_time\":" << op.lambda_time << "}";
+    }
+    strm << "]}";
+  }
+  strm << "]}";
+  return strm.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static mutex published_profiles_lock;
+static std::deque<std::shared_ptr<query_profile>> published_profiles;
+static bool metric_server_callback_added = false;
+
+static std::pair<std::string, std::string>
+query_profiles_json(std::map<std::string, std::string>& varmap) {
+  std::stringstream strm;
+  strm << "[";
+  auto profiles = get_published_query_profiles();
+  for (size_t i = 0; i < profiles.size(); ++i) {
+    if (i > 0) strm << ",";
+    strm << profiles[i]->to_json();
+  }
+  strm << "]";
+  return std::make_pair(std::string("application/json"), strm.str());
+}
+
+void publish_query_profile(const std::shared_ptr<query_profile>& profile) {
+  std::lock_guard<mutex> guard(published_profiles_lock);
+  if (!metric_server_callback_added) {
+    add_metric_server_callback("query_profiles.json", query_profiles_json);
+    metric_server_callback_added = true;
+  }
+  published_profiles.push_back(profile);
+  while (published_profiles.size() > SFRAME_QUERY_PROFILE_HISTORY) {
+    published_profiles.pop_front();
+  }
+}
+
+std::vector<std::shared_ptr<query_profile>> get_published_query_profiles() {
+  std::lock_guard<mutex> guard(published_profiles_lock);
+  return std::vector<std::shared_ptr<query_profile>>(published_profiles.begin(),
+                                                     published_profiles.end());
+}
+
+} // query_eval
+} // graphlab
@@ -0,0 +1,150 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_SFRAME_QUERY_ENGINE_EXECUTION_QUERY_PROFILE_HPP
+#define GRAPHLAB_SFRAME_QUERY_ENGINE_EXECUTION_QUERY_PROFILE_HPP
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <parallel/mutex.hpp>
+
+namespace graphlab {
+namespace query_eval {
+
+/**
+ * The profile of one operator of an executed plan.
+ *
+ * All times and counters exclude the work done by the inputs of the
+ * operator: the time spent by a transform does not include the time spent
+ * reading its source.
+ */
+struct operator_profile {
+  /// The operator name
+  std::string name;
+  /// The positions of the inputs of the operator in stage_profile::operators
+  std::vector<size_t> inputs;
+  /// The number of operator instances merged (one per parallel segment)
+  size_t num_instances = 0;
+  /// Wall clock time in seconds
+  double wall_time = 0;
+  /// CPU time in seconds
+  double cpu_time = 0;
+  /// Rows and blocks of rows read from the inputs
+  uint64_t rows_in = 0;
+  uint64_t blocks_in = 0;
+  /// Rows and blocks of rows emitted
+  uint64_t rows_out = 0;
+  uint64_t blocks_out = 0;
+  /// sarray blocks read from disk
+  uint64_t blocks_read = 0;
+  /// Bytes produced by decompressing sarray blocks
+  uint64_t bytes_decompressed = 0;
+  /// Bytes of sarray blocks written, for instance by operators which spill
+  uint64_t bytes_written = 0;
+  /// Time spent waiting for lambda workers in seconds
+  double lambda_time = 0;
+
+  /// Adds the times and counters of another instance of the operator
+  void merge(const operator_profile& other);
+};
+
+/**
+ * The profile of one execution of a plan by the \ref subplan_executor.
+ * Materializing a query may take several stages, since plans which cannot
+ * be executed in one pass are partially materialized first.
+ */
+struct stage_profile {
+  /**
+   * The operators of the plan. Inputs come before the operators which
+   * consume them, so the last operator is the tip of the plan.
+   */
+  std::vector<operator_profile> operators;
+  /// The number of parallel segments the plan was executed in
+  size_t num_segments = 0;
+  /// Wall clock time in seconds
+  double wall_time = 0;
+  /// Rows written to the output of the stage
+  uint64_t rows_out = 0;
+  /// Bytes of sarray blocks written to the output of the stage
+  uint64_t bytes_written = 0;
+
+  /**
+   * Adds the profile of one segment of the plan. All the segments of a
+   * stage execute the same plan, so operators are matched by position.
+   */
+  void merge_segment(const std::vector<operator_profile>& segment_operators);
+};
+
+/**
+ * The profile of a materialization (see \ref materialize_options::profile).
+ *
+ * Safe for concurrent use.
+ */
+class query_profile {
+ public:
+  /// Appends a stage to the profile
+  void add_stage(const stage_profile& stage);
+
+  /// Returns the stages in the order they completed
+  std::vector<stage_profile> stages() const;
+
+  /// Sets the description of the materialized plan
+  void set_plan(const std::string& plan);
+
+  /// Returns the description of the materialized plan
+  std::string plan() const;
+
+  /// Sets the total wall clock time of the materialization in seconds
+  void set_wall_time(double wall_time);
+
+  /// Returns the total wall clock time of the materialization in seconds
+  double wall_time() const;
+
+  /**
+   * Returns the profile as a table with one line per operator, with the
+   * inputs of each operator indented below it.
+   */
+  std::string to_string() const;
+
+  /// Returns the profile as a JSON object
+  std::string to_json() const;
+
+ private:
+  mutable mutex m_lock;
+  std::string m_plan;
+  double m_wall_time = 0;
+  std::vector<stage_profile> m_stages;
+};
+
+/**
+ * Enables profiling of every materialization. The most recent profiles are
+ * served by the metrics server on the "query_profiles.json" page.
+ */
+extern size_t SFRAME_QUERY_PROFILING;
+
+/**
+ * The number of profiles kept for the "query_profiles.json" metrics server page.
+ */
+extern size_t SFRAME_QUERY_PROFILE_HISTORY;
+
+/**
+ * Adds a profile to the profiles served on the "query_profiles.json" metrics
+ * server page, evicting the oldest profile when there are more than
+ * SFRAME_QUERY_PROFILE_HISTORY.
+ */
+void publish_query_profile(const std::shared_ptr<query_profile>& profile);
+
+/**
+ * Returns the profiles served on the "query_profiles.json" metrics server page,
+ * oldest first.
+ */
+std::vector<std::shared_ptr<query_profile>> get_published_query_profiles();
+
+} // query_eval
+} // graphlab
+#endif
@@ -6,6 +6,8 @@
  * of the BSD license. See the LICENSE file for details.
  */
 #include <parallel/lambda_omp.hpp>
+#include <timer/timer.hpp>
+#include <perf/thread_counters.hpp>
 #include <sframe_query_engine/execution/subplan_executor.hpp>
 #include <sframe_query_engine/execution/execution_node.hpp>
 #include <sframe_query_engine/operators/operator_properties.hpp> 
@@ -82,22 +84,59 @@ find_earliest_exception(std::shared_ptr<execution_node> tip,
   }
 }
 
+/**
+ * Numbers the execution nodes reachable from tip so that inputs come before
+ * the nodes consuming them.
+ */
+static size_t number_execution_nodes(
+    const std::shared_ptr<execution_node>& tip,
+    std::map<std::shared_ptr<execution_node>, size_t>& ids,
+    std::vector<std::shared_ptr<execution_node>>& nodes) {
+  auto iter = ids.find(tip);
+  if (iter != ids.end()) return iter->second;
+  for (size_t i = 0;i < tip->num_inputs(); ++i) {
+    number_execution_nodes(tip->get_input_node(i), ids, nodes);
+  }
+  nodes.push_back(tip);
+  ids[tip] = nodes.size() - 1;
+  return nodes.size() - 1;
+}
+
 void subplan_executor::generate_to_callback_function(
     const std::shared_ptr<planner_node>& plan,
     size_t output_segment_id,
-    execution_callback out_function) {
+    execution_callback out_function,
+    stage_profile* profile) {
 
   std::map<std::shared_ptr<planner_node>, std::shared_ptr<execution_node> > memo;
   std::shared_ptr<execution_node> ex_op = get_executor(plan, memo);
+  // the operators run on this thread
+  thread_counters_scope counters_scope(profile != nullptr);
+  if (profile != nullptr) {
+    for (auto& node: memo) node.second->enable_profiling();
+  }
 
   size_t consumer_id = ex_op->register_consumer();
 
+  // work done by the output callback
+  uint64_t rows_out = 0;
+  thread_counters output_counters;
+
   while(1) {
     auto rows = ex_op->get_next(consumer_id);
     if (rows == nullptr)
       break;
 
-    bool done = out_function(output_segment_id, rows);
+    bool done = false;
+    if (profile != nullptr) {
+      rows_out += rows->num_rows();
+      thread_counters begin = get_thread_counters();
+      done = out_function(output_segment_id, rows);
+      output_counters += get_thread_counters();
+      output_counters -= begin;
+    } else {
+      done = out_function(output_segment_id, rows);
+    }
     if(done)
       break;
   }
@@ -115,11 +154,29 @@ void subplan_executor::generate_to_callback_function(
     auto earliest_exception = find_earliest_exception(ex_op, memo);
     std::rethrow_exception(earliest_exception);
   }
+
+  if (profile != nullptr) {
+    std::map<std::shared_ptr<execution_node>, size_t> ids;
+    std::vector<std::shared_ptr<execution_node>> nodes;
+    number_execution_nodes(ex_op, ids, nodes);
+    std::vector<operator_profile> operators(nodes.size());
+    for (size_t i = 0;i < nodes.size(); ++i) {
+      operators[i] = nodes[i]->get_profile();
+      for (size_t j = 0;j < nodes[i]->num_inputs(); ++j) {
+        operators[i].inputs.push_back(ids.at(nodes[i]->get_input_node(j)));
+      }
+    }
+    std::lock_guard<mutex> guard(m_profile_lock);
+    profile->merge_segment(operators);
+    profile->rows_out += rows_out;
+    profile->bytes_written += output_counters.bytes_written;
+  }
 }
 
 void subplan_executor::generate_to_sframe_segment(const std::shared_ptr<planner_node>& plan,
                                           sframe& out,
-                                          size_t output_segment_id) {
+                                          size_t output_segment_id,
+                                          stage_profile* profile) {
 
   auto outiter = out.get_output_iterator(output_segment_id);
 
@@ -128,26 +185,45 @@ void subplan_executor::generate_to_sframe_segment(const std::shared_ptr<planner_
       [&](size_t segment_idx, const std::shared_ptr<sframe_rows>& rows) {
         (*outiter) = *rows;
         return false;
-      });
+      },
+      profile);
 }
 
+/**
+ * Closes an output sframe, adding the bytes written while closing to
+ * the profile if there is one.
+ */
+static void close_output_sframe(sframe& out, stage_profile* profile) {
+  thread_counters_scope counters_scope(profile != nullptr);
+  thread_counters begin = get_thread_counters();
+  out.close();
+  if (profile != nullptr) {
+    profile->bytes_written += get_thread_counters().bytes_written - begin.bytes_written;
+  }
+}
 
 sframe subplan_executor::run(const std::shared_ptr<planner_node>& pnode,
                              const materialize_options& exec_params) {
+  stage_profile stage;
+  stage_profile* profile = exec_params.profile != nullptr ? &stage : nullptr;
+  timer ti;
 
+  sframe ret;
   if(exec_params.write_callback != nullptr) {
-    generate_to_callback_function(pnode, 0, exec_params.write_callback);
-
-    sframe ret;
-    return ret;
+    generate_to_callback_function(pnode, 0, exec_params.write_callback, profile);
   } else {
-    sframe out = get_output_sframe_schema(pnode, 
-                                          1, // just 1 segment will do
-                                          exec_params.output_index_file); 
-    generate_to_sframe_segment(pnode, out, 0);
-    out.close();
-    return out;
+    ret = get_output_sframe_schema(pnode, 
+                                   1, // just 1 segment will do
+                                   exec_params.output_index_file); 
+    generate_to_sframe_segment(pnode, ret, 0, profile);
+    close_output_sframe(ret, profile);
+  }
+
+  if (profile != nullptr) {
+    stage.wall_time = ti.current_time();
+    exec_params.profile->add_stage(stage);
   }
+  return ret;
 }
 
 std::vector<sframe> subplan_executor::run(
@@ -173,30 +249,37 @@ sframe subplan_executor::run_concat(
     return ret;
   }
 
+  stage_profile stage;
+  stage_profile* profile = exec_params.profile != nullptr ? &stage : nullptr;
+  timer ti;
+
+  // an empty sframe is returned when there is a callback
+  sframe ret;
   if(exec_params.write_callback != nullptr) {
     execution_callback exec_f = exec_params.write_callback;
 
     parallel_for(0, stuff_to_run_in_parallel.size(), [&](size_t i) {
-        generate_to_callback_function(stuff_to_run_in_parallel[i], i, exec_f);
+        generate_to_callback_function(stuff_to_run_in_parallel[i], i, exec_f, profile);
       });
-
-    // make an empty sframe and return
-    sframe ret;
-    return ret;
   } else {
 
-    sframe ret = get_output_sframe_schema(stuff_to_run_in_parallel[0],
-                                          stuff_to_run_in_parallel.size(),
-                                          exec_params.output_index_file,
-                                          exec_params.output_column_names);
+    ret = get_output_sframe_schema(stuff_to_run_in_parallel[0],
+                                   stuff_to_run_in_parallel.size(),
+                                   exec_params.output_index_file,
+                                   exec_params.output_column_names);
 
     parallel_for(0, stuff_to_run_in_parallel.size(), [&](size_t i) {
-        generate_to_sframe_segment(stuff_to_run_in_parallel[i], ret, i);
+        generate_to_sframe_segment(stuff_to_run_in_parallel[i], ret, i, profile);
       });
 
-    ret.close();
-    return ret;
+    close_output_sframe(ret, profile);
+  }
+
+  if (profile != nullptr) {
+    stage.wall_time = ti.current_time();
+    exec_params.profile->add_stage(stage);
   }
+  return ret;
 }
 
 }}
@@ -12,7 +12,9 @@
 #include <memory>
 #include <functional>
 #include <sframe/sframe.hpp>
+#include <parallel/mutex.hpp>
 #include <sframe_query_engine/planning/materialize_options.hpp>
+#include <sframe_query_engine/execution/query_profile.hpp>
 
 namespace graphlab { namespace query_eval {
 
@@ -84,19 +86,26 @@ class subplan_executor {
  /** 
   * \internal
   * Runs a single job sequentially to a single sframe segment. 
+  * If profile is not null, the profile of the job is added to it.
   */
   void generate_to_sframe_segment(const std::shared_ptr<planner_node>& run_this,
                                   sframe& out, 
-                                  size_t output_segment_id);
+                                  size_t output_segment_id,
+                                  stage_profile* profile = nullptr);
 
   /**
    * \internal
    * Runs a single job sequentially, calling the callback on each output.
+   * If profile is not null, the profile of the job is added to it.
    */
   void generate_to_callback_function(
     const std::shared_ptr<planner_node>& plan,
     size_t output_segment_id,
-    execution_callback out_f);
+    execution_callback out_f,
+    stage_profile* profile = nullptr);
+
+  /// Protects the stage profile updated by concurrent segments
+  mutex m_profile_lock;
 };
 
 }}
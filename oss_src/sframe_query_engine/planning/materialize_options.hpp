@@ -16,6 +16,7 @@
 namespace graphlab {
 class sframe_rows;
 namespace query_eval {
+class query_profile;
 
 /**  
  * Materialization options.
@@ -89,6 +90,13 @@ struct materialize_options {
    * This argument has no effect if \ref write_callback is set.
    */
   std::vector<std::string> output_column_names;
+
+  /**
+   * If set, the materialization is profiled: the times and counters of
+   * every operator executed are added to the profile. Profiling is also
+   * enabled for all materializations when SFRAME_QUERY_PROFILING is set.
+   */
+  std::shared_ptr<query_profile> profile;
 };
 
 } // query_eval
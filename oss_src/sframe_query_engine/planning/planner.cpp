@@ -9,12 +9,14 @@
 #include <sframe_query_engine/execution/execution_node.hpp>
 #include <sframe_query_engine/planning/planner_node.hpp>
 #include <sframe_query_engine/execution/subplan_executor.hpp> 
+#include <sframe_query_engine/execution/query_profile.hpp>
 #include <sframe_query_engine/operators/operator_transformations.hpp>
 #include <sframe_query_engine/operators/all_operators.hpp>
 #include <sframe_query_engine/planning/planner.hpp>
 #include <sframe_query_engine/planning/optimization_engine.hpp>
 #include <sframe_query_engine/query_engine_lock.hpp>
 #include <globals/globals.hpp>
+#include <timer/timer.hpp>
 #include <sframe/sframe.hpp>
 
 namespace graphlab { namespace query_eval {
@@ -247,6 +249,10 @@ sframe planner::materialize(pnode_ptr ptip,
   if (exec_params.num_segments == 0) {
     exec_params.num_segments = thread::cpu_count();
   }
+  if (exec_params.profile == nullptr && SFRAME_QUERY_PROFILING) {
+    exec_params.profile = std::make_shared<query_profile>();
+  }
+  timer ti;
   auto original_ptip = ptip;
   // Optimize Query Plan
   if (!is_source_node(ptip)) {
@@ -258,6 +264,11 @@ sframe planner::materialize(pnode_ptr ptip,
       logstream(LOG_INFO) << "Optimized As: " << ptip << std::endl;
     }
   }
+  if (exec_params.profile != nullptr) {
+    std::stringstream plan;
+    plan << ptip;
+    exec_params.profile->set_plan(plan.str());
+  }
 
   ////////////////////////////////////////////////////////////////////////////////
   // Execute stuff.
@@ -275,16 +286,23 @@ sframe planner::materialize(pnode_ptr ptip,
   }
   logstream(LOG_INFO) << "Reduced plan: " << final_node << std::endl;
 
+  sframe ret_sf;
   if (exec_params.write_callback == nullptr) {
     // no write callback
     // Rewrite the query node to be materialized source node
-    auto ret_sf = execute_node(final_node, exec_params);
+    ret_sf = execute_node(final_node, exec_params);
     (*original_ptip) = (*(op_sframe_source::make_planner_node(ret_sf)));
-    return ret_sf;
   } else {
     // there is a callback. push it through to execute parameters.
-    return execute_node(final_node, exec_params);
+    ret_sf = execute_node(final_node, exec_params);
+  }
+
+  if (exec_params.profile != nullptr) {
+    exec_params.profile->set_wall_time(ti.current_time());
+    logstream(LOG_INFO) << exec_params.profile->to_string();
+    publish_query_profile(exec_params.profile);
   }
+  return ret_sf;
 }
 
 void planner::materialize(std::shared_ptr<planner_node> tip, 
@@ -12,9 +12,9 @@
 #include <sframe/sarray_sorted_buffer.hpp>
 #include <sframe/sarray_reader_buffer.hpp>
 #include <sframe/sframe_saving.hpp>
+#include <sframe/sframe_constants.hpp>
 #include <atomic>
 #include <timer/timer.hpp>
-#include <sparsehash/sparse_hash_set>
 
 /**
  * Specialization of hash of pairs.
@@ -64,6 +64,7 @@ void sgraph::init(size_t num_partitions) {
   for (auto& sf : m_vertex_groups[0]) {
     init_empty_sframe(sf, {VID_COLUMN_NAME}, {m_vid_type});
   }
+  m_vid_index.push_back(std::vector<sgraph_vid_index>(m_num_partitions));
 
   // create a vector of m_num_partitions*m_num_partitions sframes for each edge group
   m_edge_groups.insert({{0,0},
@@ -86,6 +87,11 @@ void sgraph::bootstrap_vertex_id_type(flex_type_enum id_type) {
       init_empty_sframe(sf, {VID_COLUMN_NAME}, {m_vid_type});
     }
   }
+  for (auto& g: m_vid_index) {
+    for (auto& index : g) {
+      index.clear();
+    }
+  }
   for (auto& g: m_edge_groups) {
     for (auto& sf : g.second) {
       init_empty_sframe(sf, {SRC_COLUMN_NAME, DST_COLUMN_NAME}, 
@@ -101,6 +107,7 @@ void sgraph::increase_number_of_groups(size_t num_groups) {
     for (auto& sf : m_vertex_groups[i]) {
       init_empty_sframe(sf, {VID_COLUMN_NAME}, {m_vid_type});
     }
+    m_vid_index.push_back(std::vector<sgraph_vid_index>(m_num_partitions));
 
     for (size_t from_group = 0; from_group < num_groups; ++from_group) {
       for (size_t to_group = 0; to_group < num_groups; ++to_group) {
@@ -358,77 +365,135 @@ sframe sgraph::get_edges(const std::vector<flexible_type>& source_vids,
           out_sframe.close();
           out_edge_blocks[i * m_num_partitions + j] = std::move(out_sframe);
         });
-  // Case 2: reorganize the id constraints into partitions.
+  // Case 2: locate the constrained vertices with the vertex id index and
+  // only scan the edge partitions which may contain matching edges.
   } else {
-    // separate the source/target vertices that are matching wildcards.
-    std::vector<std::unordered_set<flexible_type>> wild_source_vids(m_num_partitions);
-    std::vector<std::unordered_set<flexible_type>> wild_target_vids(m_num_partitions);
-    // normal source target id constraints:  map from (src_partition, dst_partition) -> set<(src_id, dst_id>
-    std::unordered_map<std::pair<size_t, size_t>, std::unordered_set<std::pair<flexible_type, flexible_type>>>
-      vid_constraints;
+    std::vector<std::pair<size_t, size_t>> source_addresses = find_vertices(source_vids, groupa);
+    std::vector<std::pair<size_t, size_t>> target_addresses = find_vertices(target_vids, groupb);
+
+    // separate the source/target rows that are matching wildcards.
+    std::vector<std::unordered_set<size_t>> wild_source_rows(m_num_partitions);
+    std::vector<std::unordered_set<size_t>> wild_target_rows(m_num_partitions);
+    // normal source target row constraints:  map from (src_partition, dst_partition) -> set<(src_row, dst_row>
+    std::unordered_map<std::pair<size_t, size_t>, std::unordered_set<std::pair<size_t, size_t>>>
+      row_constraints;
+
+    for (size_t i = 0; i < source_vids.size(); ++i) {
+      const auto& source = source_addresses[i];
+      const auto& target = target_addresses[i];
+      bool source_found = source.second != sgraph_vid_index::NOT_FOUND;
+      bool target_found = target.second != sgraph_vid_index::NOT_FOUND;
+      if (source_vids[i].get_type() == flex_type_enum::UNDEFINED) {
+        if (target_found) wild_target_rows[target.first].insert(target.second);
+      } else if (target_vids[i].get_type() == flex_type_enum::UNDEFINED) {
+        if (source_found) wild_source_rows[source.first].insert(source.second);
+      } else if (source_found && target_found) {
+        row_constraints[{source.first, target.first}].insert({source.second, target.second});
+      }
+    }
+
+    std::vector<std::pair<size_t, size_t>> coordinates;
     for (size_t i = 0; i < m_num_partitions; ++i) {
       for (size_t j = 0; j < m_num_partitions; ++j) {
-        vid_constraints[{i,j}] = {};
+        if (!wild_source_rows[i].empty() || !wild_target_rows[j].empty() ||
+            row_constraints.count({i, j})) {
+          coordinates.push_back({i, j});
+        }
       }
     }
 
-    for (size_t i = 0; i < source_vids.size(); ++i) {
-      const flexible_type& source = source_vids[i];
-      const flexible_type& target = target_vids[i];
-      size_t source_pid = source.hash() % m_num_partitions;
-      size_t target_pid = target.hash() % m_num_partitions;
-      if (source.get_type() == flex_type_enum::UNDEFINED) {
-        wild_target_vids[target_pid].insert(target);
-      } else if (target.get_type() == flex_type_enum::UNDEFINED) {
-        wild_source_vids[source_pid].insert(source);
-      } else {
-        vid_constraints[{source_pid, target_pid}].insert({source, target});
+    // Filter the edges, still addressed by row ids.
+    std::vector<sframe> matched_edges(coordinates.size());
+    parallel_for(0, coordinates.size(), [&](size_t k) {
+      size_t i = coordinates[k].first;
+      size_t j = coordinates[k].second;
+      sframe edge_sframe = edge_partition(i, j, groupa, groupb);
+      auto iter = row_constraints.find({i, j});
+      const std::unordered_set<std::pair<size_t, size_t>>* pair_constraint =
+          (iter == row_constraints.end()) ? NULL : &(iter->second);
+
+      // The filter function checks the id constraints and then value constraints
+      std::function<bool(const std::vector<flexible_type>&)> filter_fn =
+          [&](const std::vector<flexible_type>& row) {
+            size_t src_idx = row[src_column_idx];
+            size_t dst_idx = row[dst_column_idx];
+            if (wild_source_rows[i].count(src_idx) ||
+                wild_target_rows[j].count(dst_idx) ||
+                (pair_constraint && pair_constraint->count({src_idx, dst_idx}))) {
+              return satisfy_value_constraint(row);
+            }
+            return false;
+          };
+
+      sframe out_sframe;
+      out_sframe.open_for_write(edge_sframe.column_names(), edge_sframe.column_types(),
+                                "", edge_sframe.num_segments());
+      copy_if(edge_sframe, out_sframe, filter_fn);
+      out_sframe.close();
+      matched_edges[k] = std::move(out_sframe);
+    });
+
+    // Fetch the vertex ids of the rows referenced by the matched edges only.
+    std::vector<std::set<size_t>> src_rows(m_num_partitions);
+    std::vector<std::set<size_t>> dst_rows(m_num_partitions);
+    for (size_t k = 0; k < coordinates.size(); ++k) {
+      std::vector<std::vector<flexible_type>> rows;
+      matched_edges[k].select_columns({SRC_COLUMN_NAME, DST_COLUMN_NAME})
+          .get_reader()->read_rows(0, matched_edges[k].size(), rows);
+      for (const auto& row : rows) {
+        src_rows[coordinates[k].first].insert(row[0].get<flex_int>());
+        dst_rows[coordinates[k].second].insert(row[1].get<flex_int>());
       }
     }
-    sgraph_compute::hilbert_blocked_parallel_for(
-        get_num_partitions(),
-        load_partition_vids,
-        [&](std::pair<size_t, size_t> coordinate) {
-        size_t i = coordinate.first;
-        size_t j = coordinate.second;
-        const std::vector<flexible_type>& src_partition_vids = partition_vid_cache.at({i, groupa});
-        const std::vector<flexible_type>& dst_partition_vids = partition_vid_cache.at({j, groupb});
-        sframe edge_sframe = edge_partition(i, j, groupa, groupb);
-
-        std::vector<flex_type_enum> out_column_types = edge_sframe.column_types();
-        out_column_types[src_column_idx] = m_vid_type;
-        out_column_types[dst_column_idx] = m_vid_type;
-
-        sframe out_sframe;
-        out_sframe.open_for_write(edge_sframe.column_names(), out_column_types,
-                                  "", edge_sframe.num_segments());
-
-        // The filter function checks the id constraints and then value constraints
-        std::function<bool(const std::vector<flexible_type>&)> filter_fn = 
-            [&](const std::vector<flexible_type>& row) {
-              size_t src_idx = row[src_column_idx];
-              size_t dst_idx = row[dst_column_idx];
-              const flexible_type& source = src_partition_vids[src_idx];
-              const flexible_type& target = dst_partition_vids[dst_idx];
-              std::pair<size_t, size_t> partition_addr{i, j};
-              std::pair<flexible_type, flexible_type> source_target_pair{source, target};
-              if ((wild_source_vids[i].count(source) || wild_target_vids[j].count(target)) ||
-                  (vid_constraints.at(partition_addr).count(source_target_pair) > 0)) {
-               return satisfy_value_constraint(row);
-              }
-              return false;
-            };
-
-        copy_transform_if(edge_sframe, out_sframe, filter_fn,
-                          boost::bind(edge_id_transform, _1,
-                                      boost::cref(src_partition_vids),
-                                      boost::cref(dst_partition_vids)));
-        out_sframe.close();
-        out_edge_blocks[i * m_num_partitions + j] = std::move(out_sframe);
+    std::vector<std::vector<size_t>> src_row_vec(m_num_partitions), dst_row_vec(m_num_partitions);
+    std::vector<std::vector<flexible_type>> src_vid_vec(m_num_partitions), dst_vid_vec(m_num_partitions);
+    parallel_for(0, m_num_partitions, [&](size_t p) {
+      src_row_vec[p].assign(src_rows[p].begin(), src_rows[p].end());
+      dst_row_vec[p].assign(dst_rows[p].begin(), dst_rows[p].end());
+      src_vid_vec[p] = get_vertex_ids(p, groupa, src_row_vec[p]);
+      dst_vid_vec[p] = get_vertex_ids(p, groupb, dst_row_vec[p]);
+    });
+
+    parallel_for(0, coordinates.size(), [&](size_t k) {
+      size_t i = coordinates[k].first;
+      size_t j = coordinates[k].second;
+      const sframe& edge_sframe = matched_edges[k];
+      std::vector<flex_type_enum> out_column_types = edge_sframe.column_types();
+      out_column_types[src_column_idx] = m_vid_type;
+      out_column_types[dst_column_idx] = m_vid_type;
+
+      auto lookup = [](const std::vector<size_t>& rows,
+                       const std::vector<flexible_type>& vids,
+                       size_t row) -> const flexible_type& {
+        auto iter = std::lower_bound(rows.begin(), rows.end(), row);
+        DASSERT_TRUE(iter != rows.end() && *iter == row);
+        return vids[iter - rows.begin()];
+      };
+
+      sframe out_sframe;
+      out_sframe.open_for_write(edge_sframe.column_names(), out_column_types,
+                                "", edge_sframe.num_segments());
+      copy_transform_if(edge_sframe, out_sframe,
+                        [](const std::vector<flexible_type>&) { return true; },
+                        [&](const std::vector<flexible_type>& row) {
+                          std::vector<flexible_type> ret = row;
+                          ret[src_column_idx] = lookup(src_row_vec[i], src_vid_vec[i],
+                                                       row[src_column_idx].get<flex_int>());
+                          ret[dst_column_idx] = lookup(dst_row_vec[j], dst_vid_vec[j],
+                                                       row[dst_column_idx].get<flex_int>());
+                          return ret;
+                        });
+      out_sframe.close();
+      out_edge_blocks[i * m_num_partitions + j] = std::move(out_sframe);
     });
   }
   for (auto& sf : out_edge_blocks)
     ret = ret.append(sf);
+  if (!ret.is_opened_for_read()) {
+    // no edge partition was scanned
+    ret.open_for_write(get_edge_fields(groupa, groupb), get_edge_field_types(groupa, groupb));
+    ret.close();
+  }
   return ret;
 }
 
@@ -497,7 +562,12 @@ void sgraph::commit_vertex_buffer(size_t group,
     sframe& new_partition = vertex_partitions[i];
     reorder_and_add_new_columns(old_partition, all_column_names, all_column_types);
     reorder_and_add_new_columns(new_partition, all_column_names, all_column_types);
-    new_partition = merge_vertex_partition(old_partition, new_partition);
+    sgraph_vid_index& index = mutable_vid_index(i, group);
+    std::vector<flexible_type> appended_vids;
+    new_partition = merge_vertex_partition(old_partition, new_partition,
+                                           index, appended_vids);
+    index.append(appended_vids);
+    index.set_column(*new_partition.select_column(VID_COLUMN_NAME));
     num_vertex_added[i] = (new_partition.size() - old_partition.size());
     old_partition = new_partition;
   });
@@ -508,53 +578,90 @@ void sgraph::commit_vertex_buffer(size_t group,
 }
 
 sframe sgraph::merge_vertex_partition(sframe& current_data,
-                                      sframe& new_data) {
+                                      sframe& new_data,
+                                      const sgraph_vid_index& index,
+                                      std::vector<flexible_type>& appended_vids) {
 
   size_t id_column_idx = current_data.column_index(VID_COLUMN_NAME);
 
-  std::vector<std::vector<flexible_type>> buffer_a, buffer_b;
-  std::unordered_map<flexible_type, std::vector<flexible_type>*> join_hash_map;
+  // Only the new data is read in memory. Each new row either updates an
+  // existing vertex, located with the vertex id index, or adds a vertex.
+  // The last row wins if a vertex id appears several times.
+  std::vector<std::vector<flexible_type>> new_rows;
+  new_data.get_reader()->read_rows(0, new_data.size(), new_rows);
 
-  // read both sframe in memory
-  current_data.get_reader()->read_rows(0, current_data.size(), buffer_a);
-  new_data.get_reader()->read_rows(0, new_data.size(), buffer_b);
+  std::unordered_map<size_t, std::vector<flexible_type>*> updated_rows;
+  std::unordered_map<flexible_type, size_t> appended_row_position;
+  std::vector<std::vector<flexible_type>*> appended_rows;
 
-  for (auto& row : buffer_a) {
-    flexible_type vid = row[id_column_idx];
-    join_hash_map[vid] = &row;
-  }
-
-  for (auto& row : buffer_b) {
-    flexible_type vid = row[id_column_idx];
+  for (auto& row : new_rows) {
+    const flexible_type& vid = row[id_column_idx];
     if (vid.get_type() == flex_type_enum::UNDEFINED) {
       std::string error_message =
           std::string("Vertex id column cannot contain missing value. ") +
           "Please use dropna() to drop the missing value from the input and try again.";
       log_and_throw(error_message);
     }
-    join_hash_map[vid] = &row;
+    size_t existing_row = index.find(vid);
+    if (existing_row != sgraph_vid_index::NOT_FOUND) {
+      updated_rows[existing_row] = &row;
+    } else {
+      auto iter = appended_row_position.find(vid);
+      if (iter == appended_row_position.end()) {
+        appended_row_position[vid] = appended_rows.size();
+        appended_rows.push_back(&row);
+      } else {
+        appended_rows[iter->second] = &row;
+      }
+    }
   }
 
-  // prepare the return sframe.
-  sframe ret;
+  // write the new vertices
+  sframe appended;
   size_t num_segments = 1; // use one logical segment
+  appended.open_for_write(current_data.column_names(),
+                          current_data.column_types(),
+                          "", num_segments);
+  appended_vids.clear();
+  appended_vids.reserve(appended_rows.size());
+  auto out = appended.get_output_iterator(0);
+  for (auto row : appended_rows) {
+    appended_vids.push_back((*row)[id_column_idx]);
+    *out = std::move(*row);
+    ++out;
+  }
+  appended.close();
+
+  // fast pass if no existing vertex is updated
+  if (updated_rows.empty()) {
+    return current_data.append(appended);
+  }
+
+  // otherwise rewrite the current data, replacing the updated rows
+  sframe ret;
   ret.open_for_write(current_data.column_names(),
                      current_data.column_types(),
                      "", num_segments);
-
-  auto out = ret.get_output_iterator(0);
-  for (auto& row: buffer_a) {
-    decltype(join_hash_map)::const_iterator iter = join_hash_map.find(row[id_column_idx]);
-    *out = std::move(*(iter->second));
-    ++out;
-    join_hash_map.erase(iter);
-  }
-  for (auto& kv : join_hash_map) {
-    *out = std::move(*(kv.second));
-    ++out;
+  out = ret.get_output_iterator(0);
+  auto reader = current_data.get_reader();
+  std::vector<std::vector<flexible_type>> buffer;
+  for (size_t row_start = 0; row_start < current_data.size();
+       row_start += DEFAULT_SARRAY_READER_BUFFER_SIZE) {
+    size_t row_end = std::min(row_start + DEFAULT_SARRAY_READER_BUFFER_SIZE,
+                              current_data.size());
+    reader->read_rows(row_start, row_end, buffer);
+    for (size_t i = 0; i < buffer.size(); ++i) {
+      auto iter = updated_rows.find(row_start + i);
+      if (iter == updated_rows.end()) {
+        *out = std::move(buffer[i]);
+      } else {
+        *out = std::move(*(iter->second));
+      }
+      ++out;
+    }
   }
   ret.close();
-  return ret;
+  return ret.append(appended);
 }
 
 bool sgraph::add_vertices(const dataframe_t& vertices,
@@ -738,16 +845,13 @@ void sgraph::commit_edge_buffer(size_t groupa,
       column_types = column_types_of_second_group;
     }
 
-    std::vector<flexible_type> old_vids = get_vertex_ids(partitionid, groupid);
-    google::sparse_hash_set<flexible_type, std::hash<flexible_type>>
-        old_vid_set(std::make_move_iterator(old_vids.begin()),
-                    std::make_move_iterator(old_vids.end()));
+    sgraph_vid_index& index = mutable_vid_index(partitionid, groupid);
 
     sarray<flexible_type>& raw_id_sarray = unique_vertex_ids[i];
     sarray<flexible_type> new_raw_id_sarray;
     size_t new_vertices_cnt = 0;
 
-    if (old_vids.empty()) {
+    if (index.size() == 0) {
       new_raw_id_sarray = raw_id_sarray;
     } else {
       new_raw_id_sarray.open_for_write(1);
@@ -755,7 +859,7 @@ void sgraph::commit_edge_buffer(size_t groupa,
       graphlab::copy_if(raw_id_sarray,
                         new_raw_id_sarray,
                         [&](const flexible_type& id) {
-                          return old_vid_set.count(id) == 0;
+                          return index.find(id) == sgraph_vid_index::NOT_FOUND;
                         });
       new_raw_id_sarray.close();
     }
@@ -771,6 +875,8 @@ void sgraph::commit_edge_buffer(size_t groupa,
     sframe& old_vertices = vertex_partition(partitionid, groupid);
     ASSERT_TRUE(union_columns(old_vertices, new_vertices));
     old_vertices = old_vertices.append(new_vertices);
+    index.append(new_raw_id_sarray);
+    index.set_column(*old_vertices.select_column(VID_COLUMN_NAME));
 
     // debug print
     // std::cerr << "New vertices in partition " << i << ":\n";
@@ -788,64 +894,35 @@ void sgraph::commit_edge_buffer(size_t groupa,
   local_timer.start();
   logstream(LOG_EMPH) << "Rename id columns " << std::endl;
 
-  std::unordered_map<std::pair<size_t, size_t>,
-                     std::shared_ptr<vid_hash_map_type>> vid_hash_map_cache;
+  // The vertex id indices of both groups are up to date after step 2.
+  const std::vector<sgraph_vid_index>& vid_index_a = m_vid_index[groupa];
+  const std::vector<sgraph_vid_index>& vid_index_b = m_vid_index[groupb];
 
   /**
-   * Preamble function to load the vid to row id lookup table in memory for the
-   * next batch of coordinates.
+   * Preamble function to log the next batch of coordinates.
    */
   std::function<void(std::vector<std::pair<size_t, size_t>>)>
-    load_vid_hash_map_cache = [&](std::vector<std::pair<size_t, size_t>> coordinates) {
-      std::unordered_set<std::pair<size_t, size_t>> block_to_load;
-      for (auto& corrd : coordinates) {
-        block_to_load.insert({corrd.first, groupa});
-        block_to_load.insert({corrd.second, groupb});
-      }
-      std::unordered_set<std::pair<size_t, size_t>> block_to_unload;
-      for (auto& kv : vid_hash_map_cache) {
-        if (block_to_load.count(kv.first)) {
-          block_to_load.erase(block_to_load.find(kv.first));
-        } else {
-          block_to_unload.insert(kv.first);
-        }
-      }
-      for (auto& coord : block_to_unload) {
-        vid_hash_map_cache.erase(vid_hash_map_cache.find(coord));
-      }
-      for (auto& coord : block_to_load) {
-        vid_hash_map_cache[coord] = {};
-      }
-      std::vector<std::pair<size_t, size_t>> block_to_load_vec(
-          block_to_load.begin(), block_to_load.end());
-      parallel_for(0, block_to_load_vec.size(), [&](size_t i) {
-          auto coord = block_to_load_vec[i];
-          vid_hash_map_cache[coord] = fetch_vid_hash_map(coord.first, coord.second);
-          });
-
+    log_coordinates = [&](std::vector<std::pair<size_t, size_t>> coordinates) {
       std::stringstream message_ss;
       message_ss <<  "Processing edge partitions: ";
       for (auto& coord: coordinates) {
         message_ss << "(" << coord.first << " , " << coord.second << ") ";
       }
       logstream(LOG_INFO) << message_ss.str() << std::endl;
-      logstream(LOG_INFO) << "Number of vid maps in cache: " << vid_hash_map_cache.size() << std::endl;
     };
 
   //// Second pass for every edge, we rename the global vertex id
   //// into the rowid in the local vertex partition.
   sgraph_compute::hilbert_blocked_parallel_for(
       m_num_partitions,
-      load_vid_hash_map_cache,
+      log_coordinates,
       [&](std::pair<size_t, size_t> coordinate) {
         size_t i = coordinate.first;
         size_t j = coordinate.second;
         size_t edge_partition_id = i * m_num_partitions + j;
 
-        std::shared_ptr<vid_hash_map_type>
-          vid_lookup_a = vid_hash_map_cache[{i, groupa}];
-        std::shared_ptr<vid_hash_map_type>
-          vid_lookup_b = vid_hash_map_cache[{j, groupb}];
+        const sgraph_vid_index& vid_lookup_a = vid_index_a[i];
+        const sgraph_vid_index& vid_lookup_b = vid_index_b[j];
 
         auto& new_edges = edge_partitions[edge_partition_id];
         size_t src_column_idx = new_edges.column_index(SRC_COLUMN_NAME);
@@ -860,14 +937,18 @@ void sgraph::commit_edge_buffer(size_t groupa,
         new_src_column->set_type(flex_type_enum::INTEGER);
         transform(*src_column, *new_src_column,
             [&](const flexible_type& val) {
-              return vid_lookup_a->find(val)->second;
+              size_t row = vid_lookup_a.find(val);
+              DASSERT_NE(row, sgraph_vid_index::NOT_FOUND);
+              return row;
             });
         new_src_column->close();
         new_dst_column->open_for_write(dst_column->num_segments());
         new_dst_column->set_type(flex_type_enum::INTEGER);
         transform(*dst_column, *new_dst_column,
             [&](const flexible_type& val) {
-              return vid_lookup_b->find(val)->second;
+              size_t row = vid_lookup_b.find(val);
+              DASSERT_NE(row, sgraph_vid_index::NOT_FOUND);
+              return row;
             });
         new_dst_column->close();
 
@@ -1025,6 +1106,7 @@ bool sgraph::clear() {
   m_vertex_group_names.clear();
   m_vertex_groups.clear();
   m_edge_groups.clear();
+  m_vid_index.clear();
 
   // Reinitialize with the given number of partitions
   m_num_partitions = 0;
@@ -1280,9 +1362,9 @@ size_t sgraph::get_edge_field_id(std::string column_name, size_t groupa, size_t
 /*                                                                        */
 /**************************************************************************/
 
-void parallel_save_sframes(const std::vector<sframe>& sf_vec,
-                           oarchive& oarc,
-                           bool save_reference) {
+std::vector<std::string> parallel_save_sframes(const std::vector<sframe>& sf_vec,
+                                               oarchive& oarc,
+                                               bool save_reference) {
   std::vector<std::string> prefixes;
   for (size_t i = 0; i < sf_vec.size(); ++i) {
     prefixes.push_back(oarc.dir->get_next_write_prefix());
@@ -1296,6 +1378,7 @@ void parallel_save_sframes(const std::vector<sframe>& sf_vec,
       sf_vec[i].save(name);
     }
   });
+  return prefixes;
 }
 
 /**
@@ -1308,11 +1391,13 @@ void sgraph::save(oarchive& oarc) const {
        << m_num_vertices << m_num_edges << m_vid_type
        << m_vertex_group_names;
   bool save_reference = false;
-  for (const auto& vgroup : m_vertex_groups) {
+  for (size_t group = 0; group < m_vertex_groups.size(); ++group) {
+    const auto& vgroup = m_vertex_groups[group];
     // This relies on the serialization format of vector,
     // otherwise old will not load.
     oarc << vgroup.size();
-    parallel_save_sframes(vgroup, oarc, save_reference);
+    auto prefixes = parallel_save_sframes(vgroup, oarc, save_reference);
+    save_vid_index(group, prefixes);
   }
   for (const auto& kv : m_edge_groups) {
     oarc << kv.first;
@@ -1327,11 +1412,13 @@ void sgraph::save_reference(oarchive& oarc) const {
        << m_num_vertices << m_num_edges << m_vid_type
        << m_vertex_group_names;
   bool save_reference = true;
-  for (const auto& vgroup : m_vertex_groups) {
+  for (size_t group = 0; group < m_vertex_groups.size(); ++group) {
+    const auto& vgroup = m_vertex_groups[group];
     // This relies on the serialization format of vector,
     // otherwise it will not load.
     oarc << vgroup.size();
-    parallel_save_sframes(vgroup, oarc, save_reference);
+    auto prefixes = parallel_save_sframes(vgroup, oarc, save_reference);
+    save_vid_index(group, prefixes);
   }
   for (const auto& kv : m_edge_groups) {
     oarc << kv.first;
@@ -1351,9 +1438,18 @@ void sgraph::load(iarchive& iarc) {
        >> m_num_vertices >> m_num_edges >> m_vid_type
        >> m_vertex_group_names;
   for (size_t i = 0; i < m_num_groups; ++i) {
+    // Same format as deserializing a vector of sframes, but keeping
+    // the prefixes to locate the vertex id indices.
+    size_t num_partitions = 0;
+    iarc >> num_partitions;
+    std::vector<std::string> prefixes;
     std::vector<sframe> vgroup;
-    iarc >> vgroup;
+    for (size_t j = 0; j < num_partitions; ++j) {
+      prefixes.push_back(iarc.get_prefix());
+      vgroup.push_back(sframe(prefixes.back() + ".frame_idx"));
+    }
     m_vertex_groups.push_back(std::move(vgroup));
+    load_vid_index(i, prefixes);
   }
   for (size_t i = 0; i < m_num_groups; ++i) {
     for (size_t j = 0; j < m_num_groups; ++j) {
@@ -1370,16 +1466,95 @@ void sgraph::load(iarchive& iarc) {
 /*                            Helper Function                             */
 /*                                                                        */
 /**************************************************************************/
-std::shared_ptr<sgraph::vid_hash_map_type> sgraph::fetch_vid_hash_map(size_t partition,
-                                                                      size_t group) {
-  std::shared_ptr<vid_hash_map_type> ret(new vid_hash_map_type);
-  auto vid_sarray = vertex_partition(partition, group).select_column(VID_COLUMN_NAME);
-  auto reader = vid_sarray->get_reader();
-  auto reader_buffer = sarray_reader_buffer<flexible_type>(std::move(reader), 0, vid_sarray->size());
-  size_t i = 0;
-  while (reader_buffer.has_next()) {
-    ret->insert({reader_buffer.next(), i});
-    ++i;
+void sgraph::save_vid_index(size_t group,
+                            const std::vector<std::string>& prefixes) const {
+  DASSERT_EQ(prefixes.size(), m_num_partitions);
+  parallel_for(0, prefixes.size(), [&](size_t i) {
+    fetch_vid_index(i, group).save(prefixes[i] + ".vid_index");
+  });
+}
+
+void sgraph::load_vid_index(size_t group,
+                            const std::vector<std::string>& prefixes) {
+  DASSERT_EQ(m_vid_index.size(), group);
+  m_vid_index.push_back(std::vector<sgraph_vid_index>(prefixes.size()));
+  parallel_for(0, prefixes.size(), [&](size_t i) {
+    sgraph_vid_index& index = m_vid_index[group][i];
+    auto vids = vertex_partition(i, group).select_column(VID_COLUMN_NAME);
+    if (index.load(prefixes[i] + ".vid_index") && index.size() == vids->size()) {
+      // the index was saved together with this partition
+      index.set_column(*vids);
+    } else {
+      // graphs saved without index are indexed on demand
+      index.clear();
+    }
+  });
+}
+
+sgraph_vid_index& sgraph::mutable_vid_index(size_t partition, size_t group) {
+  sgraph_vid_index& index = m_vid_index[group][partition];
+  auto vids = vertex_partition(partition, group).select_column(VID_COLUMN_NAME);
+  if (!index.indexes(*vids)) {
+    logstream(LOG_INFO) << "Building vertex id index of partition " << partition
+                        << " in group " << group << std::endl;
+    index = sgraph_vid_index(*vids);
+  }
+  return index;
+}
+
+sgraph_vid_index sgraph::fetch_vid_index(size_t partition, size_t group) const {
+  auto vids = vertex_partition(partition, group).select_column(VID_COLUMN_NAME);
+  if (group < m_vid_index.size() && m_vid_index[group][partition].indexes(*vids)) {
+    return m_vid_index[group][partition];
+  }
+  logstream(LOG_INFO) << "Building temporary vertex id index of partition "
+                      << partition << " in group " << group << std::endl;
+  return sgraph_vid_index(*vids);
+}
+
+std::vector<std::pair<size_t, size_t>>
+sgraph::find_vertices(const std::vector<flexible_type>& vids, size_t group) const {
+  std::vector<std::pair<size_t, size_t>> ret(vids.size());
+  std::vector<std::vector<size_t>> vids_in_partition(m_num_partitions);
+  for (size_t i = 0; i < vids.size(); ++i) {
+    size_t partition = get_vertex_partition(vids[i]);
+    ret[i] = {partition, sgraph_vid_index::NOT_FOUND};
+    if (group < m_num_groups && vids[i].get_type() != flex_type_enum::UNDEFINED) {
+      vids_in_partition[partition].push_back(i);
+    }
+  }
+  parallel_for(0, m_num_partitions, [&](size_t partition) {
+    if (vids_in_partition[partition].empty()) return;
+    sgraph_vid_index index = fetch_vid_index(partition, group);
+    for (size_t i : vids_in_partition[partition]) {
+      ret[i].second = index.find(vids[i]);
+    }
+  });
+  return ret;
+}
+
+std::vector<flexible_type> sgraph::get_vertex_ids(size_t partition, size_t group,
+                                                  const std::vector<size_t>& rows) const {
+  std::vector<flexible_type> ret;
+  if (rows.empty()) return ret;
+  auto id_column = vertex_partition(partition, group).select_column(VID_COLUMN_NAME);
+  ret.reserve(rows.size());
+  // a sequential scan is cheaper when a large fraction of rows is requested
+  if (rows.size() * 8 > id_column->size()) {
+    std::vector<flexible_type> all_vids = get_vertex_ids(partition, group);
+    for (size_t row : rows) ret.push_back(all_vids[row]);
+    return ret;
+  }
+  // otherwise read the runs of consecutive rows
+  auto reader = id_column->get_reader();
+  std::vector<flexible_type> buffer;
+  size_t run_begin = 0;
+  while (run_begin < rows.size()) {
+    size_t run_end = run_begin + 1;
+    while (run_end < rows.size() && rows[run_end] == rows[run_end - 1] + 1) ++run_end;
+    reader->read_rows(rows[run_begin], rows[run_end - 1] + 1, buffer);
+    std::move(buffer.begin(), buffer.end(), std::back_inserter(ret));
+    run_begin = run_end;
   }
   return ret;
 }
@@ -11,7 +11,7 @@
 #include <flexible_type/flexible_type.hpp>
 #include <sgraph/sgraph_constants.hpp>
 #include <sframe/sframe.hpp>
-#include <sparsehash/sparse_hash_map>
+#include <sgraph/sgraph_vid_index.hpp>
 
 namespace graphlab {
 
@@ -497,6 +497,16 @@ class sgraph {
 
   inline flex_type_enum vertex_id_type() const { return m_vid_type; }
 
+  /**
+   * Looks up vertices of a group using the vertex id index, without scanning
+   * the vertex data.
+   *
+   * Returns the (partition, row) address of each vertex id. The row is
+   * sgraph_vid_index::NOT_FOUND if the vertex does not exist.
+   */
+  std::vector<std::pair<size_t, size_t> >
+  find_vertices(const std::vector<flexible_type>& vids, size_t group = 0) const;
+
 /**************************************************************************/
 /*                                                                        */
 /*                             Serialization                              */
@@ -676,19 +686,23 @@ class sgraph {
                             std::vector<sframe>& vertex_buffer);
 
   /**
-   * Helper function to merge a single vertex partition.
+   * Helper function to merge a single vertex partition. Vertices already in
+   * the partition are updated in place, new vertices are appended in the
+   * order of their ids in appended_vids.
    */
-  sframe merge_vertex_partition(sframe& current_vdata, sframe& new_vdata);
+  sframe merge_vertex_partition(sframe& current_vdata, sframe& new_vdata,
+                                const sgraph_vid_index& index,
+                                std::vector<flexible_type>& appended_vids);
 
   /**
    * Return the vertex partition number for given vertex id.
    */
-  inline size_t get_vertex_partition(const flexible_type& vid) { return vid.hash() % m_num_partitions; }
+  inline size_t get_vertex_partition(const flexible_type& vid) const { return vid.hash() % m_num_partitions; }
 
   /**
    * Return the edge partition number for an edge.
    */
-  inline size_t get_edge_partition(const flexible_type& src, const flexible_type& dst) {
+  inline size_t get_edge_partition(const flexible_type& src, const flexible_type& dst) const {
     return get_vertex_partition(src) * m_num_partitions + get_vertex_partition(dst);
   }
 
@@ -704,6 +718,25 @@ class sgraph {
     return ret;
   }
 
+  /**
+   * Returns the vertex ids at the given rows of a vertex partition.
+   * The rows must be sorted in increasing order.
+   */
+  std::vector<flexible_type> get_vertex_ids(size_t partition, size_t group,
+                                            const std::vector<size_t>& rows) const;
+
+  /**
+   * Returns the vertex id index of a vertex partition. The cached index is
+   * rebuilt from the vertex data if it does not match the partition.
+   */
+  sgraph_vid_index& mutable_vid_index(size_t partition, size_t group);
+
+  /**
+   * Returns the vertex id index of a vertex partition. If the cached index
+   * does not match the partition, a temporary index is built.
+   */
+  sgraph_vid_index fetch_vid_index(size_t partition, size_t group) const;
+
   /**
    * Returns true if this field name begins with __
    */
@@ -757,6 +790,13 @@ class sgraph {
    */
   std::map<std::pair<size_t, size_t>, std::vector<sframe> > m_edge_groups;
 
+  /**
+   * The vertex id to row id index of each vertex partition, addressed as
+   * m_vid_index[group][partition]. It is maintained incrementally by the
+   * modifiers, saved alongside the vertex partitions and memory mapped on load.
+   */
+  std::vector<std::vector<sgraph_vid_index> > m_vid_index;
+
  private:
   friend class distributed_sgraph_compute::distributed_graph_ingress;
 
@@ -797,12 +837,18 @@ class sgraph {
    */
   static bool union_columns(sframe& sframe_a, sframe& sframe_b);
 
-  typedef google::sparse_hash_map<flexible_type, size_t, std::hash<flexible_type> > vid_hash_map_type;
+  /**
+   * Saves the vertex id index of each partition of a vertex group next to
+   * the vertex partition saved at the same archive prefix.
+   */
+  void save_vid_index(size_t group, const std::vector<std::string>& prefixes) const;
 
   /**
-   * Fetch the vertex id to row id lookup table.
+   * Loads the vertex id index of each partition of a vertex group saved by
+   * \ref save_vid_index. Missing or outdated indices are left empty and
+   * rebuilt on demand.
    */
-  std::shared_ptr<vid_hash_map_type> fetch_vid_hash_map(size_t partition, size_t group);
+  void load_vid_index(size_t group, const std::vector<std::string>& prefixes);
 
   /**
    * Initialize an empty sframe with column names and types.
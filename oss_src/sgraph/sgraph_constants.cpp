@@ -19,6 +19,8 @@ EXPORT size_t SGRAPH_TRIPLE_APPLY_EDGE_BATCH_SIZE = 1024;
 EXPORT size_t SGRAPH_DEFAULT_NUM_PARTITIONS = 8;
 EXPORT size_t SGRAPH_INGRESS_VID_BUFFER_SIZE = 1024 * 1024 * 1;
 EXPORT size_t SGRAPH_HILBERT_CURVE_PARALLEL_FOR_NUM_THREADS = thread::cpu_count();
+EXPORT size_t SGRAPH_VERTEX_BLOCK_MEMORY_BUDGET = 4LL * 1024 * 1024 * 1024;
+EXPORT size_t SGRAPH_FRONTIER_PULL_THRESHOLD = 20;
 
 REGISTER_GLOBAL_WITH_CHECKS(int64_t, 
                             SGRAPH_TRIPLE_APPLY_LOCK_ARRAY_SIZE, 
@@ -51,4 +53,14 @@ REGISTER_GLOBAL_WITH_CHECKS(int64_t,
                             SGRAPH_HILBERT_CURVE_PARALLEL_FOR_NUM_THREADS,
                             true,
                             +[](int64_t val){ return val >= 1; });
+
+REGISTER_GLOBAL_WITH_CHECKS(int64_t,
+                            SGRAPH_VERTEX_BLOCK_MEMORY_BUDGET,
+                            true,
+                            +[](int64_t val){ return val >= 1; });
+
+REGISTER_GLOBAL_WITH_CHECKS(int64_t,
+                            SGRAPH_FRONTIER_PULL_THRESHOLD,
+                            true,
+                            +[](int64_t val){ return val >= 1; });
 }
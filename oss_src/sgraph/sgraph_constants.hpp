@@ -41,6 +41,19 @@ extern size_t SGRAPH_INGRESS_VID_BUFFER_SIZE;
  * Number of threads used for hilber curve parallel for
  */
 extern size_t SGRAPH_HILBERT_CURVE_PARALLEL_FOR_NUM_THREADS;
+
+/**
+ * Memory budget (in bytes) for vertex blocks kept in memory while sweeping
+ * over the edge partitions. See \ref sgraph_compute::plan_partition_schedule.
+ */
+extern size_t SGRAPH_VERTEX_BLOCK_MEMORY_BUDGET;
+
+/**
+ * A frontier_engine edge map pulls along in edges, instead of pushing along
+ * out edges, when the active vertices and their out edges exceed
+ * num_edges / SGRAPH_FRONTIER_PULL_THRESHOLD.
+ */
+extern size_t SGRAPH_FRONTIER_PULL_THRESHOLD;
 }
 
 #endif
@@ -0,0 +1,218 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <sgraph/sgraph_csr_snapshot.hpp>
+#include <sgraph/sgraph_constants.hpp>
+#include <serialization/oarchive.hpp>
+#include <timer/timer.hpp>
+#include <logger/logger.hpp>
+
+namespace graphlab {
+namespace sgraph_compute {
+
+namespace {
+  /**
+   * An edge collected while building the adjacency of one vertex partition.
+   * owner is the local id of the vertex owning the edge list,
+   * neighbor is the global id of the other end point.
+   */
+  struct collected_edge {
+    size_t owner;
+    size_t neighbor;
+    double weight;
+    bool operator<(const collected_edge& other) const {
+      return owner < other.owner ||
+          (owner == other.owner && neighbor < other.neighbor);
+    }
+  };
+
+  /**
+   * The adjacency of one vertex partition, with offsets local to the
+   * partition.
+   */
+  struct partition_adjacency {
+    std::vector<size_t> edge_offsets;
+    std::vector<size_t> byte_offsets;
+    std::vector<char> neighbors;
+    std::vector<double> weights;
+  };
+}
+
+csr_snapshot::csr_snapshot(const sgraph& g,
+                           sgraph::edge_direction dir,
+                           const std::string& weight_field) {
+  timer ti;
+  size_t num_partitions = g.get_num_partitions();
+  m_partition_offsets.resize(num_partitions + 1, 0);
+  for (size_t i = 0; i < num_partitions; ++i) {
+    m_partition_offsets[i + 1] =
+        m_partition_offsets[i] + g.vertex_partition(i).size();
+  }
+
+  if (!weight_field.empty()) {
+    auto fields = g.get_edge_fields();
+    auto iter = std::find(fields.begin(), fields.end(), weight_field);
+    if (iter == fields.end()) {
+      log_and_throw(std::string("Cannot find edge field: ") + weight_field);
+    }
+    flex_type_enum wtype = g.get_edge_field_types()[iter - fields.begin()];
+    if (wtype != flex_type_enum::INTEGER && wtype != flex_type_enum::FLOAT) {
+      log_and_throw(std::string("Edge weight field must be numeric: ") + weight_field);
+    }
+  }
+
+  if (dir == sgraph::edge_direction::OUT_EDGE ||
+      dir == sgraph::edge_direction::ANY_EDGE) {
+    build_adjacency(g, true, weight_field, m_out);
+    m_num_edges = m_out.edge_offsets.back();
+  }
+  if (dir == sgraph::edge_direction::IN_EDGE ||
+      dir == sgraph::edge_direction::ANY_EDGE) {
+    build_adjacency(g, false, weight_field, m_in);
+    m_num_edges = m_in.edge_offsets.back();
+  }
+  logstream(LOG_INFO) << "Built csr snapshot of " << num_vertices()
+                      << " vertices and " << num_edges() << " edges using "
+                      << memory_usage() << " bytes in "
+                      << ti.current_time() << " secs" << std::endl;
+}
+
+void csr_snapshot::build_adjacency(const sgraph& g, bool out_edges,
+                                   const std::string& weight_field,
+                                   adjacency& adj) {
+  size_t num_partitions = g.get_num_partitions();
+  std::vector<std::string> columns{sgraph::SRC_COLUMN_NAME,
+                                   sgraph::DST_COLUMN_NAME};
+  bool weighted = !weight_field.empty();
+  if (weighted) columns.push_back(weight_field);
+
+  std::vector<partition_adjacency> parts(num_partitions);
+
+  // Each vertex partition collects the edges it owns from one row
+  // (out edges) or one column (in edges) of the edge partition grid.
+  parallel_for(0, num_partitions, [&](size_t owner_partition) {
+    std::vector<collected_edge> edges;
+    for (size_t other_partition = 0; other_partition < num_partitions;
+         ++other_partition) {
+      size_t src_partition = out_edges ? owner_partition : other_partition;
+      size_t dst_partition = out_edges ? other_partition : owner_partition;
+      const sframe& sf = g.edge_partition(src_partition, dst_partition);
+      if (sf.num_rows() == 0) continue;
+      auto reader = sf.select_columns(columns).get_reader();
+      size_t neighbor_offset = m_partition_offsets[other_partition];
+      std::vector<std::vector<flexible_type>> rows;
+      for (size_t row_start = 0; row_start < reader->num_rows();
+           row_start += SGRAPH_TRIPLE_APPLY_EDGE_BATCH_SIZE) {
+        size_t row_end = std::min<size_t>(
+            row_start + SGRAPH_TRIPLE_APPLY_EDGE_BATCH_SIZE, reader->num_rows());
+        reader->read_rows(row_start, row_end, rows);
+        for (const auto& row : rows) {
+          size_t src = row[0].get<flex_int>();
+          size_t dst = row[1].get<flex_int>();
+          double weight = 1.0;
+          if (weighted && row[2].get_type() != flex_type_enum::UNDEFINED) {
+            weight = (double)row[2];
+          }
+          if (out_edges) {
+            edges.push_back({src, neighbor_offset + dst, weight});
+          } else {
+            edges.push_back({dst, neighbor_offset + src, weight});
+          }
+        }
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    size_t num_local = m_partition_offsets[owner_partition + 1] -
+                       m_partition_offsets[owner_partition];
+    size_t owner_offset = m_partition_offsets[owner_partition];
+    partition_adjacency& part = parts[owner_partition];
+    part.edge_offsets.resize(num_local + 1, 0);
+    part.byte_offsets.resize(num_local + 1, 0);
+    if (weighted) part.weights.reserve(edges.size());
+
+    oarchive oarc(part.neighbors);
+    size_t e = 0;
+    for (size_t local = 0; local < num_local; ++local) {
+      part.edge_offsets[local] = e;
+      part.byte_offsets[local] = oarc.off;
+      size_t prev = owner_offset + local;
+      bool first = true;
+      for (; e < edges.size() && edges[e].owner == local; ++e) {
+        if (first) {
+          integer_pack::variable_encode(oarc, integer_pack::shifted_integer_encode(
+              (int64_t)edges[e].neighbor - (int64_t)prev));
+          first = false;
+        } else {
+          integer_pack::variable_encode(oarc, edges[e].neighbor - prev);
+        }
+        prev = edges[e].neighbor;
+        if (weighted) part.weights.push_back(edges[e].weight);
+      }
+    }
+    ASSERT_EQ(e, edges.size());
+    part.edge_offsets[num_local] = e;
+    part.byte_offsets[num_local] = oarc.off;
+    part.neighbors.resize(oarc.off);
+  });
+
+  // Concatenate the partitions into the global arrays.
+  size_t total_edges = 0, total_bytes = 0;
+  for (const auto& part : parts) {
+    total_edges += part.edge_offsets.back();
+    total_bytes += part.neighbors.size();
+  }
+  adj.edge_offsets.resize(num_vertices() + 1);
+  adj.byte_offsets.resize(num_vertices() + 1);
+  adj.neighbors.resize(total_bytes);
+  adj.weights.clear();
+  if (weighted) adj.weights.reserve(total_edges);
+
+  size_t edge_base = 0, byte_base = 0;
+  for (size_t i = 0; i < num_partitions; ++i) {
+    auto& part = parts[i];
+    size_t num_local = part.edge_offsets.size() - 1;
+    for (size_t local = 0; local < num_local; ++local) {
+      adj.edge_offsets[m_partition_offsets[i] + local] =
+          edge_base + part.edge_offsets[local];
+      adj.byte_offsets[m_partition_offsets[i] + local] =
+          byte_base + part.byte_offsets[local];
+    }
+    std::copy(part.neighbors.begin(), part.neighbors.end(),
+              adj.neighbors.begin() + byte_base);
+    adj.weights.insert(adj.weights.end(),
+                       part.weights.begin(), part.weights.end());
+    edge_base += part.edge_offsets.back();
+    byte_base += part.neighbors.size();
+    part = partition_adjacency();
+  }
+  adj.edge_offsets[num_vertices()] = edge_base;
+  adj.byte_offsets[num_vertices()] = byte_base;
+  adj.built = true;
+}
+
+vertex_address csr_snapshot::address_of(size_t global_id) const {
+  DASSERT_LT(global_id, num_vertices());
+  auto iter = std::upper_bound(m_partition_offsets.begin(),
+                               m_partition_offsets.end(), global_id);
+  size_t partition = (iter - m_partition_offsets.begin()) - 1;
+  return {partition, global_id - m_partition_offsets[partition]};
+}
+
+size_t csr_snapshot::memory_usage() const {
+  size_t ret = m_partition_offsets.size() * sizeof(size_t);
+  for (const adjacency* adj : {&m_out, &m_in}) {
+    ret += adj->edge_offsets.size() * sizeof(size_t);
+    ret += adj->byte_offsets.size() * sizeof(size_t);
+    ret += adj->neighbors.size();
+    ret += adj->weights.size() * sizeof(double);
+  }
+  return ret;
+}
+
+} // end of sgraph_compute
+} // end of graphlab
@@ -0,0 +1,245 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_SGRAPH_SGRAPH_CSR_SNAPSHOT_HPP
+#define GRAPHLAB_SGRAPH_SGRAPH_CSR_SNAPSHOT_HPP
+
+#include <vector>
+#include <string>
+#include <flexible_type/flexible_type.hpp>
+#include <serialization/iarchive.hpp>
+#include <sframe/integer_pack.hpp>
+#include <parallel/lambda_omp.hpp>
+#include <sgraph/sgraph.hpp>
+#include <sgraph/sgraph_fast_triple_apply.hpp>
+
+namespace graphlab {
+namespace sgraph_compute {
+
+/**
+ * An immutable, in-memory compressed adjacency snapshot of an \ref sgraph.
+ *
+ * The snapshot is meant for iterative algorithms (PageRank, connected
+ * components, ...) which sweep over all edges many times. The edge SFrames
+ * are read exactly once when the snapshot is built; every subsequent
+ * iteration only touches the in-memory arrays.
+ *
+ * Vertices are renumbered into a dense global id space:
+ * \code
+ *   global_id = partition_offset(partition) + local_id
+ * \endcode
+ * where (partition, local_id) is the \ref vertex_address used by
+ * \ref fast_triple_apply. Vertex data can hence be held in plain contiguous
+ * arrays of size \ref num_vertices() (see \ref load_vertex_column and
+ * \ref store_vertex_column).
+ *
+ * For each vertex, the sorted neighbor list is stored delta encoded with
+ * \ref integer_pack::variable_encode. The first neighbor is stored relative
+ * to the vertex itself (zigzag encoded), the rest as the gap to the previous
+ * neighbor. The out-edge list (CSR) and the in-edge list (CSC) are built
+ * independently, controlled by the edge direction passed to the constructor.
+ *
+ * Only vertex group 0 and edge group (0, 0) are captured, matching
+ * \ref fast_triple_apply. The snapshot does not observe later mutations to
+ * the graph.
+ *
+ * \code
+ * csr_snapshot csr(g, sgraph::edge_direction::IN_EDGE);
+ * std::vector<double> rank = csr.load_vertex_column<double>(g, "pagerank");
+ * std::vector<double> next(csr.num_vertices());
+ * for (size_t iter = 0; iter < 10; ++iter) {
+ *   csr.parallel_for_vertices([&](size_t v) {
+ *     double acc = 0;
+ *     csr.for_each_in_neighbor(v, [&](size_t u, double) { acc += rank[u]; });
+ *     next[v] = acc;
+ *   });
+ *   std::swap(rank, next);
+ * }
+ * csr.store_vertex_column(g, rank, "pagerank", flex_type_enum::FLOAT);
+ * \endcode
+ */
+class csr_snapshot {
+ public:
+  csr_snapshot() = default;
+
+  /**
+   * Builds a snapshot of the graph.
+   *
+   * \param g The graph to snapshot.
+   * \param dir OUT_EDGE builds the out-edge lists, IN_EDGE builds the
+   * in-edge lists, and ANY_EDGE builds both.
+   * \param weight_field An optional numeric edge field. If not empty, its
+   * value is kept alongside every edge and passed to the neighbor visitors.
+   * Otherwise every edge has weight 1.0.
+   */
+  csr_snapshot(const sgraph& g,
+               sgraph::edge_direction dir = sgraph::edge_direction::ANY_EDGE,
+               const std::string& weight_field = "");
+
+  /// Returns the total number of vertices in the snapshot.
+  inline size_t num_vertices() const {
+    return m_partition_offsets.empty() ? 0 : m_partition_offsets.back();
+  }
+
+  /// Returns the total number of edges in the snapshot.
+  inline size_t num_edges() const { return m_num_edges; }
+
+  /// Returns the number of vertex partitions of the source graph.
+  inline size_t num_partitions() const {
+    return m_partition_offsets.empty() ? 0 : m_partition_offsets.size() - 1;
+  }
+
+  /// Returns the first global id of a vertex partition.
+  inline size_t partition_offset(size_t partition) const {
+    return m_partition_offsets[partition];
+  }
+
+  /// Converts a vertex address into a global vertex id.
+  inline size_t global_id(const vertex_address& addr) const {
+    return m_partition_offsets[addr.partition_id] + addr.local_id;
+  }
+
+  /// Converts a global vertex id into a vertex address.
+  vertex_address address_of(size_t global_id) const;
+
+  /// Returns true if the out-edge lists were built.
+  inline bool has_out_edges() const { return m_out.built; }
+
+  /// Returns true if the in-edge lists were built.
+  inline bool has_in_edges() const { return m_in.built; }
+
+  /// Returns the number of out edges of a vertex. Requires out-edge lists.
+  inline size_t out_degree(size_t v) const { return m_out.degree(v); }
+
+  /// Returns the number of in edges of a vertex. Requires in-edge lists.
+  inline size_t in_degree(size_t v) const { return m_in.degree(v); }
+
+  /**
+   * Calls fn(size_t target, double weight) for every out edge of v,
+   * in increasing order of target.
+   */
+  template <typename Fn>
+  inline void for_each_out_neighbor(size_t v, Fn fn) const {
+    m_out.for_each_neighbor(v, fn);
+  }
+
+  /**
+   * Calls fn(size_t source, double weight) for every in edge of v,
+   * in increasing order of source.
+   */
+  template <typename Fn>
+  inline void for_each_in_neighbor(size_t v, Fn fn) const {
+    m_in.for_each_neighbor(v, fn);
+  }
+
+  /**
+   * Calls fn(size_t v) for every vertex in parallel.
+   */
+  template <typename Fn>
+  inline void parallel_for_vertices(Fn fn) const {
+    parallel_for(0, num_vertices(), fn);
+  }
+
+  /**
+   * Returns the number of bytes held by the snapshot.
+   */
+  size_t memory_usage() const;
+
+  /**
+   * Reads a vertex field into a contiguous array indexed by global id.
+   * The field values must be convertible to T.
+   */
+  template <typename T>
+  std::vector<T> load_vertex_column(const sgraph& g,
+                                    const std::string& field) const {
+    std::vector<T> ret(num_vertices());
+    auto column = g.fetch_vertex_data_field_in_memory(field);
+    ASSERT_EQ(column.size(), num_partitions());
+    parallel_for(0, column.size(), [&](size_t i) {
+      ASSERT_EQ(column[i].size(),
+                m_partition_offsets[i + 1] - m_partition_offsets[i]);
+      T* out = ret.data() + m_partition_offsets[i];
+      for (const auto& value : column[i]) *out++ = (T)(value);
+    });
+    return ret;
+  }
+
+  /**
+   * Writes a contiguous array indexed by global id back into the graph as a
+   * vertex field, replacing the field if it already exists.
+   */
+  template <typename T>
+  void store_vertex_column(sgraph& g,
+                           const std::vector<T>& column,
+                           const std::string& field,
+                           flex_type_enum field_type) const {
+    ASSERT_EQ(column.size(), num_vertices());
+    std::vector<std::vector<T>> partitioned(num_partitions());
+    for (size_t i = 0; i < num_partitions(); ++i) {
+      partitioned[i].assign(column.begin() + m_partition_offsets[i],
+                            column.begin() + m_partition_offsets[i + 1]);
+    }
+    auto fields = g.get_vertex_fields();
+    if (std::find(fields.begin(), fields.end(), field) != fields.end()) {
+      g.replace_vertex_field<T, flexible_type>(partitioned, field);
+    } else {
+      g.add_vertex_field<T, flexible_type>(partitioned, field, field_type);
+    }
+  }
+
+ private:
+  /**
+   * One direction of adjacency. Vertex v owns the edges
+   * [edge_offsets[v], edge_offsets[v+1]) and the encoded bytes
+   * [byte_offsets[v], byte_offsets[v+1]) of neighbors.
+   */
+  struct adjacency {
+    bool built = false;
+    std::vector<size_t> edge_offsets;
+    std::vector<size_t> byte_offsets;
+    std::vector<char> neighbors;
+    std::vector<double> weights;
+
+    inline size_t degree(size_t v) const {
+      DASSERT_TRUE(built);
+      return edge_offsets[v + 1] - edge_offsets[v];
+    }
+
+    template <typename Fn>
+    inline void for_each_neighbor(size_t v, Fn& fn) const {
+      DASSERT_TRUE(built);
+      size_t begin = edge_offsets[v];
+      size_t end = edge_offsets[v + 1];
+      if (begin == end) return;
+      iarchive iarc(neighbors.data() + byte_offsets[v],
+                    byte_offsets[v + 1] - byte_offsets[v]);
+      uint64_t code = 0;
+      integer_pack::variable_decode(iarc, code);
+      size_t nbr = v + integer_pack::shifted_integer_decode(code);
+      bool weighted = !weights.empty();
+      fn(nbr, weighted ? weights[begin] : 1.0);
+      for (size_t e = begin + 1; e < end; ++e) {
+        integer_pack::variable_decode(iarc, code);
+        nbr += code;
+        fn(nbr, weighted ? weights[e] : 1.0);
+      }
+    }
+  };
+
+  void build_adjacency(const sgraph& g, bool out_edges,
+                       const std::string& weight_field, adjacency& adj);
+
+  std::vector<size_t> m_partition_offsets;
+  size_t m_num_edges = 0;
+  adjacency m_out;
+  adjacency m_in;
+};
+
+} // end of sgraph_compute
+} // end of graphlab
+
+#endif
@@ -15,9 +15,12 @@
 #include <functional>
 #include <sframe/sarray.hpp>
 #include <sgraph/sgraph.hpp>
+#include <sgraph/hilbert_curve.hpp>
 #include <sgraph/hilbert_parallel_for.hpp>
+#include <sgraph/sgraph_partition_schedule.hpp>
 #include <sgraph/sgraph_compute_vertex_block.hpp>
 #include <util/cityhash_gl.hpp>
+#include <util/dense_bitset.hpp>
 
 namespace graphlab {
 namespace sgraph_compute {
@@ -127,17 +130,82 @@ class sgraph_engine {
                                 size_t central_group = 0,
                                 std::unordered_set<size_t> sgraph_compute_group = {0},
                                 size_t parallel_limit = (size_t)(-1)) {
+    return gather_impl(graph, gather, initial_value, edgedir, central_group,
+                       sgraph_compute_group, parallel_limit, NULL);
+  }
+
+  /**
+   * Frontier mode of \ref gather.
+   *
+   * Only the edges whose other vertex is active take part in the gather:
+   * the source of an in edge, the target of an out edge. Since edge
+   * partition (i, j) only holds edges from vertex partition i to vertex
+   * partition j, the edge partitions of inactive vertex partitions are not
+   * read at all, and their vertex blocks are not loaded. The vertices which
+   * gather nothing keep the initial value.
+   *
+   * \param active active[p] is the set of active rows of vertex partition p
+   * of the central group. It is also the frontier of the gathered groups.
+   *
+   * \note With a small graph held in memory, \ref frontier_engine over a
+   * \ref csr_snapshot avoids reading the edge partitions at every iteration.
+   */
+  std::vector<std::shared_ptr<sarray<T>>> gather_frontier(sgraph& graph,
+                                const std::vector<dense_bitset>& active,
+                                const_gather_function_type gather,
+                                const T& initial_value,
+                                edge_direction edgedir = edge_direction::ANY_EDGE,
+                                size_t central_group = 0,
+                                size_t parallel_limit = (size_t)(-1)) {
+    ASSERT_EQ(active.size(), graph.get_num_partitions());
+    return gather_impl(graph, gather, initial_value, edgedir, central_group,
+                       {central_group}, parallel_limit, &active);
+  }
+
+  /**
+   * Returns the number of edge partitions read by the last call to
+   * \ref gather or \ref gather_frontier.
+   */
+  size_t last_num_edge_partitions() const {
+    return m_num_edge_partitions;
+  }
+
+ private:
+  std::vector<std::shared_ptr<sarray<T>>> gather_impl(sgraph& graph,
+                                const_gather_function_type gather,
+                                const T& initial_value,
+                                edge_direction edgedir,
+                                size_t central_group,
+                                std::unordered_set<size_t> sgraph_compute_group,
+                                size_t parallel_limit,
+                                const std::vector<dense_bitset>* active) {
     if (parallel_limit == -1) {
       parallel_limit = thread::cpu_count();
     }
     init_data_structures(graph, central_group, initial_value);
-    hilbert_blocked_parallel_for(
-         graph.get_num_partitions(),
+    std::set<size_t> all_groups(sgraph_compute_group.begin(), sgraph_compute_group.end());
+    all_groups.insert(central_group);
+    std::vector<std::pair<size_t, size_t> > edge_partitions =
+        gather_edge_partitions(graph.get_num_partitions(), edgedir, active);
+    m_num_edge_partitions = edge_partitions.size();
+    scheduled_blocked_parallel_for(
+         estimate_vertex_block_bytes(graph, all_groups),
+         edge_partitions,
          // The preamble to each parallel for block.
          // Thisis the collection of edges that will be executed in the next pass.
-         [&](std::vector<std::pair<size_t, size_t> > edgeparts) {
+         [&](const std::vector<std::pair<size_t, size_t> >& edgeparts,
+             const std::set<size_t>& resident_partitions) {
            std::set<vertex_partition_address> vertex_partitions;
            std::set<size_t> combine_partitions;
+           // keep the vertex partitions the schedule retains for later passes.
+           for (size_t partition: resident_partitions) {
+             for (size_t group: all_groups) {
+               vertex_partitions.insert(vertex_partition_address(group, partition));
+             }
+             if (combine_data[partition].is_loaded()) {
+               combine_partitions.insert(partition);
+             }
+           }
            // for each partition requested, figure out exactly 
            // which partition / group I need to load
            // That does depend on the edge direction I am 
@@ -191,14 +259,53 @@ class sgraph_engine {
              address = edge_partition_address(gather_vgroup, central_group,
                                               edgepart.first, edgepart.second);
              sframe& edgeframe = graph.edge_partition(address);
-             compute_const_gather(edgeframe, address, central_group, edgedir, gather);
+             compute_const_gather(edgeframe, address, central_group, edgedir,
+                                  gather, active);
            }
-         });
+         },
+         SGRAPH_VERTEX_BLOCK_MEMORY_BUDGET,
+         parallel_limit,
+         &m_schedule_stats);
+    // release the vertex blocks
+    load_graph_vertex_blocks(graph, std::set<vertex_partition_address>());
     // flush the combine blocks
     load_combine_blocks(std::set<size_t>());
     return combine_sarrays;
   }
 
+  /**
+   * Returns the edge partitions a gather has to read, in hilbert curve
+   * order. Without a frontier, all of them. With a frontier, in edges are
+   * only read from active source partitions (rows of the edge partition
+   * grid), and out edges from active target partitions (columns).
+   */
+  static std::vector<std::pair<size_t, size_t> > gather_edge_partitions(
+      size_t num_partitions, edge_direction edgedir,
+      const std::vector<dense_bitset>* active) {
+    dense_bitset active_partitions(num_partitions);
+    active_partitions.fill();
+    if (active) {
+      for (size_t i = 0; i < num_partitions; ++i) {
+        if ((*active)[i].empty()) active_partitions.clear_bit_unsync(i);
+      }
+    }
+    bool in_edges = (edgedir == edge_direction::IN_EDGE ||
+                     edgedir == edge_direction::ANY_EDGE);
+    bool out_edges = (edgedir == edge_direction::OUT_EDGE ||
+                      edgedir == edge_direction::ANY_EDGE);
+    std::vector<std::pair<size_t, size_t> > ret;
+    for (size_t i = 0; i < num_partitions * num_partitions; ++i) {
+      auto coord = hilbert_index_to_coordinate(i, num_partitions);
+      if ((in_edges && active_partitions.get(coord.first)) ||
+          (out_edges && active_partitions.get(coord.second))) {
+        ret.push_back(coord);
+      }
+    }
+    return ret;
+  }
+
+ public:
+
 
   /**************************************************************************/
   /*                                                                        */
@@ -224,13 +331,21 @@ class sgraph_engine {
 
     size_t return_size = graph.get_num_partitions() * graph.get_num_partitions();
     std::vector<std::shared_ptr<sarray<T>>> return_edge_value(return_size);
-    hilbert_blocked_parallel_for(
-         graph.get_num_partitions(),
+    std::set<size_t> all_groups{groupa, groupb};
+    scheduled_blocked_parallel_for(
+         estimate_vertex_block_bytes(graph, all_groups),
          // The preamble to each parallel for block.
          // Thisis the collection of edges that will be executed in the next pass.
-         [&](std::vector<std::pair<size_t, size_t> > edgeparts) {
+         [&](const std::vector<std::pair<size_t, size_t> >& edgeparts,
+             const std::set<size_t>& resident_partitions) {
            std::set<vertex_partition_address> vertex_partitions;
            std::set<size_t> combine_partitions;
+           // keep the vertex partitions the schedule retains for later passes.
+           for (size_t partition: resident_partitions) {
+             for (size_t group: all_groups) {
+               vertex_partitions.insert(vertex_partition_address(group, partition));
+             }
+           }
            // for each partition requested, figure out exactly 
            // which partition / group I need to load
            // That does depend on the edge direction I am 
@@ -264,10 +379,23 @@ class sgraph_engine {
            sframe& edgeframe = graph.edge_partition(address);
            size_t partid = edgepart.first * graph.get_num_partitions() + edgepart.second;
            return_edge_value[partid] = compute_edge_map(edgeframe, address, map_fn, ret_type);
-         });
+         },
+         SGRAPH_VERTEX_BLOCK_MEMORY_BUDGET,
+         parallel_limit,
+         &m_schedule_stats);
+    // release the vertex blocks
+    load_graph_vertex_blocks(graph, std::set<vertex_partition_address>());
     return return_edge_value;
   }
 
+  /**
+   * Returns the vertex block schedule statistics of the last call to
+   * \ref gather or \ref parallel_for_edges.
+   */
+  const partition_schedule_stats& last_schedule_stats() const {
+    return m_schedule_stats;
+  }
+
  private:
   // vertex_data[group][partition]
   std::vector<std::vector<vertex_block<sframe> > > vertex_data;
@@ -277,6 +405,24 @@ class sgraph_engine {
   static constexpr size_t LOCK_ARRAY_SIZE = 1024;
   graphlab::mutex lock_array[LOCK_ARRAY_SIZE];
   flex_type_enum m_return_type = flex_type_enum::UNDEFINED;
+  partition_schedule_stats m_schedule_stats;
+  size_t m_num_edge_partitions = 0;
+
+  /**
+   * Returns the estimated in memory size of each vertex partition, summed
+   * over the given vertex groups.
+   */
+  std::vector<size_t> estimate_vertex_block_bytes(const sgraph& graph,
+                                                  const std::set<size_t>& groups) {
+    std::vector<size_t> ret(graph.get_num_partitions(), 0);
+    for (size_t partition = 0; partition < ret.size(); ++partition) {
+      for (size_t group: groups) {
+        ret[partition] += sgraph_compute::estimate_vertex_block_bytes(
+            graph.vertex_partition(partition, group));
+      }
+    }
+    return ret;
+  }
 
   template <typename S>
   typename std::enable_if<std::is_same<S, flexible_type>::value>::type
@@ -400,7 +546,8 @@ class sgraph_engine {
                             edge_partition_address address,
                             size_t central_group,
                             edge_direction edgedir,
-                            const_gather_function_type& gather) {
+                            const_gather_function_type& gather,
+                            const std::vector<dense_bitset>* active) {
     auto reader = edgeframe.get_reader();
     size_t row_start = 0;
     size_t row_end = reader->num_rows();
@@ -420,8 +567,9 @@ class sgraph_engine {
         size_t srcid = edgedata[srcid_column];
         size_t dstid = edgedata[dstid_column];
 
-        if (edgedir == edge_direction::IN_EDGE || 
-            edgedir == edge_direction::ANY_EDGE) {
+        if ((edgedir == edge_direction::IN_EDGE || 
+             edgedir == edge_direction::ANY_EDGE) &&
+            (active == NULL || (*active)[src_address.partition].get(srcid))) {
           DASSERT_EQ(address.dst_group, central_group);
           // acquire lock on the combine target
           size_t vertexhash = hash64_combine(hash64(dst_address.partition), hash64(dstid));
@@ -434,7 +582,8 @@ class sgraph_engine {
                  edge_direction::IN_EDGE,
                  combine_data[dst_address.partition][dstid]);
         }
-        if (edgedir == edge_direction::OUT_EDGE || edgedir == edge_direction::ANY_EDGE) {
+        if ((edgedir == edge_direction::OUT_EDGE || edgedir == edge_direction::ANY_EDGE) &&
+            (active == NULL || (*active)[dst_address.partition].get(dstid))) {
           DASSERT_EQ(address.src_group, central_group);
           // acquire lock on the combine target
           size_t vertexhash = hash64_combine(hash64(src_address.partition), hash64(srcid));
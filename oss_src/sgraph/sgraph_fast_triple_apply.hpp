@@ -8,9 +8,13 @@
 #ifndef GRAPHLAB_SGRAPH_SGRAPH_FAST_TRIPLE_APPLY
 #define GRAPHLAB_SGRAPH_SGRAPH_FAST_TRIPLE_APPLY
 
+#include<atomic>
+#include<algorithm>
+#include<type_traits>
 #include<flexible_type/flexible_type.hpp>
 #include<sgraph/sgraph.hpp>
 #include<sgraph/sgraph_compute_vertex_block.hpp>
+#include<sgraph/sgraph_triple_apply.hpp>
 
 namespace graphlab {
 namespace sgraph_compute {
@@ -80,6 +84,60 @@ void fast_triple_apply(sgraph& g,
                        const std::vector<std::string>& mutated_edge_fields);
 
 
+/**
+ * Applies a \ref combiner_op to two integers.
+ */
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, T>::type
+combined(combiner_op op, T acc, T value) {
+  switch(op) {
+    case combiner_op::SUM: return acc + value;
+    case combiner_op::MIN: return std::min(acc, value);
+    case combiner_op::MAX: return std::max(acc, value);
+    case combiner_op::BIT_OR: return acc | value;
+  }
+  return acc;
+}
+
+/**
+ * Applies a \ref combiner_op to two floating point values.
+ */
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, T>::type
+combined(combiner_op op, T acc, T value) {
+  switch(op) {
+    case combiner_op::SUM: return acc + value;
+    case combiner_op::MIN: return std::min(acc, value);
+    case combiner_op::MAX: return std::max(acc, value);
+    case combiner_op::BIT_OR:
+      log_and_throw("BIT_OR can only combine integer vertex data");
+  }
+  return acc;
+}
+
+/**
+ * Combines value into in-memory vertex data with a compare and swap loop,
+ * so that a fast_triple_apply function can update vertex data without
+ * locks.
+ *
+ * \code
+ * auto out_degree = create_vertex_data<std::atomic<size_t>>(g);
+ * fast_triple_apply(g, [&](fast_edge_scope& scope) {
+ *   auto addr = scope.source_vertex_address();
+ *   combine_atomic(combiner_op::SUM, out_degree[addr.partition_id][addr.local_id], size_t(1));
+ * }, {}, {});
+ * \endcode
+ */
+template <typename T>
+void combine_atomic(combiner_op op, std::atomic<T>& acc, T value) {
+  T current = acc.load(std::memory_order_relaxed);
+  T next = combined(op, current, value);
+  while (next != current &&
+         !acc.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+    next = combined(op, current, value);
+  }
+}
+
 /**
  * Utility function
  */
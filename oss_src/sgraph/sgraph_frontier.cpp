@@ -0,0 +1,122 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <sgraph/sgraph_frontier.hpp>
+#include <parallel/atomic_ops.hpp>
+#include <logger/logger.hpp>
+#include <limits>
+#include <map>
+
+namespace graphlab {
+namespace sgraph_compute {
+
+void vertex_frontier::clear() {
+  for (size_t v : m_vertices) m_active.clear_bit_unsync(v);
+  m_vertices.clear();
+}
+
+bool frontier_engine::use_pull(const vertex_frontier& frontier) const {
+  if (!m_csr->has_in_edges()) return false;
+  if (!m_csr->has_out_edges()) return true;
+  size_t threshold = m_csr->num_edges() / SGRAPH_FRONTIER_PULL_THRESHOLD;
+  size_t work = frontier.num_active();
+  for (size_t v : frontier.active_vertices()) {
+    if (work > threshold) return true;
+    work += m_csr->out_degree(v);
+  }
+  return work > threshold;
+}
+
+void frontier_engine::gather_chunks(std::vector<std::vector<size_t> >& chunks,
+                                    vertex_frontier& next) {
+  size_t total = 0;
+  for (const auto& chunk : chunks) total += chunk.size();
+  next.m_vertices.reserve(total);
+  for (auto& chunk : chunks) {
+    next.m_vertices.insert(next.m_vertices.end(), chunk.begin(), chunk.end());
+    std::vector<size_t>().swap(chunk);
+  }
+}
+
+namespace {
+  /**
+   * Atomically lowers target to value. Returns true if target was lowered.
+   */
+  inline bool atomic_lower(volatile double& target, double value) {
+    double current = target;
+    while (value < current) {
+      if (atomic_compare_and_swap(target, current, value)) return true;
+      current = target;
+    }
+    return false;
+  }
+}
+
+std::vector<double> delta_stepping_sssp(const csr_snapshot& csr,
+                                        size_t source,
+                                        double delta,
+                                        frontier_stats* stats) {
+  ASSERT_LT(source, csr.num_vertices());
+  ASSERT_GT(delta, 0);
+  if (!csr.has_out_edges()) {
+    log_and_throw("delta_stepping_sssp requires the out edges of the snapshot");
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<double> dist(csr.num_vertices(), inf);
+  dist[source] = 0;
+
+  auto bucket_of = [&](double d) { return (size_t)(d / delta); };
+
+  // buckets may contain stale entries of vertices which moved to a lower
+  // bucket since. They are skipped when the bucket is processed.
+  std::map<size_t, std::vector<size_t> > buckets;
+  buckets[0].push_back(source);
+
+  frontier_engine engine(csr);
+  vertex_frontier frontier(csr.num_vertices());
+  auto relax = [&](size_t u, size_t v, double weight) {
+    return atomic_lower(dist[v], dist[u] + weight);
+  };
+
+  size_t num_buckets = 0;
+  while (!buckets.empty()) {
+    size_t current = buckets.begin()->first;
+    std::vector<size_t> members = std::move(buckets.begin()->second);
+    buckets.erase(buckets.begin());
+
+    frontier.clear();
+    for (size_t v : members) {
+      if (bucket_of(dist[v]) == current) frontier.activate(v);
+    }
+    if (frontier.empty()) continue;
+    ++num_buckets;
+
+    // relax until the current bucket is settled
+    while (!frontier.empty()) {
+      vertex_frontier next = engine.edge_map(frontier, relax);
+      frontier.clear();
+      for (size_t v : next.active_vertices()) {
+        size_t b = bucket_of(dist[v]);
+        if (b <= current) {
+          frontier.activate(v);
+        } else {
+          buckets[b].push_back(v);
+        }
+      }
+    }
+  }
+
+  logstream(LOG_INFO) << "Delta stepping processed " << num_buckets
+                      << " buckets in " << engine.stats().num_push << " push and "
+                      << engine.stats().num_pull << " pull iterations" << std::endl;
+  if (stats) *stats = engine.stats();
+  return dist;
+}
+
+} // end of sgraph_compute
+} // end of graphlab
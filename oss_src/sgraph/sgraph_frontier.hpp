@@ -0,0 +1,286 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_SGRAPH_SGRAPH_FRONTIER_HPP
+#define GRAPHLAB_SGRAPH_SGRAPH_FRONTIER_HPP
+
+#include <vector>
+#include <util/dense_bitset.hpp>
+#include <parallel/lambda_omp.hpp>
+#include <parallel/pthread_tools.hpp>
+#include <sgraph/sgraph_constants.hpp>
+#include <sgraph/sgraph_csr_snapshot.hpp>
+
+namespace graphlab {
+namespace sgraph_compute {
+
+/**
+ * A set of active vertices of a \ref csr_snapshot, addressed by global id.
+ *
+ * The frontier keeps both a dense bitset, for constant time membership
+ * tests, and the list of active vertices, so that iterating over a small
+ * frontier does not scan the whole vertex set.
+ */
+class vertex_frontier {
+ public:
+  vertex_frontier() = default;
+
+  /// Constructs an empty frontier over num_vertices vertices.
+  explicit vertex_frontier(size_t num_vertices) : m_active(num_vertices) { }
+
+  /// Returns the number of vertices the frontier is defined over.
+  inline size_t num_vertices() const { return m_active.size(); }
+
+  /// Returns the number of active vertices.
+  inline size_t num_active() const { return m_vertices.size(); }
+
+  /// Returns true if no vertex is active.
+  inline bool empty() const { return m_vertices.empty(); }
+
+  /// Returns the fraction of active vertices.
+  inline double density() const {
+    return num_vertices() == 0 ? 0.0 : (double)num_active() / num_vertices();
+  }
+
+  /// Returns true if the vertex is active.
+  inline bool is_active(size_t v) const { return m_active.get(v); }
+
+  /**
+   * Activates a vertex. Returns false if it was already active.
+   * Not thread safe.
+   */
+  inline bool activate(size_t v) {
+    if (m_active.set_bit_unsync(v)) return false;
+    m_vertices.push_back(v);
+    return true;
+  }
+
+  /// Returns the active vertices, in activation order.
+  inline const std::vector<size_t>& active_vertices() const { return m_vertices; }
+
+  /// Deactivates all vertices.
+  void clear();
+
+ private:
+  friend class frontier_engine;
+
+  dense_bitset m_active;
+  std::vector<size_t> m_vertices;
+};
+
+/**
+ * Statistics of the iterations run by a \ref frontier_engine.
+ */
+struct frontier_stats {
+  /// Number of edge_map calls which pushed along out edges.
+  size_t num_push = 0;
+  /// Number of edge_map calls which pulled along in edges.
+  size_t num_pull = 0;
+  /// Number of edges visited.
+  size_t edges_visited = 0;
+};
+
+/**
+ * Frontier based (sparse) execution over a \ref csr_snapshot.
+ *
+ * Instead of sweeping all edges on every iteration, \ref edge_map only
+ * visits the edges adjacent to the active vertices, and produces the
+ * frontier of the next iteration. Each call picks a direction based on the
+ * frontier density:
+ *  - push: for every active vertex u and out edge (u, v), if cond(v),
+ *    call update(u, v, weight). Only the edges of the frontier are visited.
+ *  - pull: for every vertex v such that cond(v), and in edge (u, v) with u
+ *    active, call update(u, v, weight). Every vertex is visited once, but
+ *    updates to v happen in a single thread and stop as soon as cond(v)
+ *    becomes false.
+ * A vertex v joins the next frontier when an update returns true.
+ *
+ * Pull is chosen when the number of active vertices and their out edges
+ * exceeds num_edges / SGRAPH_FRONTIER_PULL_THRESHOLD, and requires the
+ * in-edge lists. Push requires the out-edge lists. With a single direction
+ * in the snapshot, that direction is always used.
+ *
+ * In push mode, update may be called concurrently for the same target and
+ * must be thread safe (\ref delta_stepping_sssp lowers distances with a
+ * compare and swap loop).
+ *
+ * This is the in memory fast path: the snapshot must fit in memory. For
+ * graphs that do not, \ref sgraph_engine::gather_frontier skips the edge
+ * partitions of inactive vertex partitions out of core.
+ *
+ * \code
+ * // breadth first search levels
+ * csr_snapshot csr(g);
+ * frontier_engine engine(csr);
+ * std::vector<size_t> level(csr.num_vertices(), (size_t)(-1));
+ * vertex_frontier frontier(csr.num_vertices());
+ * frontier.activate(source);
+ * level[source] = 0;
+ * for (size_t depth = 1; !frontier.empty(); ++depth) {
+ *   frontier = engine.edge_map(frontier,
+ *       [&](size_t u, size_t v, double) {
+ *         return atomic_compare_and_swap(level[v], (size_t)(-1), depth); },
+ *       [&](size_t v) { return level[v] == (size_t)(-1); });
+ * }
+ * \endcode
+ */
+class frontier_engine {
+ public:
+  explicit frontier_engine(const csr_snapshot& csr) : m_csr(&csr) { }
+
+  /**
+   * Visits the edges out of the frontier, and returns the next frontier.
+   * See the class documentation.
+   *
+   * \param frontier The active vertices.
+   * \param update fn(size_t u, size_t v, double weight) -> bool.
+   * \param cond fn(size_t v) -> bool. Targets for which cond is false
+   * are skipped.
+   */
+  template <typename UpdateFn, typename CondFn>
+  vertex_frontier edge_map(const vertex_frontier& frontier,
+                           UpdateFn update, CondFn cond) {
+    DASSERT_EQ(frontier.num_vertices(), m_csr->num_vertices());
+    vertex_frontier next(m_csr->num_vertices());
+    if (frontier.empty()) return next;
+    if (use_pull(frontier)) {
+      ++m_stats.num_pull;
+      pull(frontier, update, cond, next);
+    } else {
+      ++m_stats.num_push;
+      push(frontier, update, cond, next);
+    }
+    return next;
+  }
+
+  /**
+   * Overload. Visits every target.
+   */
+  template <typename UpdateFn>
+  vertex_frontier edge_map(const vertex_frontier& frontier, UpdateFn update) {
+    return edge_map(frontier, update, [](size_t) { return true; });
+  }
+
+  /**
+   * Calls fn(size_t v) for every active vertex in parallel.
+   */
+  template <typename Fn>
+  void vertex_map(const vertex_frontier& frontier, Fn fn) const {
+    const std::vector<size_t>& vertices = frontier.active_vertices();
+    parallel_for(0, vertices.size(), [&](size_t i) { fn(vertices[i]); });
+  }
+
+  /// Returns the statistics of all edge_map calls so far.
+  inline const frontier_stats& stats() const { return m_stats; }
+
+ private:
+  /**
+   * Returns true if the next edge_map should pull.
+   */
+  bool use_pull(const vertex_frontier& frontier) const;
+
+  /**
+   * Returns the number of chunks the work is split into. Each chunk
+   * collects the vertices it activates in its own buffer.
+   */
+  static size_t num_chunks(size_t work) {
+    return std::max<size_t>(1, std::min<size_t>(work, thread::cpu_count() * 4));
+  }
+
+  /**
+   * Concatenates the vertices activated by each chunk into the frontier.
+   * The bits are already set.
+   */
+  static void gather_chunks(std::vector<std::vector<size_t> >& chunks,
+                            vertex_frontier& next);
+
+  template <typename UpdateFn, typename CondFn>
+  void push(const vertex_frontier& frontier, UpdateFn& update, CondFn& cond,
+            vertex_frontier& next) {
+    const std::vector<size_t>& vertices = frontier.active_vertices();
+    size_t nchunks = num_chunks(vertices.size());
+    std::vector<std::vector<size_t> > activated(nchunks);
+    std::vector<size_t> visited(nchunks, 0);
+    parallel_for(0, nchunks, [&](size_t chunk) {
+      size_t begin = vertices.size() * chunk / nchunks;
+      size_t end = vertices.size() * (chunk + 1) / nchunks;
+      for (size_t i = begin; i < end; ++i) {
+        size_t u = vertices[i];
+        m_csr->for_each_out_neighbor(u, [&](size_t v, double weight) {
+          ++visited[chunk];
+          if (cond(v) && update(u, v, weight)) {
+            // set_bit is atomic, only the first activation records v
+            if (!next.m_active.set_bit(v)) activated[chunk].push_back(v);
+          }
+        });
+      }
+    });
+    for (size_t n : visited) m_stats.edges_visited += n;
+    gather_chunks(activated, next);
+  }
+
+  template <typename UpdateFn, typename CondFn>
+  void pull(const vertex_frontier& frontier, UpdateFn& update, CondFn& cond,
+            vertex_frontier& next) {
+    size_t num_vertices = m_csr->num_vertices();
+    size_t nchunks = num_chunks(num_vertices);
+    std::vector<std::vector<size_t> > activated(nchunks);
+    std::vector<size_t> visited(nchunks, 0);
+    parallel_for(0, nchunks, [&](size_t chunk) {
+      size_t begin = num_vertices * chunk / nchunks;
+      size_t end = num_vertices * (chunk + 1) / nchunks;
+      for (size_t v = begin; v < end; ++v) {
+        if (!cond(v)) continue;
+        bool active = false;
+        m_csr->for_each_in_neighbor(v, [&](size_t u, double weight) {
+          ++visited[chunk];
+          if (frontier.is_active(u) && cond(v) && update(u, v, weight)) {
+            active = true;
+          }
+        });
+        if (active) {
+          next.m_active.set_bit(v);
+          activated[chunk].push_back(v);
+        }
+      }
+    });
+    for (size_t n : visited) m_stats.edges_visited += n;
+    gather_chunks(activated, next);
+  }
+
+  const csr_snapshot* m_csr;
+  frontier_stats m_stats;
+};
+
+/**
+ * Single source shortest path by delta stepping over a
+ * \ref frontier_engine.
+ *
+ * Vertices are processed in buckets of tentative distance
+ * [i * delta, (i+1) * delta), in increasing order of i. The vertices of the
+ * current bucket are relaxed until the bucket is empty, then the next non
+ * empty bucket is processed. A large delta degenerates to a frontier
+ * Bellman-Ford, a small delta to Dijkstra's algorithm.
+ *
+ * \param csr The snapshot. It must contain the out-edge lists, and the
+ * in-edge lists to allow pull iterations. Edge weights must be non negative.
+ * \param source The global id of the source vertex.
+ * \param delta The bucket width, must be positive.
+ * \param stats If not NULL, filled with the statistics of the run.
+ *
+ * Returns the distances indexed by global id. Unreachable vertices have an
+ * infinite distance.
+ */
+std::vector<double> delta_stepping_sssp(const csr_snapshot& csr,
+                                        size_t source,
+                                        double delta,
+                                        frontier_stats* stats = NULL);
+
+} // end of sgraph_compute
+} // end of graphlab
+
+#endif
@@ -0,0 +1,283 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <sgraph/sgraph_partition_schedule.hpp>
+#include <sgraph/hilbert_curve.hpp>
+#include <sframe/sarray_v2_block_manager.hpp>
+#include <fileio/general_fstream.hpp>
+#include <parallel/lambda_omp.hpp>
+#include <logger/logger.hpp>
+
+namespace graphlab {
+namespace sgraph_compute {
+
+/**
+ * Returns all the edge partitions in hilbert curve order.
+ */
+static std::vector<std::pair<size_t, size_t> > all_edge_partitions(size_t n) {
+  std::vector<std::pair<size_t, size_t> > coordinates;
+  for (size_t i = 0; i < n * n; ++i) {
+    coordinates.push_back(hilbert_index_to_coordinate(i, n));
+  }
+  return coordinates;
+}
+
+std::vector<partition_schedule_pass> plan_partition_schedule(
+    const std::vector<size_t>& vertex_block_bytes,
+    size_t memory_budget,
+    size_t parallel_limit,
+    partition_schedule_stats* stats) {
+  return plan_partition_schedule(vertex_block_bytes,
+                                 all_edge_partitions(vertex_block_bytes.size()),
+                                 memory_budget, parallel_limit, stats);
+}
+
+std::vector<partition_schedule_pass> plan_partition_schedule(
+    const std::vector<size_t>& vertex_block_bytes,
+    const std::vector<std::pair<size_t, size_t> >& coordinates,
+    size_t memory_budget,
+    size_t parallel_limit,
+    partition_schedule_stats* stats) {
+  size_t n = vertex_block_bytes.size();
+  ASSERT_GE(parallel_limit, 1);
+
+  // The unscheduled edge partitions adjacent to each vertex partition,
+  // in the order given. A pick only has to look at the lists of the
+  // vertex partitions already in memory.
+  std::vector<std::set<size_t> > unscheduled(n);
+  for (size_t idx = 0; idx < coordinates.size(); ++idx) {
+    unscheduled[coordinates[idx].first].insert(idx);
+    unscheduled[coordinates[idx].second].insert(idx);
+  }
+
+  auto bytes_of = [&](const std::set<size_t>& blocks) {
+    size_t ret = 0;
+    for (size_t b : blocks) ret += vertex_block_bytes[b];
+    return ret;
+  };
+
+  partition_schedule_stats local_stats;
+  std::vector<partition_schedule_pass> schedule;
+  std::set<size_t> resident;
+  std::vector<bool> is_resident(n, false);
+  size_t num_remaining = coordinates.size();
+
+  while (num_remaining > 0) {
+    partition_schedule_pass pass;
+    std::set<size_t> needed;
+    std::vector<bool> is_needed(n, false);
+    std::vector<size_t> picked;
+    size_t needed_bytes = 0;
+
+    // Returns the bytes to add to the pass, and the bytes to load,
+    // for executing an edge partition.
+    auto cost_of = [&](size_t idx) {
+      const auto& coord = coordinates[idx];
+      std::pair<size_t, size_t> ret{0, 0};
+      for (size_t b : {coord.first, coord.second}) {
+        if (!is_needed[b]) {
+          ret.first += vertex_block_bytes[b];
+          if (!is_resident[b]) ret.second += vertex_block_bytes[b];
+        }
+        if (coord.first == coord.second) break;
+      }
+      return ret;
+    };
+
+    // Picks the cheapest edge partition within the budget among the
+    // candidates. Returns false if none fits.
+    auto pick_from = [&](const std::set<size_t>& candidates,
+                         size_t& best, size_t& best_cost) {
+      bool found = false;
+      for (size_t idx : candidates) {
+        auto cost = cost_of(idx);
+        if (!pass.coordinates.empty() &&
+            needed_bytes + cost.first > memory_budget) {
+          continue;
+        }
+        if (cost.second < best_cost ||
+            (cost.second == best_cost && idx < best)) {
+          best = idx;
+          best_cost = cost.second;
+          found = true;
+        }
+        // candidates are in the order given
+        if (cost.second == 0) break;
+      }
+      return found;
+    };
+
+    while (pass.coordinates.size() < parallel_limit) {
+      size_t best = (size_t)(-1);
+      size_t best_cost = (size_t)(-1);
+      // edge partitions adjacent to the vertex partitions in memory
+      for (size_t b : needed) pick_from(unscheduled[b], best, best_cost);
+      for (size_t b : resident) {
+        if (!is_needed[b]) pick_from(unscheduled[b], best, best_cost);
+      }
+      if (best == (size_t)(-1)) {
+        // Nothing adjacent fits: start from the smallest vertex partition
+        // not in memory which still has work left.
+        size_t start = (size_t)(-1);
+        for (size_t b = 0; b < n; ++b) {
+          if (unscheduled[b].empty() || is_needed[b] || is_resident[b]) {
+            continue;
+          }
+          if (start == (size_t)(-1) ||
+              vertex_block_bytes[b] < vertex_block_bytes[start]) {
+            start = b;
+          }
+        }
+        if (start != (size_t)(-1)) pick_from(unscheduled[start], best, best_cost);
+      }
+      if (best == (size_t)(-1)) break;
+
+      const auto& coord = coordinates[best];
+      unscheduled[coord.first].erase(best);
+      unscheduled[coord.second].erase(best);
+      picked.push_back(best);
+      pass.coordinates.push_back(coord);
+      needed.insert(coord.first);
+      needed.insert(coord.second);
+      is_needed[coord.first] = true;
+      is_needed[coord.second] = true;
+      needed_bytes = bytes_of(needed);
+    }
+    DASSERT_FALSE(picked.empty());
+
+    num_remaining -= picked.size();
+
+    for (size_t b : needed) {
+      if (resident.count(b) == 0) {
+        ++local_stats.vertex_block_loads;
+        local_stats.bytes_loaded += vertex_block_bytes[b];
+      }
+    }
+
+    // Retain the previously resident blocks which still have work left,
+    // the ones with the most remaining work first, within the budget.
+    std::vector<size_t> candidates;
+    for (size_t b : resident) {
+      if (needed.count(b) == 0 && !unscheduled[b].empty()) candidates.push_back(b);
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [&](size_t a, size_t b) {
+                       return unscheduled[a].size() > unscheduled[b].size();
+                     });
+    std::set<size_t> next_resident = needed;
+    size_t resident_bytes = needed_bytes;
+    for (size_t b : candidates) {
+      if (resident_bytes + vertex_block_bytes[b] <= memory_budget) {
+        next_resident.insert(b);
+        resident_bytes += vertex_block_bytes[b];
+      }
+    }
+    for (size_t b : resident) {
+      if (next_resident.count(b) == 0) ++local_stats.vertex_block_unloads;
+    }
+
+    for (size_t b : resident) is_resident[b] = false;
+    for (size_t b : next_resident) is_resident[b] = true;
+    resident = next_resident;
+    pass.resident_partitions = next_resident;
+    schedule.push_back(std::move(pass));
+  }
+  // everything is released at the end
+  local_stats.vertex_block_unloads += resident.size();
+  local_stats.num_passes = schedule.size();
+
+  if (stats) *stats = local_stats;
+  return schedule;
+}
+
+/**
+ * Returns the size of the values of a column once decompressed, from the
+ * block metadata.
+ */
+static size_t column_payload_bytes(const sarray<flexible_type>& column) {
+  auto index_info = column.get_index_info();
+  size_t ret = 0;
+  if (index_info.version < 2) {
+    for (const auto& segment_file : index_info.segment_files) {
+      general_ifstream fin(segment_file);
+      if (fin.good()) ret += fin.file_size();
+    }
+    return ret;
+  }
+  auto& manager = v2_block_impl::block_manager::get_instance();
+  for (const auto& segment_file : index_info.segment_files) {
+    auto columnaddr = manager.open_column(segment_file);
+    size_t nblocks = manager.num_blocks_in_column(columnaddr);
+    for (size_t j = 0; j < nblocks; ++j) {
+      v2_block_impl::block_address blockaddr{std::get<0>(columnaddr),
+                                             std::get<1>(columnaddr), j};
+      ret += manager.get_block_info(blockaddr).block_size;
+    }
+    manager.close_column(columnaddr);
+  }
+  return ret;
+}
+
+size_t estimate_vertex_block_bytes(const sframe& sf) {
+  size_t ret = sf.num_rows() * (sizeof(std::vector<flexible_type>) +
+                                sf.num_columns() * sizeof(flexible_type));
+  for (size_t i = 0; i < sf.num_columns(); ++i) {
+    switch (sf.column_type(i)) {
+     case flex_type_enum::INTEGER:
+     case flex_type_enum::FLOAT:
+     case flex_type_enum::DATETIME:
+     case flex_type_enum::UNDEFINED:
+       // stored within the flexible_type
+       break;
+     default:
+       ret += column_payload_bytes(*sf.select_column(i));
+    }
+  }
+  return ret;
+}
+
+void scheduled_blocked_parallel_for(
+    const std::vector<size_t>& vertex_block_bytes,
+    std::function<void(const std::vector<std::pair<size_t, size_t> >&,
+                       const std::set<size_t>&)> preamble,
+    std::function<void(std::pair<size_t, size_t>)> fn,
+    size_t memory_budget,
+    size_t parallel_limit,
+    partition_schedule_stats* stats) {
+  scheduled_blocked_parallel_for(vertex_block_bytes,
+                                 all_edge_partitions(vertex_block_bytes.size()),
+                                 preamble, fn, memory_budget, parallel_limit,
+                                 stats);
+}
+
+void scheduled_blocked_parallel_for(
+    const std::vector<size_t>& vertex_block_bytes,
+    const std::vector<std::pair<size_t, size_t> >& edge_partitions,
+    std::function<void(const std::vector<std::pair<size_t, size_t> >&,
+                       const std::set<size_t>&)> preamble,
+    std::function<void(std::pair<size_t, size_t>)> fn,
+    size_t memory_budget,
+    size_t parallel_limit,
+    partition_schedule_stats* stats) {
+  partition_schedule_stats local_stats;
+  auto schedule = plan_partition_schedule(vertex_block_bytes, edge_partitions,
+                                          memory_budget, parallel_limit,
+                                          &local_stats);
+  logstream(LOG_INFO) << "Vertex block schedule: " << local_stats.num_passes
+                      << " passes, " << local_stats.vertex_block_loads
+                      << " loads, " << local_stats.vertex_block_unloads
+                      << " unloads, " << local_stats.bytes_loaded
+                      << " bytes loaded" << std::endl;
+  for (const auto& pass : schedule) {
+    preamble(pass.coordinates, pass.resident_partitions);
+    parallel_for(pass.coordinates.begin(), pass.coordinates.end(), fn);
+  }
+  if (stats) *stats = local_stats;
+}
+
+} // end of sgraph_compute
+} // end of graphlab
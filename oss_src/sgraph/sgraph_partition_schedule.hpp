@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_SGRAPH_SGRAPH_PARTITION_SCHEDULE_HPP
+#define GRAPHLAB_SGRAPH_SGRAPH_PARTITION_SCHEDULE_HPP
+
+#include <set>
+#include <vector>
+#include <functional>
+#include <sframe/sframe.hpp>
+#include <sgraph/sgraph_constants.hpp>
+
+namespace graphlab {
+namespace sgraph_compute {
+
+/**
+ * Statistics of a vertex block schedule.
+ */
+struct partition_schedule_stats {
+  /// Number of passes (parallel blocks) in the schedule.
+  size_t num_passes = 0;
+  /// Number of times a vertex block is loaded into memory.
+  size_t vertex_block_loads = 0;
+  /// Number of times a vertex block is released from memory.
+  size_t vertex_block_unloads = 0;
+  /// Estimated bytes of vertex data loaded into memory.
+  size_t bytes_loaded = 0;
+};
+
+/**
+ * One pass of a vertex block schedule.
+ */
+struct partition_schedule_pass {
+  /// The edge partitions (row, column) executed in parallel in this pass.
+  std::vector<std::pair<size_t, size_t> > coordinates;
+  /**
+   * The vertex partitions which must be in memory during this pass.
+   * It contains all vertex partitions adjacent to \ref coordinates, and
+   * possibly vertex partitions retained for later passes.
+   */
+  std::set<size_t> resident_partitions;
+};
+
+/**
+ * Plans the order in which the n*n edge partitions are visited so that the
+ * vertex blocks held in memory never exceed a memory budget, while
+ * minimizing the number of times a vertex block is (re)loaded.
+ *
+ * The planner is greedy. Each pass picks up to parallel_limit edge partitions
+ * among the ones adjacent to a vertex block in memory, those requiring the
+ * fewest new bytes first (ties broken by Hilbert curve order). When none of
+ * them fits, it starts from the smallest vertex block not in memory.
+ * Between passes, vertex blocks that still have unvisited edge partitions are
+ * retained within the budget, those with the most remaining work first.
+ *
+ * A single edge partition whose two vertex blocks exceed the budget is still
+ * scheduled on its own.
+ *
+ * \param vertex_block_bytes The estimated in memory size of each vertex
+ * partition. Its size n is the number of partitions and must be a power of 2.
+ * \param memory_budget The memory budget in bytes.
+ * \param parallel_limit The maximum number of edge partitions in a pass.
+ * \param stats If not NULL, filled with the statistics of the schedule.
+ */
+std::vector<partition_schedule_pass> plan_partition_schedule(
+    const std::vector<size_t>& vertex_block_bytes,
+    size_t memory_budget,
+    size_t parallel_limit,
+    partition_schedule_stats* stats = NULL);
+
+/**
+ * Overload. Plans the visit of a subset of the edge partitions, for instance
+ * the ones adjacent to the active vertex partitions. Ties are broken by the
+ * order of edge_partitions, which should follow the Hilbert curve.
+ */
+std::vector<partition_schedule_pass> plan_partition_schedule(
+    const std::vector<size_t>& vertex_block_bytes,
+    const std::vector<std::pair<size_t, size_t> >& edge_partitions,
+    size_t memory_budget,
+    size_t parallel_limit,
+    partition_schedule_stats* stats = NULL);
+
+/**
+ * Returns an estimate of the in memory size of an sframe loaded as
+ * a vertex block.
+ *
+ * Every value takes a flexible_type. Strings, vectors, lists, dicts and images
+ * also take their payload, estimated by the decompressed size of the column
+ * blocks (or the size of the segment files of legacy arrays).
+ */
+size_t estimate_vertex_block_bytes(const sframe& sf);
+
+/**
+ * A drop-in replacement of \ref hilbert_blocked_parallel_for which follows
+ * the schedule of \ref plan_partition_schedule.
+ *
+ * \code
+ * for pass in plan_partition_schedule(vertex_block_bytes, budget, limit)
+ *   preamble(pass.coordinates, pass.resident_partitions)
+ *   parallel for over coordinate in pass.coordinates:
+ *      fn(coordinate)
+ * \endcode
+ *
+ * The preamble is responsible for loading the resident partitions and
+ * unloading every other partition.
+ */
+void scheduled_blocked_parallel_for(
+    const std::vector<size_t>& vertex_block_bytes,
+    std::function<void(const std::vector<std::pair<size_t, size_t> >&,
+                       const std::set<size_t>&)> preamble,
+    std::function<void(std::pair<size_t, size_t>)> fn,
+    size_t memory_budget = SGRAPH_VERTEX_BLOCK_MEMORY_BUDGET,
+    size_t parallel_limit = SGRAPH_HILBERT_CURVE_PARALLEL_FOR_NUM_THREADS,
+    partition_schedule_stats* stats = NULL);
+
+/**
+ * Overload. Only visits the given edge partitions.
+ */
+void scheduled_blocked_parallel_for(
+    const std::vector<size_t>& vertex_block_bytes,
+    const std::vector<std::pair<size_t, size_t> >& edge_partitions,
+    std::function<void(const std::vector<std::pair<size_t, size_t> >&,
+                       const std::set<size_t>&)> preamble,
+    std::function<void(std::pair<size_t, size_t>)> fn,
+    size_t memory_budget = SGRAPH_VERTEX_BLOCK_MEMORY_BUDGET,
+    size_t parallel_limit = SGRAPH_HILBERT_CURVE_PARALLEL_FOR_NUM_THREADS,
+    partition_schedule_stats* stats = NULL);
+
+} // end of sgraph_compute
+} // end of graphlab
+
+#endif
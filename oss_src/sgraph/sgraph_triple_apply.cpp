@@ -7,6 +7,7 @@
  */
 #include <sgraph/sgraph_triple_apply.hpp>
 #include <sgraph/hilbert_parallel_for.hpp>
+#include <sgraph/sgraph_partition_schedule.hpp>
 #include <sgraph/sgraph_constants.hpp>
 #include <util/cityhash_gl.hpp>
 #include <lambda/graph_lambda_interface.hpp>
@@ -148,19 +149,22 @@ namespace {
   template<typename EdgeVisitor>
   void triple_apply_impl::run(EdgeVisitor edge_visitor) {
     // preamble function that load the vertex blocks associated with the
-    // edge partitions to be visited.
-    std::function<void(std::vector<std::pair<size_t, size_t>>)>
-      preamble_fn = [&](std::vector<std::pair<size_t, size_t>> coordinates) {
+    // edge partitions to be visited, and keeps the vertex blocks the schedule
+    // retains for later passes.
+    auto preamble_fn = [&](const std::vector<std::pair<size_t, size_t>>& coordinates,
+                           const std::set<size_t>& resident_partitions) {
         std::set<vertex_partition_address> vertex_partition_to_load;
         std::set<vertex_partition_address> vertex_partition_to_unload;
 
         for (const auto& coordinate: coordinates) {
           size_t srcid = coordinate.first; 
           size_t dstid = coordinate.second; 
-          edge_partition_address edge_partition(0, 0, srcid, dstid);
           vertex_partition_to_load.insert(vertex_partition_address(0, srcid));
           vertex_partition_to_load.insert(vertex_partition_address(0, dstid));
         }
+        for (size_t partition: resident_partitions) {
+          vertex_partition_to_load.insert(vertex_partition_address(0, partition));
+        }
 
         for (const auto& address: m_loaded_vertex_block_address) {
           if (vertex_partition_to_load.find(address) == vertex_partition_to_load.end()) {
@@ -180,8 +184,13 @@ namespace {
         logstream(LOG_INFO) << message_ss.str() << std::endl;
       };
 
-    hilbert_blocked_parallel_for(
-        m_graph.get_num_partitions(),
+    std::vector<size_t> vertex_block_bytes(m_graph.get_num_partitions());
+    for (size_t i = 0; i < vertex_block_bytes.size(); ++i) {
+      vertex_block_bytes[i] = estimate_vertex_block_bytes(m_graph.vertex_partition(i));
+    }
+
+    scheduled_blocked_parallel_for(
+        vertex_block_bytes,
         preamble_fn,
         [&](std::pair<size_t, size_t> coordinate) {
           edge_partition_address partition_address(0, 0, coordinate.first, coordinate.second);
@@ -190,7 +199,7 @@ namespace {
         }
     );
     // unload and commit the remaining vertex block in the memory.
-    preamble_fn({});
+    preamble_fn({}, {});
   }
 
   void triple_apply_impl::init_data_structures(
@@ -982,7 +991,224 @@ namespace {
 
     sgraph_synchronize m_graph_sync;
   }; // end of lambda_triple_apply_edge_visitor
-  
+
+
+/**************************************************************************/
+/*                                                                        */
+/*                   Implementation of combiner triple apply              */
+/*                                                                        */
+/**************************************************************************/
+
+  /**
+   * State shared by all the combiner visitors of one combiner_triple_apply.
+   *
+   * accumulators[p] holds the combined updates of all vertices in vertex
+   * partition p, laid out vertex major: the update to combiner c of vertex i
+   * is at accumulators[p][i * ops.size() + c]. UNDEFINED denotes no update.
+   */
+  struct combiner_state {
+    std::vector<combiner_op> ops;
+    std::vector<std::vector<flexible_type>> accumulators;
+    std::vector<graphlab::mutex> partition_locks;
+  };
+
+  /**
+   * Visit the edges one at a time, creating a \ref combiner_edge_scope object
+   * and apply a user defined function on the scope.
+   *
+   * Vertex updates are accumulated into delta buffers private to the visited
+   * edge partition, so no vertex lock is taken per edge. The buffers are
+   * merged into the shared \ref combiner_state on \ref finalize, taking
+   * one lock per vertex partition.
+   */
+  class combiner_triple_apply_visitor : public edge_visitor_interface {
+   public:
+    /**
+     * Constructor.
+     * \param apply_fn the user defined apply function of type void(combiner_edge_scope&).
+     * \param state the accumulators shared by all edge partitions.
+     * \param srcid_column the column id of the source id field in edge data.
+     * \param dstid_column  the column id of the target id field in edge data.
+     */
+    combiner_triple_apply_visitor(
+        combiner_triple_apply_fn_type apply_fn,
+        combiner_state& state,
+        size_t srcid_column, size_t dstid_column) :
+      apply_fn(apply_fn), state(state),
+      srcid_column(srcid_column), dstid_column(dstid_column) { }
+
+    /**
+     * Set the source and target vertex partition, and allocate the
+     * delta buffers. Prepare an sframe to store the modfied edge data.
+     */
+    void load_partition(
+        sgraph& g,
+        vertex_block<sframe>& source_vertex_block,
+        vertex_block<sframe>& target_vertex_block,
+        const std::vector<field_info>& _mutated_vertex_fields,
+        const std::vector<field_info>& _mutated_edge_fields,
+        size_t _src_partition, size_t _dst_partition) {
+
+      source_vertex_data = &source_vertex_block;
+      target_vertex_data = &target_vertex_block;
+
+      src_partition = _src_partition;
+      dst_partition = _dst_partition;
+      edge_data_ptr = &(g.edge_partition(src_partition, dst_partition));
+
+      size_t num_combiners = state.ops.size();
+      m_source_delta.assign(source_vertex_block.m_vertices.size() * num_combiners,
+                            FLEX_UNDEFINED);
+      if (src_partition != dst_partition) {
+        m_target_delta.assign(target_vertex_block.m_vertices.size() * num_combiners,
+                              FLEX_UNDEFINED);
+      }
+
+      m_mutating_edge_data = !_mutated_edge_fields.empty();
+      if (m_mutating_edge_data) {
+        std::vector<std::string> field_names;
+        std::vector<flex_type_enum> field_types;
+        for (auto& finfo : _mutated_edge_fields) {
+          field_names.push_back(finfo.name);
+          field_types.push_back(finfo.type);
+          m_mutated_edge_field_ids.push_back(finfo.id);
+        }
+        m_mutated_edges.open_for_write(field_names, field_types, "", 1);
+        m_mutated_edge_data_writer = m_mutated_edges.get_output_iterator(0);
+      }
+    }
+
+    void visit_edges(std::vector<edge_data>& edgedata) {
+      std::vector<flexible_type> edge_data_buffer;
+      size_t num_mutated_fields = m_mutated_edge_field_ids.size();
+      size_t num_combiners = state.ops.size();
+      std::vector<flexible_type>& target_delta =
+          (src_partition == dst_partition) ? m_source_delta : m_target_delta;
+
+      for (auto& edata: edgedata) {
+        size_t srcid = edata[srcid_column];
+        size_t dstid = edata[dstid_column];
+
+        combiner_edge_scope scope(&(*source_vertex_data)[srcid],
+                                  &(*target_vertex_data)[dstid],
+                                  &edata,
+                                  m_source_delta.data() + srcid * num_combiners,
+                                  target_delta.data() + dstid * num_combiners,
+                                  &state.ops);
+
+        apply_fn(scope);
+
+        if (m_mutating_edge_data) {
+          edge_data_buffer.resize(num_mutated_fields);
+          for (size_t i = 0; i < num_mutated_fields; ++i) {
+            edge_data_buffer[i] = edata[m_mutated_edge_field_ids[i]];
+          }
+          *m_mutated_edge_data_writer = std::move(edge_data_buffer);
+          ++m_mutated_edge_data_writer;
+        }
+      }
+    }
+
+    /**
+     * Merge the delta buffers into the shared accumulators, and replace
+     * the edge partition sframe with the modified edge data.
+     */
+    void finalize() {
+      if (m_mutating_edge_data) {
+        m_mutated_edges.close();
+        for (size_t i  = 0; i < m_mutated_edge_field_ids.size(); ++i) {
+          *edge_data_ptr = edge_data_ptr->replace_column(
+              m_mutated_edges.select_column(i),
+              m_mutated_edges.column_name(i));
+        }
+      }
+      merge_delta(src_partition, m_source_delta);
+      if (src_partition != dst_partition) {
+        merge_delta(dst_partition, m_target_delta);
+      }
+    }
+
+  private:
+    void merge_delta(size_t partition, std::vector<flexible_type>& delta) {
+      size_t num_combiners = state.ops.size();
+      std::lock_guard<graphlab::mutex> guard(state.partition_locks[partition]);
+      auto& acc = state.accumulators[partition];
+      DASSERT_EQ(acc.size(), delta.size());
+      for (size_t i = 0; i < delta.size(); ++i) {
+        if (delta[i].get_type() != flex_type_enum::UNDEFINED) {
+          combine_value(state.ops[i % num_combiners], acc[i], delta[i]);
+        }
+      }
+      delta.clear();
+      delta.shrink_to_fit();
+    }
+
+    vertex_block<sframe>* source_vertex_data;
+    vertex_block<sframe>* target_vertex_data;
+    sframe* edge_data_ptr;
+
+    // delta buffers of the source and target vertex partitions. When the
+    // partitions are the same, only m_source_delta is used.
+    std::vector<flexible_type> m_source_delta;
+    std::vector<flexible_type> m_target_delta;
+
+    bool m_mutating_edge_data;
+    // sframe storing the mutated edge data.
+    sframe m_mutated_edges;
+    // output iterator of m_mutated_edges
+    sframe::iterator m_mutated_edge_data_writer;
+    // id of the edge fields to be modified.
+    std::vector<size_t> m_mutated_edge_field_ids;
+
+    // source vertex partition id
+    size_t src_partition;
+    // target vertex partition id
+    size_t dst_partition;
+
+    // user defined triple apply function
+    combiner_triple_apply_fn_type apply_fn;
+
+    combiner_state& state;
+    size_t srcid_column;
+    size_t dstid_column;
+  };
+
+  /**
+   * Apply the accumulated updates to the combined vertex fields of the graph.
+   */
+  void commit_combiners(sgraph& g,
+                        const std::vector<vertex_field_combiner>& combiners,
+                        combiner_state& state) {
+    size_t num_combiners = combiners.size();
+    const auto& all_vertex_field_types = g.get_vertex_field_types();
+    for (size_t c = 0; c < num_combiners; ++c) {
+      const std::string& field = combiners[c].field;
+      flex_type_enum ftype = all_vertex_field_types[g.get_vertex_field_id(field)];
+      auto column = g.fetch_vertex_data_field_in_memory(field);
+      parallel_for(0, column.size(), [&](size_t p) {
+        const auto& acc = state.accumulators[p];
+        for (size_t i = 0; i < column[p].size(); ++i) {
+          const flexible_type& delta = acc[i * num_combiners + c];
+          if (delta.get_type() == flex_type_enum::UNDEFINED) continue;
+          flexible_type& value = column[p][i];
+          combine_value(combiners[c].op, value, delta);
+          // contributions are checked to be numeric by combiner_edge_scope,
+          // but may be of a different numeric type than the field
+          if (value.get_type() != ftype) {
+            DASSERT_TRUE(value.get_type() == flex_type_enum::INTEGER ||
+                         value.get_type() == flex_type_enum::FLOAT);
+            if (ftype == flex_type_enum::INTEGER) {
+              value = (flex_int)(value.get<flex_float>());
+            } else {
+              value = (flex_float)(value.get<flex_int>());
+            }
+          }
+        }
+      });
+      g.replace_vertex_field<flexible_type>(column, field);
+    }
+  }
+
   }// end of empty namespace 
 
   /**
@@ -1003,6 +1229,54 @@ namespace {
     compute.run(visitor);
   }
 
+  /**
+   * The combiner triple apply API.
+   */
+  void combiner_triple_apply(sgraph& g, combiner_triple_apply_fn_type apply_fn,
+                             const std::vector<vertex_field_combiner>& combiners,
+                             const std::vector<std::string>& mutated_edge_fields) {
+    const auto& all_vertex_fields = g.get_vertex_fields();
+    const auto& all_vertex_field_types = g.get_vertex_field_types();
+    std::set<std::string> combined_fields;
+    combiner_state state;
+    for (const auto& combiner : combiners) {
+      auto iter = std::find(all_vertex_fields.begin(), all_vertex_fields.end(),
+                            combiner.field);
+      if (iter == all_vertex_fields.end()) {
+        log_and_throw(std::string("Cannot find vertex field: ") + combiner.field);
+      }
+      if (combiner.field == sgraph::VID_COLUMN_NAME) {
+        log_and_throw(std::string("Id column cannot be combined: ") + combiner.field);
+      }
+      if (!combined_fields.insert(combiner.field).second) {
+        log_and_throw(std::string("Vertex field is combined more than once: ") + combiner.field);
+      }
+      flex_type_enum ftype = all_vertex_field_types[iter - all_vertex_fields.begin()];
+      if (!combiner_accepts_type(combiner.op, ftype)) {
+        log_and_throw(std::string("Unsupported type for combined vertex field: ") + combiner.field);
+      }
+      state.ops.push_back(combiner.op);
+    }
+
+    state.accumulators.resize(g.get_num_partitions());
+    for (size_t i = 0; i < g.get_num_partitions(); ++i) {
+      state.accumulators[i].resize(g.vertex_partition(i).size() * combiners.size(),
+                                   FLEX_UNDEFINED);
+    }
+    state.partition_locks.resize(g.get_num_partitions());
+
+    // No vertex field is mutated in place, the combined fields are
+    // committed once all edges have been visited.
+    triple_apply_impl compute(g, {}, mutated_edge_fields);
+    size_t srcid_column = g.get_edge_field_id(sgraph::SRC_COLUMN_NAME);
+    size_t dstid_column = g.get_edge_field_id(sgraph::DST_COLUMN_NAME);
+
+    combiner_triple_apply_visitor visitor(apply_fn, state, srcid_column, dstid_column);
+    compute.run(visitor);
+
+    commit_combiners(g, combiners, state);
+  }
+
   /**
    * The batch_triple_apply API.
    *
@@ -8,6 +8,7 @@
 #ifndef GRAPHLAB_SGRAPH_SGRAPH_TRIPLE_APPLY
 #define GRAPHLAB_SGRAPH_SGRAPH_TRIPLE_APPLY
 
+#include<logger/logger.hpp>
 #include<flexible_type/flexible_type.hpp>
 #include<sgraph/sgraph.hpp>
 #include<sgraph/sgraph_compute_vertex_block.hpp>
@@ -84,6 +85,126 @@ class edge_scope {
 
 typedef std::function<void(edge_scope&)> triple_apply_fn_type;
 
+/**
+ * The reduction used to combine updates to a vertex field in
+ * \ref combiner_triple_apply. All operators are commutative and associative
+ * so the order in which edges are visited does not matter.
+ */
+enum class combiner_op {
+  SUM,    ///< Sum of all contributions (integer or float field).
+  MIN,    ///< Minimum of all contributions (integer or float field).
+  MAX,    ///< Maximum of all contributions (integer or float field).
+  BIT_OR  ///< Bitwise or of all contributions (integer field).
+};
+
+/**
+ * Declares that a vertex field is updated through a \ref combiner_op.
+ */
+struct vertex_field_combiner {
+  std::string field;
+  combiner_op op;
+};
+
+/**
+ * Returns true if values of the given type can be combined with op.
+ */
+inline bool combiner_accepts_type(combiner_op op, flex_type_enum type) {
+  if (op == combiner_op::BIT_OR) return type == flex_type_enum::INTEGER;
+  return type == flex_type_enum::INTEGER || type == flex_type_enum::FLOAT;
+}
+
+/**
+ * Combines value into acc using op. An UNDEFINED acc denotes an empty
+ * accumulator and is replaced by value.
+ */
+inline void combine_value(combiner_op op, flexible_type& acc,
+                          const flexible_type& value) {
+  if (acc.get_type() == flex_type_enum::UNDEFINED) {
+    acc = value;
+    return;
+  }
+  switch(op) {
+    case combiner_op::SUM:
+      acc += value;
+      break;
+    case combiner_op::MIN:
+      if (value < acc) acc = value;
+      break;
+    case combiner_op::MAX:
+      if (acc < value) acc = value;
+      break;
+    case combiner_op::BIT_OR:
+      acc = acc.get<flex_int>() | value.get<flex_int>();
+      break;
+  }
+}
+
+/**
+ * Edge scope used by \ref combiner_triple_apply.
+ *
+ * Vertex data is read only, and reflects the values before the
+ * combiner_triple_apply call. Updates to vertex fields are expressed through
+ * \ref combine_source and \ref combine_target, and become visible in
+ * the graph once the call returns.
+ */
+class combiner_edge_scope {
+ public:
+  /// Provide read only vertex data access
+  const vertex_data& source() const { return *m_source; }
+
+  const vertex_data& target() const { return *m_target; }
+
+  /// Provide edge data access
+  edge_data& edge() { return *m_edge; }
+
+  const edge_data& edge() const { return *m_edge; }
+
+  /**
+   * Combines value into the source vertex field declared at position
+   * combiner_id of the combiner list.
+   */
+  void combine_source(size_t combiner_id, const flexible_type& value) {
+    check_contribution(combiner_id, value);
+    combine_value((*m_ops)[combiner_id], m_source_delta[combiner_id], value);
+  }
+
+  /**
+   * Combines value into the target vertex field declared at position
+   * combiner_id of the combiner list.
+   */
+  void combine_target(size_t combiner_id, const flexible_type& value) {
+    check_contribution(combiner_id, value);
+    combine_value((*m_ops)[combiner_id], m_target_delta[combiner_id], value);
+  }
+
+  /// Do not construct combiner_edge_scope directly. Used by triple_apply_impl.
+  combiner_edge_scope(const vertex_data* source, const vertex_data* target,
+                      edge_data* edge,
+                      flexible_type* source_delta, flexible_type* target_delta,
+                      const std::vector<combiner_op>* ops) :
+      m_source(source), m_target(target), m_edge(edge),
+      m_source_delta(source_delta), m_target_delta(target_delta), m_ops(ops) { }
+
+ private:
+  void check_contribution(size_t combiner_id, const flexible_type& value) const {
+    DASSERT_LT(combiner_id, m_ops->size());
+    if (!combiner_accepts_type((*m_ops)[combiner_id], value.get_type())) {
+      log_and_throw(std::string("Unsupported type ")
+                    + flex_type_enum_to_name(value.get_type())
+                    + " combined into combiner " + std::to_string(combiner_id));
+    }
+  }
+
+  const vertex_data* m_source;
+  const vertex_data* m_target;
+  edge_data* m_edge;
+  flexible_type* m_source_delta;
+  flexible_type* m_target_delta;
+  const std::vector<combiner_op>* m_ops;
+};
+
+typedef std::function<void(combiner_edge_scope&)> combiner_triple_apply_fn_type;
+
 typedef std::function<void(std::vector<edge_scope>&)> batch_triple_apply_fn_type;
 
 /**
@@ -116,6 +237,34 @@ void triple_apply(sgraph& g,
                   bool requires_vertex_id = true);
 
 
+/**
+ * A lock free variant of triple_apply for commutative vertex updates.
+ *
+ * Instead of locking and mutating vertex data, the apply_fn declares its
+ * updates through \ref combiner_edge_scope::combine_source and
+ * \ref combiner_edge_scope::combine_target. Each edge partition accumulates
+ * the updates into its own delta buffers without any vertex lock, and the
+ * buffers are merged once per edge partition. When the call returns, every
+ * combined field holds combine(old value, all contributions).
+ *
+ * \code
+ * // out degree count
+ * combiner_triple_apply(g, [](combiner_edge_scope& scope) {
+ *                         scope.combine_source(0, 1);
+ *                       }, {{"out_degree", combiner_op::SUM}});
+ * \endcode
+ *
+ * \param g The target graph to perform the transformation.
+ * \param apply_fn The user defined function that will be applied on each edge scope.
+ * \param combiners The combined vertex fields and their reduction. combiner_id
+ *        in the scope functions indexes into this list.
+ * \param mutated_edge_fields A subset of edge data columns that the apply_fn will modify.
+ */
+void combiner_triple_apply(sgraph& g,
+                           combiner_triple_apply_fn_type apply_fn,
+                           const std::vector<vertex_field_combiner>& combiners,
+                           const std::vector<std::string>& mutated_edge_fields = {});
+
 /**
  * Overload. Uses python lambda function.
  */
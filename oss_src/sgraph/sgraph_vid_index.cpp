@@ -0,0 +1,302 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <sgraph/sgraph_vid_index.hpp>
+#include <sframe/sarray_reader_buffer.hpp>
+#include <fileio/general_fstream.hpp>
+#include <fileio/fs_utils.hpp>
+#include <fileio/sanitize_url.hpp>
+#include <logger/logger.hpp>
+#include <util/cityhash_gl.hpp>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace graphlab {
+
+const size_t sgraph_vid_index::NOT_FOUND;
+
+namespace {
+  /// Marks an unused slot of a segment table.
+  const uint64_t EMPTY_ROW = (uint64_t)(-1);
+
+  /**
+   * Two neighboring segments are merged when the older one is at most
+   * this many times larger than the newer one.
+   */
+  const size_t SEGMENT_MERGE_RATIO = 4;
+
+  const char INDEX_FILE_MAGIC[8] = {'S', 'G', 'V', 'I', 'D', 'X', 0, 0};
+  const uint64_t INDEX_FILE_VERSION = 1;
+
+  struct index_file_header {
+    char magic[8];
+    uint64_t version;
+    uint64_t size;
+    uint64_t capacity;
+  };
+
+  bool is_local_path(const std::string& path) {
+    std::string protocol = fileio::get_protocol(path);
+    return protocol == "" || protocol == "file";
+  }
+}
+
+/**
+ * An immutable open addressing (linear probing) hash table of entries.
+ * The table either owns its memory or wraps a memory mapped file.
+ */
+class sgraph_vid_index::segment {
+ public:
+  explicit segment(const std::vector<entry>& entries) {
+    size_t capacity = 16;
+    // keep the load factor under 0.7
+    while (capacity * 7 < entries.size() * 10) capacity *= 2;
+    m_owned.resize(capacity, entry{0, 0, EMPTY_ROW});
+    m_table = m_owned.data();
+    m_mask = capacity - 1;
+    m_size = entries.size();
+    for (const auto& e : entries) {
+      size_t pos = e.hash_low & m_mask;
+      while (m_owned[pos].row != EMPTY_ROW) pos = (pos + 1) & m_mask;
+      m_owned[pos] = e;
+    }
+  }
+
+  segment(std::vector<entry>&& table, size_t size)
+      : m_owned(std::move(table)) {
+    m_table = m_owned.data();
+    m_mask = m_owned.size() - 1;
+    m_size = size;
+  }
+
+  segment(const entry* table, size_t capacity, size_t size,
+          void* mapped, size_t mapped_length)
+      : m_table(table), m_mask(capacity - 1), m_size(size),
+        m_mapped(mapped), m_mapped_length(mapped_length) { }
+
+  segment(const segment&) = delete;
+  segment& operator=(const segment&) = delete;
+
+  ~segment() {
+#ifndef _WIN32
+    if (m_mapped) munmap(m_mapped, m_mapped_length);
+#endif
+  }
+
+  inline size_t find(uint64_t hash_high, uint64_t hash_low) const {
+    size_t pos = hash_low & m_mask;
+    while (true) {
+      const entry& e = m_table[pos];
+      if (e.row == EMPTY_ROW) return NOT_FOUND;
+      if (e.hash_low == hash_low && e.hash_high == hash_high) return e.row;
+      pos = (pos + 1) & m_mask;
+    }
+  }
+
+  inline size_t size() const { return m_size; }
+
+  inline size_t capacity() const { return m_mask + 1; }
+
+  inline const entry* table() const { return m_table; }
+
+  void collect(std::vector<entry>& out) const {
+    for (size_t i = 0; i < capacity(); ++i) {
+      if (m_table[i].row != EMPTY_ROW) out.push_back(m_table[i]);
+    }
+  }
+
+ private:
+  const entry* m_table = NULL;
+  size_t m_mask = 0;
+  size_t m_size = 0;
+  std::vector<entry> m_owned;
+  void* m_mapped = NULL;
+  size_t m_mapped_length = 0;
+};
+
+sgraph_vid_index::entry sgraph_vid_index::make_entry(const flexible_type& vid,
+                                                     size_t row) {
+  uint128_t h = vid.hash128();
+  return entry{(uint64_t)(h >> 64), (uint64_t)(h), (uint64_t)row};
+}
+
+sgraph_vid_index::sgraph_vid_index(const sarray<flexible_type>& vids) {
+  append(vids);
+  set_column(vids);
+}
+
+uint128_t sgraph_vid_index::column_identity(const sarray<flexible_type>& vids) {
+  const auto& index_info = vids.get_index_info();
+  uint128_t ret = hash128(index_info.segment_files);
+  for (size_t size: index_info.segment_sizes) ret = hash128_update(ret, size);
+  return ret;
+}
+
+bool sgraph_vid_index::indexes(const sarray<flexible_type>& vids) const {
+  return m_size == vids.size() && m_column_identity == column_identity(vids);
+}
+
+void sgraph_vid_index::set_column(const sarray<flexible_type>& vids) {
+  DASSERT_EQ(m_size, vids.size());
+  m_column_identity = column_identity(vids);
+}
+
+size_t sgraph_vid_index::find(const flexible_type& vid) const {
+  if (m_size == 0) return NOT_FOUND;
+  uint128_t h = vid.hash128();
+  uint64_t hash_high = (uint64_t)(h >> 64);
+  uint64_t hash_low = (uint64_t)(h);
+  for (auto iter = m_segments.rbegin(); iter != m_segments.rend(); ++iter) {
+    size_t row = (*iter)->find(hash_high, hash_low);
+    if (row != NOT_FOUND) return row;
+  }
+  return NOT_FOUND;
+}
+
+void sgraph_vid_index::append(const std::vector<flexible_type>& vids) {
+  std::vector<entry> entries;
+  entries.reserve(vids.size());
+  for (size_t i = 0; i < vids.size(); ++i) {
+    entries.push_back(make_entry(vids[i], m_size + i));
+  }
+  append_entries(entries);
+}
+
+void sgraph_vid_index::append(const sarray<flexible_type>& vids) {
+  std::vector<entry> entries;
+  entries.reserve(vids.size());
+  auto reader = sarray_reader_buffer<flexible_type>(vids.get_reader(), 0, vids.size());
+  size_t row = m_size;
+  while (reader.has_next()) {
+    entries.push_back(make_entry(reader.next(), row));
+    ++row;
+  }
+  append_entries(entries);
+}
+
+void sgraph_vid_index::append_entries(std::vector<entry>& entries) {
+  if (entries.empty()) return;
+  m_segments.push_back(std::make_shared<segment>(entries));
+  m_size += entries.size();
+  entries.clear();
+
+  while (m_segments.size() >= 2) {
+    const auto& newer = m_segments[m_segments.size() - 1];
+    const auto& older = m_segments[m_segments.size() - 2];
+    if (older->size() > SEGMENT_MERGE_RATIO * newer->size()) break;
+    entries.reserve(older->size() + newer->size());
+    older->collect(entries);
+    newer->collect(entries);
+    m_segments.pop_back();
+    m_segments.pop_back();
+    m_segments.push_back(std::make_shared<segment>(entries));
+    entries.clear();
+  }
+}
+
+void sgraph_vid_index::clear() {
+  m_segments.clear();
+  m_size = 0;
+  m_column_identity = 0;
+}
+
+size_t sgraph_vid_index::memory_usage() const {
+  size_t ret = 0;
+  for (const auto& seg : m_segments) ret += seg->capacity() * sizeof(entry);
+  return ret;
+}
+
+void sgraph_vid_index::save(const std::string& path) const {
+  std::shared_ptr<const segment> merged;
+  if (m_segments.size() == 1) {
+    merged = m_segments[0];
+  } else {
+    std::vector<entry> entries;
+    entries.reserve(m_size);
+    for (const auto& seg : m_segments) seg->collect(entries);
+    merged = std::make_shared<segment>(entries);
+  }
+
+  index_file_header header;
+  memcpy(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic));
+  header.version = INDEX_FILE_VERSION;
+  header.size = merged->size();
+  header.capacity = merged->capacity();
+
+  general_ofstream fout(path);
+  fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  fout.write(reinterpret_cast<const char*>(merged->table()),
+             merged->capacity() * sizeof(entry));
+  if (fout.fail()) {
+    log_and_throw_io_failure("Fail to write vertex id index " + sanitize_url(path));
+  }
+  fout.close();
+}
+
+bool sgraph_vid_index::load(const std::string& path) {
+  clear();
+  if (fileio::get_file_status(path) != fileio::file_status::REGULAR_FILE) {
+    return false;
+  }
+
+  auto valid_header = [](const index_file_header& header, size_t file_size) {
+    return memcmp(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+        header.version == INDEX_FILE_VERSION &&
+        header.capacity > 0 &&
+        (header.capacity & (header.capacity - 1)) == 0 &&
+        header.size < header.capacity &&
+        file_size == sizeof(index_file_header) + header.capacity * sizeof(entry);
+  };
+
+#ifndef _WIN32
+  if (is_local_path(path)) {
+    std::string local_path = fileio::remove_protocol(path);
+    int fd = open(local_path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(index_file_header)) {
+      ::close(fd);
+      return false;
+    }
+    size_t length = st.st_size;
+    void* mapped = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+    const index_file_header* header = reinterpret_cast<const index_file_header*>(mapped);
+    if (!valid_header(*header, length)) {
+      munmap(mapped, length);
+      return false;
+    }
+    const entry* table = reinterpret_cast<const entry*>(
+        reinterpret_cast<const char*>(mapped) + sizeof(index_file_header));
+    m_segments.push_back(std::make_shared<segment>(
+        table, header->capacity, header->size, mapped, length));
+    m_size = header->size;
+    logstream(LOG_INFO) << "Memory mapped vertex id index " << path << " of "
+                        << m_size << " vertices" << std::endl;
+    return true;
+  }
+#endif
+
+  general_ifstream fin(path);
+  index_file_header header;
+  fin.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (fin.fail() || !valid_header(header, fin.file_size())) return false;
+  std::vector<entry> table(header.capacity);
+  fin.read(reinterpret_cast<char*>(table.data()), header.capacity * sizeof(entry));
+  if (fin.fail()) return false;
+  m_segments.push_back(std::make_shared<segment>(std::move(table), header.size));
+  m_size = header.size;
+  return true;
+}
+
+} // end of graphlab
@@ -0,0 +1,133 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_SGRAPH_SGRAPH_VID_INDEX_HPP
+#define GRAPHLAB_SGRAPH_SGRAPH_VID_INDEX_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <flexible_type/flexible_type.hpp>
+#include <sframe/sarray.hpp>
+
+namespace graphlab {
+
+/**
+ * A vertex id to row id index of one vertex partition of an \ref sgraph.
+ *
+ * Vertex ids are identified by their 128 bit hash (\ref flexible_type::hash128),
+ * so the index never stores the ids themselves: each vertex costs a fixed
+ * 24 bytes entry in an open addressing table.
+ *
+ * The index is a list of immutable segments, newest last. Appending a batch
+ * of vertices creates a new segment for the batch only, and neighboring
+ * segments are merged once they are of similar sizes (the number of segments
+ * is logarithmic in the number of vertices). Since segments are never
+ * modified, copies of an index (and of the graph owning it) share the
+ * segments and appending to one copy does not affect the other.
+ *
+ * The index can be saved into a single file, which is memory mapped on
+ * \ref load when it resides on the local file system.
+ *
+ * Row ids are only ever appended: the index assumes that the vertex
+ * partition keeps the row order of existing vertices and adds new vertices
+ * at the end, which is the case for all sgraph modifiers.
+ */
+class sgraph_vid_index {
+ public:
+  /// Returned by \ref find when the vertex id is not in the index.
+  static const size_t NOT_FOUND = (size_t)(-1);
+
+  sgraph_vid_index() = default;
+
+  /**
+   * Builds the index of a vertex id column. The vertex at row i of the
+   * column is mapped to i.
+   */
+  explicit sgraph_vid_index(const sarray<flexible_type>& vids);
+
+  /// Returns the number of indexed vertices.
+  inline size_t size() const { return m_size; }
+
+  /**
+   * Returns true if the index was built or last updated for this vertex id
+   * column. Columns are identified by their segment files, so a vertex
+   * partition rewritten with the same number of rows is not mistaken for
+   * the indexed one.
+   */
+  bool indexes(const sarray<flexible_type>& vids) const;
+
+  /**
+   * Records that the index now covers the vertex id column, after the
+   * caller appended the new vertices of the column to the index.
+   */
+  void set_column(const sarray<flexible_type>& vids);
+
+  /// Returns the number of segments.
+  inline size_t num_segments() const { return m_segments.size(); }
+
+  /**
+   * Returns the row id of the vertex, or \ref NOT_FOUND.
+   */
+  size_t find(const flexible_type& vid) const;
+
+  /**
+   * Appends vertices to the index. vids[i] is mapped to row size() + i.
+   * The vertex ids must not exist in the index.
+   */
+  void append(const std::vector<flexible_type>& vids);
+
+  /**
+   * Appends vertices to the index. Row i of the column is mapped to row
+   * size() + i. The vertex ids must not exist in the index.
+   */
+  void append(const sarray<flexible_type>& vids);
+
+  /// Removes all vertices from the index.
+  void clear();
+
+  /// Returns the number of bytes held by the index, mapped or not.
+  size_t memory_usage() const;
+
+  /**
+   * Writes the index into a file, merging all segments into one.
+   */
+  void save(const std::string& path) const;
+
+  /**
+   * Replaces the index with the one saved in the file. The file is memory
+   * mapped when it is local, and read into memory otherwise.
+   *
+   * Returns false, leaving the index empty, if the file is missing or is
+   * not a valid index file.
+   */
+  bool load(const std::string& path);
+
+ private:
+  struct entry {
+    uint64_t hash_high;
+    uint64_t hash_low;
+    uint64_t row;
+  };
+
+  class segment;
+
+  static entry make_entry(const flexible_type& vid, size_t row);
+
+  static uint128_t column_identity(const sarray<flexible_type>& vids);
+
+  void append_entries(std::vector<entry>& entries);
+
+  std::vector<std::shared_ptr<const segment> > m_segments;
+  size_t m_size = 0;
+  /// \ref column_identity of the indexed column, 0 if unknown.
+  uint128_t m_column_identity = 0;
+};
+
+} // end of graphlab
+
+#endif
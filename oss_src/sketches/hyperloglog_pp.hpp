@@ -0,0 +1,386 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#ifndef GRAPHLAB_SKETCH_HYPERLOGLOG_PP_HPP
+#define GRAPHLAB_SKETCH_HYPERLOGLOG_PP_HPP
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <util/cityhash_gl.hpp>
+#include <logger/assertions.hpp>
+#include <serialization/serialization_includes.hpp>
+namespace graphlab {
+namespace sketches {
+/**
+ * A mergeable HyperLogLog++ sketch for estimating the number of unique
+ * elements in a datastream.
+ *
+ * Compared to \ref hyperloglog, the sketch
+ *  - starts in a sparse representation: a sorted list of 32 bit entries
+ *    (a 25 bit bucket index and a 6 bit rank), as described in
+ *      Stefan Heule, Marc Nunkesser and Alexander Hall.
+ *      HyperLogLog in Practice: Algorithmic Engineering of a State of The
+ *      Art Cardinality Estimation Algorithm. EDBT 2013.
+ *    The sketch only switches to 2^precision dense registers once the sparse
+ *    list would use more memory than the registers. Small cardinalities
+ *    therefore cost a few bytes, and are estimated almost exactly by linear
+ *    counting over 2^25 buckets.
+ *  - estimates the dense registers with the improved raw estimator of
+ *      Otmar Ertl. New cardinality estimation algorithms for HyperLogLog
+ *      sketches. arXiv:1702.01284, 2017.
+ *    which is unbiased over the whole cardinality range without the
+ *    empirical bias tables of HLL++, and only needs a histogram of the
+ *    registers (no std::pow per register).
+ *  - has a compact serialized form: the sparse list is delta and varint
+ *    encoded, and the dense registers are packed in 6 bits each.
+ *
+ * Register merges and histograms are plain loops over byte arrays, which the
+ * compiler vectorizes.
+ *
+ * \code
+ *   hyperloglog_pp hll(12);
+ *   hll.add(stuff);     // accepts anything std::hash can hash
+ *   hll.combine(other); // other must have the same precision
+ *   hll.estimate();     // estimate of the number of unique elements
+ *   hll.error_bound();  // standard deviation of the estimate
+ * \endcode
+ */
+class hyperloglog_pp {
+ public:
+  /// Number of hash bits addressing a bucket in the sparse representation
+  static constexpr size_t SPARSE_PRECISION = 25;
+  static constexpr size_t MIN_PRECISION = 4;
+  static constexpr size_t MAX_PRECISION = 18;
+
+  /**
+   * Constructs a sketch which uses at most 2^precision bytes of registers.
+   * The relative standard error of the estimate is 1.04 / sqrt(2^precision).
+   * precision must be between 4 and 18.
+   */
+  explicit hyperloglog_pp(size_t precision = 14) : m_p(precision) {
+    ASSERT_GE(precision, MIN_PRECISION);
+    ASSERT_LE(precision, MAX_PRECISION);
+  }
+
+  /**
+   * Adds an arbitrary object to be counted. Any object type can be used
+   * as long as std::hash<T> can be used to obtain a hash value.
+   */
+  template <typename T>
+  void add(const T& t) {
+    // same hashing as hyperloglog: std::hash brings it to a 64-bit number,
+    // and cityhash's hash64 twice distributes the bits.
+    add_hash(hash64(hash64(std::hash<T>()(t))));
+  }
+
+  /**
+   * Adds an already well distributed 64 bit hash value.
+   */
+  void add_hash(uint64_t h) {
+    if (m_sparse) {
+      m_buffer.push_back(sparse_encode(h));
+      if (m_buffer.size() >= buffer_limit()) flush_buffer();
+    } else {
+      size_t index = h >> (64 - m_p);
+      uint8_t rank = rank_of(h << m_p, 64 - m_p);
+      if (rank > m_registers[index]) m_registers[index] = rank;
+    }
+  }
+
+  /**
+   * Merges another sketch of the same precision into this one. Combining
+   * the sketches of two data streams gives the same registers as sketching
+   * both streams together.
+   */
+  void combine(const hyperloglog_pp& other) {
+    ASSERT_EQ(m_p, other.m_p);
+    if (m_sparse && other.m_sparse) {
+      std::vector<uint32_t> entries = other.m_buffer;
+      std::sort(entries.begin(), entries.end());
+      merge_sorted(entries, other.m_list);
+      m_buffer.insert(m_buffer.end(), entries.begin(), entries.end());
+      flush_buffer();
+      return;
+    }
+    if (m_sparse) to_dense();
+    if (other.m_sparse) {
+      other.for_each_sparse_register([&](size_t index, uint8_t rank) {
+        if (rank > m_registers[index]) m_registers[index] = rank;
+      });
+    } else {
+      uint8_t* __restrict__ out = m_registers.data();
+      const uint8_t* __restrict__ in = other.m_registers.data();
+      for (size_t i = 0; i < m_registers.size(); ++i) {
+        out[i] = std::max(out[i], in[i]);
+      }
+    }
+  }
+
+  /**
+   * Returns the estimate of the number of unique items.
+   */
+  double estimate() const {
+    if (m_sparse) {
+      double m = (double)(1ULL << SPARSE_PRECISION);
+      double empty = m - (double)num_sparse_buckets();
+      return m * std::log(m / empty);
+    }
+    // histogram of the register values, ranks are at most q + 1
+    const size_t q = 64 - m_p;
+    size_t counts[64] = {0};
+    for (uint8_t r : m_registers) ++counts[r];
+
+    double m = (double)num_registers();
+    double z = m * tau(1.0 - (double)counts[q + 1] / m);
+    for (size_t k = q; k >= 1; --k) z = 0.5 * (z + (double)counts[k]);
+    z += m * sigma((double)counts[0] / m);
+    return (0.5 / std::log(2.0)) * m * m / z;
+  }
+
+  /**
+   * Returns the standard error of the estimate.
+   */
+  double error_bound() const {
+    double e = estimate();
+    if (m_sparse) {
+      // linear counting over 2^SPARSE_PRECISION buckets
+      double m = (double)(1ULL << SPARSE_PRECISION);
+      double t = e / m;
+      return std::sqrt(m * std::max(0.0, std::exp(t) - t - 1));
+    }
+    return e * 1.04 / std::sqrt((double)num_registers());
+  }
+
+  /// Returns the precision. The dense representation has 2^precision registers.
+  inline size_t precision() const { return m_p; }
+
+  /// Returns true if the sketch is in the sparse representation.
+  inline bool is_sparse() const { return m_sparse; }
+
+  /// Returns the number of bytes used by the sketch data.
+  inline size_t memory_usage() const {
+    return (m_list.capacity() + m_buffer.capacity()) * sizeof(uint32_t) +
+        m_registers.capacity();
+  }
+
+  /**
+   * Serializes the sketch. The sparse list is delta encoded into varints,
+   * and dense registers are packed into 6 bits each.
+   */
+  void save(oarchive& oarc) const {
+    oarc << m_p << m_sparse;
+    std::vector<uint8_t> bytes;
+    if (m_sparse) {
+      std::vector<uint32_t> entries = m_buffer;
+      std::sort(entries.begin(), entries.end());
+      merge_sorted(entries, m_list);
+      uint32_t prev = 0;
+      for (uint32_t e : entries) {
+        uint32_t delta = e - prev;
+        prev = e;
+        while (delta >= 0x80) {
+          bytes.push_back((uint8_t)(delta | 0x80));
+          delta >>= 7;
+        }
+        bytes.push_back((uint8_t)delta);
+      }
+      oarc << entries.size();
+    } else {
+      bytes.resize((m_registers.size() * 6 + 7) / 8, 0);
+      for (size_t i = 0; i < m_registers.size(); ++i) {
+        size_t bit = i * 6;
+        uint16_t value = (uint16_t)m_registers[i] << (bit % 8);
+        bytes[bit / 8] |= (uint8_t)value;
+        if (bit % 8 > 2) bytes[bit / 8 + 1] |= (uint8_t)(value >> 8);
+      }
+    }
+    oarc << bytes;
+  }
+
+  /**
+   * Deserializes the sketch.
+   */
+  void load(iarchive& iarc) {
+    iarc >> m_p >> m_sparse;
+    m_list.clear();
+    m_buffer.clear();
+    m_registers.clear();
+    if (m_sparse) {
+      size_t num_entries = 0;
+      iarc >> num_entries;
+      std::vector<uint8_t> bytes;
+      iarc >> bytes;
+      m_list.reserve(num_entries);
+      uint32_t prev = 0;
+      size_t pos = 0;
+      for (size_t i = 0; i < num_entries; ++i) {
+        uint32_t delta = 0;
+        for (size_t shift = 0; ; shift += 7) {
+          ASSERT_LT(pos, bytes.size());
+          delta |= (uint32_t)(bytes[pos] & 0x7f) << shift;
+          if ((bytes[pos++] & 0x80) == 0) break;
+        }
+        prev += delta;
+        m_list.push_back(prev);
+      }
+    } else {
+      std::vector<uint8_t> bytes;
+      iarc >> bytes;
+      m_registers.resize(num_registers());
+      ASSERT_EQ(bytes.size(), (m_registers.size() * 6 + 7) / 8);
+      for (size_t i = 0; i < m_registers.size(); ++i) {
+        size_t bit = i * 6;
+        uint16_t value = bytes[bit / 8];
+        if (bit % 8 > 2) value |= (uint16_t)bytes[bit / 8 + 1] << 8;
+        m_registers[i] = (value >> (bit % 8)) & 0x3f;
+      }
+    }
+  }
+
+ private:
+  size_t m_p = 14;
+  bool m_sparse = true;
+  /// Sorted sparse entries, at most one per sparse bucket.
+  std::vector<uint32_t> m_list;
+  /// Unsorted sparse entries not yet merged into m_list.
+  std::vector<uint32_t> m_buffer;
+  /// Dense registers.
+  std::vector<uint8_t> m_registers;
+
+  inline size_t num_registers() const { return (size_t)1 << m_p; }
+
+  /**
+   * The sparse list is converted to registers once it would use more
+   * memory than the registers (4 bytes per entry vs 1 byte per register).
+   */
+  inline size_t sparse_limit() const { return std::max<size_t>(1, num_registers() / 4); }
+
+  inline size_t buffer_limit() const { return std::max<size_t>(16, sparse_limit() / 4); }
+
+  /**
+   * Returns the 1-based position of the first set bit of the top nbits of
+   * w, or nbits + 1 if they are all zero.
+   */
+  static inline uint8_t rank_of(uint64_t w, size_t nbits) {
+    if (w == 0) return nbits + 1;
+    return std::min<size_t>(__builtin_clzll(w), nbits) + 1;
+  }
+
+  /// Encodes a hash as (sparse bucket index << 6) | rank.
+  static inline uint32_t sparse_encode(uint64_t h) {
+    uint32_t index = h >> (64 - SPARSE_PRECISION);
+    uint8_t rank = rank_of(h << SPARSE_PRECISION, 64 - SPARSE_PRECISION);
+    return (index << 6) | rank;
+  }
+
+  /**
+   * Merges the sorted entries of other into the sorted entries of list,
+   * keeping the largest rank of each sparse bucket.
+   */
+  static void merge_sorted(std::vector<uint32_t>& list,
+                           const std::vector<uint32_t>& other) {
+    std::vector<uint32_t> merged(list.size() + other.size());
+    std::merge(list.begin(), list.end(), other.begin(), other.end(),
+               merged.begin());
+    // within a bucket, entries are ordered by rank: keep the last one
+    size_t out = 0;
+    for (size_t i = 0; i < merged.size(); ++i) {
+      if (out > 0 && (merged[out - 1] >> 6) == (merged[i] >> 6)) {
+        merged[out - 1] = merged[i];
+      } else {
+        merged[out++] = merged[i];
+      }
+    }
+    merged.resize(out);
+    list.swap(merged);
+  }
+
+  void flush_buffer() {
+    std::sort(m_buffer.begin(), m_buffer.end());
+    merge_sorted(m_list, m_buffer);
+    m_buffer.clear();
+    if (m_list.size() > sparse_limit()) to_dense();
+  }
+
+  /// Returns the number of distinct sparse buckets in the list and buffer.
+  size_t num_sparse_buckets() const {
+    if (m_buffer.empty()) return m_list.size();
+    std::vector<uint32_t> entries = m_buffer;
+    std::sort(entries.begin(), entries.end());
+    merge_sorted(entries, m_list);
+    return entries.size();
+  }
+
+  /**
+   * Calls fn(register index, rank) for every sparse entry, converting the
+   * sparse bucket and rank to the dense precision.
+   */
+  template <typename Fn>
+  void for_each_sparse_register(Fn fn) const {
+    const size_t extra_bits = SPARSE_PRECISION - m_p;
+    auto convert = [&](uint32_t e) {
+      uint32_t sparse_index = e >> 6;
+      uint32_t low = sparse_index & ((1u << extra_bits) - 1);
+      uint8_t rank;
+      if (low != 0) {
+        // the first set bit is within the extra index bits
+        rank = __builtin_clz(low) - (32 - extra_bits) + 1;
+      } else {
+        rank = extra_bits + (e & 0x3f);
+      }
+      fn(sparse_index >> extra_bits, rank);
+    };
+    for (uint32_t e : m_list) convert(e);
+    for (uint32_t e : m_buffer) convert(e);
+  }
+
+  void to_dense() {
+    m_registers.assign(num_registers(), 0);
+    for_each_sparse_register([&](size_t index, uint8_t rank) {
+      if (rank > m_registers[index]) m_registers[index] = rank;
+    });
+    std::vector<uint32_t>().swap(m_list);
+    std::vector<uint32_t>().swap(m_buffer);
+    m_sparse = false;
+  }
+
+  /// sigma(x) = x + sum_{k>=1} x^(2^k) 2^(k-1), from Ertl
+  static double sigma(double x) {
+    if (x == 1.0) return std::numeric_limits<double>::infinity();
+    double y = 1.0;
+    double z = x;
+    double z_prev;
+    do {
+      x *= x;
+      z_prev = z;
+      z += x * y;
+      y += y;
+    } while (z != z_prev);
+    return z;
+  }
+
+  /// tau(x) = (1 - x - sum_{k>=1} (1 - x^(2^-k))^2 2^-k) / 3, from Ertl
+  static double tau(double x) {
+    if (x == 0.0 || x == 1.0) return 0.0;
+    double y = 1.0;
+    double z = 1.0 - x;
+    double z_prev;
+    do {
+      x = std::sqrt(x);
+      z_prev = z;
+      y *= 0.5;
+      z -= (1.0 - x) * (1.0 - x) * y;
+    } while (z != z_prev);
+    return z / 3.0;
+  }
+}; // hyperloglog_pp
+} // namespace sketches
+} // namespace graphlab
+#endif
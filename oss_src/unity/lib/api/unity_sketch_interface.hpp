@@ -14,6 +14,7 @@
 
 #include <flexible_type/flexible_type.hpp>
 #include <unity/lib/api/unity_sarray_interface.hpp>
+#include <unity/lib/api/unity_sframe_interface.hpp>
 #include <cppipc/magic_macros.hpp>
 
 namespace graphlab {
@@ -24,6 +25,7 @@ typedef std::map<flexible_type, std::shared_ptr<unity_sketch_base>> sub_sketch_m
 
 GENERATE_INTERFACE_AND_PROXY_NO_INLINE_DESTRUCTOR(unity_sketch_base, unity_sketch_proxy,
     (void, construct_from_sarray, (std::shared_ptr<unity_sarray_base>)(bool)(const std::vector<flexible_type>&))
+    (std::vector<std::shared_ptr<unity_sketch_base> >, sketch_sframe_columns, (std::shared_ptr<unity_sframe_base>)(double)(double))
     (double, get_quantile, (double))
     (double, frequency_count, (flexible_type))
     (std::vector<item_count>, frequent_items, )
@@ -6,11 +6,39 @@
  * of the BSD license. See the LICENSE file for details.
  */
 #include <vector>
+#include <cmath>
+#include <algorithm>
+#include <functional>
 #include <flexible_type/flexible_type.hpp>
 #include <unity/lib/flex_dict_view.hpp>
 
 namespace graphlab {
 
+  size_t flex_dict_key_hash::operator()(const flexible_type& key) const {
+    switch(key.get_type()) {
+     case flex_type_enum::STRING:
+       return std::hash<flex_string>()(key.get<flex_string>());
+     case flex_type_enum::INTEGER:
+       return std::hash<flex_int>()(key.get<flex_int>());
+     case flex_type_enum::FLOAT:
+       {
+         // integral floats hash like the equal integer, and all NaNs are
+         // equal to each other
+         flex_float value = key.get<flex_float>();
+         if (std::isnan(value)) return 0;
+         if (value >= -9.2e18 && value <= 9.2e18 && std::floor(value) == value) {
+           return std::hash<flex_int>()((flex_int)value);
+         }
+         return std::hash<flex_float>()(value);
+       }
+     default:
+       return 0;
+    }
+  }
+
+  constexpr size_t flex_dict_view::INDEX_MIN_SIZE;
+  constexpr size_t flex_dict_view::INDEX_MIN_LOOKUPS;
+
   flex_dict_view::flex_dict_view(const flex_dict& value) {
     m_flex_dict_ptr = &value;
   }
@@ -24,11 +52,39 @@ namespace graphlab {
     log_and_throw("Cannot construct a flex_dict_view object from type ");
   }
 
-  const flexible_type& flex_dict_view::operator[](const flexible_type& key) const {
-    for(const auto& value : (*m_flex_dict_ptr)) {
-      if (value.first == key) {
-        return value.second;
+  size_t flex_dict_view::find(const flexible_type& key) const {
+    const flex_dict& dict = *m_flex_dict_ptr;
+    if (m_index.empty()) {
+      if (dict.size() < INDEX_MIN_SIZE || m_num_lookups < INDEX_MIN_LOOKUPS) {
+        ++m_num_lookups;
+        for (size_t i = 0; i < dict.size(); ++i) {
+          if (dict[i].first == key) return i;
+        }
+        return dict.size();
+      }
+      flex_dict_key_hash hasher;
+      m_index.resize(dict.size());
+      for (size_t i = 0; i < dict.size(); ++i) {
+        m_index[i] = {hasher(dict[i].first), i};
       }
+      std::sort(m_index.begin(), m_index.end());
+    }
+
+    // entries with the same hash are sorted by position, so the first match
+    // is the first occurrence of the key
+    size_t hash = flex_dict_key_hash()(key);
+    auto iter = std::lower_bound(m_index.begin(), m_index.end(),
+                                 std::make_pair(hash, size_t(0)));
+    for (; iter != m_index.end() && iter->first == hash; ++iter) {
+      if (dict[iter->second].first == key) return iter->second;
+    }
+    return dict.size();
+  }
+
+  const flexible_type& flex_dict_view::operator[](const flexible_type& key) const {
+    size_t pos = find(key);
+    if (pos < m_flex_dict_ptr->size()) {
+      return (*m_flex_dict_ptr)[pos].second;
     }
 
     std::stringstream s;
@@ -37,13 +93,7 @@ namespace graphlab {
   }
 
   bool flex_dict_view::has_key(const flexible_type& key) const {
-    for(const auto& value : (*m_flex_dict_ptr)) {
-      if (value.first == key) {
-        return true;
-      }
-    }
-
-    return false;
+    return find(key) < m_flex_dict_ptr->size();
   }
 
   size_t flex_dict_view::size() const {
@@ -10,14 +10,36 @@
 #define GRAPHLAB_UNITY_FLEX_DICT_HPP
 
 #include <vector>
+#include <utility>
 #include <flexible_type/flexible_type.hpp>
 
 namespace graphlab {
 
+  /**
+   * A hash function for dictionary keys which is consistent with
+   * flexible_type::operator==: an INTEGER key and a FLOAT key with the same
+   * integral value hash to the same value.
+   *
+   * Only STRING, INTEGER and FLOAT keys are hashed. All other keys (which can
+   * compare equal across types, or approximately) share a single hash value,
+   * so lookups of such keys degrade to comparisons against all of them.
+   *
+   * It can be used to build hashed key sets for flex_dict keys:
+   *   std::unordered_set<flexible_type, flex_dict_key_hash> keyset;
+  **/
+  struct flex_dict_key_hash {
+    size_t operator()(const flexible_type& key) const;
+  };
+
   /**
    * A thin wrapper around flex_dict to facilitate access of the underneath
    * sparse vector.
    *
+   * Key lookups are linear scans of the dictionary. When a view of a large
+   * dictionary serves more than a few lookups, a hashed index of the keys is
+   * built, and later lookups are O(log n). The index is owned by the view and
+   * the underlying flex_dict is not modified.
+   *
    * It can be used the following way, suppose sa_iter is an iterator on top
    * of sarray:
    *   flex_dict_view value = (*sa_iter);
@@ -78,9 +100,25 @@ namespace graphlab {
      */
     flex_dict::const_iterator end() const;
 
+    /// Dictionaries smaller than this are never indexed
+    static constexpr size_t INDEX_MIN_SIZE = 16;
+
+    /// The number of linear lookups performed before the index is built
+    static constexpr size_t INDEX_MIN_LOOKUPS = 4;
+
   private:
     const flex_dict* m_flex_dict_ptr;
 
+    // (key hash, position in the dictionary) sorted, built lazily by find()
+    mutable std::vector<std::pair<size_t, size_t>> m_index;
+    mutable size_t m_num_lookups = 0;
+
+    /**
+     * Returns the position of the first entry with the given key, or
+     * size() if there is none.
+     */
+    size_t find(const flexible_type& key) const;
+
     // keys and values are lazily materialized when queried
     std::vector<flexible_type> m_keys;
     std::vector<flexible_type> m_values;
@@ -17,6 +17,9 @@
 #include <sframe/sframe_reader.hpp>
 #include <sframe/sframe_reader_buffer.hpp>
 #include <sframe/dataframe.hpp>
+#include <sframe/membership_set.hpp>
+#include <sframe/distinct.hpp>
+#include <sframe/rolling_aggregate.hpp>
 #include <sframe_query_engine/planning/planner.hpp>
 #include <table_printer/table_printer.hpp>
 
@@ -104,6 +107,10 @@ groupby_descriptor_type COUNT_DISTINCT(const std::string& col) {
   return {"__builtin__count__distinct__", {col}};
 }
 
+groupby_descriptor_type APPROX_COUNT_DISTINCT(const std::string& col) {
+  return {"__builtin__approx__count__distinct__", {col}};
+}
+
 groupby_descriptor_type QUANTILE(const std::string& col, double quantile) {
   std::vector<double> q{quantile};
   return QUANTILE(col, q);
@@ -640,20 +647,14 @@ gl_sframe gl_sframe::filter_by(const gl_sarray& values,
     throw std::string("Type of given values does not match type of column ") + 
         column_name + " in SFrame";
   }
-  gl_sframe value_sf({{column_name, values}});
-  value_sf = value_sf.unique();
-  if (exclude == false) {
-    return join(value_sf, {column_name}, "inner");
-  } else {
-    std::string id_name = "id";
-    while(colnameset.count(id_name)) id_name += "1";
-    value_sf[id_name] = 1;
-    auto retsf = join(value_sf, {column_name}, "left");
-    retsf = retsf[retsf[id_name] == FLEX_UNDEFINED];
-    retsf.remove_column(id_name);
-    return retsf;
-  }
-
+  // a semi-join (or anti-join): filter the rows lazily with a set of the
+  // values, rather than joining with the unique values
+  auto value_set = std::make_shared<const membership_set>(*values.materialize_to_sarray());
+  gl_sarray mask = (*this)[column_name].apply(
+      [value_set, exclude](const flexible_type& f)->flexible_type {
+        return value_set->contains(f) != exclude;
+      }, flex_type_enum::INTEGER, false);
+  return (*this)[mask];
 }
 
 
@@ -899,8 +900,11 @@ gl_sframe gl_sframe::unstack(const std::vector<std::string>& columns,
 }
 
 gl_sframe gl_sframe::unique() const {
-  return groupby(column_names(), 
-                 std::map<std::string, aggregate::groupby_descriptor_type>());
+  return gl_sframe(distinct(materialize_to_sframe()));
+}
+
+size_t gl_sframe::num_unique_rows(bool approximate) const {
+  return count_distinct(materialize_to_sframe(), approximate);
 }
 
 gl_sframe gl_sframe::sort(const std::string& column, bool ascending) const {
@@ -921,6 +925,29 @@ gl_sframe gl_sframe::sort(const std::vector<std::pair<std::string, bool>>& colum
   }
   return get_proxy()->sort(keys, order);
 }
+gl_sframe gl_sframe::builtin_rolling_apply(const std::vector<std::string>& partition_columns,
+                                           const std::string& order_column,
+                                           const std::string& value_column,
+                                           const std::string& fn_name,
+                                           double range_start,
+                                           double range_end,
+                                           const std::string& output_column_name,
+                                           size_t min_observations) const {
+  std::vector<std::string> sort_columns = partition_columns;
+  sort_columns.push_back(order_column);
+  gl_sframe ret = sort(sort_columns);
+  auto windowed_array = rolling_aggregate::partitioned_rolling_apply(
+      ret.materialize_to_sframe(),
+      partition_columns,
+      order_column,
+      value_column,
+      get_builtin_group_aggregator(fn_name),
+      range_start,
+      range_end,
+      min_observations);
+  ret.add_column(gl_sarray(windowed_array), output_column_name);
+  return ret;
+}
 gl_sframe gl_sframe::dropna(const std::vector<std::string>& columns, 
                             std::string how) const {
   auto ret = get_proxy()->drop_missing_values(columns, how == "all", false);
@@ -293,6 +293,19 @@ groupby_descriptor_type SELECT_ONE(const std::string& col);
  */
 groupby_descriptor_type COUNT_DISTINCT(const std::string& col);
 
+/**
+ * Builtin approximate unique counter for groupby. Estimates the number of
+ * unique values with a HyperLogLog++ sketch (about 1.6% relative error)
+ * using at most 4KB per group, instead of keeping every unique value.
+ *
+ * Example: Get the approximate number of unique movies rated by each user
+ * \code
+ * sf.groupby("user",
+ *            {{"num_movies", aggregate::APPROX_COUNT_DISTINCT("movie")}});
+ * \endcode
+ */
+groupby_descriptor_type APPROX_COUNT_DISTINCT(const std::string& col);
+
 ///@{
 /**
  * Builtin aggregator that combines values from one or two columns in one group
@@ -1866,6 +1879,9 @@ class gl_sframe {
    * \param exclude Optional. Defaults to false. If true, the result \ref
    * gl_sframe will contain all rows except those that have one of "values" in
    * "column_name".
+   *
+   * The rows are filtered lazily against a hash set of the values, and keep
+   * their order.
    * 
    * Example: 
    * \code
@@ -1889,8 +1905,8 @@ class gl_sframe {
    * +-------------+----+--------+
    * | animal_type | id |  name  |
    * +-------------+----+--------+
-   * |    horse    | 4  | bobjim |
    * |     cow     | 3  | jimbob |
+   * |    horse    | 4  | bobjim |
    * +-------------+----+--------+
    * [2 rows x 3 columns]
    * \endcode
@@ -2456,6 +2472,8 @@ class gl_sframe {
   /**
    * Remove duplicate rows of the \ref gl_sframe. Will not necessarily preserve the
    * order of the given \ref gl_sframe in the new \ref gl_sframe.
+   * Rows are deduplicated by a hash of their values, partitioned to disk when
+   * there are too many to fit in memory.
    * 
    * Example:
    * \code
@@ -2481,6 +2499,16 @@ class gl_sframe {
    */
   gl_sframe unique() const;
 
+  /**
+   * Returns the number of distinct rows of the \ref gl_sframe.
+   *
+   * If approximate is true, the rows are counted in a single pass with a
+   * HyperLogLog++ sketch instead (about 0.8% relative error).
+   *
+   * \see unique
+   */
+  size_t num_unique_rows(bool approximate = false) const;
+
   /**
    * Sort current \ref gl_sframe by a single column, using the given sort order.
    *
@@ -2611,6 +2639,54 @@ class gl_sframe {
    */
   gl_sframe sort(const std::vector<std::pair<std::string, bool>>& column_and_ascending) const;
 
+  /**
+   * Apply a builtin aggregate function over a moving range of the rows of
+   * each partition, in the order of an order column. This is the equivalent
+   * of a SQL window function with PARTITION BY partition_columns ORDER BY
+   * order_column RANGE BETWEEN range_start AND range_end.
+   *
+   * The rows are sorted by the partition columns and then by the order
+   * column, and the window of each row holds the rows of its partition
+   * whose order value is within [order + range_start, order + range_end].
+   *
+   * \param partition_columns The columns forming the partition key. If
+   * empty, all the rows form one partition.
+   * \param order_column The column ordering the rows. Must be of type int,
+   * float or datetime, without missing values. Ranges over datetime columns
+   * are in seconds.
+   * \param value_column The column to aggregate.
+   * \param fn_name The name of a builtin aggregator, as in
+   * \ref gl_sarray::builtin_rolling_apply.
+   * \param range_start The start of the window relative to the order value
+   * of the current row, inclusive.
+   * \param range_end The end of the window relative to the order value of
+   * the current row, inclusive. Must be greater than or equal to
+   * range_start.
+   * \param output_column_name The name of the column of aggregated values.
+   * \param min_observations The minimum allowed number of non-NULL values
+   * in the window for the emitted value to be non-NULL. size_t(-1)
+   * indicates that all values must be non-NULL.
+   *
+   * Returns the rows sorted by the partition columns and then the order
+   * column, with a column of aggregated values added.
+   *
+   * Example:
+   * \code
+   * // the amount spent by each user over the past 7 days
+   * auto result = sf.builtin_rolling_apply({"user_id"}, "time", "amount",
+   *                                        "__builtin__sum__", -7 * 86400, 0,
+   *                                        "amount_7d");
+   * \endcode
+   */
+  gl_sframe builtin_rolling_apply(const std::vector<std::string>& partition_columns,
+                                  const std::string& order_column,
+                                  const std::string& value_column,
+                                  const std::string& fn_name,
+                                  double range_start,
+                                  double range_end,
+                                  const std::string& output_column_name,
+                                  size_t min_observations=0) const;
+
   /**
    * Remove missing values from an \ref gl_sframe. A missing value is either "FLEX_UNDEFINED"
    * or "NaN".  If "how" is "any", a row will be removed if any of the
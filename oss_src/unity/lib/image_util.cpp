@@ -392,6 +392,142 @@ std::shared_ptr<unity_sarray> resize_image_sarray(
   return std::static_pointer_cast<unity_sarray>(ret);
 };
 
+namespace {
+
+/// Number of images read at once by each thread of the image pipeline
+const size_t IMAGE_PIPELINE_BATCH_SIZE = 64;
+
+/// Per thread buffers reused across the images of the image pipeline
+struct image_pipeline_buffers {
+  std::vector<char> decoded;
+  std::vector<char> resized;
+};
+
+/**
+ * Decodes and resizes one image into buffers.resized.
+ */
+void run_image_pipeline(const flex_image& image,
+                        size_t resized_width,
+                        size_t resized_height,
+                        size_t resized_channels,
+                        image_pipeline_buffers& buffers) {
+  const char* pixels = NULL;
+  size_t width = image.m_width;
+  size_t height = image.m_height;
+  size_t channels = image.m_channels;
+  std::unique_ptr<char[]> png_pixels;
+
+  if (image.is_decoded()) {
+    pixels = (const char*)image.get_image_data();
+  } else if (image.m_format == Format::JPG) {
+    decode_jpeg_scaled((const char*)image.get_image_data(), image.m_image_data_size,
+                       resized_width, resized_height,
+                       buffers.decoded, width, height, channels);
+    pixels = buffers.decoded.data();
+  } else if (image.m_format == Format::PNG) {
+    char* buf = NULL;
+    size_t length = 0;
+    decode_png((const char*)image.get_image_data(), image.m_image_data_size,
+               &buf, length);
+    png_pixels.reset(buf);
+    pixels = buf;
+  } else {
+    log_and_throw(std::string("Cannot decode image. Unknown format."));
+  }
+
+  buffers.resized.resize(resized_width * resized_height * resized_channels);
+  image_util_detail::resize_image_into(pixels, width, height, channels,
+                                       resized_width, resized_height,
+                                       resized_channels, buffers.resized.data());
+}
+
+} // anonymous namespace
+
+/**
+ * Decode, resize and convert an sarray of images in one pass.
+ */
+std::shared_ptr<unity_sarray> image_pipeline_sarray(
+    std::shared_ptr<unity_sarray> image_sarray,
+    size_t resized_width,
+    size_t resized_height,
+    size_t resized_channels,
+    bool to_vector,
+    bool undefined_on_failure) {
+  log_func_entry();
+  if (image_sarray->dtype() != flex_type_enum::IMAGE) {
+    log_and_throw("Image pipeline requires an SArray of images");
+  }
+  if (resized_width == 0 || resized_height == 0) {
+    log_and_throw("Resized width and height must be positive");
+  }
+  if (resized_channels != 1 && resized_channels != 3 && resized_channels != 4) {
+    log_and_throw(std::string("Unsupported channel size ") + std::to_string(resized_channels));
+  }
+
+  auto source = image_sarray->get_underlying_sarray();
+  auto reader = source->get_reader();
+  size_t num_rows = source->size();
+  size_t num_segments = thread_pool::get_instance().size();
+
+  auto output = std::make_shared<sarray<flexible_type>>();
+  output->open_for_write(num_segments);
+  output->set_type(to_vector ? flex_type_enum::VECTOR : flex_type_enum::IMAGE);
+
+  parallel_for(0, num_segments, [&](size_t segment) {
+    image_pipeline_buffers buffers;
+    std::vector<flexible_type> batch;
+    auto out_iter = output->get_output_iterator(segment);
+    size_t row = segment * num_rows / num_segments;
+    size_t row_end = (segment + 1) * num_rows / num_segments;
+    while (row < row_end) {
+      size_t batch_end = std::min(row + IMAGE_PIPELINE_BATCH_SIZE, row_end);
+      reader->read_rows(row, batch_end, batch);
+      for (const flexible_type& f : batch) {
+        flexible_type out = FLEX_UNDEFINED;
+        if (f.get_type() == flex_type_enum::IMAGE) {
+          try {
+            run_image_pipeline(f.get<flex_image>(), resized_width, resized_height,
+                               resized_channels, buffers);
+            const std::vector<char>& pixels = buffers.resized;
+            if (to_vector) {
+              flex_vec vec(pixels.size());
+              for (size_t i = 0; i < pixels.size(); ++i) {
+                vec[i] = static_cast<double>(static_cast<unsigned char>(pixels[i]));
+              }
+              out = std::move(vec);
+            } else {
+              char* data = new char[pixels.size()];
+              memcpy(data, pixels.data(), pixels.size());
+              flex_image img;
+              img.m_image_data.reset(data);
+              img.m_image_data_size = pixels.size();
+              img.m_width = resized_width;
+              img.m_height = resized_height;
+              img.m_channels = resized_channels;
+              img.m_version = IMAGE_TYPE_CURRENT_VERSION;
+              img.m_format = Format::RAW_ARRAY;
+              out = img;
+            }
+          } catch (...) {
+            if (!undefined_on_failure) throw;
+          }
+        }
+        *out_iter = out;
+        ++out_iter;
+      }
+      row = batch_end;
+      if (cppipc::must_cancel()) {
+        log_and_throw("Cancelled by user");
+      }
+    }
+  });
+  output->close();
+
+  auto ret = std::make_shared<unity_sarray>();
+  ret->construct_from_sarray(output);
+  return ret;
+};
+
 /**
  * Convert sarray of image data to sarray of vector
  */
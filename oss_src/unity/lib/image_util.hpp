@@ -98,6 +98,36 @@ std::shared_ptr<unity_sarray> resize_image_sarray(
 
 
 
+/**************************************************************************/
+/*                                                                        */
+/*                             Image Pipeline                             */
+/*                                                                        */
+/**************************************************************************/
+
+/**
+ * Decodes, resizes and optionally converts to vectors an sarray of images in
+ * a single fused pass.
+ *
+ * Every thread processes a contiguous range of rows in batches and reuses
+ * its decode and resize buffers across images. JPEG images which are at
+ * least twice as large as the target size are downscaled during decoding
+ * (in the DCT domain) before the final resize.
+ *
+ * \param image_sarray An sarray of images.
+ * \param resized_width, resized_height, resized_channels The output size.
+ * Channels must be 1, 3 or 4.
+ * \param to_vector If true, the output is an sarray of vectors of pixel
+ * values. Otherwise it is an sarray of decoded images.
+ * \param undefined_on_failure If true, images failing to decode produce a
+ * missing value instead of an error.
+ */
+std::shared_ptr<unity_sarray> image_pipeline_sarray(
+    std::shared_ptr<unity_sarray> image_sarray, size_t resized_width,
+    size_t resized_height, size_t resized_channels, bool to_vector,
+    bool undefined_on_failure);
+
+
+
 /**************************************************************************/
 /*                                                                        */
 /*                      Vector <-> Image Conversion                       */
@@ -29,29 +29,28 @@ namespace image_util_detail {
 using namespace boost::gil;
 
 template<typename current_pixel_type, typename new_pixel_type>
-void resize_image_detail(const char* data, size_t width, size_t height, size_t channels, size_t resized_width, size_t resized_height, size_t resized_channels, char** resized_data){
+void resize_image_detail(const char* data, size_t width, size_t height, size_t channels, size_t resized_width, size_t resized_height, size_t resized_channels, char* resized_data){
   if (data == NULL){
     log_and_throw("Trying to resize image with NULL data pointer");
   }
   size_t len = resized_height * resized_width * resized_channels;
-  char* buf = new char[len];
   // Fast path when the sizes are equal.
   if ((width == resized_width) && (height == resized_height) && (channels == resized_channels)) {
-    memcpy(buf, data, len);
+    memcpy(resized_data, data, len);
   } else {
     auto view = interleaved_view(width, height, (current_pixel_type*)data, width * channels * sizeof(char));
-    auto resized_view = interleaved_view(resized_width, resized_height, (new_pixel_type*)buf,
+    auto resized_view = interleaved_view(resized_width, resized_height, (new_pixel_type*)resized_data,
                                          resized_width * resized_channels * sizeof(char));
     resize_view(color_converted_view<new_pixel_type>(view), (resized_view), nearest_neighbor_sampler());
   }
-  *resized_data = buf;
 }
 
 
 /**
- * Resize the image, and set resized_data to resized image data.
+ * Resize the image into resized_data, which must hold
+ * resized_width * resized_height * resized_channels bytes.
  */
-void resize_image_impl(const char* data, size_t width, size_t height, size_t channels, size_t resized_width, size_t resized_height, size_t resized_channels, char** resized_data) {
+void resize_image_into(const char* data, size_t width, size_t height, size_t channels, size_t resized_width, size_t resized_height, size_t resized_channels, char* resized_data) {
   // This code should be simplified
   if (channels == 1) {
     if (resized_channels == 1){
@@ -101,7 +100,24 @@ void resize_image_impl(const char* data, size_t width, size_t height, size_t cha
     } else {
       log_and_throw (std::string("Unsupported channel size ") + std::to_string(channels));
     }
+  } else {
+    log_and_throw (std::string("Unsupported channel size ") + std::to_string(channels));
+  }
+}
+
+/**
+ * Resize the image, and set resized_data to resized image data.
+ */
+void resize_image_impl(const char* data, size_t width, size_t height, size_t channels, size_t resized_width, size_t resized_height, size_t resized_channels, char** resized_data) {
+  char* buf = new char[resized_height * resized_width * resized_channels];
+  try {
+    resize_image_into(data, width, height, channels, resized_width, resized_height,
+                      resized_channels, buf);
+  } catch (...) {
+    delete[] buf;
+    throw;
   }
+  *resized_data = buf;
 }
 
 void decode_image_impl(image_type& image) {
@@ -43,6 +43,8 @@
 #include <sframe/rolling_aggregate.hpp>
 #include <unity/lib/gl_sarray.hpp>
 #include <cmath>
+#include <unordered_map>
+#include <unordered_set>
 namespace graphlab {
 
 using namespace query_eval;
@@ -1984,7 +1986,7 @@ unity_sarray::dict_trim_by_keys(const std::vector<flexible_type>& keys, bool exc
     log_and_throw("Only dictionary type is supported for trim by keys.");
   }
 
-  std::set<flexible_type> keyset(keys.begin(), keys.end());
+  std::unordered_set<flexible_type, flex_dict_key_hash> keyset(keys.begin(), keys.end());
 
   auto transformfn = [exclude, keyset](const flexible_type& f)->flexible_type {
     if (f.get_type() == flex_type_enum::UNDEFINED) return f;
@@ -2090,7 +2092,7 @@ unity_sarray::dict_has_any_keys(const std::vector<flexible_type>& keys) {
     log_and_throw("Only dictionary type is supported for trim by keys.");
   }
 
-  std::set<flexible_type> keyset(keys.begin(), keys.end());
+  std::unordered_set<flexible_type, flex_dict_key_hash> keyset(keys.begin(), keys.end());
 
   auto transformfn = [keyset](const flexible_type& f)->int {
     if (f.get_type() == flex_type_enum::UNDEFINED) return f;
@@ -2415,19 +2417,34 @@ std::shared_ptr<unity_sframe_base> unity_sarray::unpack(
     }
   }
   auto coltype = dtype();
-  auto transformfn = [coltype, unpacked_keys, na_value](const sframe_rows::row& row,
-                                                        sframe_rows::row& ret) {
+
+  // the output columns of each dictionary key
+  std::unordered_multimap<flexible_type, size_t, flex_dict_key_hash> key_columns;
+  if (coltype == flex_type_enum::DICT) {
+    for (size_t i = 0; i < unpacked_keys.size(); ++i) {
+      key_columns.emplace(unpacked_keys[i], i);
+    }
+  }
+
+  auto transformfn = [coltype, unpacked_keys, key_columns, na_value](const sframe_rows::row& row,
+                                                                     sframe_rows::row& ret) {
     const auto& val = row[0];
     if (val.get_type() == flex_type_enum::UNDEFINED) {
       for(size_t i = 0; i < ret.size() ; i++) ret[i] = FLEX_UNDEFINED;
     } else {
       if (coltype == flex_type_enum::DICT) {
-        const flex_dict_view& dict_val(val);
-        for(size_t i = 0; i < ret.size() ; i++) {
-          if (dict_val.has_key(unpacked_keys[i]) && dict_val[unpacked_keys[i]] != na_value) {
-            ret[i] = dict_val[unpacked_keys[i]];
-          } else {
-            ret[i] = FLEX_UNDEFINED;
+        for(size_t i = 0; i < ret.size() ; i++) ret[i] = FLEX_UNDEFINED;
+        // visit the entries in reverse so that the first occurrence of a
+        // duplicated key is the one kept
+        const flex_dict& dict_val = val.get<flex_dict>();
+        for (auto entry = dict_val.rbegin(); entry != dict_val.rend(); ++entry) {
+          auto columns = key_columns.equal_range(entry->first);
+          for (auto col = columns.first; col != columns.second; ++col) {
+            if (entry->second != na_value) {
+              ret[col->second] = entry->second;
+            } else {
+              ret[col->second] = FLEX_UNDEFINED;
+            }
           }
         }
       } else if(coltype == flex_type_enum::LIST) {
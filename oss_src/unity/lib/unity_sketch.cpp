@@ -11,17 +11,22 @@
 #include <parallel/mutex.hpp>
 #include <unity/lib/unity_sketch.hpp>
 #include <unity/lib/unity_sarray.hpp>
+#include <unity/lib/unity_sframe.hpp>
+#include <sframe/sframe.hpp>
 #include <unity/lib/flex_dict_view.hpp>
-#include <sketches/hyperloglog.hpp>
+#include <sketches/hyperloglog_pp.hpp>
 #include <sketches/countsketch.hpp>
 #include <sketches/quantile_sketch.hpp>
 #include <sketches/space_saving_flextype.hpp>
 #include <sketches/streaming_quantile_sketch.hpp>
 #include <parallel/lambda_omp.hpp>
+#include <random/random.hpp>
+#include <timer/timer.hpp>
 
 namespace graphlab {
 
 const double unity_sketch::SKETCH_COMMIT_INTERVAL = 3.0;
+const size_t unity_sketch::SFRAME_SKETCH_CHUNK_SIZE = 4096;
 
 void unity_sketch::construct_from_sarray(
     std::shared_ptr<unity_sarray_base> uarray, bool background, const std::vector<flexible_type>& keys) {
@@ -74,6 +79,81 @@ void unity_sketch::construct_from_sarray(
   }
 }
 
+std::vector<std::shared_ptr<unity_sketch> > unity_sketch::construct_from_sframe(
+    std::shared_ptr<unity_sframe_base> usframe,
+    double sample_fraction,
+    double time_budget) {
+  if (sample_fraction <= 0 || sample_fraction > 1) {
+    log_and_throw("Sample fraction must be in (0, 1]");
+  }
+  auto sf = std::static_pointer_cast<unity_sframe>(usframe)->get_underlying_sframe();
+  size_t num_columns = sf->num_columns();
+  size_t num_rows = sf->num_rows();
+
+  std::vector<std::shared_ptr<unity_sketch> > sketches(num_columns);
+  for (size_t c = 0; c < num_columns; ++c) {
+    auto column = sf->select_column(c);
+    std::shared_ptr<sarray<flexible_type>::reader_type> reader(std::move(column->get_reader()));
+    sketches[c] = std::make_shared<unity_sketch>();
+    sketches[c]->init(NULL, column->get_type(), std::unordered_set<flexible_type>(), reader);
+    if (num_rows == 0) sketches[c]->empty_sketch();
+  }
+  if (num_rows == 0 || num_columns == 0) return sketches;
+
+  // chunks of rows to scan, in random order if the scan may be partial
+  size_t num_chunks = (num_rows + SFRAME_SKETCH_CHUNK_SIZE - 1) / SFRAME_SKETCH_CHUNK_SIZE;
+  std::vector<size_t> chunks(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) chunks[i] = i;
+  if (sample_fraction < 1 || time_budget > 0) {
+    random::shuffle(chunks);
+    size_t num_sampled = std::ceil(num_chunks * sample_fraction);
+    chunks.resize(std::max<size_t>(1, std::min(num_sampled, num_chunks)));
+  }
+
+  auto reader = sf->get_reader();
+  graphlab::atomic<size_t> next_chunk;
+  timer scan_timer;
+  scan_timer.start();
+  in_parallel([&](size_t thr, size_t nthreads) {
+    std::vector<std::vector<flexible_type> > rows;
+    while (time_budget <= 0 || scan_timer.current_time() < time_budget) {
+      size_t chunk = next_chunk.inc_ret_last();
+      if (chunk >= chunks.size()) break;
+      size_t row_start = chunks[chunk] * SFRAME_SKETCH_CHUNK_SIZE;
+      size_t row_end = std::min(row_start + SFRAME_SKETCH_CHUNK_SIZE, num_rows);
+      reader->read_rows(row_start, row_end, rows);
+      // feed the chunk to one column sketch at a time
+      for (size_t c = 0; c < num_columns; ++c) {
+        unity_sketch& sketch = *sketches[c];
+        std::unique_lock<graphlab::mutex> thrlocal_lock(sketch.m_thrlocks[thr]);
+        for (const auto& row : rows) sketch.accumulate_one_value(thr, row[c]);
+        sketch.m_thrlocal[thr].num_elements_processed += rows.size();
+        sketch.m_rows_processed_by_threads.inc(rows.size());
+      }
+    }
+  });
+
+  size_t rows_scanned = sketches[0]->m_rows_processed_by_threads.value;
+  logstream(LOG_INFO) << "Sketched " << num_columns << " columns over "
+                      << rows_scanned << " of " << num_rows << " rows in "
+                      << scan_timer.current_time() << " seconds" << std::endl;
+  for (auto& sketch : sketches) {
+    sketch->m_size = rows_scanned;
+    sketch->combine_global(sketch->m_thrlocks);
+    sketch->m_thrlocal.clear();
+    if (rows_scanned == 0) sketch->empty_sketch();
+  }
+  return sketches;
+}
+
+std::vector<std::shared_ptr<unity_sketch_base> > unity_sketch::sketch_sframe_columns(
+    std::shared_ptr<unity_sframe_base> usframe,
+    double sample_fraction,
+    double time_budget) {
+  auto sketches = construct_from_sframe(usframe, sample_fraction, time_budget);
+  return std::vector<std::shared_ptr<unity_sketch_base> >(sketches.begin(), sketches.end());
+}
+
 unity_sketch::~unity_sketch() {
   if (m_background_future.valid()) {
     m_cancel = true;
@@ -605,7 +685,7 @@ void unity_sketch::numeric_sketch_struct::finalize() {
 void unity_sketch::discrete_sketch_struct::reset() {
   count.reset(new sketches::countsketch<flexible_type>());
   frequent.reset(new sketches::space_saving_flextype());
-  unique.reset(new sketches::hyperloglog());
+  unique.reset(new sketches::hyperloglog_pp(16));
 }
 
 void unity_sketch::discrete_sketch_struct::accumulate(const flexible_type& val) {
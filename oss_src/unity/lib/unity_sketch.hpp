@@ -12,7 +12,7 @@
 #include <flexible_type/flexible_type.hpp>
 #include <unity/lib/api/unity_sketch_interface.hpp>
 #include <sframe/sarray.hpp>
-#include <sketches/hyperloglog.hpp>
+#include <sketches/hyperloglog_pp.hpp>
 #include <sketches/countsketch.hpp>
 #include <sketches/quantile_sketch.hpp>
 #include <sketches/streaming_quantile_sketch.hpp>
@@ -22,6 +22,7 @@ namespace graphlab {
 
 // forward declarations
 class unity_sarray;
+class unity_sframe_base;
 class unity_sketch;
 
 namespace sketches {
@@ -33,7 +34,7 @@ class quantile_sketch;
 template <typename T>
 class countsketch;
 class space_saving_flextype;
-class hyperloglog;
+class hyperloglog_pp;
 
 } // sketches
 
@@ -143,6 +144,9 @@ class unity_sketch: public unity_sketch_base {
 
   static const double SKETCH_COMMIT_INTERVAL;
 
+  /// Number of rows read at once by \ref construct_from_sframe
+  static const size_t SFRAME_SKETCH_CHUNK_SIZE;
+
   inline unity_sketch() { }
 
   ~unity_sketch();
@@ -155,6 +159,36 @@ class unity_sketch: public unity_sketch_base {
    */
   void construct_from_sarray(std::shared_ptr<unity_sarray_base> uarray, bool background = false, const std::vector<flexible_type>& keys = {});
 
+  /**
+   * Generates the sketch statistics of every column of an SFrame in a single
+   * pass. Each block of rows is read once and fed to all the column
+   * sketches; every thread accumulates into its own sketch instances which
+   * are combined at the end. Returns one completed sketch per column, in
+   * column order.
+   *
+   * \param sample_fraction If less than 1, only a random subset of chunks of
+   * rows, covering about this fraction of the rows, is scanned.
+   * \param time_budget If positive, the scan stops after this many seconds.
+   * Chunks are then scanned in random order so that the partial scan is
+   * still a sample of the whole SFrame.
+   *
+   * When the scan is sampled or stopped early, the statistics, counts and
+   * size() of the returned sketches describe the scanned rows only.
+   */
+  static std::vector<std::shared_ptr<unity_sketch> > construct_from_sframe(
+      std::shared_ptr<unity_sframe_base> usframe,
+      double sample_fraction = 1.0,
+      double time_budget = 0.0);
+
+  /**
+   * Interface entry point of \ref construct_from_sframe. The sketch it is
+   * called on is not modified.
+   */
+  std::vector<std::shared_ptr<unity_sketch_base> > sketch_sframe_columns(
+      std::shared_ptr<unity_sframe_base> usframe,
+      double sample_fraction,
+      double time_budget);
+
   /**
    * Returns true if the sketch is complete.
    * If the sketch is constructed with background == false, this will always
@@ -345,7 +379,7 @@ class unity_sketch: public unity_sketch_base {
   struct discrete_sketch_struct {
     std::shared_ptr<sketches::countsketch<flexible_type> > count;
     std::shared_ptr<sketches::space_saving_flextype> frequent;
-    std::shared_ptr<sketches::hyperloglog> unique;
+    std::shared_ptr<sketches::hyperloglog_pp> unique;
 
     void reset();
 
@@ -272,6 +272,23 @@ def COUNT_DISTINCT(src_column):
   return ("__builtin__count__distinct__", [src_column])
 
 
+def APPROX_COUNT_DISTINCT(src_column):
+  """
+  Builtin approximate unique counter for groupby. Estimates the number of
+  unique values with a HyperLogLog++ sketch, which has a relative error of
+  about 1.6% and uses at most 4KB per group regardless of the number of
+  unique values. Prefer it over COUNT_DISTINCT when there are many groups
+  with many unique values.
+
+  Example: Get the approximate number of unique ratings produced by each user.
+
+  >>> sf.groupby("user",
+  ...    {'rating_distinct_count':gl.aggregate.APPROX_COUNT_DISTINCT('rating')})
+
+  """
+  return ("__builtin__approx__count__distinct__", [src_column])
+
+
 def DISTINCT(src_column):
   """
   Builtin distinct values for groupby. Returns a list of distinct values.
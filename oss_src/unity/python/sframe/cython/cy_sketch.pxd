@@ -9,6 +9,7 @@ from .cy_ipc cimport comm_client
 from .cy_ipc cimport PyCommClient
 from .cy_flexible_type cimport flexible_type
 from .cy_sarray cimport UnitySArrayProxy
+from .cy_sframe cimport UnitySFrameProxy
 from libcpp.vector cimport vector
 from libcpp.map cimport map
 from libcpp.string cimport string
@@ -19,6 +20,7 @@ cdef extern from "<unity/lib/api/unity_sketch_interface.hpp>" namespace 'graphla
     cdef cppclass unity_sketch_proxy nogil:
         unity_sketch_proxy(comm_client) except +
         void construct_from_sarray(unity_sarray_base_ptr, bint, vector[flexible_type]) except +
+        vector[unity_sketch_base_ptr] sketch_sframe_columns(unity_sframe_base_ptr, double, double) except +
         double get_quantile(double) except +
         double frequency_count(flexible_type) except +
         vector[pair[flexible_type, size_t]] frequent_items() except +
@@ -48,6 +50,8 @@ cdef class UnitySketchProxy:
 
     cpdef construct_from_sarray(self, UnitySArrayProxy sarray, bint background, object elements)
 
+    cpdef sketch_sframe_columns(self, UnitySFrameProxy sframe, double sample_fraction, double time_budget)
+
     cpdef get_quantile(self, double quantile)
 
     cpdef frequency_count(self, object element)
@@ -41,6 +41,14 @@ cdef class UnitySketchProxy:
         cdef flex_list keys = flex_list_from_iterable(elements)
         self.thisptr.construct_from_sarray(sarray._base_ptr, background, keys)
 
+    cpdef sketch_sframe_columns(self, UnitySFrameProxy sframe, double sample_fraction, double time_budget):
+        cdef vector[unity_sketch_base_ptr] sketches = self.thisptr.sketch_sframe_columns(sframe._base_ptr, sample_fraction, time_budget)
+        ret = []
+        cdef size_t i
+        for i in range(sketches.size()):
+            ret.append(create_proxy_wrapper_from_existing_proxy(self._cli, sketches[i]))
+        return ret
+
     cpdef get_quantile(self, double quantile):
       return self.thisptr.get_quantile(quantile)
 
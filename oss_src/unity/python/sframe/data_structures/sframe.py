@@ -4179,6 +4179,41 @@ class SFrame(object):
 
         return generator()
 
+    def sketch_summary(self, sample_fraction=1.0, time_budget=0):
+        """
+        Summary statistics of every column, calculated with a single pass over
+        the SFrame. Each block of rows is read once for all the columns, which
+        is faster than calling :py:func:`~graphlab.SArray.sketch_summary` on
+        each column.
+
+        Parameters
+        ----------
+        sample_fraction : float, optional
+            If less than 1, only a random subset of blocks of rows, covering
+            about this fraction of the rows, is scanned. Defaults to 1.
+
+        time_budget : float, optional
+            If positive, the scan stops after this many seconds. Defaults to 0,
+            no time limit.
+
+        Returns
+        -------
+        out : dict
+            A dictionary from each column name to the Sketch of that column.
+            When the scan is sampled or stopped early, the sketches describe
+            the scanned rows only.
+        """
+        from ..data_structures.sketch import Sketch
+        from ..cython.cy_sketch import UnitySketchProxy
+        if _Image in self.column_types():
+            raise TypeError("sketch_summary() is not supported for columns of image type")
+        if sample_fraction <= 0 or sample_fraction > 1:
+            raise ValueError("'sample_fraction' has to be in (0, 1]")
+        with cython_context():
+            proxy = UnitySketchProxy(glconnect.get_client())
+            sketches = proxy.sketch_sframe_columns(self.__proxy__, sample_fraction, time_budget)
+        return dict(zip(self.column_names(), [Sketch(_proxy=s) for s in sketches]))
+
     def append(self, other):
         """
         Add the rows of an SFrame to the end of this SFrame.
@@ -291,3 +291,17 @@ class SArraySketchTest(unittest.TestCase):
         s.cancel()
         # this can be rather non-deterministic, so there is very little
         # real output validation that can be done...
+
+    def test_sframe_sketch(self):
+        from ..data_structures.sframe import SFrame
+        sf = SFrame({'a': range(1000), 'b': [float(i) / 2 for i in range(1000)]})
+        sketches = sf.sketch_summary()
+        self.assertEqual(sorted(sketches.keys()), ['a', 'b'])
+        self.__validate_sketch_result(sketches['a'], sf['a'])
+        self.__validate_sketch_result(sketches['b'], sf['b'])
+
+        sampled = sf.sketch_summary(sample_fraction=0.5)
+        self.assertTrue(0 < sampled['a'].size() <= 1000)
+        self.assertEqual(sampled['a'].size(), sampled['b'].size())
+        with self.assertRaises(ValueError):
+            sf.sketch_summary(sample_fraction=0)
@@ -20,6 +20,7 @@ REGISTER_FUNCTION(decode_image, "image")
 REGISTER_FUNCTION(decode_image_sarray, "image_sarray")
 REGISTER_FUNCTION(resize_image, "image",  "resized_width", "resized_height", "resized_channels", "decode")
 REGISTER_FUNCTION(resize_image_sarray, "image_sarray",  "resized_width", "resized_height", "resized_channels", "decode")
+REGISTER_FUNCTION(image_pipeline_sarray, "image_sarray",  "resized_width", "resized_height", "resized_channels", "to_vector", "undefined_on_failure")
 REGISTER_FUNCTION(vector_sarray_to_image_sarray, "sarray",  "width", "height", "channels", "undefined_on_failure")
 REGISTER_FUNCTION(generate_mean, "unity_data")
 END_FUNCTION_REGISTRATION
@@ -0,0 +1,155 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fileio/async_file_io.hpp>
+#include <fileio/fileio_constants.hpp>
+#include <fileio/temp_files.hpp>
+#include <random/random.hpp>
+#include <cxxtest/TestSuite.h>
+
+using namespace graphlab;
+using fileio::async_io_request;
+
+class async_file_io_test: public CxxTest::TestSuite {
+
+ public:
+
+  void test_read_write_io_uring() {
+    fileio::async_file_io io;
+    write_and_read(io);
+  }
+
+  void test_read_write_synchronous() {
+    size_t old_use_io_uring = fileio::FILEIO_USE_IO_URING;
+    fileio::FILEIO_USE_IO_URING = 0;
+    fileio::async_file_io io;
+    TS_ASSERT(!io.using_io_uring());
+    write_and_read(io);
+    fileio::FILEIO_USE_IO_URING = old_use_io_uring;
+  }
+
+  void test_short_read() {
+    std::string fname = get_temp_name();
+    {
+      std::ofstream fout(fname, std::ofstream::binary);
+      fout << "hello world";
+    }
+    int fd = open(fname.c_str(), O_RDONLY);
+    TS_ASSERT_LESS_THAN_EQUALS(0, fd);
+    std::vector<char> a(5), b(100);
+    std::vector<async_io_request> requests(2);
+    requests[0].fd = fd; requests[0].offset = 0;
+    requests[0].buffer = a.data(); requests[0].length = a.size();
+    requests[1].fd = fd; requests[1].offset = 6;
+    requests[1].buffer = b.data(); requests[1].length = b.size();
+    TS_ASSERT(!fileio::get_thread_local_async_file_io().read(requests));
+    TS_ASSERT_EQUALS(requests[0].result, 5);
+    TS_ASSERT_EQUALS(requests[1].result, 5);
+    TS_ASSERT_EQUALS(std::string(a.data(), 5), "hello");
+    TS_ASSERT_EQUALS(std::string(b.data(), 5), "world");
+    close(fd);
+
+    // reads of an invalid descriptor fail
+    TS_ASSERT(!fileio::get_thread_local_async_file_io().read(requests));
+    TS_ASSERT_LESS_THAN(requests[0].result, 0);
+  }
+
+  void test_direct_read() {
+    std::string fname = get_temp_name();
+    std::string contents(4 * fileio::DIRECT_IO_ALIGNMENT, 0);
+    for (size_t i = 0; i < contents.size(); ++i) contents[i] = (char)(i * 7);
+    {
+      std::ofstream fout(fname, std::ofstream::binary);
+      fout.write(contents.data(), contents.size());
+    }
+    // O_DIRECT may not be supported by the file system, in which case the
+    // file is opened normally
+    bool direct = true;
+    int fd = fileio::open_local_file_for_read(fname, direct);
+    TS_ASSERT_LESS_THAN_EQUALS(0, fd);
+    void* buffer = NULL;
+    TS_ASSERT_EQUALS(posix_memalign(&buffer, fileio::DIRECT_IO_ALIGNMENT,
+                                    contents.size()), 0);
+    std::vector<async_io_request> requests(2);
+    for (size_t i = 0; i < 2; ++i) {
+      requests[i].fd = fd;
+      requests[i].offset = 2 * i * fileio::DIRECT_IO_ALIGNMENT;
+      requests[i].buffer = (char*)buffer + requests[i].offset;
+      requests[i].length = 2 * fileio::DIRECT_IO_ALIGNMENT;
+    }
+    TS_ASSERT(fileio::get_thread_local_async_file_io().read(requests));
+    TS_ASSERT(memcmp(buffer, contents.data(), contents.size()) == 0);
+    free(buffer);
+    close(fd);
+  }
+
+  void test_write_fully() {
+    std::string fname = get_temp_name();
+    int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    TS_ASSERT_LESS_THAN_EQUALS(0, fd);
+    // out of order positional writes leave no gap
+    TS_ASSERT(fileio::write_fully(fd, 6, "world", 5));
+    TS_ASSERT(fileio::write_fully(fd, 0, "hello ", 6));
+    TS_ASSERT(fileio::write_fully(fd, 11, "", 0));
+    std::vector<char> buffer(11);
+    TS_ASSERT_EQUALS(pread(fd, buffer.data(), buffer.size(), 0), 11);
+    TS_ASSERT_EQUALS(std::string(buffer.data(), buffer.size()), "hello world");
+    close(fd);
+    // writes to an invalid descriptor fail
+    TS_ASSERT(!fileio::write_fully(fd, 0, "hello", 5));
+  }
+
+ private:
+  void write_and_read(fileio::async_file_io& io) {
+    std::string fname = get_temp_name();
+    int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    TS_ASSERT_LESS_THAN_EQUALS(0, fd);
+
+    // more requests than the queue depth, in random order
+    size_t nrequests = 3 * fileio::FILEIO_IO_URING_QUEUE_DEPTH + 5;
+    size_t request_size = 3000;
+    std::vector<char> contents(nrequests * request_size);
+    for (size_t i = 0; i < contents.size(); ++i) contents[i] = (char)random::rand();
+    std::vector<async_io_request> requests(nrequests);
+    for (size_t i = 0; i < nrequests; ++i) {
+      requests[i].fd = fd;
+      requests[i].offset = i * request_size;
+      requests[i].buffer = contents.data() + i * request_size;
+      requests[i].length = request_size;
+    }
+    random::shuffle(requests);
+    TS_ASSERT(io.write(requests));
+    for (auto& request : requests) {
+      TS_ASSERT_EQUALS(request.result, (ssize_t)request_size);
+    }
+
+    std::vector<char> read_back(contents.size());
+    for (auto& request : requests) {
+      request.buffer = read_back.data() + request.offset;
+    }
+    random::shuffle(requests);
+    TS_ASSERT(io.read(requests));
+    TS_ASSERT(read_back == contents);
+    close(fd);
+  }
+};
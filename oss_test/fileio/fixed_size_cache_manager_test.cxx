@@ -15,7 +15,12 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <string>
+#include <fstream>
 #include <fileio/fixed_size_cache_manager.hpp>
+#include <fileio/fs_utils.hpp>
+#include <fileio/temp_files.hpp>
+#include <minipsutil/minipsutil.h>
+#include <boost/filesystem.hpp>
 #include <cxxtest/TestSuite.h>
 
 using namespace graphlab::fileio;
@@ -169,3 +174,185 @@ class cache_eviction_test: public CxxTest::TestSuite {
     TS_ASSERT_EQUALS(cache_instance.get_cache(size_to_file[1*1024])->is_pointer(), true);
   }
 };
+
+
+class cache_spill_test: public CxxTest::TestSuite {
+ public:
+  void setUp() {
+    old_capacity = FILEIO_MAXIMUM_CACHE_CAPACITY;
+    old_capacity_per_file = FILEIO_MAXIMUM_CACHE_CAPACITY_PER_FILE;
+    old_rss_limit = FILEIO_CACHE_RSS_LIMIT_PERCENT;
+    old_async = FILEIO_CACHE_ASYNC_WRITE_BACK;
+    FILEIO_MAXIMUM_CACHE_CAPACITY = 64 * 1024;
+    FILEIO_MAXIMUM_CACHE_CAPACITY_PER_FILE = 16 * 1024;
+    FILEIO_CACHE_RSS_LIMIT_PERCENT = 0;
+    FILEIO_CACHE_ASYNC_WRITE_BACK = 1;
+    fixed_size_cache_manager::get_instance().clear();
+  }
+
+  void tearDown() {
+    fixed_size_cache_manager::get_instance().wait_for_write_back();
+    fixed_size_cache_manager::get_instance().clear();
+    FILEIO_MAXIMUM_CACHE_CAPACITY = old_capacity;
+    FILEIO_MAXIMUM_CACHE_CAPACITY_PER_FILE = old_capacity_per_file;
+    FILEIO_CACHE_RSS_LIMIT_PERCENT = old_rss_limit;
+    FILEIO_CACHE_ASYNC_WRITE_BACK = old_async;
+  }
+
+  void test_evicts_least_recently_used() {
+    auto& manager = fixed_size_cache_manager::get_instance();
+    for (size_t i = 0; i < 4; ++i) make_block(i, 16 * 1024);
+    // 0 becomes the most recently used. 1 is now the least recently used.
+    manager.get_cache(make_cache_id(0));
+    // the cache is full. Creating a block evicts down to 3/4 of the capacity
+    auto blk = manager.new_cache(make_cache_id(4));
+    manager.wait_for_write_back();
+    TS_ASSERT(manager.get_cache(make_cache_id(1))->is_file());
+    check_file_contents(manager.get_cache(make_cache_id(1)), 1, 16 * 1024);
+    TS_ASSERT(manager.get_cache(make_cache_id(0))->is_pointer());
+    TS_ASSERT(manager.get_cache(make_cache_id(2))->is_pointer());
+    TS_ASSERT(manager.get_cache(make_cache_id(3))->is_pointer());
+    TS_ASSERT_EQUALS(manager.get_cache_utilization(),
+                     48 * 1024 + blk->get_pointer_capacity());
+  }
+
+  void test_evicts_large_blocks_first() {
+    auto& manager = fixed_size_cache_manager::get_instance();
+    FILEIO_MAXIMUM_CACHE_CAPACITY = 49 * 1024;
+    // the small block is the oldest, but evicting it would not free enough
+    make_block(0, 1024);
+    for (size_t i = 1; i < 4; ++i) make_block(i, 16 * 1024);
+    manager.new_cache(make_cache_id(4));
+    manager.wait_for_write_back();
+    TS_ASSERT(manager.get_cache(make_cache_id(0))->is_pointer());
+    TS_ASSERT(manager.get_cache(make_cache_id(1))->is_file());
+    TS_ASSERT(manager.get_cache(make_cache_id(2))->is_pointer());
+    TS_ASSERT(manager.get_cache(make_cache_id(3))->is_pointer());
+  }
+
+  void test_synchronous_eviction() {
+    auto& manager = fixed_size_cache_manager::get_instance();
+    FILEIO_CACHE_ASYNC_WRITE_BACK = 0;
+    for (size_t i = 0; i < 4; ++i) make_block(i, 16 * 1024);
+    manager.new_cache(make_cache_id(4));
+    // evicted before new_cache returns
+    TS_ASSERT(manager.get_cache(make_cache_id(0))->is_file());
+    check_file_contents(manager.get_cache(make_cache_id(0)), 0, 16 * 1024);
+  }
+
+  void test_fast_spill_tier() {
+    auto& manager = fixed_size_cache_manager::get_instance();
+    std::string fast_dir = graphlab::get_temp_name();
+    TS_ASSERT(create_directory(fast_dir));
+    std::string old_location = FILEIO_CACHE_FAST_SPILL_LOCATION;
+    size_t old_fast_capacity = FILEIO_CACHE_FAST_SPILL_CAPACITY;
+    FILEIO_CACHE_FAST_SPILL_LOCATION = fast_dir;
+    FILEIO_CACHE_FAST_SPILL_CAPACITY = 20 * 1024;
+
+    auto blk0 = make_block(0, 16 * 1024);
+    auto blk1 = make_block(1, 16 * 1024);
+    blk0->write_to_file();
+    blk1->write_to_file();
+    // the first block fills the fast tier, the second one overflows
+    TS_ASSERT(blk0->is_fast_tier_file());
+    TS_ASSERT_EQUALS(blk0->get_filename().find(fast_dir), 0);
+    TS_ASSERT(!blk1->is_fast_tier_file());
+    TS_ASSERT_EQUALS(blk1->get_filename().find(fast_dir), std::string::npos);
+    TS_ASSERT_EQUALS(manager.get_fast_tier_utilization(), 16 * 1024);
+    check_file_contents(blk0, 0, 16 * 1024);
+    // freeing the block makes room in the fast tier
+    manager.free(blk0);
+    blk0.reset();
+    TS_ASSERT_EQUALS(manager.get_fast_tier_utilization(), 0);
+
+    FILEIO_CACHE_FAST_SPILL_LOCATION = old_location;
+    FILEIO_CACHE_FAST_SPILL_CAPACITY = old_fast_capacity;
+  }
+
+  void test_fast_spill_tier_reaped() {
+    namespace fs = boost::filesystem;
+    // [directory]/graphlab-[username]/[pid]/[file]
+    std::string used_dir = graphlab::get_temp_name();
+    TS_ASSERT(create_directory(used_dir));
+    fs::path used_user_dir =
+        fs::path(graphlab::get_temp_name_in_directory(used_dir)).parent_path().parent_path();
+    std::string fast_dir = graphlab::get_temp_name();
+    TS_ASSERT(create_directory(fast_dir));
+    fs::path fast_user_dir = fs::path(fast_dir) / used_user_dir.filename();
+
+    // the files of a process which no longer exists, in a directory used by
+    // this process, and in the fast spill location
+    for (auto& user_dir: {used_user_dir, fast_user_dir}) {
+      fs::create_directories(user_dir / "999999999");
+      std::ofstream((user_dir / "999999999" / "spill").string()) << "x";
+    }
+    std::string old_location = FILEIO_CACHE_FAST_SPILL_LOCATION;
+    FILEIO_CACHE_FAST_SPILL_LOCATION = fast_dir;
+    graphlab::reap_unused_temp_files();
+    FILEIO_CACHE_FAST_SPILL_LOCATION = old_location;
+    TS_ASSERT(!fs::exists(used_user_dir / "999999999"));
+    TS_ASSERT(!fs::exists(fast_user_dir / "999999999"));
+    // the directory of this process is kept
+    TS_ASSERT(fs::exists(used_user_dir / std::to_string(getpid())));
+  }
+
+  void test_memory_pressure_eviction() {
+    auto& manager = fixed_size_cache_manager::get_instance();
+    FILEIO_CACHE_RSS_LIMIT_PERCENT = 50;
+    uint64_t total = total_mem();
+    manager.set_process_rss_function([]() { return uint64_t(1); });
+    for (size_t i = 0; i < 3; ++i) make_block(i, 16 * 1024);
+    // 2 is now the least recently used, then 1
+    manager.get_cache(make_cache_id(1));
+    manager.get_cache(make_cache_id(0));
+
+    // over the limit. Creating a block gives back half of the cache, and the
+    // new block goes directly to disk.
+    manager.set_process_rss_function([total]() { return total / 100 * 60; });
+    auto blk = manager.new_cache(make_cache_id(3));
+    TS_ASSERT_EQUALS(blk->get_pointer_capacity(), 0);
+    std::string data(1024, 'd');
+    TS_ASSERT(!blk->write_bytes_to_memory_cache(data.data(), data.length()));
+    manager.wait_for_write_back();
+    TS_ASSERT(manager.get_cache(make_cache_id(2))->is_file());
+    TS_ASSERT(manager.get_cache(make_cache_id(1))->is_file());
+    TS_ASSERT(manager.get_cache(make_cache_id(0))->is_pointer());
+    TS_ASSERT_EQUALS(manager.get_cache_utilization(), 16 * 1024);
+    check_file_contents(manager.get_cache(make_cache_id(1)), 1, 16 * 1024);
+    check_file_contents(manager.get_cache(make_cache_id(2)), 2, 16 * 1024);
+
+    // blocks do not grow under pressure
+    manager.set_process_rss_function([]() { return uint64_t(1); });
+    auto blk4 = manager.new_cache(make_cache_id(4));
+    std::string fill(blk4->get_pointer_capacity(), 'e');
+    TS_ASSERT(blk4->write_bytes_to_memory_cache(fill.data(), fill.length()));
+    manager.set_process_rss_function([total]() { return total / 100 * 60; });
+    TS_ASSERT(!blk4->write_bytes_to_memory_cache(data.data(), data.length()));
+
+    // once the pressure is relieved, new blocks are in memory again
+    manager.set_process_rss_function([]() { return uint64_t(1); });
+    TS_ASSERT(manager.new_cache(make_cache_id(5))->get_pointer_capacity() > 0);
+    manager.set_process_rss_function(nullptr);
+  }
+
+ private:
+  size_t old_capacity, old_capacity_per_file, old_rss_limit, old_async;
+
+  cache_id_type make_cache_id(size_t i) {
+    return cache_id_type("cache://spill" + std::to_string(i));
+  }
+
+  std::shared_ptr<cache_block> make_block(size_t i, size_t size) {
+    auto blk = fixed_size_cache_manager::get_instance().new_cache(make_cache_id(i));
+    std::string data(size, (char)('a' + i));
+    TS_ASSERT(blk->write_bytes_to_memory_cache(data.data(), size));
+    return blk;
+  }
+
+  void check_file_contents(std::shared_ptr<cache_block> blk, size_t i, size_t size) {
+    std::ifstream fin(blk->get_filename(), std::ifstream::binary);
+    std::string contents((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+    TS_ASSERT_EQUALS(contents, std::string(size, (char)('a' + i)));
+  }
+};
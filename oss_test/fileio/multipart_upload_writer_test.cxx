@@ -0,0 +1,174 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <string>
+#include <map>
+#include <ios>
+#include <stdexcept>
+#include <fileio/multipart_upload_writer.hpp>
+#include <parallel/mutex.hpp>
+#include <cxxtest/TestSuite.h>
+
+using namespace graphlab;
+using fileio::multipart_upload_writer;
+
+/**
+ * An in memory multipart upload. Parts listed in fail_parts fail that many
+ * times before succeeding.
+ */
+struct fake_upload {
+  graphlab::mutex lock;
+  std::map<size_t, std::string> parts;
+  std::map<size_t, size_t> fail_parts;
+  std::map<size_t, size_t> attempts;
+  std::string completed;
+  size_t num_completed = 0;
+  size_t num_aborted = 0;
+  size_t max_thread_id = 0;
+
+  multipart_upload_writer::upload_part_function upload_part() {
+    return [this](size_t thread_id, size_t part_number, const std::string& data) {
+      std::lock_guard<graphlab::mutex> guard(lock);
+      max_thread_id = std::max(max_thread_id, thread_id);
+      ++attempts[part_number];
+      auto iter = fail_parts.find(part_number);
+      if (iter != fail_parts.end() && iter->second > 0) {
+        --iter->second;
+        throw std::runtime_error("injected failure");
+      }
+      parts[part_number] = data;
+      return "\"etag" + std::to_string(part_number) + "\"";
+    };
+  }
+
+  multipart_upload_writer::complete_function complete() {
+    return [this](const std::map<size_t, std::string>& etags) {
+      ++num_completed;
+      for (const auto& etag : etags) {
+        TS_ASSERT_EQUALS(etag.second, "\"etag" + std::to_string(etag.first) + "\"");
+        completed += parts[etag.first];
+      }
+    };
+  }
+
+  multipart_upload_writer::abort_function abort() {
+    return [this]() { ++num_aborted; };
+  }
+};
+
+class multipart_upload_writer_test: public CxxTest::TestSuite {
+ public:
+
+  void test_part_boundaries() {
+    fake_upload upload;
+    multipart_upload_writer writer(10, 3, 1, upload.upload_part(),
+                                   upload.complete(), upload.abort(), 0);
+    std::string expected;
+    // writes straddling, ending on and spanning several part boundaries
+    for (size_t length : {3, 7, 10, 25, 1, 0, 4}) {
+      std::string data;
+      for (size_t i = 0; i < length; ++i) data += char('a' + (expected.length() + i) % 26);
+      writer.write(data.c_str(), data.length());
+      expected += data;
+    }
+    writer.close();
+    TS_ASSERT_EQUALS(expected.length(), 50);
+    TS_ASSERT_EQUALS(writer.num_parts(), 5);
+    TS_ASSERT_EQUALS(upload.parts.size(), 5);
+    for (const auto& part : upload.parts) TS_ASSERT_EQUALS(part.second.length(), 10);
+    TS_ASSERT_EQUALS(upload.completed, expected);
+    TS_ASSERT_EQUALS(upload.num_completed, 1);
+    TS_ASSERT_EQUALS(upload.num_aborted, 0);
+    TS_ASSERT_LESS_THAN(upload.max_thread_id, 3);
+  }
+
+  void test_last_part() {
+    // the remainder becomes a shorter last part
+    fake_upload upload;
+    multipart_upload_writer writer(10, 2, 1, upload.upload_part(),
+                                   upload.complete(), upload.abort(), 0);
+    std::string data(23, 'x');
+    writer.write(data.c_str(), data.length());
+    writer.close();
+    TS_ASSERT_EQUALS(upload.parts.size(), 3);
+    TS_ASSERT_EQUALS(upload.parts[3].length(), 3);
+    TS_ASSERT_EQUALS(upload.completed, data);
+
+    // an empty stream is a single empty part
+    fake_upload empty_upload;
+    multipart_upload_writer empty_writer(10, 2, 1, empty_upload.upload_part(),
+                                         empty_upload.complete(), empty_upload.abort(), 0);
+    empty_writer.close();
+    TS_ASSERT_EQUALS(empty_upload.parts.size(), 1);
+    TS_ASSERT_EQUALS(empty_upload.parts[1], "");
+    TS_ASSERT_EQUALS(empty_upload.num_completed, 1);
+  }
+
+  void test_retry() {
+    // every part is attempted at most max_attempts times
+    fake_upload upload;
+    upload.fail_parts[2] = 2;
+    multipart_upload_writer writer(4, 2, 3, upload.upload_part(),
+                                   upload.complete(), upload.abort(), 0);
+    std::string data(16, 'y');
+    writer.write(data.c_str(), data.length());
+    writer.close();
+    TS_ASSERT_EQUALS(upload.attempts[1], 1);
+    TS_ASSERT_EQUALS(upload.attempts[2], 3);
+    TS_ASSERT_EQUALS(upload.completed, data);
+    TS_ASSERT_EQUALS(upload.num_aborted, 0);
+  }
+
+  void test_abort_on_close() {
+    fake_upload upload;
+    upload.fail_parts[2] = 100;
+    multipart_upload_writer writer(4, 4, 2, upload.upload_part(),
+                                   upload.complete(), upload.abort(), 0);
+    std::string data(10, 'z');
+    writer.write(data.c_str(), data.length());
+    TS_ASSERT_THROWS_ANYTHING(writer.close());
+    TS_ASSERT_EQUALS(upload.attempts[2], 2);
+    TS_ASSERT_EQUALS(upload.num_completed, 0);
+    TS_ASSERT_EQUALS(upload.num_aborted, 1);
+    // the writer stays failed, and aborts only once
+    TS_ASSERT_THROWS_ANYTHING(writer.close());
+    TS_ASSERT_THROWS_ANYTHING(writer.write(data.c_str(), data.length()));
+    TS_ASSERT_EQUALS(upload.num_aborted, 1);
+  }
+
+  void test_abort_on_write() {
+    // with a single part in flight, the failure of part 1 is seen by the
+    // write which queues part 2, and no later part is uploaded
+    fake_upload upload;
+    upload.fail_parts[1] = 100;
+    multipart_upload_writer writer(4, 1, 1, upload.upload_part(),
+                                   upload.complete(), upload.abort(), 0);
+    std::string data(4, 'w');
+    bool failed = false;
+    for (size_t i = 0; i < 10 && !failed; ++i) {
+      try {
+        writer.write(data.c_str(), data.length());
+      } catch (std::ios_base::failure&) {
+        failed = true;
+      }
+    }
+    TS_ASSERT(failed);
+    TS_ASSERT_EQUALS(upload.parts.size(), 0);
+    TS_ASSERT_EQUALS(upload.attempts.size(), 1);
+    TS_ASSERT_EQUALS(upload.num_aborted, 1);
+    TS_ASSERT_EQUALS(upload.num_completed, 0);
+  }
+};
@@ -0,0 +1,168 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <string>
+#include <sstream>
+#include <memory>
+#include <cstring>
+#include <zlib.h>
+#include <fileio/parallel_gzip_decompressor.hpp>
+#include <random/random.hpp>
+#include <cxxtest/TestSuite.h>
+
+using namespace graphlab;
+using fileio_impl::parallel_gzip_decompressor;
+
+class parallel_gzip_decompressor_test: public CxxTest::TestSuite {
+
+ public:
+
+  void test_single_member() {
+    std::string data = make_data(2 * 1024 * 1024);
+    std::string compressed = gzip(data, 6);
+    size_t parallel_chunks = 0;
+    TS_ASSERT_EQUALS(decompress(compressed, 64 * 1024, parallel_chunks), data);
+    // a single member cannot be cut
+    TS_ASSERT_EQUALS(parallel_chunks, 0);
+  }
+
+  void test_multiple_members() {
+    std::string data, compressed;
+    for (size_t i = 0; i < 200; ++i) {
+      std::string member = make_data(random::fast_uniform<size_t>(0, 20000));
+      data += member;
+      compressed += gzip(member, 6);
+    }
+    size_t parallel_chunks = 0;
+    TS_ASSERT_EQUALS(decompress(compressed, 16 * 1024, parallel_chunks), data);
+    TS_ASSERT_LESS_THAN(1, parallel_chunks);
+  }
+
+  void test_bgzf() {
+    std::string data, compressed;
+    for (size_t i = 0; i < 100; ++i) {
+      std::string member = make_data(60000);
+      data += member;
+      compressed += bgzf_block(member);
+    }
+    compressed += bgzf_block("");
+    size_t parallel_chunks = 0;
+    TS_ASSERT_EQUALS(decompress(compressed, 64 * 1024, parallel_chunks), data);
+    TS_ASSERT_LESS_THAN(1, parallel_chunks);
+  }
+
+  void test_false_member_header() {
+    // stored members contain their data verbatim, so a gzip header in the
+    // data looks like a member boundary
+    std::string fake_header("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03", 10);
+    std::string data, compressed;
+    for (size_t i = 0; i < 50; ++i) {
+      std::string member = make_data(30000) + fake_header + make_data(30000);
+      data += member;
+      compressed += gzip(member, 0);
+    }
+    size_t parallel_chunks = 0;
+    TS_ASSERT_EQUALS(decompress(compressed, 8 * 1024, parallel_chunks), data);
+  }
+
+  void test_trailing_garbage() {
+    std::string data = make_data(100000);
+    std::string compressed = gzip(data, 6) + std::string(100, '\0');
+    size_t parallel_chunks = 0;
+    TS_ASSERT_EQUALS(decompress(compressed, 16 * 1024, parallel_chunks, false),
+                     data);
+  }
+
+  void test_corrupted() {
+    std::string compressed;
+    for (size_t i = 0; i < 20; ++i) compressed += gzip(make_data(50000), 6);
+    size_t parallel_chunks = 0;
+    std::string corrupted = compressed;
+    corrupted[corrupted.size() / 2] ^= 0x55;
+    TS_ASSERT_THROWS_ANYTHING(decompress(corrupted, 16 * 1024, parallel_chunks));
+
+    std::string truncated = compressed.substr(0, compressed.size() - 5);
+    TS_ASSERT_THROWS_ANYTHING(decompress(truncated, 16 * 1024, parallel_chunks));
+  }
+
+ private:
+  /// Compressible text
+  std::string make_data(size_t length) {
+    std::string ret;
+    ret.reserve(length);
+    while (ret.size() < length) {
+      ret += std::to_string(random::fast_uniform<size_t>(0, 100000)) + ",abc,";
+      ret += (random::fast_uniform<size_t>(0, 10) == 0) ? "\n" : "def";
+    }
+    ret.resize(length);
+    return ret;
+  }
+
+  std::string deflate_data(const std::string& data, int level, int window_bits) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    TS_ASSERT_EQUALS(deflateInit2(&stream, level, Z_DEFLATED, window_bits,
+                                  8, Z_DEFAULT_STRATEGY), Z_OK);
+    std::string ret(deflateBound(&stream, data.size()), 0);
+    stream.next_in = (Bytef*)data.data();
+    stream.avail_in = data.size();
+    stream.next_out = (Bytef*)&ret[0];
+    stream.avail_out = ret.size();
+    TS_ASSERT_EQUALS(deflate(&stream, Z_FINISH), Z_STREAM_END);
+    ret.resize(ret.size() - stream.avail_out);
+    deflateEnd(&stream);
+    return ret;
+  }
+
+  std::string gzip(const std::string& data, int level) {
+    return deflate_data(data, level, 16 + MAX_WBITS);
+  }
+
+  void append_le(std::string& s, size_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) s.push_back((char)((value >> (8 * i)) & 0xff));
+  }
+
+  /// A gzip member with the bgzip "BC" extra field holding its size
+  std::string bgzf_block(const std::string& data) {
+    std::string deflated = deflate_data(data, 6, -MAX_WBITS);
+    std::string ret("\x1f\x8b\x08\x04\x00\x00\x00\x00\x00\xff\x06\x00""BC\x02\x00", 16);
+    append_le(ret, 18 + deflated.size() + 8 - 1, 2);
+    ret += deflated;
+    append_le(ret, crc32(0, (const Bytef*)data.data(), data.size()), 4);
+    append_le(ret, data.size(), 4);
+    return ret;
+  }
+
+  std::string decompress(const std::string& compressed,
+                         size_t chunk_size,
+                         size_t& parallel_chunks,
+                         bool reads_all_input = true) {
+    auto input = std::make_shared<std::istringstream>(compressed);
+    parallel_gzip_decompressor decompressor(input, 4, chunk_size);
+    std::string ret;
+    std::vector<char> buffer(7919);
+    while (true) {
+      std::streamsize n = decompressor.read(buffer.data(), buffer.size());
+      if (n < 0) break;
+      ret.append(buffer.data(), n);
+    }
+    if (reads_all_input) {
+      TS_ASSERT_EQUALS(decompressor.get_bytes_read(), compressed.size());
+    }
+    parallel_chunks = decompressor.num_parallel_chunks();
+    return ret;
+  }
+};
@@ -0,0 +1,156 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include <fileio/range_reader.hpp>
+#include <fileio/fileio_constants.hpp>
+#include <fileio/temp_files.hpp>
+#include <parallel/atomic.hpp>
+#include <parallel/atomic_ops.hpp>
+#include <random/random.hpp>
+#include <cxxtest/TestSuite.h>
+
+using namespace graphlab;
+using fileio::byte_range;
+
+class range_reader_test: public CxxTest::TestSuite {
+
+ public:
+
+  void test_coalesce() {
+    // adjacent and close ranges merge, far ranges do not
+    auto requests = fileio::coalesce_byte_ranges(
+        {{100, 10}, {0, 50}, {50, 20}, {75, 10}, {1000, 10}, {0, 0}}, 20, 1000);
+    TS_ASSERT_EQUALS(requests.size(), 2);
+    TS_ASSERT_EQUALS(requests[0].offset, 0);
+    TS_ASSERT_EQUALS(requests[0].length, 110);
+    TS_ASSERT_EQUALS(requests[1].offset, 1000);
+    TS_ASSERT_EQUALS(requests[1].length, 10);
+
+    // the request size is bounded, but a single large range is kept whole
+    requests = fileio::coalesce_byte_ranges(
+        {{0, 40}, {40, 40}, {80, 40}, {120, 500}}, 0, 100);
+    TS_ASSERT_EQUALS(requests.size(), 3);
+    TS_ASSERT_EQUALS(requests[0].offset, 0);
+    TS_ASSERT_EQUALS(requests[0].length, 80);
+    TS_ASSERT_EQUALS(requests[1].offset, 80);
+    TS_ASSERT_EQUALS(requests[1].length, 40);
+    TS_ASSERT_EQUALS(requests[2].offset, 120);
+    TS_ASSERT_EQUALS(requests[2].length, 500);
+
+    // contained ranges never start a new request
+    requests = fileio::coalesce_byte_ranges({{0, 100}, {10, 10}, {20, 10}}, 0, 50);
+    TS_ASSERT_EQUALS(requests.size(), 1);
+    TS_ASSERT_EQUALS(requests[0].length, 100);
+  }
+
+  void test_concurrent_ranged_reads() {
+    // an in memory stand-in for a remote file which records the number of
+    // requests in flight
+    size_t file_size = 1024 * 1024;
+    std::string contents(file_size, 0);
+    for (size_t i = 0; i < file_size; ++i) contents[i] = (char)(i * 31 + 7);
+
+    graphlab::atomic<size_t> in_flight;
+    graphlab::atomic<size_t> max_in_flight;
+    auto fetch = [&](char* out, size_t offset, size_t length) -> size_t {
+      size_t current = in_flight.inc();
+      size_t prev_max = max_in_flight.value;
+      while (current > prev_max &&
+             !atomic_compare_and_swap(max_in_flight.value, prev_max, current)) {
+        prev_max = max_in_flight.value;
+      }
+      usleep(1000);
+      memcpy(out, contents.data() + offset, length);
+      in_flight.dec();
+      return length;
+    };
+
+    size_t old_parallelism = fileio::FILEIO_RANGE_READ_PARALLELISM;
+    size_t old_max_gap = fileio::FILEIO_RANGE_READ_MAX_GAP;
+    size_t old_max_request = fileio::FILEIO_RANGE_READ_MAX_REQUEST_SIZE;
+    fileio::FILEIO_RANGE_READ_PARALLELISM = 4;
+    fileio::FILEIO_RANGE_READ_MAX_GAP = 256;
+    fileio::FILEIO_RANGE_READ_MAX_REQUEST_SIZE = 16 * 1024;
+
+    fileio::range_reader reader(fetch, file_size);
+    TS_ASSERT_EQUALS(reader.file_size(), file_size);
+
+    // blocks of 4000 bytes, 4096 aligned, like the blocks of a column
+    // within a segment, in random order.
+    std::vector<byte_range> ranges;
+    for (size_t i = 0; i < 200; ++i) ranges.emplace_back(i * 4096, 4000);
+    random::shuffle(ranges);
+    std::vector<std::vector<char> > out;
+    reader.read(ranges, out);
+    TS_ASSERT_EQUALS(out.size(), ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      TS_ASSERT_EQUALS(out[i].size(), ranges[i].length);
+      TS_ASSERT(memcmp(out[i].data(), contents.data() + ranges[i].offset,
+                       ranges[i].length) == 0);
+    }
+    // 4 blocks per request
+    TS_ASSERT_EQUALS(reader.num_requests(), 50);
+    TS_ASSERT_LESS_THAN_EQUALS(max_in_flight.value, 4);
+    TS_ASSERT_LESS_THAN(1, max_in_flight.value);
+
+    // reading past the end fails
+    TS_ASSERT_THROWS_ANYTHING(reader.read({byte_range(file_size - 10, 20)}, out));
+
+    fileio::FILEIO_RANGE_READ_PARALLELISM = old_parallelism;
+    fileio::FILEIO_RANGE_READ_MAX_GAP = old_max_gap;
+    fileio::FILEIO_RANGE_READ_MAX_REQUEST_SIZE = old_max_request;
+  }
+
+  void test_failed_request() {
+    size_t file_size = 1024 * 1024;
+    auto fetch = [&](char* out, size_t offset, size_t length) -> size_t {
+      // the stand-in truncates every request past the first half of the file
+      if (offset + length > file_size / 2) return length / 2;
+      memset(out, 0, length);
+      return length;
+    };
+    fileio::range_reader reader(fetch, file_size);
+    std::vector<byte_range> ranges;
+    for (size_t i = 0; i < 16; ++i) ranges.emplace_back(i * 65536, 1024);
+    std::vector<std::vector<char> > out;
+    TS_ASSERT_THROWS_ANYTHING(reader.read(ranges, out));
+  }
+
+  void test_local_file() {
+    std::string fname = get_temp_name();
+    std::string contents;
+    for (size_t i = 0; i < 100000; ++i) contents += std::to_string(i);
+    {
+      std::ofstream fout(fname, std::ofstream::binary);
+      fout.write(contents.data(), contents.size());
+    }
+    fileio::range_reader reader(fname);
+    TS_ASSERT_EQUALS(reader.file_size(), contents.size());
+    std::vector<byte_range> ranges{{0, 10}, {5, 100}, {200000, 5000},
+                                   {contents.size() - 1, 1}, {1000, 0}};
+    std::vector<std::vector<char> > out;
+    reader.read(ranges, out);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      TS_ASSERT_EQUALS(std::string(out[i].begin(), out[i].end()),
+                       contents.substr(ranges[i].offset, ranges[i].length));
+    }
+  }
+};
@@ -0,0 +1,204 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <cxxtest/TestSuite.h>
+#include <serialization/serialization_includes.hpp>
+#include <flexible_type/flexible_type.hpp>
+#include <flexible_type/flexible_type_column.hpp>
+
+using namespace graphlab;
+
+class flexible_type_column_test : public CxxTest::TestSuite {
+
+ public:
+
+  void test_integer_column() {
+    std::vector<flexible_type> values{1, -5, FLEX_UNDEFINED, 1LL << 40};
+    // a header, the undefined bitmap and 8 bytes per value
+    TS_ASSERT_EQUALS(save_and_load(values), 19 + 1 + 4 * 8);
+  }
+
+  void test_float_column() {
+    std::vector<flexible_type> values{1.5, -2.25, 0.0};
+    TS_ASSERT_EQUALS(save_and_load(values), 19 + 3 * 8);
+  }
+
+  void test_string_column() {
+    std::vector<flexible_type> values{"hello", "", FLEX_UNDEFINED, "world"};
+    // a header, the undefined bitmap, the offsets and the contents
+    TS_ASSERT_EQUALS(save_and_load(values), 19 + 1 + 5 * 8 + 10);
+  }
+
+  void test_round_trip() {
+    std::vector<std::vector<flexible_type>> columns{
+      {},
+      {FLEX_UNDEFINED, FLEX_UNDEFINED},
+      {1, 2.5, "a"},
+      {flex_vec{1, 2, 3}, flex_vec{}, FLEX_UNDEFINED},
+      {flex_list{1, "a"}, flex_dict{{"k", 1}}, 3},
+      {"abc", 1},
+    };
+    std::vector<flexible_type> long_column;
+    for (size_t i = 0; i < 1000; ++i) {
+      if (i % 7 == 0) long_column.push_back(FLEX_UNDEFINED);
+      else long_column.push_back(std::to_string(i));
+    }
+    columns.push_back(long_column);
+
+    for (const auto& column: columns) {
+      // in memory archives
+      oarchive oarc;
+      save_flexible_type_column(oarc, column);
+      oarc << std::string("end");
+      iarchive iarc(oarc.buf, oarc.off);
+      std::vector<flexible_type> loaded{flexible_type("previous contents")};
+      load_flexible_type_column(iarc, loaded);
+      std::string end;
+      iarc >> end;
+      TS_ASSERT_EQUALS(end, "end");
+      check_equal(loaded, column);
+      free(oarc.buf);
+
+      // streams
+      std::stringstream strm;
+      oarchive stream_oarc(strm);
+      save_flexible_type_column(stream_oarc, column);
+      stream_oarc << std::string("end");
+      iarchive stream_iarc(strm);
+      load_flexible_type_column(stream_iarc, loaded);
+      stream_iarc >> end;
+      TS_ASSERT_EQUALS(end, "end");
+      check_equal(loaded, column);
+    }
+  }
+
+  void test_corrupted() {
+    std::vector<flexible_type> values{1, 2, 3};
+    oarchive oarc;
+    save_flexible_type_column(oarc, values);
+    std::vector<flexible_type> loaded;
+    iarchive truncated(oarc.buf, oarc.off - 1);
+    TS_ASSERT_THROWS_ANYTHING(load_flexible_type_column(truncated, loaded));
+    oarc.buf[0] = 0;
+    iarchive bad_version(oarc.buf, oarc.off);
+    TS_ASSERT_THROWS_ANYTHING(load_flexible_type_column(bad_version, loaded));
+    free(oarc.buf);
+  }
+
+  void test_corrupted_sizes() {
+    // header: version, type, has_undefined, size at byte 3, payload size
+    // at byte 11, then the payload at byte 19
+    const size_t size_pos = 3;
+    std::vector<flexible_type> integers{1, 2, 3};
+    std::vector<flexible_type> strings{"ab", "cde", "f"};
+    std::vector<flexible_type> mixed{1, "ab", flex_vec{1.0, 2.0}};
+
+    // sizes which do not fit in the payload
+    for (uint64_t size : {(uint64_t)4, (uint64_t)1 << 62, (uint64_t)(-1)}) {
+      for (auto* values : {&integers, &strings, &mixed}) {
+        std::string column = save(*values);
+        memcpy(&column[size_pos], &size, sizeof(size));
+        TS_ASSERT_THROWS_ANYTHING(load(column));
+      }
+    }
+    // an undefined bitmap which is not there
+    for (auto* values : {&integers, &strings}) {
+      std::string column = save(*values);
+      column[2] = 1;
+      TS_ASSERT_THROWS_ANYTHING(load(column));
+    }
+    // an unknown column type
+    {
+      std::string column = save(integers);
+      column[1] = (char)flex_type_enum::DICT;
+      TS_ASSERT_THROWS_ANYTHING(load(column));
+    }
+  }
+
+  void test_corrupted_offsets() {
+    const size_t payload_pos = 19;
+    std::vector<flexible_type> strings{"ab", "cde", "f"};
+    std::vector<flexible_type> mixed{1, "ab", flex_vec{1.0, 2.0}};
+    // past the end of the payload, decreasing, and an offset which does
+    // not fall at the end of a value
+    for (auto* values : {&strings, &mixed}) {
+      for (size_t i = 1; i <= 3; ++i) {
+        for (uint64_t offset : {(uint64_t)1000, (uint64_t)(-1)}) {
+          std::string column = save(*values);
+          memcpy(&column[payload_pos + i * sizeof(uint64_t)], &offset, sizeof(offset));
+          TS_ASSERT_THROWS_ANYTHING(load(column));
+        }
+      }
+      std::string column = save(*values);
+      uint64_t offset = 0;
+      memcpy(&column[payload_pos + 2 * sizeof(uint64_t)], &offset, sizeof(offset));
+      TS_ASSERT_THROWS_ANYTHING(load(column));
+    }
+    std::string column = save(mixed);
+    uint64_t offset = 0;
+    memcpy(&offset, &column[payload_pos + sizeof(uint64_t)], sizeof(offset));
+    offset += 1;
+    memcpy(&column[payload_pos + sizeof(uint64_t)], &offset, sizeof(offset));
+    TS_ASSERT_THROWS_ANYTHING(load(column));
+
+    // the unmodified columns still load
+    check_equal(load(save(strings)), strings);
+    check_equal(load(save(mixed)), mixed);
+  }
+
+ private:
+  std::vector<char> m_buffer;
+
+  /// Saves and loads values. Returns the size of the serialized column.
+  size_t save_and_load(const std::vector<flexible_type>& values) {
+    oarchive oarc(m_buffer);
+    save_flexible_type_column(oarc, values);
+    iarchive iarc(m_buffer.data(), oarc.off);
+    std::vector<flexible_type> loaded;
+    load_flexible_type_column(iarc, loaded);
+    TS_ASSERT_EQUALS(iarc.off, oarc.off);
+    check_equal(loaded, values);
+    return oarc.off;
+  }
+
+  std::string save(const std::vector<flexible_type>& values) {
+    oarchive oarc;
+    save_flexible_type_column(oarc, values);
+    std::string ret(oarc.buf, oarc.off);
+    free(oarc.buf);
+    return ret;
+  }
+
+  std::vector<flexible_type> load(const std::string& column) {
+    iarchive iarc(column.data(), column.size());
+    std::vector<flexible_type> ret;
+    load_flexible_type_column(iarc, ret);
+    return ret;
+  }
+
+  void check_equal(const std::vector<flexible_type>& a,
+                   const std::vector<flexible_type>& b) {
+    TS_ASSERT_EQUALS(a.size(), b.size());
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+      TS_ASSERT_EQUALS(a[i].get_type(), b[i].get_type());
+      TS_ASSERT(a[i] == b[i] || a[i].get_type() == flex_type_enum::UNDEFINED);
+    }
+  }
+};
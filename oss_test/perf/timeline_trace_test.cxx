@@ -0,0 +1,264 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <map>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <perf/timeline_trace.hpp>
+#include <cxxtest/TestSuite.h>
+
+using namespace graphlab;
+
+/**
+ * The number of distinct event names. It is coprime with the buffer size,
+ * so that an event overwritten by a later one has a different name.
+ */
+static const size_t NUM_NAMES = 17;
+
+struct parsed_event {
+  size_t name_index;
+  std::string category;
+  double ts;
+  double dur;
+};
+
+struct parsed_trace {
+  std::map<std::string, std::vector<parsed_event> > events_by_thread;
+  size_t num_events = 0;
+};
+
+class timeline_trace_test: public CxxTest::TestSuite {
+ public:
+  void setUp() {
+    timeline_trace_stop();
+    timeline_trace_clear();
+    for (size_t i = names.size(); i < NUM_NAMES; ++i) {
+      names.push_back(timeline_trace_intern("event" + std::to_string(i)));
+    }
+  }
+
+  void tearDown() {
+    timeline_trace_stop();
+    timeline_trace_clear();
+  }
+
+  void test_buffer_overflow() {
+    // every thread overwrites its oldest events
+    const size_t num_threads = 3;
+    timeline_trace_start();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+      threads.emplace_back([this, t]() {
+        timeline_trace_set_thread_name("writer " + std::to_string(t));
+        record_events(0, TIMELINE_TRACE_BUFFER_EVENTS + 1000 + t);
+      });
+    }
+    for (auto& thread: threads) thread.join();
+    timeline_trace_stop();
+
+    parsed_trace trace = parse_trace();
+    TS_ASSERT_EQUALS(trace.num_events, num_threads * TIMELINE_TRACE_BUFFER_EVENTS);
+    for (size_t t = 0; t < num_threads; ++t) {
+      auto& events = trace.events_by_thread["writer " + std::to_string(t)];
+      TS_ASSERT_EQUALS(events.size(), TIMELINE_TRACE_BUFFER_EVENTS);
+      // the last TIMELINE_TRACE_BUFFER_EVENTS events are kept
+      check_consecutive(events);
+      if (!events.empty()) {
+        TS_ASSERT_EQUALS(events.front().name_index, (1000 + t) % NUM_NAMES);
+      }
+    }
+  }
+
+  void test_export_while_recording() {
+    // the events overwritten while they are copied are discarded
+    const size_t num_threads = 2;
+    timeline_trace_start();
+    std::atomic<bool> done(false);
+    std::atomic<size_t> num_recorded(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        timeline_trace_set_thread_name("writer " + std::to_string(t));
+        for (size_t i = 0; !done; i += 100) {
+          record_events(i, 100);
+          num_recorded += 100;
+        }
+      });
+    }
+    while (num_recorded < 4 * num_threads * TIMELINE_TRACE_BUFFER_EVENTS) {
+      std::this_thread::yield();
+    }
+    for (size_t i = 0; i < 3; ++i) {
+      parsed_trace trace = parse_trace();
+      for (size_t t = 0; t < num_threads; ++t) {
+        auto& events = trace.events_by_thread["writer " + std::to_string(t)];
+        TS_ASSERT_LESS_THAN_EQUALS(events.size(), TIMELINE_TRACE_BUFFER_EVENTS);
+        check_consecutive(events);
+      }
+    }
+    done = true;
+    for (auto& thread: threads) thread.join();
+  }
+
+  void test_sampling() {
+    timeline_trace_start(4);
+    std::thread thread([this]() {
+      timeline_trace_set_thread_name("sampled");
+      record_events(0, 100);
+    });
+    thread.join();
+    timeline_trace_stop();
+
+    parsed_trace trace = parse_trace();
+    auto& events = trace.events_by_thread["sampled"];
+    // one in every 4 scopes, starting with the first
+    TS_ASSERT_EQUALS(events.size(), 25);
+    for (size_t i = 0; i < events.size(); ++i) {
+      TS_ASSERT_EQUALS(events[i].name_index, (4 * i) % NUM_NAMES);
+    }
+  }
+
+  void test_clear() {
+    timeline_trace_start();
+    std::thread thread([this]() {
+      timeline_trace_set_thread_name("exited");
+      record_events(0, 10);
+    });
+    thread.join();
+    timeline_trace_set_thread_name("main");
+    record_events(0, 5);
+    TS_ASSERT_EQUALS(parse_trace().num_events, 15);
+
+    // the buffers of exited threads are dropped
+    timeline_trace_clear();
+    parsed_trace trace = parse_trace();
+    TS_ASSERT_EQUALS(trace.num_events, 0);
+    TS_ASSERT_EQUALS(trace.events_by_thread.count("exited"), 0);
+    TS_ASSERT_EQUALS(trace.events_by_thread.count("main"), 1);
+
+    record_events(5, 3);
+    trace = parse_trace();
+    TS_ASSERT_EQUALS(trace.num_events, 3);
+    TS_ASSERT_EQUALS(trace.events_by_thread["main"].size(), 3);
+    TS_ASSERT_EQUALS(trace.events_by_thread["main"][0].name_index, 5);
+
+    // nothing is recorded once stopped
+    timeline_trace_stop();
+    record_events(0, 3);
+    TS_ASSERT_EQUALS(parse_trace().num_events, 3);
+  }
+
+  void test_json_format() {
+    timeline_trace_start();
+    std::string odd_name = "a \"quoted\" \\ name\n\ttab";
+    timeline_trace_set_thread_name(odd_name);
+    {
+      TIMELINE_TRACE_SCOPE("outer", "outer");
+      TIMELINE_TRACE_SCOPE("inner", timeline_trace_intern(odd_name));
+    }
+    timeline_trace_stop();
+
+    std::stringstream strm(timeline_trace_to_json());
+    boost::property_tree::ptree root;
+    boost::property_tree::read_json(strm, root);
+    TS_ASSERT_EQUALS(root.get<std::string>("displayTimeUnit"), "ms");
+    std::vector<boost::property_tree::ptree> events;
+    for (auto& item: root.get_child("traceEvents")) events.push_back(item.second);
+    TS_ASSERT_EQUALS(events.size(), 3);
+    if (events.size() != 3) return;
+
+    // the thread name, then the events in the order they ended
+    TS_ASSERT_EQUALS(events[0].get<std::string>("name"), "thread_name");
+    TS_ASSERT_EQUALS(events[0].get<std::string>("ph"), "M");
+    TS_ASSERT_EQUALS(events[0].get<std::string>("args.name"), odd_name);
+    TS_ASSERT_EQUALS(events[1].get<std::string>("name"), odd_name);
+    TS_ASSERT_EQUALS(events[1].get<std::string>("cat"), "inner");
+    TS_ASSERT_EQUALS(events[2].get<std::string>("name"), "outer");
+    TS_ASSERT_EQUALS(events[2].get<std::string>("cat"), "outer");
+    for (size_t i = 1; i < 3; ++i) {
+      TS_ASSERT_EQUALS(events[i].get<std::string>("ph"), "X");
+      TS_ASSERT_EQUALS(events[i].get<size_t>("pid"), 0);
+      TS_ASSERT_EQUALS(events[i].get<size_t>("tid"), events[0].get<size_t>("tid"));
+      // microseconds with 3 decimals
+      std::string ts = events[i].get<std::string>("ts");
+      TS_ASSERT_EQUALS(ts.find('.'), ts.length() - 4);
+      TS_ASSERT_LESS_THAN_EQUALS(0, events[i].get<double>("dur"));
+    }
+    // the inner scope is within the outer one
+    double outer_begin = events[2].get<double>("ts");
+    double outer_end = outer_begin + events[2].get<double>("dur");
+    double inner_begin = events[1].get<double>("ts");
+    double inner_end = inner_begin + events[1].get<double>("dur");
+    TS_ASSERT_LESS_THAN_EQUALS(outer_begin, inner_begin);
+    TS_ASSERT_LESS_THAN_EQUALS(inner_end, outer_end + 0.001);
+  }
+
+ private:
+  std::vector<const char*> names;
+
+  /// Records count scopes, named after their index.
+  void record_events(size_t first, size_t count) {
+    for (size_t i = first; i < first + count; ++i) {
+      TIMELINE_TRACE_SCOPE("test", names[i % NUM_NAMES]);
+    }
+  }
+
+  /// Exports and parses the trace, grouping the events by thread name.
+  parsed_trace parse_trace() {
+    std::stringstream strm(timeline_trace_to_json());
+    boost::property_tree::ptree root;
+    boost::property_tree::read_json(strm, root);
+    std::map<size_t, std::string> thread_names;
+    std::map<size_t, std::vector<parsed_event> > events_by_tid;
+    parsed_trace ret;
+    for (auto& item: root.get_child("traceEvents")) {
+      auto& event = item.second;
+      size_t tid = event.get<size_t>("tid");
+      if (event.get<std::string>("ph") == "M") {
+        thread_names[tid] = event.get<std::string>("args.name");
+        events_by_tid[tid];
+        continue;
+      }
+      std::string name = event.get<std::string>("name");
+      if (name.compare(0, 5, "event") != 0) continue;
+      parsed_event e;
+      e.name_index = std::stoul(name.substr(5));
+      e.category = event.get<std::string>("cat");
+      e.ts = event.get<double>("ts");
+      e.dur = event.get<double>("dur");
+      events_by_tid[tid].push_back(e);
+      ++ret.num_events;
+    }
+    for (auto& thread: events_by_tid) {
+      ret.events_by_thread[thread_names[thread.first]] = std::move(thread.second);
+    }
+    return ret;
+  }
+
+  /// Checks that the events were recorded one after the other.
+  void check_consecutive(const std::vector<parsed_event>& events) {
+    for (size_t i = 1; i < events.size(); ++i) {
+      TS_ASSERT_EQUALS(events[i].name_index, (events[i - 1].name_index + 1) % NUM_NAMES);
+      TS_ASSERT_LESS_THAN_EQUALS(events[i - 1].ts, events[i].ts);
+      if (events[i].name_index != (events[i - 1].name_index + 1) % NUM_NAMES) break;
+    }
+  }
+};
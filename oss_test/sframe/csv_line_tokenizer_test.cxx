@@ -0,0 +1,146 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <string>
+#include <cmath>
+#include <vector>
+#include <sframe/csv_line_tokenizer.hpp>
+#include <sframe/sframe_constants.hpp>
+#include <random/random.hpp>
+#include <cxxtest/TestSuite.h>
+
+using namespace graphlab;
+
+class csv_line_tokenizer_test: public CxxTest::TestSuite {
+
+ public:
+
+  void test_simple_lines() {
+    csv_line_tokenizer tokenizer = make_tokenizer(",", true, true);
+    std::vector<std::string> tokens;
+    std::string line = "1, abc ,,  ,x y,";
+    TS_ASSERT(tokenizer.tokenize_line(line.c_str(), line.length(), tokens));
+    TS_ASSERT_EQUALS(tokens.size(), 6);
+    TS_ASSERT_EQUALS(tokens[0], "1");
+    TS_ASSERT_EQUALS(tokens[1], "abc");
+    TS_ASSERT_EQUALS(tokens[2], "");
+    TS_ASSERT_EQUALS(tokens[3], "");
+    TS_ASSERT_EQUALS(tokens[4], "x y");
+    TS_ASSERT_EQUALS(tokens[5], "");
+
+    line = "   ";
+    TS_ASSERT(tokenizer.tokenize_line(line.c_str(), line.length(), tokens));
+    TS_ASSERT_EQUALS(tokens.size(), 0);
+  }
+
+  void test_typed_fields() {
+    csv_line_tokenizer tokenizer = make_tokenizer(",", true, true);
+    std::string line = " -12,3.25e2,  hello, 7x,.5,,1e-3";
+    std::vector<flexible_type> out{flexible_type(flex_type_enum::INTEGER),
+                                   flexible_type(flex_type_enum::FLOAT),
+                                   flexible_type(flex_type_enum::STRING),
+                                   flexible_type(flex_type_enum::INTEGER),
+                                   flexible_type(flex_type_enum::FLOAT),
+                                   flexible_type(flex_type_enum::FLOAT),
+                                   flexible_type(flex_type_enum::FLOAT)};
+    TS_ASSERT_EQUALS(tokenizer.tokenize_line(&line[0], line.length(), out, true), 7);
+    TS_ASSERT_EQUALS(out[0], -12);
+    TS_ASSERT_EQUALS(out[1], 325.0);
+    TS_ASSERT_EQUALS(out[2], "hello");
+    // like the general parser, characters after the number are ignored
+    TS_ASSERT_EQUALS(out[3], 7);
+    TS_ASSERT_EQUALS(out[4], 0.5);
+    TS_ASSERT_EQUALS(out[5].get_type(), flex_type_enum::UNDEFINED);
+    TS_ASSERT_EQUALS(out[6], 0.001);
+  }
+
+  void test_same_as_state_machine() {
+    // random lines tokenized with and without the fast path. Lines with
+    // brackets take the same path either way.
+    const char alphabet[] = "ab1 \t.,;-e\"'";
+    std::vector<std::string> delimiters{",", "\t", ";", "::", " "};
+    for (const std::string& delimiter: delimiters) {
+      for (size_t skip_space = 0; skip_space < 2; ++skip_space) {
+        csv_line_tokenizer fast = make_tokenizer(delimiter, skip_space, true);
+        csv_line_tokenizer slow = make_tokenizer(delimiter, skip_space, false);
+        for (size_t i = 0; i < 2000; ++i) {
+          size_t len = random::fast_uniform<size_t>(0, 40);
+          std::string line;
+          for (size_t j = 0; j < len; ++j) {
+            // mostly lines without special characters
+            size_t num_chars = (i % 4 == 0) ? sizeof(alphabet) - 1 : 10;
+            line.push_back(alphabet[random::fast_uniform<size_t>(0, num_chars - 1)]);
+          }
+          std::vector<std::string> fast_tokens, slow_tokens;
+          bool fast_ret = fast.tokenize_line(line.c_str(), line.length(), fast_tokens);
+          bool slow_ret = slow.tokenize_line(line.c_str(), line.length(), slow_tokens);
+          TS_ASSERT_EQUALS(fast_ret, slow_ret);
+          TS_ASSERT(fast_tokens == slow_tokens);
+        }
+      }
+    }
+  }
+
+  void test_numbers_same_as_general_parser() {
+    csv_line_tokenizer fast = make_tokenizer(",", true, true);
+    csv_line_tokenizer slow = make_tokenizer(",", true, false);
+    std::vector<std::string> numbers{
+      "0", "-0", "+5", "123456789012345678", "1234567890123456789",
+      "-9223372036854775808", "99999999999999999999", "1.", ".5", "-.5e-3",
+      "0.1", "3.14159", "1e22", "1e23", "123456789012345.6", "1.5E+10",
+      "1e", "e5", "-", ".", "nan", "inf", "1_000", " 42 ", "4 2", "0x10"};
+    for (size_t i = 0; i < 1000; ++i) {
+      numbers.push_back(std::to_string(random::fast_uniform<int>(-100000, 100000)) +
+                        "." + std::to_string(random::fast_uniform<int>(0, 999999)));
+    }
+    for (const std::string& number: numbers) {
+      for (flex_type_enum type: {flex_type_enum::INTEGER, flex_type_enum::FLOAT}) {
+        std::string fast_line = number, slow_line = number;
+        std::vector<flexible_type> fast_out{flexible_type(type)};
+        std::vector<flexible_type> slow_out{flexible_type(type)};
+        size_t fast_ret = fast.tokenize_line(&fast_line[0], fast_line.length(),
+                                             fast_out, true);
+        size_t slow_ret = slow.tokenize_line(&slow_line[0], slow_line.length(),
+                                             slow_out, true);
+        TS_ASSERT_EQUALS(fast_ret, slow_ret);
+        if (fast_ret == 0) continue;
+        TS_ASSERT_EQUALS(fast_out[0].get_type(), slow_out[0].get_type());
+        if (type == flex_type_enum::INTEGER) {
+          TS_ASSERT_EQUALS(fast_out[0].get<flex_int>(), slow_out[0].get<flex_int>());
+        } else if (std::isnan(slow_out[0].get<flex_float>())) {
+          TS_ASSERT(std::isnan(fast_out[0].get<flex_float>()));
+        } else {
+          TS_ASSERT_DELTA(fast_out[0].get<flex_float>(), slow_out[0].get<flex_float>(),
+                          1e-12 * std::abs(slow_out[0].get<flex_float>()));
+        }
+      }
+    }
+  }
+
+ private:
+  csv_line_tokenizer make_tokenizer(const std::string& delimiter,
+                                    bool skip_initial_space,
+                                    bool fast_path) {
+    size_t old_fast_tokenizer = SFRAME_CSV_PARSER_FAST_TOKENIZER;
+    SFRAME_CSV_PARSER_FAST_TOKENIZER = fast_path;
+    csv_line_tokenizer tokenizer;
+    tokenizer.delimiter = delimiter;
+    tokenizer.skip_initial_space = skip_initial_space;
+    tokenizer.init();
+    SFRAME_CSV_PARSER_FAST_TOKENIZER = old_fast_tokenizer;
+    return tokenizer;
+  }
+};
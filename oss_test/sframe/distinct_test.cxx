@@ -0,0 +1,108 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <set>
+#include <cxxtest/TestSuite.h>
+#include <util/try_finally.hpp>
+#include <sframe/distinct.hpp>
+#include <sframe/sframe_constants.hpp>
+#include <sframe/testing_utils.hpp>
+
+using namespace graphlab;
+
+class distinct_test: public CxxTest::TestSuite {
+ public:
+  void test_distinct_keeps_first_occurrence() {
+    sframe sf = make_testing_sframe({"a", "b"},
+                                    {flex_type_enum::INTEGER, flex_type_enum::STRING},
+                                    {{3, "x"}, {1, "y"}, {3, "x"}, {1, "z"},
+                                     {FLEX_UNDEFINED, "x"}, {1, "y"}, {FLEX_UNDEFINED, "x"}});
+    sframe result = distinct(sf);
+    TS_ASSERT_EQUALS(result.column_names(), sf.column_names());
+    TS_ASSERT_EQUALS(result.column_types(), sf.column_types());
+    auto rows = testing_extract_sframe_data(result);
+    std::vector<std::vector<flexible_type>> expected{
+        {3, "x"}, {1, "y"}, {1, "z"}, {FLEX_UNDEFINED, "x"}};
+    TS_ASSERT_EQUALS(rows.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      TS_ASSERT_EQUALS(rows[i][0].get_type(), expected[i][0].get_type());
+      TS_ASSERT(rows[i][0] == expected[i][0] ||
+                rows[i][0].get_type() == flex_type_enum::UNDEFINED);
+      TS_ASSERT_EQUALS(rows[i][1], expected[i][1]);
+    }
+    TS_ASSERT_EQUALS(count_distinct(sf), 4);
+  }
+
+  void test_distinct_partitioned() {
+    // small enough buffer to partition the input into 1024 row partitions
+    size_t old_buffer_size = SFRAME_DISTINCT_BUFFER_SIZE;
+    SFRAME_DISTINCT_BUFFER_SIZE = 1024;
+    scoped_finally restore_buffer_size([&]() {
+      SFRAME_DISTINCT_BUFFER_SIZE = old_buffer_size;
+    });
+    std::vector<std::vector<size_t>> data;
+    for (size_t i = 0; i < 20000; ++i) {
+      data.push_back({(i * 7919) % 3001, (i * 7919) % 3001 % 7});
+    }
+    sframe sf = make_integer_testing_sframe({"a", "b"}, data);
+    sframe result = distinct(sf);
+
+    TS_ASSERT_EQUALS(result.num_segments(), 20);
+    auto rows = testing_extract_sframe_data(result);
+    std::set<size_t> values;
+    for (const auto& row: rows) {
+      TS_ASSERT_EQUALS(row[0].get<flex_int>() % 7, row[1].get<flex_int>());
+      values.insert(row[0].get<flex_int>());
+    }
+    TS_ASSERT_EQUALS(rows.size(), 3001);
+    TS_ASSERT_EQUALS(values.size(), 3001);
+  }
+
+  void test_distinct_skewed() {
+    size_t old_buffer_size = SFRAME_DISTINCT_BUFFER_SIZE;
+    SFRAME_DISTINCT_BUFFER_SIZE = 1024;
+    scoped_finally restore_buffer_size([&]() {
+      SFRAME_DISTINCT_BUFFER_SIZE = old_buffer_size;
+    });
+    // All distinct rows: about half of the 20 partitions get more than
+    // their share of 1024 distinct rows, and are partitioned again.
+    std::vector<std::vector<size_t>> data;
+    for (size_t i = 0; i < 20 * 1024; ++i) data.push_back({i, i % 7});
+    check_distinct(make_integer_testing_sframe({"a", "b"}, data), 20 * 1024);
+
+    // A heavy hitter interleaved with the other rows, so that the recently
+    // seen fingerprints do not drop it, and a few other duplicates.
+    data.clear();
+    for (size_t i = 0; i < 30000; ++i) {
+      if (i % 3 == 0) data.push_back({0, 0});
+      else data.push_back({i % 12000, i % 12000 % 7});
+    }
+    check_distinct(make_integer_testing_sframe({"a", "b"}, data), 12000 - 4000 + 1);
+  }
+
+  void test_approximate_count_distinct() {
+    std::vector<std::vector<size_t>> data;
+    for (size_t i = 0; i < 100000; ++i) {
+      data.push_back({i % 50000, i % 2});
+    }
+    sframe sf = make_integer_testing_sframe({"a", "b"}, data);
+    TS_ASSERT_EQUALS(count_distinct(sf), 50000);
+    size_t estimate = count_distinct(sf, true);
+    TS_ASSERT_DELTA(estimate, 50000, 50000 * 0.03);
+  }
+ private:
+  /// Checks that the result has each row of the input once.
+  void check_distinct(const sframe& sf, size_t num_distinct) {
+    auto input_rows = testing_extract_sframe_data(sf);
+    std::set<std::vector<flexible_type>> expected(input_rows.begin(), input_rows.end());
+    TS_ASSERT_EQUALS(expected.size(), num_distinct);
+    auto rows = testing_extract_sframe_data(distinct(sf));
+    TS_ASSERT_EQUALS(rows.size(), num_distinct);
+    std::set<std::vector<flexible_type>> values(rows.begin(), rows.end());
+    TS_ASSERT(values == expected);
+  }
+};
@@ -0,0 +1,81 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <cxxtest/TestSuite.h>
+#include <sframe/membership_set.hpp>
+#include <sframe/algorithm.hpp>
+
+using namespace graphlab;
+
+class membership_set_test: public CxxTest::TestSuite {
+ public:
+  void test_small_set() {
+    membership_set empty(std::vector<flexible_type>{});
+    TS_ASSERT_EQUALS(empty.size(), 0);
+    TS_ASSERT(!empty.contains(1));
+
+    membership_set s(std::vector<flexible_type>{1, 2, 2, "a", FLEX_UNDEFINED, 2.5});
+    TS_ASSERT_EQUALS(s.size(), 5);
+    TS_ASSERT(s.contains(1));
+    TS_ASSERT(s.contains(2));
+    TS_ASSERT(s.contains("a"));
+    TS_ASSERT(s.contains(FLEX_UNDEFINED));
+    TS_ASSERT(s.contains(2.5));
+    TS_ASSERT(!s.contains(3));
+    TS_ASSERT(!s.contains("b"));
+  }
+
+  void test_large_set() {
+    // large enough to be fronted by the bloom filter
+    std::vector<flexible_type> values;
+    for (size_t i = 0; i < 2 * membership_set::BLOOM_FILTER_MIN_SIZE; ++i) {
+      values.push_back(3 * i);
+    }
+    membership_set s(values);
+    TS_ASSERT_EQUALS(s.size(), values.size());
+    size_t num_found = 0;
+    for (size_t i = 0; i < 6 * membership_set::BLOOM_FILTER_MIN_SIZE; ++i) {
+      bool found = s.contains(i);
+      TS_ASSERT_EQUALS(found, i % 3 == 0);
+      num_found += found;
+    }
+    TS_ASSERT_EQUALS(num_found, values.size());
+  }
+
+  void test_table_sized_by_distinct_values() {
+    // many duplicates: the table grows with the distinct values only
+    std::vector<flexible_type> values;
+    for (size_t i = 0; i < 100000; ++i) values.push_back(std::to_string(i % 10));
+    membership_set s(values);
+    TS_ASSERT_EQUALS(s.size(), 10);
+    TS_ASSERT_EQUALS(s.num_slots(), 32);
+
+    // the load factor stays under 1/2 as the table grows
+    values.clear();
+    for (size_t i = 0; i < 5000; ++i) values.push_back(i);
+    membership_set grown(values);
+    TS_ASSERT_EQUALS(grown.size(), 5000);
+    TS_ASSERT_EQUALS(grown.num_slots(), 16384);
+    for (size_t i = 0; i < 10000; ++i) TS_ASSERT_EQUALS(grown.contains(i), i < 5000);
+  }
+
+  void test_from_sarray() {
+    std::vector<flexible_type> values;
+    for (size_t i = 0; i < 1000; ++i) values.push_back(std::to_string(i % 100));
+    sarray<flexible_type> input;
+    input.open_for_write();
+    input.set_type(flex_type_enum::STRING);
+    graphlab::copy(values.begin(), values.end(), input);
+    input.close();
+
+    membership_set s(input);
+    TS_ASSERT_EQUALS(s.size(), 100);
+    TS_ASSERT(s.contains("42"));
+    TS_ASSERT(!s.contains("100"));
+    TS_ASSERT(!s.contains(42));
+  }
+};
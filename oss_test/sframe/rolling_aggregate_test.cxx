@@ -0,0 +1,232 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <sframe/rolling_aggregate.hpp>
+#include <sframe/groupby_aggregate_operators.hpp>
+#include <sframe/algorithm.hpp>
+
+using namespace graphlab;
+using namespace graphlab::rolling_aggregate;
+
+class rolling_aggregate_test: public CxxTest::TestSuite {
+ private:
+  /**
+   * Random values of the given type, with NULLs, and NaNs and infinities
+   * for floats.
+   */
+  std::vector<flexible_type> random_values(flex_type_enum type, size_t n) {
+    std::mt19937 gen(n);
+    std::uniform_int_distribution<int> dist(-20, 20);
+    std::vector<flexible_type> ret;
+    for (size_t i = 0; i < n; ++i) {
+      int r = dist(gen);
+      if (r < -17) {
+        ret.push_back(FLEX_UNDEFINED);
+      } else if (type == flex_type_enum::INTEGER) {
+        ret.push_back(r);
+      } else if (r == 17) {
+        ret.push_back(std::numeric_limits<double>::quiet_NaN());
+      } else if (r == 16) {
+        ret.push_back(std::numeric_limits<double>::infinity());
+      } else {
+        ret.push_back(r * 0.25);
+      }
+    }
+    return ret;
+  }
+
+  bool same_value(const flexible_type& a, const flexible_type& b) {
+    if (a.get_type() != b.get_type()) return false;
+    if (a.get_type() != flex_type_enum::FLOAT) return a == b;
+    double x = a.get<flex_float>(), y = b.get<flex_float>();
+    if (std::isnan(x) || std::isnan(y)) return std::isnan(x) && std::isnan(y);
+    if (std::isinf(x) || std::isinf(y)) return x == y;
+    return std::abs(x - y) < 1e-9;
+  }
+
+  std::shared_ptr<sarray<flexible_type>> make_sarray(const std::vector<flexible_type>& values,
+                                                     flex_type_enum type) {
+    auto ret = std::make_shared<sarray<flexible_type>>();
+    ret->open_for_write();
+    ret->set_type(type);
+    graphlab::copy(values.begin(), values.end(), *ret);
+    ret->close();
+    return ret;
+  }
+
+  /**
+   * Compares partitioned_rolling_apply with a computation over each window
+   * on rows sorted by key and time, with ties and gaps in the times.
+   */
+  void check_partitioned(const std::string& name, double range_start,
+                         double range_end, size_t min_observations,
+                         size_t num_keys) {
+    std::mt19937 gen(num_keys);
+    std::vector<flexible_type> keys, times, values;
+    for (size_t k = 0; k < num_keys; ++k) {
+      size_t num_rows = gen() % 300;
+      int64_t time = gen() % 10;
+      for (size_t i = 0; i < num_rows; ++i) {
+        time += gen() % 4;
+        keys.push_back("key" + std::to_string(k));
+        times.push_back(time);
+        values.push_back(gen() % 5 == 0 ? FLEX_UNDEFINED : flexible_type(int(gen() % 100)));
+      }
+    }
+    sframe input({make_sarray(keys, flex_type_enum::STRING),
+                  make_sarray(times, flex_type_enum::INTEGER),
+                  make_sarray(values, flex_type_enum::INTEGER)},
+                 {"key", "time", "value"});
+
+    auto agg_op = get_builtin_group_aggregator(name);
+    std::vector<std::string> partition_columns;
+    if (num_keys > 1) partition_columns.push_back("key");
+    auto result = partitioned_rolling_apply(input, partition_columns, "time", "value",
+                                            agg_op, range_start, range_end,
+                                            min_observations);
+    std::vector<flexible_type> output;
+    graphlab::copy(*result, std::inserter(output, output.end()));
+    TS_ASSERT_EQUALS(output.size(), values.size());
+
+    for (size_t i = 0; i < values.size(); ++i) {
+      std::vector<flexible_type> window;
+      size_t observations = 0;
+      for (size_t j = 0; j < values.size(); ++j) {
+        if (keys[j] != keys[i]) continue;
+        double offset = times[j].get<flex_int>() - times[i].get<flex_int>();
+        if (offset < range_start || offset > range_end) continue;
+        window.push_back(values[j]);
+        if (values[j].get_type() != flex_type_enum::UNDEFINED) ++observations;
+      }
+      bool has_min_observations = (min_observations == size_t(-1)) ?
+          observations == window.size() : observations >= min_observations;
+      flexible_type expected = has_min_observations ?
+          full_window_aggregate(agg_op, window.begin(), window.end()) : FLEX_UNDEFINED;
+      if (!same_value(expected, output[i])) {
+        TS_FAIL(name + " at row " + std::to_string(i) + ": expected " +
+                std::string(expected) + " got " + std::string(output[i]));
+        return;
+      }
+    }
+  }
+
+  /**
+   * Slides windows of several sizes over random values, comparing the
+   * window_aggregate with a recomputation over the whole window.
+   */
+  void check_against_full_window(const std::string& name, flex_type_enum type) {
+    auto agg_op = get_builtin_group_aggregator(name);
+    agg_op->set_input_type(type);
+    auto values = random_values(type, 2000);
+    for (size_t window_size: {1, 2, 7, 100}) {
+      auto window_agg = make_window_aggregate(agg_op, type);
+      std::deque<flexible_type> window;
+      for (const auto& value: values) {
+        if (window.size() == window_size) {
+          window_agg->remove(window.front());
+          window.pop_front();
+        }
+        window_agg->add(value);
+        window.push_back(value);
+        auto expected = full_window_aggregate(agg_op, window.begin(), window.end());
+        auto actual = window_agg->emit();
+        if (!same_value(expected, actual)) {
+          TS_FAIL(name + " over window of " + std::to_string(window_size) +
+                  ": expected " + std::string(expected) +
+                  " got " + std::string(actual));
+          return;
+        }
+      }
+    }
+  }
+
+ public:
+  void test_sum() {
+    check_against_full_window("__builtin__sum__", flex_type_enum::INTEGER);
+    check_against_full_window("__builtin__sum__", flex_type_enum::FLOAT);
+  }
+
+  void test_avg() {
+    check_against_full_window("__builtin__avg__", flex_type_enum::INTEGER);
+  }
+
+  void test_nonnull_count() {
+    check_against_full_window("__builtin__nonnull__count__", flex_type_enum::FLOAT);
+  }
+
+  void test_var() {
+    check_against_full_window("__builtin__var__", flex_type_enum::INTEGER);
+    check_against_full_window("__builtin__stdv__", flex_type_enum::INTEGER);
+    check_against_full_window("__builtin__var__", flex_type_enum::FLOAT);
+  }
+
+  void test_min_max() {
+    check_against_full_window("__builtin__min__", flex_type_enum::INTEGER);
+    check_against_full_window("__builtin__max__", flex_type_enum::INTEGER);
+    check_against_full_window("__builtin__min__", flex_type_enum::FLOAT);
+    check_against_full_window("__builtin__max__", flex_type_enum::FLOAT);
+  }
+
+  void test_recompute() {
+    check_against_full_window("__builtin__count__distinct__", flex_type_enum::INTEGER);
+  }
+
+  void test_rolling_apply() {
+    std::vector<flexible_type> values;
+    for (size_t i = 0; i < 1000; ++i) {
+      values.push_back(i % 13 == 0 ? FLEX_UNDEFINED : flexible_type(i % 17));
+    }
+    sarray<flexible_type> input;
+    input.open_for_write();
+    input.set_type(flex_type_enum::INTEGER);
+    graphlab::copy(values.begin(), values.end(), input);
+    input.close();
+
+    auto result = rolling_apply(input, get_builtin_group_aggregator("__builtin__max__"),
+                                -5, 2, 7);
+    std::vector<flexible_type> output;
+    graphlab::copy(*result, std::inserter(output, output.end()));
+    TS_ASSERT_EQUALS(output.size(), values.size());
+    for (ssize_t i = 0; i < (ssize_t)values.size(); ++i) {
+      size_t observations = 0;
+      flexible_type expected = FLEX_UNDEFINED;
+      for (ssize_t j = i - 5; j <= i + 2; ++j) {
+        if (j < 0 || j >= (ssize_t)values.size() ||
+            values[j].get_type() == flex_type_enum::UNDEFINED) continue;
+        ++observations;
+        if (expected.get_type() == flex_type_enum::UNDEFINED || expected < values[j]) {
+          expected = values[j];
+        }
+      }
+      if (observations < 7) expected = FLEX_UNDEFINED;
+      TS_ASSERT(output[i] == expected);
+    }
+  }
+
+  void test_partitioned_rolling_apply() {
+    check_partitioned("__builtin__sum__", -10, 0, 0, 37);
+    check_partitioned("__builtin__max__", -5, 5, 3, 37);
+    check_partitioned("__builtin__avg__", 3, 8, 0, 37);
+    check_partitioned("__builtin__min__", -8, -3, size_t(-1), 37);
+    check_partitioned("__builtin__count__distinct__", -20, 0, 0, 37);
+    check_partitioned("__builtin__stdv__", -3, 3, 0, 2);
+    check_partitioned("__builtin__var__", -4, 4, 0, 1);
+  }
+
+  void test_partitioned_rolling_apply_unsorted() {
+    sframe input({make_sarray({1, 1, 1}, flex_type_enum::INTEGER),
+                  make_sarray({1, 3, 2}, flex_type_enum::INTEGER)},
+                 {"key", "time"});
+    TS_ASSERT_THROWS_ANYTHING(partitioned_rolling_apply(
+        input, {"key"}, "time", "time",
+        get_builtin_group_aggregator("__builtin__sum__"), -1, 0, 0));
+  }
+};
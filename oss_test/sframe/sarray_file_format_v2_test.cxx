@@ -19,8 +19,11 @@
 #include <sframe/sarray_v2_block_manager.hpp>
 #include <sframe/sarray_file_format_v2.hpp>
 #include <sframe/sarray_index_file.hpp>
+#include <sframe/string_intern_pool.hpp>
+#include <sframe/sframe_constants.hpp>
 #include <timer/timer.hpp>
 #include <random/random.hpp>
+#include <parallel/lambda_omp.hpp>
 
 using namespace graphlab;
 
@@ -434,4 +437,99 @@ class sarray_file_format_v2_test: public CxxTest::TestSuite {
     }
   }
 
+
+  void test_interned_strings(void) {
+    // few distinct strings, spanning many blocks
+    std::string test_file_name = get_temp_name() + ".sidx";
+    sarray_group_format_writer_v2<flexible_type> group_writer;
+    group_writer.open(test_file_name, 1, 1);
+    size_t num_rows = 200000;
+    for (size_t i = 0; i < num_rows; ++i) {
+      if (i % 13 == 0) group_writer.write_segment(0, 0, FLEX_UNDEFINED);
+      else group_writer.write_segment(0, 0, "category" + std::to_string(i % 10));
+    }
+    group_writer.close();
+    group_writer.write_index_file();
+
+    for (size_t pool_size: {size_t(0), size_t(4096)}) {
+      size_t old_pool_size = SFRAME_STRING_INTERN_POOL_SIZE;
+      SFRAME_STRING_INTERN_POOL_SIZE = pool_size;
+      sarray_format_reader_v2<flexible_type> reader;
+      reader.open(test_file_name + ":0");
+      SFRAME_STRING_INTERN_POOL_SIZE = old_pool_size;
+      std::vector<flexible_type> vals;
+      TS_ASSERT_EQUALS(reader.read_rows(0, num_rows, vals), num_rows);
+      for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 13 == 0) {
+          TS_ASSERT_EQUALS(vals[i].get_type(), flex_type_enum::UNDEFINED);
+        } else {
+          TS_ASSERT_EQUALS(vals[i], "category" + std::to_string(i % 10));
+        }
+      }
+      // values of the first and the last block share their buffer
+      bool shared = vals[1].get<flex_string>().data() ==
+          vals[num_rows - 9].get<flex_string>().data();
+      TS_ASSERT_EQUALS(shared, pool_size > 0);
+    }
+  }
+
+  void test_read_ahead(void) {
+    // small blocks, so that every segment has many of them
+    size_t old_block_size = SFRAME_DEFAULT_BLOCK_SIZE;
+    SFRAME_DEFAULT_BLOCK_SIZE = 1024;
+    sarray_group_format_writer_v2<flexible_type> group_writer;
+    std::string test_file_name = get_temp_name() + ".sidx";
+    group_writer.open(test_file_name, 4, 1);
+    size_t rows_per_segment = 100000;
+    size_t v = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      for (size_t j = 0; j < rows_per_segment; ++j) {
+        group_writer.write_segment(0, i, flexible_type(v++));
+      }
+    }
+    group_writer.close();
+    group_writer.write_index_file();
+    SFRAME_DEFAULT_BLOCK_SIZE = old_block_size;
+
+    for (size_t read_ahead: {size_t(1), size_t(4), size_t(64)}) {
+      size_t old_read_ahead = SFRAME_READ_AHEAD_BLOCKS;
+      SFRAME_READ_AHEAD_BLOCKS = read_ahead;
+      sarray_format_reader_v2<flexible_type> reader;
+      reader.open(test_file_name + ":0");
+      // sequential scans of all the segments in parallel, interleaved with
+      // random reads
+      random::seed(10001);
+      parallel_for(size_t(0), size_t(4), [&](size_t segment) {
+        std::vector<flexible_type> vals;
+        size_t start = segment * rows_per_segment;
+        size_t end = start + rows_per_segment;
+        for (size_t row = start; row < end; row += 1000) {
+          TS_ASSERT_EQUALS(reader.read_rows(row, row + 1000, vals), 1000);
+          for (size_t k = 0; k < vals.size(); ++k) {
+            TS_ASSERT_EQUALS((size_t)vals[k], row + k);
+          }
+          size_t random_row = random::fast_uniform<size_t>(0, 4 * rows_per_segment - 11);
+          TS_ASSERT_EQUALS(reader.read_rows(random_row, random_row + 10, vals), 10);
+          TS_ASSERT_EQUALS((size_t)vals[0], random_row);
+        }
+      });
+      SFRAME_READ_AHEAD_BLOCKS = old_read_ahead;
+    }
+  }
+
+  void test_string_intern_pool(void) {
+    string_intern_pool pool(2);
+    flexible_type a = pool.intern("abc", 3);
+    flexible_type b = pool.intern("abcd", 3);
+    TS_ASSERT_EQUALS(b, "abc");
+    TS_ASSERT_EQUALS(a.get<flex_string>().data(), b.get<flex_string>().data());
+    pool.intern("def", 3);
+    TS_ASSERT_EQUALS(pool.size(), 2);
+    // the pool is cleared when full
+    pool.intern("ghi", 3);
+    TS_ASSERT_EQUALS(pool.size(), 1);
+    std::string long_string(string_intern_pool::MAX_STRING_LENGTH + 1, 'x');
+    TS_ASSERT_EQUALS(pool.intern(long_string.data(), long_string.length()), long_string);
+    TS_ASSERT_EQUALS(pool.size(), 1);
+  }
 };
@@ -848,4 +848,52 @@ class sframe_test : public CxxTest::TestSuite {
    void test_alternate_line_endings() {
      evaluate(alternate_endline_test());
    }
+
+   void test_parallel_ingestion() {
+     size_t old_num_readers = SFRAME_CSV_PARSER_NUM_READERS;
+     size_t old_split_size = SFRAME_CSV_PARSER_SPLIT_SIZE;
+
+     // a few small files, and a large one which is split in ranges
+     std::string dir = get_temp_name();
+     boost::filesystem::create_directory(dir);
+     std::vector<size_t> rows_per_file{10, 1, 2000, 37, 5};
+     std::vector<std::pair<flex_int, flex_int> > expected;
+     for (size_t i = 0; i < rows_per_file.size(); ++i) {
+       std::ofstream fout(dir + "/" + std::to_string(i) + ".csv");
+       fout << "file,row\n";
+       for (size_t j = 0; j < rows_per_file[i]; ++j) {
+         fout << i << "," << j << (j % 2 ? "\r\n" : "\n");
+         expected.emplace_back(i, j);
+       }
+     }
+
+     csv_line_tokenizer tokenizer;
+     tokenizer.delimiter = ",";
+     tokenizer.init();
+     // range boundaries falling inside lines, on line ends, and at every
+     // file boundary
+     for (size_t num_readers: {1, 3, 4, 16}) {
+       for (size_t split_size: {10, 256, 4096}) {
+         SFRAME_CSV_PARSER_NUM_READERS = num_readers;
+         SFRAME_CSV_PARSER_SPLIT_SIZE = split_size;
+         sframe frame;
+         frame.init_from_csvs(dir, tokenizer, true, false, false,
+                              {{"file", flex_type_enum::INTEGER},
+                               {"row", flex_type_enum::INTEGER}},
+                              std::vector<std::string>(), 0, 0);
+
+         std::vector<std::vector<flexible_type> > vals;
+         graphlab::copy(frame, std::inserter(vals, vals.end()));
+         // the rows of all the files, in file order then row order
+         TS_ASSERT_EQUALS(vals.size(), expected.size());
+         for (size_t i = 0; i < std::min(vals.size(), expected.size()); ++i) {
+           TS_ASSERT_EQUALS(vals[i][0].get<flex_int>(), expected[i].first);
+           TS_ASSERT_EQUALS(vals[i][1].get<flex_int>(), expected[i].second);
+         }
+       }
+     }
+
+     SFRAME_CSV_PARSER_NUM_READERS = old_num_readers;
+     SFRAME_CSV_PARSER_SPLIT_SIZE = old_split_size;
+   }
 };
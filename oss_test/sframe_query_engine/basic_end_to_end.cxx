@@ -7,6 +7,7 @@
  */
 #include <sframe_query_engine/planning/planner.hpp>
 #include <sframe_query_engine/planning/planner_node.hpp>
+#include <sframe_query_engine/execution/query_profile.hpp>
 #include <sframe_query_engine/operators/all_operators.hpp>
 #include <sframe_query_engine/util/aggregates.hpp>
 #include <sframe/sarray.hpp>
@@ -61,6 +62,56 @@ class basic_end_to_end: public CxxTest::TestSuite {
     }
   }
 
+  void test_profile() {
+    const size_t TEST_LENGTH = 10000;
+    std::vector<flexible_type> data;
+    for (size_t i = 0;i < TEST_LENGTH; ++i) data.push_back(i);
+    auto sa = std::make_shared<sarray<flexible_type>>();
+    sa->open_for_write();
+    graphlab::copy(data.begin(), data.end(), *sa);
+    sa->close();
+
+    auto root = op_sarray_source::make_planner_node(sa);
+    auto add_one = 
+        op_transform::make_planner_node(
+            root, 
+            [](const sframe_rows::row& a)->flexible_type {
+              return a[0] + 1;
+            },
+            flex_type_enum::INTEGER);
+
+    materialize_options options;
+    options.profile = std::make_shared<query_profile>();
+    auto res = planner().materialize(add_one, options);
+    TS_ASSERT_EQUALS(res.size(), TEST_LENGTH);
+
+    auto stages = options.profile->stages();
+    TS_ASSERT_EQUALS(stages.size(), 1);
+    const stage_profile& stage = stages[0];
+    TS_ASSERT_EQUALS(stage.rows_out, TEST_LENGTH);
+    TS_ASSERT_LESS_THAN(0, stage.num_segments);
+    TS_ASSERT_LESS_THAN(0, stage.bytes_written);
+    TS_ASSERT_LESS_THAN(1, stage.operators.size());
+    // inputs come first, and the tip is last
+    for (size_t i = 0;i < stage.operators.size(); ++i) {
+      TS_ASSERT_EQUALS(stage.operators[i].num_instances, stage.num_segments);
+      for (size_t input: stage.operators[i].inputs) TS_ASSERT_LESS_THAN(input, i);
+    }
+    const operator_profile& source = stage.operators[0];
+    const operator_profile& transform = stage.operators.back();
+    TS_ASSERT_EQUALS(source.rows_in, 0);
+    TS_ASSERT_EQUALS(source.rows_out, TEST_LENGTH);
+    TS_ASSERT_LESS_THAN(0, source.blocks_read);
+    TS_ASSERT_EQUALS(transform.inputs.size(), 1);
+    TS_ASSERT_EQUALS(transform.rows_in, TEST_LENGTH);
+    TS_ASSERT_EQUALS(transform.rows_out, TEST_LENGTH);
+    TS_ASSERT_EQUALS(transform.blocks_read, 0);
+
+    TS_ASSERT_LESS_THAN(0, options.profile->to_string().size());
+    TS_ASSERT_EQUALS(options.profile->to_json()[0], '{');
+    TS_ASSERT_EQUALS(get_published_query_profiles().back(), options.profile);
+  }
+
   void test_sub_linear() {
     const size_t TEST_LENGTH = 1000000;
     std::vector<flexible_type> data;
@@ -0,0 +1,79 @@
+/**
+ * Copyright (C) 2016 Turi
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license. See the LICENSE file for details.
+ */
+#include <map>
+#include <sframe_query_engine/planning/planner.hpp>
+#include <sframe_query_engine/planning/planner_node.hpp>
+#include <sframe_query_engine/operators/all_operators.hpp>
+#include <sframe_query_engine/algorithm/partition_by_key.hpp>
+#include <sframe/testing_utils.hpp>
+#include <cxxtest/TestSuite.h>
+
+using namespace graphlab;
+using namespace graphlab::query_eval;
+
+class partition_by_key_test: public CxxTest::TestSuite {
+ public:
+  sframe make_source() {
+    std::vector<std::vector<flexible_type>> data;
+    for (size_t i = 0; i < 5000; ++i) {
+      data.push_back({flex_int(i % 97), flex_string("v" + std::to_string(i))});
+    }
+    return make_testing_sframe({"key", "value"},
+                               {flex_type_enum::INTEGER, flex_type_enum::STRING},
+                               data);
+  }
+
+  void test_hash_partition() {
+    sframe source = make_source();
+    auto node = op_sframe_source::make_planner_node(source);
+    auto result = hash_partition(node, source.column_names(), {0}, 8);
+
+    TS_ASSERT_EQUALS(result.partitions.num_segments(), 8);
+    TS_ASSERT_EQUALS(result.partitions.num_rows(), source.num_rows());
+    TS_ASSERT_EQUALS(result.partitions.column_names(), source.column_names());
+    TS_ASSERT_EQUALS(result.partition_sizes.size(), 8);
+    TS_ASSERT_LESS_THAN_EQUALS(1.0, result.skew());
+
+    // every key is in exactly one partition
+    std::map<flex_int, size_t> key_partition;
+    auto reader = result.partitions.get_reader();
+    for (size_t i = 0; i < 8; ++i) {
+      size_t num_rows = 0;
+      for (auto iter = reader->begin(i); iter != reader->end(i); ++iter, ++num_rows) {
+        flex_int key = (*iter)[0];
+        if (key_partition.count(key)) TS_ASSERT_EQUALS(key_partition[key], i);
+        key_partition[key] = i;
+      }
+      TS_ASSERT_EQUALS(num_rows, result.partition_sizes[i]);
+    }
+    TS_ASSERT_EQUALS(key_partition.size(), 97);
+  }
+
+  void test_range_partition() {
+    sframe source = make_source();
+    auto node = op_sframe_source::make_planner_node(source);
+    auto result = range_partition(node, source.column_names(), {0},
+                                  {{flex_int(10)}, {flex_int(50)}, {flex_int(90)}});
+
+    TS_ASSERT_EQUALS(result.partitions.num_segments(), 4);
+    TS_ASSERT_EQUALS(result.partitions.num_rows(), source.num_rows());
+    std::vector<std::pair<flex_int, flex_int>> ranges{{0, 10}, {10, 50}, {50, 90}, {90, 97}};
+    auto reader = result.partitions.get_reader();
+    for (size_t i = 0; i < 4; ++i) {
+      size_t num_rows = 0;
+      for (auto iter = reader->begin(i); iter != reader->end(i); ++iter, ++num_rows) {
+        flex_int key = (*iter)[0];
+        TS_ASSERT_LESS_THAN_EQUALS(ranges[i].first, key);
+        TS_ASSERT_LESS_THAN(key, ranges[i].second);
+      }
+      TS_ASSERT_EQUALS(num_rows, result.partition_sizes[i]);
+    }
+    TS_ASSERT_THROWS_ANYTHING(range_partition(node, source.column_names(), {0},
+                                              {{flex_int(50)}, {flex_int(10)}}));
+  }
+};
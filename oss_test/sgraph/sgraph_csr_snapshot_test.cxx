@@ -0,0 +1,119 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <set>
+#include <sgraph/sgraph.hpp>
+#include <sgraph/sgraph_csr_snapshot.hpp>
+#include <cxxtest/TestSuite.h>
+
+#include "sgraph_test_util.hpp"
+#include "sgraph_check_pagerank.hpp"
+
+using namespace graphlab;
+
+// Implement pagerank over an in memory csr snapshot.
+void csr_pagerank_fn(sgraph& g, size_t num_iterations) {
+  sgraph_compute::csr_snapshot csr(g);
+  std::vector<double> rank = csr.load_vertex_column<double>(g, "vdata");
+  std::vector<double> next(csr.num_vertices());
+  for (size_t iter = 0; iter < num_iterations; ++iter) {
+    csr.parallel_for_vertices([&](size_t v) {
+      double acc = 0.15;
+      csr.for_each_in_neighbor(v, [&](size_t u, double) {
+        acc += 0.85 * rank[u] / csr.out_degree(u);
+      });
+      next[v] = acc;
+    });
+    std::swap(rank, next);
+  }
+  csr.store_vertex_column(g, rank, "vdata", flex_type_enum::FLOAT);
+}
+
+class sgraph_csr_snapshot_test : public CxxTest::TestSuite {
+
+public:
+
+void test_pagerank() {
+  check_pagerank(csr_pagerank_fn);
+}
+
+void test_edges_match_graph() {
+  size_t n_vertex = 100;
+  size_t n_partition = 4;
+  sgraph g = create_ring_graph(n_vertex, n_partition, true /* bidirection */);
+  sgraph_compute::csr_snapshot csr(g);
+
+  TS_ASSERT_EQUALS(csr.num_vertices(), g.num_vertices());
+  TS_ASSERT_EQUALS(csr.num_edges(), g.num_edges());
+  TS_ASSERT_EQUALS(csr.num_partitions(), n_partition);
+
+  // map global ids back to the user vertex ids
+  std::vector<flexible_type> ids(csr.num_vertices());
+  auto vids = g.fetch_vertex_data_field_in_memory("__id");
+  for (size_t p = 0; p < vids.size(); ++p) {
+    for (size_t i = 0; i < vids[p].size(); ++i) {
+      size_t gid = csr.global_id({p, i});
+      ids[gid] = vids[p][i];
+      auto addr = csr.address_of(gid);
+      TS_ASSERT_EQUALS(addr.partition_id, p);
+      TS_ASSERT_EQUALS(addr.local_id, i);
+    }
+  }
+
+  std::set<std::pair<flex_int, flex_int>> expected;
+  for (size_t i = 0; i < n_vertex; ++i) {
+    expected.insert({i, (i + 1) % n_vertex});
+    expected.insert({(i + 1) % n_vertex, i});
+  }
+
+  std::set<std::pair<flex_int, flex_int>> out_edges, in_edges;
+  for (size_t v = 0; v < csr.num_vertices(); ++v) {
+    TS_ASSERT_EQUALS(csr.out_degree(v), 2);
+    TS_ASSERT_EQUALS(csr.in_degree(v), 2);
+    csr.for_each_out_neighbor(v, [&](size_t u, double w) {
+      TS_ASSERT_EQUALS(w, 1.0);
+      out_edges.insert({ids[v], ids[u]});
+    });
+    csr.for_each_in_neighbor(v, [&](size_t u, double w) {
+      in_edges.insert({ids[u], ids[v]});
+    });
+  }
+  TS_ASSERT(out_edges == expected);
+  TS_ASSERT(in_edges == expected);
+}
+
+void test_edge_weights() {
+  size_t n_vertex = 20;
+  size_t n_partition = 2;
+  sgraph g = create_ring_graph(n_vertex, n_partition, false);
+  g.init_edge_field("weight", flex_float(2.5));
+
+  sgraph_compute::csr_snapshot csr(g, sgraph::edge_direction::OUT_EDGE, "weight");
+  TS_ASSERT(csr.has_out_edges());
+  TS_ASSERT(!csr.has_in_edges());
+  size_t visited = 0;
+  for (size_t v = 0; v < csr.num_vertices(); ++v) {
+    csr.for_each_out_neighbor(v, [&](size_t u, double w) {
+      TS_ASSERT_EQUALS(w, 2.5);
+      ++visited;
+    });
+  }
+  TS_ASSERT_EQUALS(visited, n_vertex);
+  TS_ASSERT_THROWS_ANYTHING(
+      sgraph_compute::csr_snapshot(g, sgraph::edge_direction::OUT_EDGE, "edata"));
+}
+
+};
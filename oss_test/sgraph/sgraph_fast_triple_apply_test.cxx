@@ -77,6 +77,56 @@ void test_triple_apply_degree_count() {
   check_degree_count(triple_apply_degree_count);
 }
 
+void test_combine_atomic() {
+  size_t n_vertex = 1000;
+  size_t n_partition = 4;
+  sgraph g = create_ring_graph(n_vertex, n_partition, true /* bi direction */);
+  typedef sgraph_compute::combiner_op combiner_op;
+
+  std::vector<std::vector<flexible_type>> vids = g.fetch_vertex_data_field_in_memory("__id");
+  auto degree = sgraph_compute::create_vertex_data<std::atomic<flex_int>>(g);
+  auto min_nbr = sgraph_compute::create_vertex_data<std::atomic<flex_float>>(g);
+  auto max_nbr = sgraph_compute::create_vertex_data<std::atomic<flex_int>>(g);
+  auto nbr_bits = sgraph_compute::create_vertex_data<std::atomic<flex_int>>(g);
+  for (size_t i = 0; i < vids.size(); ++i) {
+    for (size_t j = 0; j < vids[i].size(); ++j) {
+      degree[i][j] = 0;
+      min_nbr[i][j] = n_vertex;
+      max_nbr[i][j] = -1;
+      nbr_bits[i][j] = 0;
+    }
+  }
+
+  sgraph_compute::fast_triple_apply(g,
+      [&](sgraph_compute::fast_edge_scope& scope) {
+        auto src = scope.source_vertex_address();
+        auto dst = scope.target_vertex_address();
+        flex_int src_id = vids[src.partition_id][src.local_id];
+        size_t p = dst.partition_id, l = dst.local_id;
+        sgraph_compute::combine_atomic(combiner_op::SUM, degree[p][l], flex_int(1));
+        sgraph_compute::combine_atomic(combiner_op::MIN, min_nbr[p][l], flex_float(src_id));
+        sgraph_compute::combine_atomic(combiner_op::MAX, max_nbr[p][l], src_id);
+        sgraph_compute::combine_atomic(combiner_op::BIT_OR, nbr_bits[p][l],
+                                       flex_int(1) << (src_id % 8));
+      }, {}, {});
+
+  for (size_t i = 0; i < vids.size(); ++i) {
+    for (size_t j = 0; j < vids[i].size(); ++j) {
+      flex_int id = vids[i][j];
+      flex_int prev = (id + n_vertex - 1) % n_vertex;
+      flex_int next = (id + 1) % n_vertex;
+      TS_ASSERT_EQUALS(degree[i][j].load(), 2);
+      TS_ASSERT_EQUALS(min_nbr[i][j].load(), (flex_float)std::min(prev, next));
+      TS_ASSERT_EQUALS(max_nbr[i][j].load(), std::max(prev, next));
+      TS_ASSERT_EQUALS(nbr_bits[i][j].load(),
+                       (flex_int(1) << (prev % 8)) | (flex_int(1) << (next % 8)));
+    }
+  }
+
+  std::atomic<flex_float> acc(0);
+  TS_ASSERT_THROWS_ANYTHING(sgraph_compute::combine_atomic(combiner_op::BIT_OR, acc, 1.0));
+}
+
 void test_triple_apply_edge_data_modification() {
   // Create an edge field, and assign it the value of the sum of source and target ids.
   size_t n_vertex = 10;
@@ -0,0 +1,235 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cmath>
+#include <queue>
+#include <random>
+#include <sgraph/sgraph.hpp>
+#include <sgraph/sgraph_engine.hpp>
+#include <sgraph/sgraph_frontier.hpp>
+#include <parallel/atomic_ops.hpp>
+#include <cxxtest/TestSuite.h>
+
+#include "sgraph_test_util.hpp"
+
+using namespace graphlab;
+using namespace graphlab::sgraph_compute;
+
+// Breadth first search levels from source.
+std::vector<size_t> frontier_bfs(const csr_snapshot& csr, size_t source,
+                                 frontier_stats& stats) {
+  frontier_engine engine(csr);
+  std::vector<size_t> level(csr.num_vertices(), (size_t)(-1));
+  vertex_frontier frontier(csr.num_vertices());
+  frontier.activate(source);
+  level[source] = 0;
+  for (size_t depth = 1; !frontier.empty(); ++depth) {
+    frontier = engine.edge_map(frontier,
+        [&](size_t u, size_t v, double) {
+          return atomic_compare_and_swap(level[v], (size_t)(-1), depth); },
+        [&](size_t v) { return level[v] == (size_t)(-1); });
+  }
+  stats = engine.stats();
+  return level;
+}
+
+// Reference Dijkstra over the out edges of the snapshot.
+std::vector<double> dijkstra(const csr_snapshot& csr, size_t source) {
+  std::vector<double> dist(csr.num_vertices(),
+                           std::numeric_limits<double>::infinity());
+  typedef std::pair<double, size_t> item;
+  std::priority_queue<item, std::vector<item>, std::greater<item> > queue;
+  dist[source] = 0;
+  queue.push({0, source});
+  while (!queue.empty()) {
+    item top = queue.top();
+    queue.pop();
+    if (top.first > dist[top.second]) continue;
+    csr.for_each_out_neighbor(top.second, [&](size_t v, double w) {
+      if (top.first + w < dist[v]) {
+        dist[v] = top.first + w;
+        queue.push({dist[v], v});
+      }
+    });
+  }
+  return dist;
+}
+
+class sgraph_frontier_test : public CxxTest::TestSuite {
+
+public:
+
+void test_frontier() {
+  vertex_frontier frontier(100);
+  TS_ASSERT(frontier.empty());
+  TS_ASSERT(frontier.activate(5));
+  TS_ASSERT(frontier.activate(50));
+  TS_ASSERT(!frontier.activate(5));
+  TS_ASSERT_EQUALS(frontier.num_active(), 2);
+  TS_ASSERT(frontier.is_active(50));
+  TS_ASSERT_DELTA(frontier.density(), 0.02, 1e-9);
+  frontier.clear();
+  TS_ASSERT(frontier.empty());
+  TS_ASSERT(!frontier.is_active(5));
+  TS_ASSERT(!frontier.is_active(50));
+}
+
+void test_bfs_ring() {
+  size_t n_vertex = 100;
+  sgraph g = create_ring_graph(n_vertex, 4, true /* bidirection */);
+  csr_snapshot csr(g);
+  auto ids = csr.load_vertex_column<size_t>(g, "__id");
+  size_t source = std::find(ids.begin(), ids.end(), 0) - ids.begin();
+
+  frontier_stats stats;
+  auto level = frontier_bfs(csr, source, stats);
+  for (size_t v = 0; v < csr.num_vertices(); ++v) {
+    TS_ASSERT_EQUALS(level[v], std::min(ids[v], n_vertex - ids[v]));
+  }
+  // the frontier of a ring never exceeds 2 vertices, only push is used and
+  // every edge is visited once
+  TS_ASSERT_EQUALS(stats.num_pull, 0);
+  TS_ASSERT_EQUALS(stats.edges_visited, csr.num_edges());
+}
+
+void test_bfs_star_pulls() {
+  size_t n_vertex = 1000;
+  sgraph g = create_star_graph(n_vertex, 4, true /* bidirection */);
+  csr_snapshot csr(g);
+  auto ids = csr.load_vertex_column<size_t>(g, "__id");
+  size_t leaf = std::find(ids.begin(), ids.end(), 1) - ids.begin();
+
+  frontier_stats stats;
+  auto level = frontier_bfs(csr, leaf, stats);
+  for (size_t v = 0; v < csr.num_vertices(); ++v) {
+    size_t expected = ids[v] == 1 ? 0 : (ids[v] == 0 ? 1 : 2);
+    TS_ASSERT_EQUALS(level[v], expected);
+  }
+  // the leaf pushes to the center, the center is expanded by pulling
+  TS_ASSERT_LESS_THAN_EQUALS(1, stats.num_push);
+  TS_ASSERT_LESS_THAN_EQUALS(1, stats.num_pull);
+
+  // with out edges only, the engine always pushes
+  csr_snapshot out_only(g, sgraph::edge_direction::OUT_EDGE);
+  frontier_bfs(out_only, leaf, stats);
+  TS_ASSERT_EQUALS(stats.num_pull, 0);
+}
+
+void test_bfs_out_of_core() {
+  // breadth first search over a directed ring with sgraph_engine
+  size_t n_vertex = 40;
+  size_t n_partition = 4;
+  sgraph g = create_ring_graph(n_vertex, n_partition);
+  auto ids = g.fetch_vertex_data_field(sgraph::VID_COLUMN_NAME);
+  std::vector<std::vector<flexible_type> > vertex_ids(n_partition);
+  std::vector<std::vector<size_t> > level(n_partition);
+  std::vector<dense_bitset> active(n_partition);
+  for (size_t p = 0; p < n_partition; ++p) {
+    ids[p]->get_reader()->read_rows(0, ids[p]->size(), vertex_ids[p]);
+    level[p].resize(vertex_ids[p].size(), (size_t)(-1));
+    active[p].resize(vertex_ids[p].size());
+    active[p].clear();
+    for (size_t row = 0; row < vertex_ids[p].size(); ++row) {
+      if (vertex_ids[p][row] == 0) {
+        active[p].set_bit(row);
+        level[p][row] = 0;
+      }
+    }
+  }
+
+  typedef sgraph_engine<flexible_type>::graph_data_type graph_data_type;
+  sgraph_engine<flexible_type> engine;
+  for (size_t depth = 1; ; ++depth) {
+    size_t active_partitions = 0;
+    for (size_t p = 0; p < n_partition; ++p) active_partitions += !active[p].empty();
+    if (active_partitions == 0) break;
+    auto counts = engine.gather_frontier(g, active,
+        [](const graph_data_type& center, const graph_data_type& edge,
+           const graph_data_type& other, sgraph::edge_direction edgedir,
+           flexible_type& combiner) {
+          combiner = combiner + 1;
+        },
+        flexible_type(0), sgraph::edge_direction::IN_EDGE);
+    // only the rows of the edge partition grid with an active source are read
+    TS_ASSERT_EQUALS(engine.last_num_edge_partitions(),
+                     active_partitions * n_partition);
+    for (size_t p = 0; p < n_partition; ++p) {
+      std::vector<flexible_type> count;
+      counts[p]->get_reader()->read_rows(0, counts[p]->size(), count);
+      active[p].clear();
+      for (size_t row = 0; row < count.size(); ++row) {
+        if (count[row] > 0 && level[p][row] == (size_t)(-1)) {
+          level[p][row] = depth;
+          active[p].set_bit(row);
+        }
+      }
+    }
+  }
+  for (size_t p = 0; p < n_partition; ++p) {
+    for (size_t row = 0; row < level[p].size(); ++row) {
+      TS_ASSERT_EQUALS(level[p][row], (size_t)vertex_ids[p][row]);
+    }
+  }
+}
+
+void test_delta_stepping() {
+  size_t n_vertex = 500;
+  std::default_random_engine generator(1);
+  std::uniform_int_distribution<size_t> vertex(0, n_vertex - 1);
+  std::uniform_real_distribution<double> weight(0.0, 10.0);
+  std::vector<flexible_type> sources, targets, weights;
+  for (size_t i = 0; i < n_vertex; ++i) {
+    // a ring, so that every vertex is reachable, and random chords
+    sources.push_back(i);
+    targets.push_back((i + 1) % n_vertex);
+    weights.push_back(weight(generator));
+    for (size_t j = 0; j < 3; ++j) {
+      sources.push_back(i);
+      targets.push_back(vertex(generator));
+      weights.push_back(weight(generator));
+    }
+  }
+  sgraph g(4);
+  g.add_edges(create_sframe({{"source", flex_type_enum::INTEGER, sources},
+                             {"target", flex_type_enum::INTEGER, targets},
+                             {"weight", flex_type_enum::FLOAT, weights}}),
+              "source", "target");
+  // an isolated vertex
+  g.add_vertices(create_sframe({{"vid", flex_type_enum::INTEGER, {n_vertex}}}),
+                 "vid");
+
+  csr_snapshot csr(g, sgraph::edge_direction::ANY_EDGE, "weight");
+  auto ids = csr.load_vertex_column<size_t>(g, "__id");
+  size_t source = std::find(ids.begin(), ids.end(), 0) - ids.begin();
+  auto expected = dijkstra(csr, source);
+
+  for (double delta : {0.5, 5.0, 1000.0}) {
+    frontier_stats stats;
+    auto dist = delta_stepping_sssp(csr, source, delta, &stats);
+    TS_ASSERT_EQUALS(dist.size(), expected.size());
+    for (size_t v = 0; v < dist.size(); ++v) {
+      if (ids[v] == n_vertex) {
+        TS_ASSERT(std::isinf(dist[v]));
+      } else {
+        TS_ASSERT_DELTA(dist[v], expected[v], 1e-9);
+      }
+    }
+    TS_ASSERT_LESS_THAN(0, stats.edges_visited);
+  }
+  TS_ASSERT_THROWS_ANYTHING(delta_stepping_sssp(csr, source, 0.0));
+}
+
+};
@@ -0,0 +1,167 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <set>
+#include <vector>
+#include <timer/timer.hpp>
+#include <sgraph/hilbert_curve.hpp>
+#include <sgraph/sgraph_partition_schedule.hpp>
+#include <cxxtest/TestSuite.h>
+
+using namespace graphlab;
+
+class sgraph_partition_schedule_test: public CxxTest::TestSuite {
+ public:
+  // number of vertex block loads of the plain hilbert curve blocking
+  size_t hilbert_loads(size_t n, size_t parallel_limit) {
+    size_t loads = 0;
+    std::set<size_t> prev;
+    for (size_t i = 0; i < n * n; i += parallel_limit) {
+      std::set<size_t> needed;
+      for (size_t j = i; j < std::min(i + parallel_limit, n * n); ++j) {
+        auto coord = hilbert_index_to_coordinate(j, n);
+        needed.insert(coord.first);
+        needed.insert(coord.second);
+      }
+      for (size_t b : needed) loads += (prev.count(b) == 0);
+      prev = needed;
+    }
+    return loads;
+  }
+
+  sgraph_compute::partition_schedule_stats
+  test_runner(size_t n, size_t parallel_limit, size_t budget_in_blocks) {
+    const size_t block_bytes = 100;
+    std::vector<size_t> vertex_block_bytes(n, block_bytes);
+    sgraph_compute::partition_schedule_stats stats;
+    auto schedule = sgraph_compute::plan_partition_schedule(
+        vertex_block_bytes, budget_in_blocks * block_bytes, parallel_limit, &stats);
+
+    TS_ASSERT_EQUALS(stats.num_passes, schedule.size());
+    TS_ASSERT_EQUALS(stats.vertex_block_loads, stats.vertex_block_unloads);
+    TS_ASSERT_EQUALS(stats.bytes_loaded, stats.vertex_block_loads * block_bytes);
+
+    std::set<std::pair<size_t, size_t> > visited;
+    for (const auto& pass : schedule) {
+      TS_ASSERT_LESS_THAN_EQUALS(pass.coordinates.size(), parallel_limit);
+      TS_ASSERT_LESS_THAN_EQUALS(pass.resident_partitions.size(),
+                                 std::max<size_t>(budget_in_blocks, 2));
+      for (const auto& coord : pass.coordinates) {
+        TS_ASSERT(pass.resident_partitions.count(coord.first));
+        TS_ASSERT(pass.resident_partitions.count(coord.second));
+        TS_ASSERT(visited.insert(coord).second);
+      }
+    }
+    TS_ASSERT_EQUALS(visited.size(), n * n);
+    return stats;
+  }
+
+  void test_partition_schedule() {
+    test_runner(1, 4, 2);
+    test_runner(4, 2, 4);
+    test_runner(16, 3, 2);
+    test_runner(16, 1, 4);
+    // a tiny budget still visits everything
+    test_runner(8, 8, 1);
+  }
+
+  void test_partition_schedule_reuses_blocks() {
+    // with enough memory, every block is loaded once
+    auto stats = test_runner(16, 4, 1000);
+    TS_ASSERT_EQUALS(stats.vertex_block_loads, 16);
+
+    // with a bounded budget, far fewer loads than the plain hilbert blocking
+    stats = test_runner(16, 4, 8);
+    TS_ASSERT_LESS_THAN(stats.vertex_block_loads, hilbert_loads(16, 4));
+    stats = test_runner(64, 16, 32);
+    TS_ASSERT_LESS_THAN(stats.vertex_block_loads, hilbert_loads(64, 16));
+  }
+
+  void test_partition_schedule_many_partitions() {
+    // a pick only looks at the neighbors of the blocks in memory
+    timer ti;
+    test_runner(128, 16, 16);
+    TS_ASSERT_LESS_THAN(ti.current_time(), 60);
+  }
+
+  void test_partition_schedule_uneven_blocks() {
+    std::vector<size_t> vertex_block_bytes{1000, 10, 10, 10, 10, 10, 10, 10};
+    auto schedule = sgraph_compute::plan_partition_schedule(
+        vertex_block_bytes, 1030, 4);
+    std::set<std::pair<size_t, size_t> > visited;
+    for (const auto& pass : schedule) {
+      size_t resident_bytes = 0;
+      for (size_t b : pass.resident_partitions) {
+        resident_bytes += vertex_block_bytes[b];
+      }
+      TS_ASSERT_LESS_THAN_EQUALS(resident_bytes, 1030);
+      for (const auto& coord : pass.coordinates) visited.insert(coord);
+    }
+    TS_ASSERT_EQUALS(visited.size(), 64);
+  }
+
+  void test_estimate_vertex_block_bytes() {
+    size_t num_rows = 1000;
+    sframe numeric, strings;
+    numeric.open_for_write({"id"}, {flex_type_enum::INTEGER}, "", 1);
+    strings.open_for_write({"id", "text"},
+                           {flex_type_enum::INTEGER, flex_type_enum::STRING},
+                           "", 1);
+    auto numeric_out = numeric.get_output_iterator(0);
+    auto strings_out = strings.get_output_iterator(0);
+    for (size_t i = 0; i < num_rows; ++i) {
+      *numeric_out = std::vector<flexible_type>{flexible_type(i)};
+      ++numeric_out;
+      *strings_out = std::vector<flexible_type>{
+          flexible_type(i), flexible_type(std::string(1000, 'a') + std::to_string(i))};
+      ++strings_out;
+    }
+    numeric.close();
+    strings.close();
+
+    size_t numeric_bytes = sgraph_compute::estimate_vertex_block_bytes(numeric);
+    size_t strings_bytes = sgraph_compute::estimate_vertex_block_bytes(strings);
+    TS_ASSERT_EQUALS(numeric_bytes,
+                     num_rows * (sizeof(std::vector<flexible_type>) +
+                                 sizeof(flexible_type)));
+    // the string payload is accounted for
+    TS_ASSERT_LESS_THAN(numeric_bytes + num_rows * 1000, strings_bytes);
+  }
+
+  void test_scheduled_parallel_for() {
+    size_t n = 8;
+    std::vector<size_t> vertex_block_bytes(n, 1);
+    std::vector<std::pair<size_t, size_t> > preamble_hits;
+    std::vector<std::pair<size_t, size_t> > parallel_hits;
+    mutex lock;
+    sgraph_compute::scheduled_blocked_parallel_for(
+        vertex_block_bytes,
+        [&](const std::vector<std::pair<size_t, size_t> >& v,
+            const std::set<size_t>& resident) {
+          std::copy(v.begin(), v.end(), std::back_inserter(preamble_hits));
+        },
+        [&](std::pair<size_t, size_t> v) {
+          lock.lock();
+          parallel_hits.push_back(v);
+          lock.unlock();
+        }, 4, 4);
+    TS_ASSERT_EQUALS(preamble_hits.size(), n * n);
+    TS_ASSERT_EQUALS(parallel_hits.size(), n * n);
+    std::set<std::pair<size_t, size_t> > unique_vals(parallel_hits.begin(),
+                                                     parallel_hits.end());
+    TS_ASSERT_EQUALS(unique_vals.size(), n * n);
+  }
+};
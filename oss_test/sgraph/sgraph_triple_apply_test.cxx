@@ -80,6 +80,42 @@ std::vector<std::pair<flexible_type, flexible_type>> triple_apply_degree_count(
   return ret;
 }
 
+// Implement degree count function using combiner_triple_apply
+std::vector<std::pair<flexible_type, flexible_type>> combiner_triple_apply_degree_count(
+  sgraph& g, sgraph::edge_direction dir) {
+
+  sgraph_compute::combiner_triple_apply_fn_type fn;
+  g.init_vertex_field("__degree__", flex_int(0));
+
+  if (dir == sgraph::edge_direction::IN_EDGE) {
+    fn = [](sgraph_compute::combiner_edge_scope& scope) {
+      scope.combine_target(0, 1);
+    };
+  } else if (dir == sgraph::edge_direction::OUT_EDGE) {
+    fn = [](sgraph_compute::combiner_edge_scope& scope) {
+      scope.combine_source(0, 1);
+    };
+  } else {
+    fn = [](sgraph_compute::combiner_edge_scope& scope) {
+      scope.combine_source(0, 1);
+      scope.combine_target(0, 1);
+    };
+  }
+  sgraph_compute::combiner_triple_apply(
+      g, fn, {{"__degree__", sgraph_compute::combiner_op::SUM}});
+
+  auto result = g.fetch_vertex_data_field_in_memory("__degree__");
+  auto vertex_ids = g.fetch_vertex_data_field_in_memory(sgraph::VID_COLUMN_NAME);
+  std::vector<std::pair<flexible_type, flexible_type>> ret;
+  for (size_t i = 0; i < result.size(); ++i) {
+    for (size_t j = 0; j < result[i].size(); ++j) {
+      ret.push_back({vertex_ids[i][j], result[i][j]});
+    }
+  }
+  g.remove_vertex_field("__degree__");
+  return ret;
+}
+
 class sgraph_triple_apply_test : public CxxTest::TestSuite {
 
 public:
@@ -94,6 +130,71 @@ void test_batch_triple_apply_degree_count() {
   check_degree_count(f);
 }
 
+void test_combiner_triple_apply_degree_count() {
+  check_degree_count(combiner_triple_apply_degree_count);
+}
+
+void test_combiner_triple_apply_min_max() {
+  size_t n_vertex = 1000;
+  size_t n_partition = 4;
+  sgraph g = create_ring_graph(n_vertex, n_partition, true /* bi direction */);
+  g.init_vertex_field("min_nbr", flex_int(n_vertex));
+  g.init_vertex_field("max_nbr", flex_float(-1.0));
+  g.init_vertex_field("nbr_bits", flex_int(0));
+
+  typedef sgraph_compute::combiner_op combiner_op;
+  sgraph_compute::combiner_triple_apply(
+      g,
+      [](sgraph_compute::combiner_edge_scope& scope) {
+        flexible_type src = scope.source()[0];
+        scope.combine_target(0, src);
+        scope.combine_target(1, src);
+        scope.combine_target(2, flex_int(1) << (src.get<flex_int>() % 8));
+      },
+      {{"min_nbr", combiner_op::MIN},
+       {"max_nbr", combiner_op::MAX},
+       {"nbr_bits", combiner_op::BIT_OR}});
+
+  sframe vdata = g.get_vertices();
+  std::vector<std::vector<flexible_type>> rows;
+  vdata.get_reader()->read_rows(0, vdata.size(), rows);
+  size_t id_idx = vdata.column_index("__id");
+  size_t min_idx = vdata.column_index("min_nbr");
+  size_t max_idx = vdata.column_index("max_nbr");
+  size_t bits_idx = vdata.column_index("nbr_bits");
+  for (auto& row : rows) {
+    flex_int id = row[id_idx];
+    flex_int prev = (id + n_vertex - 1) % n_vertex;
+    flex_int next = (id + 1) % n_vertex;
+    TS_ASSERT_EQUALS(row[min_idx].get_type(), flex_type_enum::INTEGER);
+    TS_ASSERT_EQUALS(row[max_idx].get_type(), flex_type_enum::FLOAT);
+    TS_ASSERT_EQUALS((flex_int)row[min_idx], std::min(prev, next));
+    TS_ASSERT_EQUALS((flex_float)row[max_idx], (flex_float)std::max(prev, next));
+    TS_ASSERT_EQUALS((flex_int)row[bits_idx],
+                     (flex_int(1) << (prev % 8)) | (flex_int(1) << (next % 8)));
+  }
+
+  // invalid combiners
+  TS_ASSERT_THROWS_ANYTHING(sgraph_compute::combiner_triple_apply(
+      g, [](sgraph_compute::combiner_edge_scope& scope) { },
+      {{"no_such_field", combiner_op::SUM}}));
+  TS_ASSERT_THROWS_ANYTHING(sgraph_compute::combiner_triple_apply(
+      g, [](sgraph_compute::combiner_edge_scope& scope) { },
+      {{"max_nbr", combiner_op::BIT_OR}}));
+
+  // invalid contributions
+  TS_ASSERT_THROWS_ANYTHING(sgraph_compute::combiner_triple_apply(
+      g, [](sgraph_compute::combiner_edge_scope& scope) {
+        scope.combine_target(0, flex_string("a"));
+      },
+      {{"min_nbr", combiner_op::MIN}}));
+  TS_ASSERT_THROWS_ANYTHING(sgraph_compute::combiner_triple_apply(
+      g, [](sgraph_compute::combiner_edge_scope& scope) {
+        scope.combine_target(0, flex_float(1.5));
+      },
+      {{"nbr_bits", combiner_op::BIT_OR}}));
+}
+
 void test_triple_apply_edge_data_modification() {
   // Create an edge field, and assign it the value of the sum of source and target ids.
   size_t n_vertex = 1000;
@@ -0,0 +1,192 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <set>
+#include <sgraph/sgraph.hpp>
+#include <sgraph/sgraph_vid_index.hpp>
+#include <serialization/dir_archive.hpp>
+#include <fileio/temp_files.hpp>
+#include <sframe/testing_utils.hpp>
+#include <cxxtest/TestSuite.h>
+
+#include "sgraph_test_util.hpp"
+
+using namespace graphlab;
+
+class sgraph_vid_index_test : public CxxTest::TestSuite {
+
+ public:
+
+  void test_append_and_find() {
+    sgraph_vid_index index;
+    TS_ASSERT_EQUALS(index.find(0), sgraph_vid_index::NOT_FOUND);
+
+    // append in many small batches to exercise segment merging
+    size_t n = 10000;
+    for (size_t start = 0; start < n; start += 100) {
+      std::vector<flexible_type> batch;
+      for (size_t i = start; i < start + 100; ++i) {
+        batch.push_back(std::to_string(i));
+      }
+      index.append(batch);
+    }
+    TS_ASSERT_EQUALS(index.size(), n);
+    TS_ASSERT_LESS_THAN(index.num_segments(), 10);
+    for (size_t i = 0; i < n; ++i) {
+      TS_ASSERT_EQUALS(index.find(std::to_string(i)), i);
+    }
+    TS_ASSERT_EQUALS(index.find(std::to_string(n)), sgraph_vid_index::NOT_FOUND);
+    TS_ASSERT_EQUALS(index.find(0), sgraph_vid_index::NOT_FOUND);
+
+    // copies are not affected by appending to the original
+    sgraph_vid_index copy = index;
+    index.append(std::vector<flexible_type>{std::to_string(n)});
+    TS_ASSERT_EQUALS(index.find(std::to_string(n)), n);
+    TS_ASSERT_EQUALS(copy.find(std::to_string(n)), sgraph_vid_index::NOT_FOUND);
+    TS_ASSERT_EQUALS(copy.size(), n);
+  }
+
+  void test_save_load() {
+    sgraph_vid_index index;
+    std::vector<flexible_type> vids;
+    for (size_t i = 0; i < 1000; ++i) vids.push_back(i * 7);
+    index.append(vids);
+
+    for (std::string path : {get_temp_name() + ".vid_index",
+                             std::string("cache://vid_index_test.vid_index")}) {
+      index.save(path);
+      sgraph_vid_index loaded;
+      TS_ASSERT(loaded.load(path));
+      TS_ASSERT_EQUALS(loaded.size(), index.size());
+      for (size_t i = 0; i < vids.size(); ++i) {
+        TS_ASSERT_EQUALS(loaded.find(vids[i]), i);
+      }
+      // a loaded index can still be appended to
+      loaded.append(std::vector<flexible_type>{1});
+      TS_ASSERT_EQUALS(loaded.find(1), vids.size());
+    }
+    sgraph_vid_index missing;
+    TS_ASSERT(!missing.load(get_temp_name() + ".vid_index"));
+  }
+
+  void test_indexed_column_identity() {
+    std::vector<flexible_type> a, b;
+    for (size_t i = 0; i < 100; ++i) {
+      a.push_back(i);
+      b.push_back(i + 100);
+    }
+    auto column_a = make_testing_sarray(flex_type_enum::INTEGER, a);
+    auto column_b = make_testing_sarray(flex_type_enum::INTEGER, b);
+    sgraph_vid_index index(*column_a);
+    TS_ASSERT(index.indexes(*column_a));
+    // same number of rows, different column
+    TS_ASSERT(!index.indexes(*column_b));
+
+    // appending to the column is only picked up through set_column
+    auto appended = std::make_shared<sarray<flexible_type>>(
+        column_a->append(*make_testing_sarray(flex_type_enum::INTEGER, {1000})));
+    index.append(std::vector<flexible_type>{1000});
+    TS_ASSERT(!index.indexes(*appended));
+    index.set_column(*appended);
+    TS_ASSERT(index.indexes(*appended));
+    TS_ASSERT(!index.indexes(*column_a));
+    index.clear();
+    TS_ASSERT(!index.indexes(*appended));
+  }
+
+  void test_find_vertices() {
+    size_t n_vertex = 100;
+    sgraph g = create_ring_graph(n_vertex, 4, false);
+    auto vids = g.fetch_vertex_data_field_in_memory("__id");
+
+    std::vector<flexible_type> query{0, 42, 99, 1000};
+    auto addresses = g.find_vertices(query);
+    TS_ASSERT_EQUALS(addresses.size(), query.size());
+    for (size_t i = 0; i < 3; ++i) {
+      TS_ASSERT_DIFFERS(addresses[i].second, sgraph_vid_index::NOT_FOUND);
+      TS_ASSERT_EQUALS(vids[addresses[i].first][addresses[i].second], query[i]);
+    }
+    TS_ASSERT_EQUALS(addresses[3].second, sgraph_vid_index::NOT_FOUND);
+  }
+
+  void test_incremental_add_edges() {
+    size_t n_vertex = 100;
+    sgraph g = create_ring_graph(n_vertex, 4, false);
+    sgraph before = g;
+
+    // add a chord to a new vertex and update a vertex
+    sframe edges = create_sframe(
+        {{"source", flex_type_enum::INTEGER, {5, 1000}},
+         {"target", flex_type_enum::INTEGER, {1000, 50}},
+         {"edata", flex_type_enum::STRING, {"a", "b"}}});
+    g.add_edges(edges, "source", "target");
+    sframe vertices = create_sframe(
+        {{"vid", flex_type_enum::INTEGER, {5, 2000}},
+         {"vdata", flex_type_enum::FLOAT, {2.0, 3.0}}});
+    g.add_vertices(vertices, "vid");
+    TS_ASSERT_EQUALS(g.num_vertices(), n_vertex + 2);
+    TS_ASSERT_EQUALS(g.num_edges(), n_vertex + 2);
+    TS_ASSERT_EQUALS(g.get_vertices({5}).num_rows(), 1);
+
+    // out edges of 5, and in edges of 50
+    auto out_edges = g.get_edges({5}, {FLEX_UNDEFINED});
+    std::vector<std::vector<flexible_type>> rows;
+    out_edges.get_reader()->read_rows(0, out_edges.size(), rows);
+    std::set<flex_int> targets;
+    for (auto& row : rows) {
+      TS_ASSERT_EQUALS(row[0], 5);
+      targets.insert(row[1]);
+    }
+    TS_ASSERT(targets == std::set<flex_int>({6, 1000}));
+    TS_ASSERT_EQUALS(g.get_edges({FLEX_UNDEFINED}, {50}).num_rows(), 2);
+    TS_ASSERT_EQUALS(g.get_edges({1000}, {50}).num_rows(), 1);
+    TS_ASSERT_EQUALS(g.get_edges({50}, {1000}).num_rows(), 0);
+    TS_ASSERT_EQUALS(g.get_edges({3000}, {FLEX_UNDEFINED}).num_rows(), 0);
+
+    // the copy made before the update is unchanged
+    TS_ASSERT_EQUALS(before.num_vertices(), n_vertex);
+    TS_ASSERT_EQUALS(before.find_vertices({1000})[0].second, sgraph_vid_index::NOT_FOUND);
+    TS_ASSERT_EQUALS(before.get_edges({5}, {FLEX_UNDEFINED}).num_rows(), 1);
+  }
+
+  void test_graph_save_load() {
+    sgraph g = create_ring_graph(100, 4, true);
+    std::string path = get_temp_name();
+    {
+      dir_archive dir;
+      dir.open_directory_for_write(path);
+      oarchive oarc(dir);
+      oarc << g;
+      dir.close();
+    }
+    sgraph g2;
+    {
+      dir_archive dir;
+      dir.open_directory_for_read(path);
+      iarchive iarc(dir);
+      iarc >> g2;
+      dir.close();
+    }
+    TS_ASSERT_EQUALS(g2.num_vertices(), 100);
+    TS_ASSERT_EQUALS(g2.get_edges({7}, {FLEX_UNDEFINED}).num_rows(), 2);
+    sframe edges = create_sframe(
+        {{"source", flex_type_enum::INTEGER, {7}},
+         {"target", flex_type_enum::INTEGER, {500}}});
+    g2.add_edges(edges, "source", "target");
+    TS_ASSERT_EQUALS(g2.num_vertices(), 101);
+    TS_ASSERT_EQUALS(g2.get_edges({7}, {FLEX_UNDEFINED}).num_rows(), 3);
+  }
+};
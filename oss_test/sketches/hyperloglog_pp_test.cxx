@@ -0,0 +1,118 @@
+/*
+* Copyright (C) 2016 Turi
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Affero General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <sketches/hyperloglog_pp.hpp>
+#include <random/random.hpp>
+#include <cxxtest/TestSuite.h>
+
+using graphlab::sketches::hyperloglog_pp;
+
+class hyperloglog_pp_test: public CxxTest::TestSuite {
+ private:
+  void check_estimate(const hyperloglog_pp& hll, size_t num_unique) {
+    auto lower = hll.estimate() - 3 * hll.error_bound() - 1;
+    auto upper = hll.estimate() + 3 * hll.error_bound() + 1;
+    TS_ASSERT_LESS_THAN(lower, num_unique);
+    TS_ASSERT_LESS_THAN(num_unique, upper);
+  }
+
+  hyperloglog_pp save_load(const hyperloglog_pp& hll) {
+    std::stringstream strm;
+    graphlab::oarchive oarc(strm);
+    oarc << hll;
+    graphlab::iarchive iarc(strm);
+    hyperloglog_pp ret;
+    iarc >> ret;
+    return ret;
+  }
+
+ public:
+  void test_estimate() {
+    graphlab::random::seed(1001);
+    for (size_t precision : {8, 12, 16}) {
+      for (size_t num_unique : {0, 1, 10, 100, 1000, 10000, 100000, 1000000}) {
+        hyperloglog_pp hll(precision);
+        size_t base = graphlab::random::fast_uniform<size_t>(0, 1 << 30);
+        for (size_t i = 0; i < num_unique; ++i) {
+          // every value twice
+          hll.add(base + i);
+          hll.add(base + i);
+        }
+        check_estimate(hll, num_unique);
+        // small cardinalities are exact in the sparse representation
+        if (num_unique <= 100 && hll.is_sparse()) {
+          TS_ASSERT_EQUALS(std::llround(hll.estimate()), num_unique);
+        }
+        if (num_unique <= ((1 << precision) / 8)) TS_ASSERT(hll.is_sparse());
+        if (num_unique >= ((1 << precision) / 2)) TS_ASSERT(!hll.is_sparse());
+      }
+    }
+  }
+
+  void test_combine() {
+    graphlab::random::seed(1001);
+    for (size_t len : {100, 10000, 1000000}) {
+      // make a bunch of "parallel" sketches which can be combined
+      std::vector<hyperloglog_pp> hllarr(16, hyperloglog_pp(12));
+      hyperloglog_pp sequential_hll(12);
+      std::vector<size_t> v(len);
+      for (size_t i = 0; i < len; ++i) {
+        v[i] = graphlab::random::fast_uniform<size_t>(0, len - 1);
+        // skew the partitions, so that sparse and dense sketches are mixed
+        hllarr[i % 16 == 0 ? 0 : i % 4].add(v[i]);
+        sequential_hll.add(v[i]);
+      }
+      hyperloglog_pp hll(12);
+      for (size_t i = 0; i < hllarr.size(); ++i) hll.combine(hllarr[i]);
+
+      std::sort(v.begin(), v.end());
+      size_t num_unique = std::distance(v.begin(), std::unique(v.begin(), v.end()));
+      check_estimate(hll, num_unique);
+      TS_ASSERT_EQUALS(hll.estimate(), sequential_hll.estimate());
+      TS_ASSERT_EQUALS(hll.is_sparse(), sequential_hll.is_sparse());
+    }
+    hyperloglog_pp a(12), b(14);
+    TS_ASSERT_THROWS_ANYTHING(a.combine(b));
+  }
+
+  void test_save_load() {
+    for (size_t num_unique : {0, 50, 100000}) {
+      hyperloglog_pp hll(14);
+      for (size_t i = 0; i < num_unique; ++i) hll.add(std::to_string(i));
+      hyperloglog_pp loaded = save_load(hll);
+      TS_ASSERT_EQUALS(loaded.precision(), hll.precision());
+      TS_ASSERT_EQUALS(loaded.is_sparse(), hll.is_sparse());
+      TS_ASSERT_EQUALS(loaded.estimate(), hll.estimate());
+      // the loaded sketch keeps counting
+      hll.add(std::string("new"));
+      loaded.add(std::string("new"));
+      TS_ASSERT_EQUALS(loaded.estimate(), hll.estimate());
+    }
+  }
+
+  void test_memory() {
+    // small sketches stay in the sparse representation
+    hyperloglog_pp hll(16);
+    for (size_t i = 0; i < 1000; ++i) hll.add(i);
+    TS_ASSERT(hll.is_sparse());
+    TS_ASSERT_LESS_THAN(hll.memory_usage(), 16 * 1024);
+    for (size_t i = 0; i < 100000; ++i) hll.add(i);
+    TS_ASSERT(!hll.is_sparse());
+  }
+};
@@ -94,4 +94,38 @@ class flex_dict_test: public CxxTest::TestSuite {
     }
   }
 
-};
\ No newline at end of file
+  void test_indexed_lookup() {
+    flex_dict dict;
+    for(size_t i = 0; i < 100; i++) {
+      dict.push_back({std::to_string(i), i});
+      dict.push_back({flex_int(i), i * 10});
+    }
+    dict.push_back({2.5, "float"});
+    dict.push_back({flex_vec{1, 2}, "vector"});
+    // duplicated keys resolve to the first occurrence
+    dict.push_back({"7", "duplicate"});
+
+    flex_dict_view fdv(dict);
+    // enough lookups for the index to be built
+    for (size_t k = 0; k < 2 * flex_dict_view::INDEX_MIN_LOOKUPS; k++) {
+      for(size_t i = 0; i < 100; i++) {
+        TS_ASSERT(fdv.has_key(std::to_string(i)));
+        TS_ASSERT_EQUALS(fdv[std::to_string(i)], i);
+        TS_ASSERT_EQUALS(fdv[flex_int(i)], i * 10);
+        // integral floats are equal to integers
+        TS_ASSERT_EQUALS(fdv[flex_float(i)], i * 10);
+      }
+      TS_ASSERT_EQUALS(fdv[2.5], "float");
+      TS_ASSERT_EQUALS(fdv[(flex_vec{1, 2})], "vector");
+      TS_ASSERT(!fdv.has_key(100));
+      TS_ASSERT(!fdv.has_key(0.5));
+      TS_ASSERT(!fdv.has_key("some random value"));
+      TS_ASSERT(!fdv.has_key(FLEX_UNDEFINED));
+      TS_ASSERT_THROWS_ANYTHING(fdv["some random value"]);
+    }
+
+    flex_dict_key_hash hasher;
+    TS_ASSERT_EQUALS(hasher(flex_int(3)), hasher(flex_float(3)));
+    TS_ASSERT_EQUALS(hasher(flex_float(NAN)), hasher(flex_float(-NAN)));
+  }
+};
@@ -278,6 +278,20 @@ class gl_sframe_test: public CxxTest::TestSuite {
       sf["a"] = gl_sarray({1,1,2,2});
       sf["b"] = gl_sarray({"a","a","b","b"});
       _assert_sframe_equals(sf.unique().sort("a"), gl_sframe{{"a",{1,2}},{"b",{"a","b"}}});
+      TS_ASSERT_EQUALS(sf.num_unique_rows(), 2);
+      TS_ASSERT_EQUALS(sf.num_unique_rows(true), 2);
+    }
+
+    void test_rolling_apply() {
+      gl_sframe sf{{"user", {"b","a","a","b","a"}},
+                   {"time", {3,1,2,1,5}},
+                   {"amount", {10,1,2,20,4}}};
+      auto res = sf.builtin_rolling_apply({"user"}, "time", "amount",
+                                          "__builtin__sum__", -2, 0, "total");
+      _assert_sframe_equals(res, gl_sframe{{"user", {"a","a","a","b","b"}},
+                                           {"time", {1,2,5,1,3}},
+                                           {"amount", {1,2,4,20,10}},
+                                           {"total", {1,3,4,20,30}}});
     }
 
     void test_drop_na() {
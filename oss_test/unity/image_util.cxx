@@ -14,14 +14,18 @@
 * You should have received a copy of the GNU Affero General Public License
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
+#include <cmath>
 #include <iostream>
 
 #include <cxxtest/TestSuite.h>
 
 #include <unistd.h>
 
+#include <fileio/temp_files.hpp>
+#include <image/io.hpp>
 #include <image/image_type.hpp>
 #include <unity/lib/image_util.hpp>
+#include <unity/lib/unity_sarray.hpp>
 
 using namespace graphlab;
 using namespace graphlab::image_util;
@@ -99,7 +103,161 @@ class image_util_test: public CxxTest::TestSuite {
     _test_resize_impl(image_wrapped, height, width, channels, false);
   }
 
+  void test_image_pipeline() {
+    // raw and png images of different sizes, a missing value and a corrupt image
+    std::vector<flexible_type> images;
+    for (size_t i = 0; i < 200; ++i) {
+      size_t height = 4 + i % 7;
+      size_t width = 5 + i % 5;
+      size_t channels = (i % 3 == 0) ? 1 : 3;
+      std::vector<char> pixels(height * width * channels);
+      for (size_t j = 0; j < pixels.size(); ++j) pixels[j] = (char)(i * 31 + j * 7);
+      flexible_type image = image_type(pixels.data(), height, width, channels,
+                                       pixels.size(), IMAGE_TYPE_CURRENT_VERSION,
+                                       (int)Format::RAW_ARRAY);
+      images.push_back(i % 2 ? encode_image(image) : image);
+    }
+    images.push_back(FLEX_UNDEFINED);
+    std::string garbage = "not an image";
+    flexible_type corrupt = image_type(garbage.c_str(), 2, 2, 3, garbage.size(),
+                                       IMAGE_TYPE_CURRENT_VERSION, (int)Format::PNG);
+    auto input = std::make_shared<unity_sarray>();
+    input->construct_from_vector(images, flex_type_enum::IMAGE);
+
+    auto vectors = image_pipeline_sarray(input, 6, 8, 3, true, false);
+    auto resized = image_pipeline_sarray(input, 6, 8, 3, false, false);
+    TS_ASSERT_EQUALS(vectors->dtype(), flex_type_enum::VECTOR);
+    TS_ASSERT_EQUALS(resized->dtype(), flex_type_enum::IMAGE);
+    auto vector_values = vectors->_head(images.size());
+    auto image_values = resized->_head(images.size());
+    TS_ASSERT_EQUALS(vector_values.size(), images.size());
+    for (size_t i = 0; i + 1 < images.size(); ++i) {
+      // identical to decode + resize + convert one image at a time
+      flexible_type expected = resize_image(images[i], 6, 8, 3, true);
+      flexible_type expected_vector(flex_type_enum::VECTOR);
+      expected_vector.soft_assign(expected);
+      TS_ASSERT(vector_values[i] == expected_vector);
+      const flex_image& img = image_values[i].get<flex_image>();
+      TS_ASSERT(img.is_decoded());
+      TS_ASSERT_EQUALS(img.m_width, 6);
+      TS_ASSERT_EQUALS(img.m_height, 8);
+      TS_ASSERT_EQUALS(img.m_channels, 3);
+      flexible_type image_vector(flex_type_enum::VECTOR);
+      image_vector.soft_assign(image_values[i]);
+      TS_ASSERT(image_vector == expected_vector);
+    }
+    TS_ASSERT_EQUALS(vector_values.back().get_type(), flex_type_enum::UNDEFINED);
+
+    // corrupt images fail, or become missing values
+    images.push_back(corrupt);
+    input->construct_from_vector(images, flex_type_enum::IMAGE);
+    TS_ASSERT_THROWS_ANYTHING(image_pipeline_sarray(input, 6, 8, 3, true, false));
+    auto tolerant = image_pipeline_sarray(input, 6, 8, 3, true, true);
+    TS_ASSERT_EQUALS(tolerant->size(), images.size());
+    TS_ASSERT_EQUALS(tolerant->_head(images.size()).back().get_type(), flex_type_enum::UNDEFINED);
+    TS_ASSERT_THROWS_ANYTHING(image_pipeline_sarray(input, 6, 8, 2, true, true));
+  }
+
+  void test_image_pipeline_jpeg() {
+    // JPEG images are downscaled while decoding by the largest of 1/2, 1/4
+    // and 1/8 which keeps at least the resized size
+    struct jpeg_case {
+      size_t width, height, resized_width, resized_height, scale_denom;
+    };
+    std::vector<jpeg_case> cases{{64, 48, 8, 6, 8},
+                                 {64, 48, 16, 12, 4},
+                                 {64, 48, 30, 20, 2},
+                                 {64, 48, 40, 40, 1},
+                                 {63, 47, 8, 6, 8},
+                                 {200, 120, 24, 15, 8},
+                                 {200, 120, 50, 30, 4}};
+    // The pixels only differ from a full decode + resize by the averaging of
+    // the downscaling, which is small on smooth images.
+    const int max_pixel_difference = 16;
+    const double max_mean_difference = 6;
+
+    for (const auto& c : cases) {
+      std::vector<flexible_type> images;
+      for (size_t channels : {1, 3}) {
+        image_type image = make_jpeg_image(c.height, c.width, channels);
+        TS_ASSERT_EQUALS((int)image.m_format, (int)Format::JPG);
+        TS_ASSERT(!image.is_decoded());
+
+        std::vector<char> decoded;
+        size_t width = 0, height = 0, decoded_channels = 0;
+        decode_jpeg_scaled((const char*)image.get_image_data(), image.m_image_data_size,
+                           c.resized_width, c.resized_height,
+                           decoded, width, height, decoded_channels);
+        TS_ASSERT_EQUALS(width, (c.width + c.scale_denom - 1) / c.scale_denom);
+        TS_ASSERT_EQUALS(height, (c.height + c.scale_denom - 1) / c.scale_denom);
+        TS_ASSERT_EQUALS(decoded_channels, channels);
+        TS_ASSERT_EQUALS(decoded.size(), width * height * channels);
+        images.push_back(image);
+      }
+      auto input = std::make_shared<unity_sarray>();
+      input->construct_from_vector(images, flex_type_enum::IMAGE);
+
+      for (size_t channels : {1, 3}) {
+        auto vectors = image_pipeline_sarray(input, c.resized_width, c.resized_height,
+                                             channels, true, false);
+        auto resized = image_pipeline_sarray(input, c.resized_width, c.resized_height,
+                                             channels, false, false);
+        auto vector_values = vectors->_head(images.size());
+        auto image_values = resized->_head(images.size());
+        TS_ASSERT_EQUALS(vector_values.size(), images.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+          const flex_image& img = image_values[i].get<flex_image>();
+          TS_ASSERT_EQUALS(img.m_width, c.resized_width);
+          TS_ASSERT_EQUALS(img.m_height, c.resized_height);
+          TS_ASSERT_EQUALS(img.m_channels, channels);
+
+          flexible_type expected = resize_image(images[i], c.resized_width,
+                                                c.resized_height, channels, true);
+          flexible_type expected_vector(flex_type_enum::VECTOR);
+          expected_vector.soft_assign(expected);
+          const flex_vec& actual = vector_values[i].get<flex_vec>();
+          const flex_vec& reference = expected_vector.get<flex_vec>();
+          TS_ASSERT_EQUALS(actual.size(), c.resized_width * c.resized_height * channels);
+          TS_ASSERT_EQUALS(actual.size(), reference.size());
+          if (actual.size() != reference.size()) continue;
+          int max_difference = 0;
+          double total_difference = 0;
+          for (size_t j = 0; j < actual.size(); ++j) {
+            int difference = std::abs((int)actual[j] - (int)reference[j]);
+            max_difference = std::max(max_difference, difference);
+            total_difference += difference;
+          }
+          TS_ASSERT_LESS_THAN_EQUALS(max_difference, max_pixel_difference);
+          TS_ASSERT_LESS_THAN_EQUALS(total_difference / actual.size(), max_mean_difference);
+          if (c.scale_denom == 1) {
+            // no downscaling, identical to a full decode
+            TS_ASSERT_EQUALS(max_difference, 0);
+          }
+        }
+      }
+    }
+  }
+
  private:
+  /**
+   * Returns a JPEG encoded image of smooth gradients.
+   */
+  image_type make_jpeg_image(size_t height, size_t width, size_t channels) {
+    std::vector<char> pixels(height * width * channels);
+    for (size_t y = 0; y < height; ++y) {
+      for (size_t x = 0; x < width; ++x) {
+        for (size_t k = 0; k < channels; ++k) {
+          pixels[(y * width + x) * channels + k] =
+              (unsigned char)(128 + 60 * std::sin(M_PI * x / width + k) *
+                                         std::cos(M_PI * y / height));
+        }
+      }
+    }
+    std::string filename = get_temp_name() + ".jpg";
+    write_image(filename, pixels.data(), width, height, channels, Format::JPG);
+    return read_image(filename, "JPG");
+  }
+
   image_type make_raw_image(size_t height, size_t width, size_t channels) {
     int format = (int)(Format::RAW_ARRAY);
     int version = IMAGE_TYPE_CURRENT_VERSION;
@@ -19,6 +19,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include <unity/lib/unity_sarray.hpp>
+#include <unity/lib/unity_sframe.hpp>
 #include <unity/lib/unity_sketch.hpp>
 
 using namespace graphlab;
@@ -206,4 +207,65 @@ class unity_sketch_test: public CxxTest::TestSuite {
     std::static_pointer_cast<unity_sketch>(sketch)->construct_from_sarray(intl);
   }
   
+  void test_sframe_sketch() {
+    // numeric, string and list columns, sketched in one pass
+    size_t n = 50000;
+    std::vector<flexible_type> nums, strs, lists;
+    for (size_t i = 0; i < n; ++i) {
+      nums.push_back(i % 7 == 0 ? flexible_type(FLEX_UNDEFINED) : flexible_type(i % 100));
+      strs.push_back(std::to_string(i % 10));
+      lists.push_back(flex_list{i % 3, i % 5});
+    }
+    auto sf = std::make_shared<unity_sframe>();
+    auto num_column = std::make_shared<unity_sarray>();
+    num_column->construct_from_vector(nums, flex_type_enum::INTEGER);
+    auto str_column = std::make_shared<unity_sarray>();
+    str_column->construct_from_vector(strs, flex_type_enum::STRING);
+    auto list_column = std::make_shared<unity_sarray>();
+    list_column->construct_from_vector(lists, flex_type_enum::LIST);
+    sf->add_column(num_column, std::string("num"));
+    sf->add_column(str_column, std::string("str"));
+    sf->add_column(list_column, std::string("list"));
+
+    auto sketches = unity_sketch::construct_from_sframe(sf);
+    TS_ASSERT_EQUALS(sketches.size(), 3);
+
+    // identical to sketching each column separately
+    for (size_t c = 0; c < 3; ++c) {
+      auto column = std::static_pointer_cast<unity_sarray_base>(
+          c == 0 ? num_column : (c == 1 ? str_column : list_column));
+      unity_sketch expected;
+      expected.construct_from_sarray(column);
+      TS_ASSERT(sketches[c]->sketch_ready());
+      TS_ASSERT_EQUALS(sketches[c]->size(), n);
+      TS_ASSERT_EQUALS(sketches[c]->num_undefined(), expected.num_undefined());
+      TS_ASSERT_EQUALS(sketches[c]->num_unique(), expected.num_unique());
+    }
+    TS_ASSERT_EQUALS(sketches[0]->sum(), num_column->sum());
+    TS_ASSERT_EQUALS(sketches[0]->min(), 1);
+    TS_ASSERT_EQUALS(sketches[0]->max(), 99);
+    TS_ASSERT_DELTA(sketches[1]->frequency_count(flexible_type("3")), n / 10, n / 100);
+    auto lengths = sketches[2]->element_length_summary();
+    TS_ASSERT_EQUALS(lengths->min(), 2);
+    TS_ASSERT_EQUALS(lengths->max(), 2);
+
+    // a sampled scan only covers part of the rows
+    auto sampled = unity_sketch::construct_from_sframe(sf, 0.25);
+    TS_ASSERT_LESS_THAN(sampled[0]->size(), n / 2);
+    TS_ASSERT_LESS_THAN(0, sampled[0]->size());
+    TS_ASSERT_EQUALS(sampled[1]->size(), sampled[0]->size());
+    TS_ASSERT_DELTA(sampled[1]->num_unique(), 10, 1);
+    TS_ASSERT_THROWS_ANYTHING(unity_sketch::construct_from_sframe(sf, 0));
+
+    // an empty sframe
+    auto empty = std::make_shared<unity_sframe>();
+    dataframe_t df;
+    df.set_column("empty", std::vector<flexible_type>(), flex_type_enum::FLOAT);
+    empty->construct_from_dataframe(df);
+    auto empty_sketches = unity_sketch::construct_from_sframe(empty);
+    TS_ASSERT_EQUALS(empty_sketches.size(), 1);
+    TS_ASSERT_EQUALS(empty_sketches[0]->size(), 0);
+    TS_ASSERT(std::isnan(empty_sketches[0]->min()));
+  }
+
 };